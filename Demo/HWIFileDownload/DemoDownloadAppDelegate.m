@@ -78,6 +78,8 @@
     {
         self.fileDownloader = [[HWIFileDownloader alloc] initWithDelegate:self.demoDownloadStore maxConcurrentDownloads:1];
     }
+    // refresh progress display about four times per second
+    self.fileDownloader.maximumProgressDeliveryRate = 4.0;
     [self.fileDownloader setupWithCompletionBlock:nil];
     
     
@@ -252,6 +252,25 @@ static void *DemoDownloadStoreProgressObserverContext = &DemoDownloadStoreProgre
 #pragma mark HWIFileDownloadDelegate (optional)
 
 
+- (void)downloadProgressChangedForIdentifiers:(nonnull NSDictionary<NSString *, HWIFileDownloadProgress *> *)aDownloadProgressesDictionary
+{
+    for (DemoDownloadItem *aDemoDownloadItem in self.downloadItemsArray)
+    {
+        HWIFileDownloadProgress *aFileDownloadProgress = [aDownloadProgressesDictionary objectForKey:aDemoDownloadItem.downloadIdentifier];
+        if (aFileDownloadProgress)
+        {
+            aDemoDownloadItem.progress = aFileDownloadProgress;
+            if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+            {
+                aDemoDownloadItem.progress.lastLocalizedDescription = aDemoDownloadItem.progress.nativeProgress.localizedDescription;
+                aDemoDownloadItem.progress.lastLocalizedAdditionalDescription = aDemoDownloadItem.progress.nativeProgress.localizedAdditionalDescription;
+            }
+        }
+    }
+    [[NSNotificationCenter defaultCenter] postNotificationName:downloadProgressChangedNotification object:nil];
+}
+
+
 - (void)downloadProgressChangedForIdentifier:(nonnull NSString *)aDownloadIdentifier
 {
     NSUInteger aFoundDownloadItemIndex = [self.downloadItemsArray indexOfObjectPassingTest:^BOOL(DemoDownloadItem *aDemoDownloadItem, NSUInteger anIndex, BOOL *aStopFlag) {
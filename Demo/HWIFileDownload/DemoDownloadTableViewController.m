@@ -61,7 +61,6 @@
 @property (nonatomic, weak) UIProgressView *totalProgressView;
 @property (nonatomic, weak) UILabel *totalProgressLocalizedDescriptionLabel;
 
-@property (nonatomic, strong, nullable) NSDate *lastProgressChangedUpdate;
 @end
 
 
@@ -436,17 +435,8 @@
 
 - (void)onProgressDidChange:(NSNotification *)aNotification
 {
-    NSTimeInterval aLastProgressChangedUpdateDelta = 0.0;
-    if (self.lastProgressChangedUpdate)
-    {
-        aLastProgressChangedUpdateDelta = [[NSDate date] timeIntervalSinceDate:self.lastProgressChangedUpdate];
-    }
-    // refresh progress display about four times per second
-    if ((aLastProgressChangedUpdateDelta == 0.0) || (aLastProgressChangedUpdateDelta > 0.25))
-    {
-        [self.tableView reloadData];
-        self.lastProgressChangedUpdate = [NSDate date];
-    }
+    // progress changes are coalesced by the file downloader (see maximumProgressDeliveryRate)
+    [self.tableView reloadData];
 }
 
 
@@ -0,0 +1,48 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkAppDelegate.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <UIKit/UIKit.h>
+
+
+/**
+ BenchmarkAppDelegate runs the benchmark scenarios on launch and writes the report.
+ @discussion The report is written as JSON to BenchmarkReport.json in the documents directory, then the app exits. The scenario resume after kill ends the first launch by killing the process; the next launch restores its downloads from the queue journal and completes the report. Scenarios are selected with the launch argument -BenchmarkScenarios and comma separated names (default: all); their sizes are set with the launch arguments described in BenchmarkScenarioCatalog.
+ */
+@interface BenchmarkAppDelegate : UIResponder <UIApplicationDelegate>
+
+@property (nullable, nonatomic, strong) UIWindow *window;
+
+@end
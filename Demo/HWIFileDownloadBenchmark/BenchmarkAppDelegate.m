@@ -0,0 +1,190 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkAppDelegate.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "BenchmarkAppDelegate.h"
+#import "BenchmarkScenario.h"
+#import "BenchmarkScenarioCatalog.h"
+
+
+@interface BenchmarkAppDelegate()
+@property (nonatomic, strong, nonnull) NSURL *benchmarkDirectoryURL;
+@property (nonatomic, strong, nonnull) NSURL *interruptedReportFileURL;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, id> *reportDictionary;
+@property (nonatomic, strong, nonnull) NSMutableArray<BenchmarkScenario *> *pendingScenariosArray;
+@property (nonatomic, strong, nullable) BenchmarkScenario *runningScenario;
+@end
+
+
+
+@implementation BenchmarkAppDelegate
+
+
+- (BOOL)application:(UIApplication *)anApplication didFinishLaunchingWithOptions:(nullable NSDictionary *)aLaunchOptionsDict
+{
+    // setup UI
+    self.window = [[UIWindow alloc] initWithFrame:[[UIScreen mainScreen] bounds]];
+    UIViewController *aViewController = [[UIViewController alloc] init];
+    aViewController.view.backgroundColor = [UIColor whiteColor];
+    [self.window setRootViewController:aViewController];
+    [self.window makeKeyAndVisible];
+    
+    
+    // setup scenarios
+    NSURL *aCachesDirectoryURL = [[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].firstObject;
+    self.benchmarkDirectoryURL = [aCachesDirectoryURL URLByAppendingPathComponent:@"Benchmark" isDirectory:YES];
+    self.interruptedReportFileURL = [self.benchmarkDirectoryURL URLByAppendingPathComponent:@"InterruptedReport.json" isDirectory:NO];
+    NSData *anInterruptedReportData = [NSData dataWithContentsOfURL:self.interruptedReportFileURL];
+    NSDictionary *anInterruptedReportDictionary = nil;
+    if (anInterruptedReportData)
+    {
+        anInterruptedReportDictionary = [NSJSONSerialization JSONObjectWithData:anInterruptedReportData options:NSJSONReadingMutableContainers error:NULL];
+        // a failing second launch does not continue again
+        [[NSFileManager defaultManager] removeItemAtURL:self.interruptedReportFileURL error:NULL];
+    }
+    if ([anInterruptedReportDictionary isKindOfClass:[NSMutableDictionary class]])
+    {
+        self.reportDictionary = (NSMutableDictionary *)anInterruptedReportDictionary;
+        self.pendingScenariosArray = [NSMutableArray arrayWithObject:[BenchmarkScenarioCatalog resumeAfterKillScenarioWithBenchmarkDirectoryURL:self.benchmarkDirectoryURL restoresQueueJournal:YES]];
+    }
+    else
+    {
+        [[NSFileManager defaultManager] removeItemAtURL:self.benchmarkDirectoryURL error:NULL];
+        NSError *aCreateError = nil;
+        BOOL aCreateSuccess = [[NSFileManager defaultManager] createDirectoryAtURL:self.benchmarkDirectoryURL withIntermediateDirectories:YES attributes:nil error:&aCreateError];
+        if (aCreateSuccess == NO)
+        {
+            NSLog(@"ERR: Unable to create directory at %@: %@ (%@, %d)", self.benchmarkDirectoryURL, aCreateError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        self.reportDictionary = [self initialReportDictionary];
+        self.pendingScenariosArray = [self selectedScenarios];
+    }
+    [self runNextScenario];
+    
+    
+    return YES;
+}
+
+
+#pragma mark - Scenarios
+
+
+- (nonnull NSMutableArray<BenchmarkScenario *> *)selectedScenarios
+{
+    NSMutableArray<BenchmarkScenario *> *aScenariosArray = [[BenchmarkScenarioCatalog scenariosWithBenchmarkDirectoryURL:self.benchmarkDirectoryURL] mutableCopy];
+    NSString *aSelectedScenarioNamesString = [[NSUserDefaults standardUserDefaults] stringForKey:@"BenchmarkScenarios"];
+    if (aSelectedScenarioNamesString.length > 0)
+    {
+        NSArray<NSString *> *aSelectedScenarioNamesArray = [aSelectedScenarioNamesString componentsSeparatedByString:@","];
+        [aScenariosArray filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(BenchmarkScenario *aScenario, NSDictionary *aBindingsDict) {
+            return [aSelectedScenarioNamesArray containsObject:aScenario.name];
+        }]];
+    }
+    return aScenariosArray;
+}
+
+
+- (void)runNextScenario
+{
+    BenchmarkScenario *aScenario = self.pendingScenariosArray.firstObject;
+    if (aScenario)
+    {
+        [self.pendingScenariosArray removeObjectAtIndex:0];
+        if (aScenario.killDelay > 0.0)
+        {
+            // continued by the next launch
+            [self writeReportToFileURL:self.interruptedReportFileURL];
+        }
+        self.runningScenario = aScenario;
+        __weak BenchmarkAppDelegate *weakSelf = self;
+        [aScenario runWithCompletionBlock:^(NSDictionary<NSString *, id> *aResultDictionary) {
+            BenchmarkAppDelegate *strongSelf = weakSelf;
+            [[strongSelf.reportDictionary objectForKey:@"scenarios"] addObject:aResultDictionary];
+            strongSelf.runningScenario = nil;
+            [strongSelf runNextScenario];
+        }];
+    }
+    else
+    {
+        NSURL *aDocumentsDirectoryURL = [[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask].firstObject;
+        NSURL *aReportFileURL = [aDocumentsDirectoryURL URLByAppendingPathComponent:@"BenchmarkReport.json" isDirectory:NO];
+        if ([self writeReportToFileURL:aReportFileURL])
+        {
+            NSLog(@"INFO: Benchmark report written to %@", aReportFileURL.path);
+        }
+        [[NSFileManager defaultManager] removeItemAtURL:self.benchmarkDirectoryURL error:NULL];
+        exit(EXIT_SUCCESS);
+    }
+}
+
+
+#pragma mark - Report
+
+
+- (nonnull NSMutableDictionary<NSString *, id> *)initialReportDictionary
+{
+    NSDateFormatter *aDateFormatter = [[NSDateFormatter alloc] init];
+    aDateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+    aDateFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ssZZZZZ";
+    UIDevice *aDevice = [UIDevice currentDevice];
+    NSMutableDictionary<NSString *, id> *aReportDictionary = [NSMutableDictionary dictionary];
+    [aReportDictionary setObject:[aDateFormatter stringFromDate:[NSDate date]] forKey:@"date"];
+    [aReportDictionary setObject:aDevice.model forKey:@"deviceModel"];
+    [aReportDictionary setObject:[NSString stringWithFormat:@"%@ %@", aDevice.systemName, aDevice.systemVersion] forKey:@"system"];
+    [aReportDictionary setObject:@([NSProcessInfo processInfo].activeProcessorCount) forKey:@"activeProcessorCount"];
+#if DEBUG
+    [aReportDictionary setObject:@"Debug" forKey:@"buildConfiguration"];
+#else
+    [aReportDictionary setObject:@"Release" forKey:@"buildConfiguration"];
+#endif
+    [aReportDictionary setObject:[NSMutableArray array] forKey:@"scenarios"];
+    return aReportDictionary;
+}
+
+
+- (BOOL)writeReportToFileURL:(nonnull NSURL *)aFileURL
+{
+    NSError *aWriteError = nil;
+    NSData *aReportData = [NSJSONSerialization dataWithJSONObject:self.reportDictionary options:NSJSONWritingPrettyPrinted error:&aWriteError];
+    BOOL aWriteSuccess = (aReportData && [aReportData writeToURL:aFileURL options:NSDataWritingAtomic error:&aWriteError]);
+    if (aWriteSuccess == NO)
+    {
+        NSLog(@"ERR: Unable to write benchmark report to %@: %@ (%@, %d)", aFileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    return aWriteSuccess;
+}
+
+
+@end
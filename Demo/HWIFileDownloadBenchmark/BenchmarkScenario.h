@@ -0,0 +1,227 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkScenario.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadDelegate.h"
+
+
+@class BenchmarkScenario;
+@class HWIFileDownloader;
+@class HWIFileDownloadLoopbackTransport;
+@class HWIFileDownloadOptions;
+
+
+/**
+ BenchmarkScenarioCompletionBlock is called with the result of a scenario.
+ */
+typedef void (^BenchmarkScenarioCompletionBlock)(NSDictionary<NSString *, id> * _Nonnull resultDictionary);
+
+/**
+ BenchmarkScenarioConfigurationBlock is called with the downloader of a scenario before it is set up.
+ */
+typedef void (^BenchmarkScenarioConfigurationBlock)(BenchmarkScenario * _Nonnull scenario, HWIFileDownloader * _Nonnull fileDownloader, HWIFileDownloadLoopbackTransport * _Nullable transport);
+
+/**
+ BenchmarkScenarioBlock is called at a stage of a scenario.
+ */
+typedef void (^BenchmarkScenarioBlock)(BenchmarkScenario * _Nonnull scenario);
+
+/**
+ BenchmarkScenarioFileBlock is called with a downloaded file of a scenario.
+ */
+typedef void (^BenchmarkScenarioFileBlock)(BenchmarkScenario * _Nonnull scenario, NSString * _Nonnull downloadIdentifier, NSURL * _Nonnull localFileURL);
+
+
+/**
+ BenchmarkScenario downloads a number of files from a loopback transport (or a local HTTP server) and measures the downloader.
+ @discussion Each run uses its own HWIFileDownloader with an HWIFileDownloadLoopbackTransport, or with a background NSURLSession if serverURL is set; delegate notifications are handled on the main queue. The blocks adapt a scenario to a measurement, e.g. by configuring the downloader, sampling it while downloading or running a microbenchmark after the start; a scenario without downloads runs the blocks only. The result holds the keys name, downloadsCount, fileSize, completedDownloadsCount, failedDownloadsCount, cancelledDownloadsCount, pausedDownloadsCount, duration (seconds), receivedBytesCount, bytesPerSecond, completionLatencyP50 and completionLatencyP99 (seconds from start to completion of the completed downloads), cpuTime and cpuTimePerMB (seconds of the process), peakResidentSize and residentSize (bytes of the process), mainQueueBusyTime (seconds the main run loop has not been waiting), statistics (statisticsDictionary of the downloader) and measurements (measurementsDictionary). Values are JSON serializable.
+ */
+@interface BenchmarkScenario : NSObject <HWIFileDownloadDelegate>
+
+/**
+ Designated initializer.
+ @param aName Name of the scenario, used for download identifiers and the directory of the downloaded files.
+ @param aDownloadsCount Number of downloads started.
+ @param aFileSize Number of bytes of each download.
+ @return Benchmark scenario.
+ */
+- (nonnull instancetype)initWithName:(nonnull NSString *)aName downloadsCount:(NSUInteger)aDownloadsCount fileSize:(int64_t)aFileSize NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init __attribute__((unavailable("use initWithName:downloadsCount:fileSize:")));
++ (nonnull instancetype)new __attribute__((unavailable("use initWithName:downloadsCount:fileSize:")));
+
+
+/**
+ Name of the scenario.
+ */
+@property (nonatomic, copy, readonly, nonnull) NSString *name;
+
+/**
+ Number of downloads started.
+ */
+@property (nonatomic, assign, readonly) NSUInteger downloadsCount;
+
+/**
+ Number of bytes of each download.
+ */
+@property (nonatomic, assign, readonly) int64_t fileSize;
+
+/**
+ Maximum number of concurrent downloads (default: 8).
+ */
+@property (nonatomic, assign) NSInteger maxConcurrentDownloadsCount;
+
+/**
+ Transfer rate of each transfer in bytes per second (default: 0, as fast as possible).
+ */
+@property (nonatomic, assign) int64_t bytesPerSecond;
+
+/**
+ Share of downloads cancelled at a random time within cancelAndPauseInterval (range 0.0 ... 1.0, default: 0.0).
+ */
+@property (nonatomic, assign) double cancelRate;
+
+/**
+ Share of downloads paused at a random time within cancelAndPauseInterval and started again (range 0.0 ... 1.0, default: 0.0).
+ */
+@property (nonatomic, assign) double pauseRate;
+
+/**
+ Interval after the start in which downloads are cancelled and paused (default: 2.0).
+ */
+@property (nonatomic, assign) NSTimeInterval cancelAndPauseInterval;
+
+/**
+ Local file URL of the queue journal of the downloader (default: nil, no journal).
+ */
+@property (nonatomic, strong, nullable) NSURL *queueJournalFileURL;
+
+/**
+ Flag whether the downloads of the queue journal are restored instead of starting downloads (default: NO).
+ @discussion The downloads count is taken from the restored downloads; completion latencies are measured from the setup of the downloader.
+ */
+@property (nonatomic, assign) BOOL restoresQueueJournal;
+
+/**
+ Delay after the start when the process is killed (default: 0.0, not killed).
+ @discussion The completion block is not called; the downloads of the queue journal are restored by a scenario with restoresQueueJournal on the next launch.
+ */
+@property (nonatomic, assign) NSTimeInterval killDelay;
+
+/**
+ Base URL of a local HTTP server (default: nil, loopback transport).
+ @discussion The downloads are requested from <serverURL>/<fileSize>/<download identifier> with a background NSURLSession, e.g. from BenchmarkServer.py of the benchmark app.
+ */
+@property (nonatomic, strong, nullable) NSURL *serverURL;
+
+/**
+ Options of the downloads (default: nil, default options).
+ */
+@property (nonatomic, strong, nullable) HWIFileDownloadOptions *options;
+
+/**
+ Numbers of entries measured by a microbenchmark, e.g. sizes of a queue (default: empty).
+ */
+@property (nonatomic, copy, nonnull) NSArray<NSNumber *> *entriesCounts;
+
+/**
+ Block called on the main queue after the downloader has been created and before it is set up (default: nil).
+ */
+@property (nonatomic, copy, nullable) BenchmarkScenarioConfigurationBlock configurationBlock;
+
+/**
+ Block called on the main queue after the downloads have been started or restored (default: nil).
+ */
+@property (nonatomic, copy, nullable) BenchmarkScenarioBlock startedBlock;
+
+/**
+ Interval of calling sampleBlock while the scenario runs (default: 0.0, no sampling).
+ */
+@property (nonatomic, assign) NSTimeInterval sampleInterval;
+
+/**
+ Block called on the main queue every sampleInterval while the scenario runs (default: nil).
+ */
+@property (nonatomic, copy, nullable) BenchmarkScenarioBlock sampleBlock;
+
+/**
+ Block called on a serial background queue with each downloaded file before it is removed (default: nil).
+ @discussion The scenario finishes after the block has run for all downloaded files. Measurements of the block are to be recorded on the main queue.
+ */
+@property (nonatomic, copy, nullable) BenchmarkScenarioFileBlock completedFileBlock;
+
+/**
+ Block called on the main queue after all downloads have completed or failed, before the result is taken (default: nil).
+ */
+@property (nonatomic, copy, nullable) BenchmarkScenarioBlock finishedBlock;
+
+/**
+ Downloader of the running scenario.
+ */
+@property (nonatomic, strong, readonly, nullable) HWIFileDownloader *fileDownloader;
+
+/**
+ Loopback transport of the running scenario (nil with serverURL).
+ */
+@property (nonatomic, strong, readonly, nullable) HWIFileDownloadLoopbackTransport *transport;
+
+/**
+ Measurements of the blocks, added to the result with the key measurements. Values need to be JSON serializable. Accessed on the main queue.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSMutableDictionary<NSString *, id> *measurementsDictionary;
+
+/**
+ Remote URL of a download of the scenario.
+ @param aDownloadIdentifier Download identifier.
+ @return Remote URL.
+ */
+- (nonnull NSURL *)remoteURLForDownloadIdentifier:(nonnull NSString *)aDownloadIdentifier;
+
+/**
+ Returns the resident size of the process.
+ @return Resident size in bytes.
+ */
++ (int64_t)residentSize;
+
+
+/**
+ Runs the scenario.
+ @param aCompletionBlock Block called on the main queue with the result after all downloads have completed or failed.
+ @discussion Needs to be called on the main queue.
+ */
+- (void)runWithCompletionBlock:(nonnull BenchmarkScenarioCompletionBlock)aCompletionBlock;
+
+@end
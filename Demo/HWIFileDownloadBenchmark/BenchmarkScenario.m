@@ -0,0 +1,501 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkScenario.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "BenchmarkScenario.h"
+#import "HWIFileDownloader.h"
+#import "HWIFileDownloadLoopbackTransport.h"
+
+#import <mach/mach.h>
+#import <signal.h>
+#import <unistd.h>
+
+
+@interface BenchmarkScenario()
+@property (nonatomic, copy, readwrite, nonnull) NSString *name;
+@property (nonatomic, assign, readwrite) NSUInteger downloadsCount;
+@property (nonatomic, assign, readwrite) int64_t fileSize;
+@property (nonatomic, strong, readwrite, nullable) HWIFileDownloader *fileDownloader;
+@property (nonatomic, strong, readwrite, nullable) HWIFileDownloadLoopbackTransport *transport;
+@property (nonatomic, strong, readwrite, nonnull) NSMutableDictionary<NSString *, id> *measurementsDictionary;
+@property (nonatomic, strong, nullable) NSURL *directoryURL;
+@property (nonatomic, copy, nullable) BenchmarkScenarioCompletionBlock completionBlock;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSNumber *> *startTimesDictionary;
+@property (nonatomic, strong, nonnull) NSMutableArray<NSNumber *> *completionLatenciesArray;
+@property (nonatomic, strong, nonnull) NSMutableSet<NSString *> *pausedIdentifiersSet;
+@property (nonatomic, strong, nonnull) NSMutableSet<NSString *> *settledIdentifiersSet;
+@property (nonatomic, assign) NSUInteger expectedDownloadsCount;
+@property (nonatomic, assign) NSUInteger completedDownloadsCount;
+@property (nonatomic, assign) NSUInteger failedDownloadsCount;
+@property (nonatomic, assign) NSUInteger cancelledDownloadsCount;
+@property (nonatomic, assign) NSUInteger pausedDownloadsCount;
+@property (nonatomic, assign) NSTimeInterval startTime;
+@property (nonatomic, assign) NSTimeInterval startCPUTime;
+@property (nonatomic, assign) BOOL isSetUp;
+@property (nonatomic, assign, nullable) CFRunLoopObserverRef mainRunLoopObserver;
+@property (nonatomic, assign) NSTimeInterval mainQueueBusyTime;
+@property (nonatomic, assign) NSTimeInterval mainQueueBusyStartTime;
+@property (nonatomic, strong, nonnull) dispatch_queue_t fileRemovalDispatchQueue;
+@property (nonatomic, strong, nullable) dispatch_source_t sampleTimerSource;
+@end
+
+
+
+@implementation BenchmarkScenario
+
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)aName downloadsCount:(NSUInteger)aDownloadsCount fileSize:(int64_t)aFileSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.name = aName;
+        self.downloadsCount = aDownloadsCount;
+        self.fileSize = aFileSize;
+        self.maxConcurrentDownloadsCount = 8;
+        self.cancelAndPauseInterval = 2.0;
+        self.entriesCounts = @[];
+        self.measurementsDictionary = [NSMutableDictionary dictionary];
+        self.startTimesDictionary = [NSMutableDictionary dictionary];
+        self.completionLatenciesArray = [NSMutableArray array];
+        self.pausedIdentifiersSet = [NSMutableSet set];
+        self.settledIdentifiersSet = [NSMutableSet set];
+        // downloaded files are removed off the main queue so that the main queue measures the delegate notifications only
+        self.fileRemovalDispatchQueue = dispatch_queue_create("BenchmarkScenario.fileRemoval", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+
+#pragma mark - Run
+
+
+- (void)runWithCompletionBlock:(nonnull BenchmarkScenarioCompletionBlock)aCompletionBlock
+{
+    self.completionBlock = aCompletionBlock;
+    
+    NSURL *aCachesDirectoryURL = [[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].firstObject;
+    self.directoryURL = [[aCachesDirectoryURL URLByAppendingPathComponent:@"BenchmarkDownloads" isDirectory:YES] URLByAppendingPathComponent:self.name isDirectory:YES];
+    NSError *aCreateError = nil;
+    BOOL aCreateSuccess = [[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:&aCreateError];
+    if (aCreateSuccess == NO)
+    {
+        NSLog(@"ERR: Unable to create directory at %@: %@ (%@, %d)", self.directoryURL, aCreateError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    
+    if (self.serverURL)
+    {
+        // the system transfers the data, as for an app
+        NSString *aBackgroundSessionIdentifier = [NSString stringWithFormat:@"%@.%@", [[NSBundle mainBundle] bundleIdentifier], self.name];
+        self.fileDownloader = [[HWIFileDownloader alloc] initWithDelegate:self maxConcurrentDownloads:self.maxConcurrentDownloadsCount backgroundSessionIdentifier:aBackgroundSessionIdentifier delegateQueue:nil];
+    }
+    else
+    {
+        HWIFileDownloadLoopbackTransport *aTransport = [[HWIFileDownloadLoopbackTransport alloc] initWithBytesPerSecond:self.bytesPerSecond latency:0.0];
+        aTransport.fileSize = self.fileSize;
+        self.transport = aTransport;
+        self.fileDownloader = [[HWIFileDownloader alloc] initWithDelegate:self maxConcurrentDownloads:self.maxConcurrentDownloadsCount transport:aTransport delegateQueue:nil];
+    }
+    self.fileDownloader.queueJournalFileURL = self.queueJournalFileURL;
+    if (self.configurationBlock)
+    {
+        self.configurationBlock(self, self.fileDownloader, self.transport);
+    }
+    
+    self.startCPUTime = [[self.fileDownloader.statisticsDictionary objectForKey:@"processCPUTime"] doubleValue];
+    self.startTime = [NSProcessInfo processInfo].systemUptime;
+    [self startObservingMainRunLoop];
+    
+    NSLog(@"INFO: Benchmark scenario started: %@", self.name);
+    __weak BenchmarkScenario *weakSelf = self;
+    [self.fileDownloader setupWithCompletionBlock:^{
+        BenchmarkScenario *strongSelf = weakSelf;
+        if (strongSelf.restoresQueueJournal)
+        {
+            [strongSelf countRestoredDownloads];
+        }
+        else
+        {
+            [strongSelf startDownloads];
+        }
+        if (strongSelf.startedBlock)
+        {
+            strongSelf.startedBlock(strongSelf);
+        }
+        [strongSelf startSampling];
+        if (strongSelf.killDelay > 0.0)
+        {
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(strongSelf.killDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+                NSLog(@"INFO: Benchmark process killed: %@", weakSelf.name);
+                kill(getpid(), SIGKILL);
+            });
+        }
+        strongSelf.isSetUp = YES;
+        [strongSelf finishIfSettled];
+    }];
+}
+
+
+- (void)startDownloads
+{
+    self.expectedDownloadsCount = self.downloadsCount;
+    NSMutableArray<HWIFileDownloadBatchItem *> *aBatchItemsArray = [NSMutableArray arrayWithCapacity:self.downloadsCount];
+    for (NSUInteger anIndex = 0; anIndex < self.downloadsCount; anIndex++)
+    {
+        NSString *aDownloadIdentifier = [NSString stringWithFormat:@"%@-%@", self.name, @(anIndex)];
+        HWIFileDownloadBatchItem *aBatchItem = [[HWIFileDownloadBatchItem alloc] initWithIdentifier:aDownloadIdentifier remoteURL:[self remoteURLForDownloadIdentifier:aDownloadIdentifier] options:self.options];
+        [aBatchItemsArray addObject:aBatchItem];
+    }
+    NSNumber *aStartTime = @([NSProcessInfo processInfo].systemUptime);
+    for (HWIFileDownloadBatchItem *aBatchItem in aBatchItemsArray)
+    {
+        [self.startTimesDictionary setObject:aStartTime forKey:aBatchItem.identifier];
+    }
+    [self.fileDownloader startDownloadsWithBatchItems:aBatchItemsArray];
+    
+    for (HWIFileDownloadBatchItem *aBatchItem in aBatchItemsArray)
+    {
+        double aRandomValue = arc4random_uniform(10000) / 10000.0;
+        if (aRandomValue < (self.cancelRate + self.pauseRate))
+        {
+            BOOL aPausesFlag = (aRandomValue >= self.cancelRate);
+            NSString *aDownloadIdentifier = aBatchItem.identifier;
+            NSTimeInterval aDelay = (arc4random_uniform(10000) / 10000.0) * self.cancelAndPauseInterval;
+            __weak BenchmarkScenario *weakSelf = self;
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(aDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+                [weakSelf stopDownloadWithIdentifier:aDownloadIdentifier pauses:aPausesFlag];
+            });
+        }
+    }
+}
+
+
+- (nonnull NSURL *)remoteURLForDownloadIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    // distinct remote URLs, so downloads are neither coalesced nor share temporary files
+    NSURL *aRemoteURL = nil;
+    if (self.serverURL)
+    {
+        aRemoteURL = [[self.serverURL URLByAppendingPathComponent:[NSString stringWithFormat:@"%@", @(self.fileSize)]] URLByAppendingPathComponent:aDownloadIdentifier];
+    }
+    else
+    {
+        aRemoteURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://loopback.invalid/%@", aDownloadIdentifier]];
+    }
+    return aRemoteURL;
+}
+
+
+- (void)countRestoredDownloads
+{
+    // downloads finished before this snapshot are notified afterwards, so they are counted as well
+    NSDictionary<NSString *, NSNumber *> *aStatisticsDictionary = self.fileDownloader.statisticsDictionary;
+    self.expectedDownloadsCount = [[aStatisticsDictionary objectForKey:@"activeDownloadsCount"] unsignedIntegerValue]
+                                + [[aStatisticsDictionary objectForKey:@"waitingDownloadsCount"] unsignedIntegerValue]
+                                + [[aStatisticsDictionary objectForKey:@"completedDownloadsCount"] unsignedIntegerValue]
+                                + [[aStatisticsDictionary objectForKey:@"failedDownloadsCount"] unsignedIntegerValue];
+    NSLog(@"INFO: Benchmark downloads restored from queue journal: %@", @(self.expectedDownloadsCount));
+}
+
+
+- (void)stopDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier pauses:(BOOL)aPausesFlag
+{
+    if (self.completionBlock && ([self.settledIdentifiersSet containsObject:aDownloadIdentifier] == NO))
+    {
+        if (aPausesFlag)
+        {
+            // started again when the pause has been notified as cancelled download
+            [self.pausedIdentifiersSet addObject:aDownloadIdentifier];
+            [self.fileDownloader pauseDownloadsWithIdentifiers:@[aDownloadIdentifier]];
+        }
+        else
+        {
+            [self.fileDownloader cancelDownloadWithIdentifier:aDownloadIdentifier];
+        }
+    }
+}
+
+
+- (void)settleDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    [self.settledIdentifiersSet addObject:aDownloadIdentifier];
+    [self finishIfSettled];
+}
+
+
+- (void)finishIfSettled
+{
+    if (self.isSetUp && self.completionBlock && (self.settledIdentifiersSet.count >= self.expectedDownloadsCount))
+    {
+        [self stopSampling];
+        if (self.finishedBlock)
+        {
+            self.finishedBlock(self);
+        }
+        [self stopObservingMainRunLoop];
+        NSDictionary<NSString *, id> *aResultDictionary = [self resultDictionary];
+        BenchmarkScenarioCompletionBlock aCompletionBlock = self.completionBlock;
+        self.completionBlock = nil;
+        self.fileDownloader = nil;
+        self.transport = nil;
+        NSURL *aDirectoryURL = self.directoryURL;
+        dispatch_async(self.fileRemovalDispatchQueue, ^{
+            [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                NSLog(@"INFO: Benchmark scenario finished: %@", [aResultDictionary objectForKey:@"name"]);
+                aCompletionBlock(aResultDictionary);
+            });
+        });
+    }
+}
+
+
+#pragma mark - Result
+
+
+- (nonnull NSDictionary<NSString *, id> *)resultDictionary
+{
+    NSTimeInterval aDuration = [NSProcessInfo processInfo].systemUptime - self.startTime;
+    NSDictionary<NSString *, NSNumber *> *aStatisticsDictionary = self.fileDownloader.statisticsDictionary;
+    int64_t aReceivedBytesCount = [[aStatisticsDictionary objectForKey:@"receivedBytesCount"] longLongValue];
+    NSTimeInterval aCPUTime = [[aStatisticsDictionary objectForKey:@"processCPUTime"] doubleValue] - self.startCPUTime;
+    double aReceivedMegabytes = aReceivedBytesCount / (1024.0 * 1024.0);
+    NSArray<NSNumber *> *aSortedLatenciesArray = [self.completionLatenciesArray sortedArrayUsingSelector:@selector(compare:)];
+    
+    NSMutableDictionary<NSString *, id> *aResultDictionary = [NSMutableDictionary dictionary];
+    [aResultDictionary setObject:self.name forKey:@"name"];
+    [aResultDictionary setObject:@(self.expectedDownloadsCount) forKey:@"downloadsCount"];
+    [aResultDictionary setObject:@(self.fileSize) forKey:@"fileSize"];
+    [aResultDictionary setObject:@(self.completedDownloadsCount) forKey:@"completedDownloadsCount"];
+    [aResultDictionary setObject:@(self.failedDownloadsCount) forKey:@"failedDownloadsCount"];
+    [aResultDictionary setObject:@(self.cancelledDownloadsCount) forKey:@"cancelledDownloadsCount"];
+    [aResultDictionary setObject:@(self.pausedDownloadsCount) forKey:@"pausedDownloadsCount"];
+    [aResultDictionary setObject:@(aDuration) forKey:@"duration"];
+    [aResultDictionary setObject:@(aReceivedBytesCount) forKey:@"receivedBytesCount"];
+    [aResultDictionary setObject:@((aDuration > 0.0) ? (aReceivedBytesCount / aDuration) : 0.0) forKey:@"bytesPerSecond"];
+    [aResultDictionary setObject:@([BenchmarkScenario percentile:0.5 ofSortedValues:aSortedLatenciesArray]) forKey:@"completionLatencyP50"];
+    [aResultDictionary setObject:@([BenchmarkScenario percentile:0.99 ofSortedValues:aSortedLatenciesArray]) forKey:@"completionLatencyP99"];
+    [aResultDictionary setObject:@(aCPUTime) forKey:@"cpuTime"];
+    [aResultDictionary setObject:@((aReceivedMegabytes > 0.0) ? (aCPUTime / aReceivedMegabytes) : 0.0) forKey:@"cpuTimePerMB"];
+    [aResultDictionary setObject:([aStatisticsDictionary objectForKey:@"processPeakResidentSize"] ?: @(0)) forKey:@"peakResidentSize"];
+    [aResultDictionary setObject:@([BenchmarkScenario residentSize]) forKey:@"residentSize"];
+    [aResultDictionary setObject:@(self.mainQueueBusyTime) forKey:@"mainQueueBusyTime"];
+    [aResultDictionary setObject:aStatisticsDictionary forKey:@"statistics"];
+    [aResultDictionary setObject:[self.measurementsDictionary copy] forKey:@"measurements"];
+    return aResultDictionary;
+}
+
+
++ (double)percentile:(double)aPercentile ofSortedValues:(nonnull NSArray<NSNumber *> *)aSortedValuesArray
+{
+    double aValue = 0.0;
+    if (aSortedValuesArray.count > 0)
+    {
+        // nearest rank
+        NSUInteger aRank = (NSUInteger)ceil(aPercentile * aSortedValuesArray.count);
+        NSUInteger anIndex = MIN(MAX(aRank, (NSUInteger)1), aSortedValuesArray.count) - 1;
+        aValue = [[aSortedValuesArray objectAtIndex:anIndex] doubleValue];
+    }
+    return aValue;
+}
+
+
++ (int64_t)residentSize
+{
+    int64_t aResidentSize = 0;
+    struct mach_task_basic_info aTaskInfo;
+    mach_msg_type_number_t aTaskInfoCount = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&aTaskInfo, &aTaskInfoCount) == KERN_SUCCESS)
+    {
+        aResidentSize = (int64_t)aTaskInfo.resident_size;
+    }
+    return aResidentSize;
+}
+
+
+#pragma mark - Sampling
+
+
+- (void)startSampling
+{
+    if (self.sampleBlock && (self.sampleInterval > 0.0))
+    {
+        dispatch_source_t aSampleTimerSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+        uint64_t anInterval = (uint64_t)(self.sampleInterval * NSEC_PER_SEC);
+        dispatch_source_set_timer(aSampleTimerSource, dispatch_time(DISPATCH_TIME_NOW, (int64_t)anInterval), anInterval, anInterval / 10);
+        __weak BenchmarkScenario *weakSelf = self;
+        dispatch_source_set_event_handler(aSampleTimerSource, ^{
+            BenchmarkScenario *strongSelf = weakSelf;
+            if (strongSelf.sampleBlock)
+            {
+                strongSelf.sampleBlock(strongSelf);
+            }
+        });
+        dispatch_resume(aSampleTimerSource);
+        self.sampleTimerSource = aSampleTimerSource;
+    }
+}
+
+
+- (void)stopSampling
+{
+    if (self.sampleTimerSource)
+    {
+        dispatch_source_cancel(self.sampleTimerSource);
+        self.sampleTimerSource = nil;
+    }
+}
+
+
+#pragma mark - Main Queue
+
+
+- (void)startObservingMainRunLoop
+{
+    // the main queue is busy from waking up of the main run loop until it waits again
+    self.mainQueueBusyTime = 0.0;
+    self.mainQueueBusyStartTime = [NSProcessInfo processInfo].systemUptime;
+    __weak BenchmarkScenario *weakSelf = self;
+    CFRunLoopObserverRef aMainRunLoopObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, (kCFRunLoopAfterWaiting | kCFRunLoopBeforeWaiting), true, 0, ^(CFRunLoopObserverRef anObserver, CFRunLoopActivity anActivity) {
+        BenchmarkScenario *strongSelf = weakSelf;
+        NSTimeInterval aTime = [NSProcessInfo processInfo].systemUptime;
+        if (anActivity == kCFRunLoopBeforeWaiting)
+        {
+            strongSelf.mainQueueBusyTime += (aTime - strongSelf.mainQueueBusyStartTime);
+        }
+        else
+        {
+            strongSelf.mainQueueBusyStartTime = aTime;
+        }
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), aMainRunLoopObserver, kCFRunLoopCommonModes);
+    self.mainRunLoopObserver = aMainRunLoopObserver;
+}
+
+
+- (void)stopObservingMainRunLoop
+{
+    if (self.mainRunLoopObserver)
+    {
+        self.mainQueueBusyTime += ([NSProcessInfo processInfo].systemUptime - self.mainQueueBusyStartTime);
+        CFRunLoopRemoveObserver(CFRunLoopGetMain(), self.mainRunLoopObserver, kCFRunLoopCommonModes);
+        CFRelease(self.mainRunLoopObserver);
+        self.mainRunLoopObserver = NULL;
+    }
+}
+
+
+#pragma mark - HWIFileDownloadDelegate
+
+
+- (void)downloadDidCompleteWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                             localFileURL:(nonnull NSURL *)aLocalFileURL
+{
+    NSNumber *aStartTime = [self.startTimesDictionary objectForKey:aDownloadIdentifier];
+    NSTimeInterval aLatency = [NSProcessInfo processInfo].systemUptime - (aStartTime ? aStartTime.doubleValue : self.startTime);
+    [self.completionLatenciesArray addObject:@(aLatency)];
+    self.completedDownloadsCount++;
+    BenchmarkScenarioFileBlock aCompletedFileBlock = self.completedFileBlock;
+    dispatch_async(self.fileRemovalDispatchQueue, ^{
+        if (aCompletedFileBlock)
+        {
+            aCompletedFileBlock(self, aDownloadIdentifier, aLocalFileURL);
+            // the work of the block is part of the scenario
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self settleDownloadWithIdentifier:aDownloadIdentifier];
+            });
+        }
+        [[NSFileManager defaultManager] removeItemAtURL:aLocalFileURL error:NULL];
+    });
+    if (aCompletedFileBlock == nil)
+    {
+        [self settleDownloadWithIdentifier:aDownloadIdentifier];
+    }
+}
+
+
+- (void)downloadFailedWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                               error:(nonnull NSError *)anError
+                      httpStatusCode:(NSInteger)aHttpStatusCode
+                  errorMessagesStack:(nullable NSArray<NSString *> *)anErrorMessagesStack
+                          resumeData:(nullable NSData *)aResumeData
+{
+    BOOL anIsCancelledFlag = ([anError.domain isEqualToString:NSURLErrorDomain] && (anError.code == NSURLErrorCancelled));
+    if (anIsCancelledFlag && [self.pausedIdentifiersSet containsObject:aDownloadIdentifier])
+    {
+        // paused download, continued like a user would
+        [self.pausedIdentifiersSet removeObject:aDownloadIdentifier];
+        self.pausedDownloadsCount++;
+        if (aResumeData)
+        {
+            [self.fileDownloader startDownloadWithIdentifier:aDownloadIdentifier usingResumeData:aResumeData];
+        }
+        else
+        {
+            [self.fileDownloader startDownloadWithIdentifier:aDownloadIdentifier fromRemoteURL:[self remoteURLForDownloadIdentifier:aDownloadIdentifier]];
+        }
+        return;
+    }
+    if (anIsCancelledFlag)
+    {
+        self.cancelledDownloadsCount++;
+    }
+    else
+    {
+        self.failedDownloadsCount++;
+        NSLog(@"ERR: Benchmark download failed: %@ %@ (%@, %d)", aDownloadIdentifier, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    [self settleDownloadWithIdentifier:aDownloadIdentifier];
+}
+
+
+- (void)incrementNetworkActivityIndicatorActivityCount
+{
+}
+
+
+- (void)decrementNetworkActivityIndicatorActivityCount
+{
+}
+
+
+- (nullable NSURL *)localFileURLForIdentifier:(nonnull NSString *)aDownloadIdentifier
+                                    remoteURL:(nonnull NSURL *)aRemoteURL
+{
+    return [self.directoryURL URLByAppendingPathComponent:aDownloadIdentifier isDirectory:NO];
+}
+
+
+@end
@@ -0,0 +1,77 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkScenarioCatalog.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+@class BenchmarkScenario;
+
+
+/**
+ BenchmarkScenarioCatalog creates the scenarios of the benchmark app.
+ @discussion Sizes of a scenario are taken from launch arguments if given: -<name>DownloadsCount, -<name>FileSize (bytes) and -<name>EntriesCounts (comma separated), e.g. -smallFilesDownloadsCount 100000. With -<name>ServerURL or -BenchmarkServerURL (e.g. http://localhost:8000) the downloads of a scenario are transferred from a local HTTP server with NSURLSession instead of the loopback transport.
+ */
+@interface BenchmarkScenarioCatalog : NSObject
+
+/**
+ Returns all scenarios in the order they are run.
+ @param aBenchmarkDirectoryURL Directory for files kept between launches, e.g. the queue journal.
+ @return Scenarios.
+ */
++ (nonnull NSArray<BenchmarkScenario *> *)scenariosWithBenchmarkDirectoryURL:(nonnull NSURL *)aBenchmarkDirectoryURL;
+
+/**
+ Returns the scenario with downloads that are interrupted by killing the process.
+ @param aBenchmarkDirectoryURL Directory of the queue journal.
+ @param aRestoresQueueJournalFlag YES for the second launch restoring the downloads, NO for the first launch killing the process.
+ @return Scenario.
+ */
++ (nonnull BenchmarkScenario *)resumeAfterKillScenarioWithBenchmarkDirectoryURL:(nonnull NSURL *)aBenchmarkDirectoryURL restoresQueueJournal:(BOOL)aRestoresQueueJournalFlag;
+
+/**
+ Returns a scenario with the sizes of the launch arguments.
+ @param aName Name of the scenario.
+ @param aDownloadsCount Number of downloads if not given as launch argument.
+ @param aFileSize Number of bytes of each download if not given as launch argument.
+ @param anEntriesCountsArray Numbers of entries of a microbenchmark if not given as launch argument.
+ @return Scenario.
+ */
++ (nonnull BenchmarkScenario *)scenarioWithName:(nonnull NSString *)aName
+                                 downloadsCount:(NSUInteger)aDownloadsCount
+                                       fileSize:(int64_t)aFileSize
+                                   entriesCounts:(nonnull NSArray<NSNumber *> *)anEntriesCountsArray;
+
+@end
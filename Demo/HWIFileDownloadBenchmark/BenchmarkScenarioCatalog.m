@@ -0,0 +1,921 @@
+/*
+ * Project: HWIFileDownload (Benchmark App)
+ 
+ * Created by Heiko Wichmann (20261017)
+ * File: BenchmarkScenarioCatalog.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "BenchmarkScenarioCatalog.h"
+#import "BenchmarkScenario.h"
+#import "HWIFileDownloadCache.h"
+#import "HWIFileDownloadDigest.h"
+#import "HWIFileDownloader.h"
+#import "HWIFileDownloadFileWriter.h"
+#import "HWIFileDownloadGzipTransform.h"
+#import "HWIFileDownloadJournal.h"
+#import "HWIFileDownloadLoopbackTransport.h"
+#import "HWIFileDownloadOptions.h"
+#import "HWIFileDownloadResumeDataStore.h"
+#import "HWIFileDownloadWaitingQueue.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+
+static NSString * const BenchmarkScenarioCatalogResumeAfterKillScenarioName = @"resumeAfterKill";
+
+
+@implementation BenchmarkScenarioCatalog
+
+
+#pragma mark - Scenarios
+
+
++ (nonnull NSArray<BenchmarkScenario *> *)scenariosWithBenchmarkDirectoryURL:(nonnull NSURL *)aBenchmarkDirectoryURL
+{
+    BenchmarkScenario *aSmallFilesScenario = [BenchmarkScenarioCatalog scenarioWithName:@"smallFiles" downloadsCount:10000 fileSize:(16 * 1024) entriesCounts:@[]];
+    
+    BenchmarkScenario *aLargeFilesScenario = [BenchmarkScenarioCatalog scenarioWithName:@"largeFiles" downloadsCount:10 fileSize:(2LL * 1024 * 1024 * 1024) entriesCounts:@[]];
+    aLargeFilesScenario.maxConcurrentDownloadsCount = 4;
+    
+    // four downloads at 4 MB/s each keep most of the queue waiting while it is cancelled and paused
+    BenchmarkScenario *aQueuedScenario = [BenchmarkScenarioCatalog scenarioWithName:@"queuedCancelPause" downloadsCount:1000 fileSize:(1024 * 1024) entriesCounts:@[]];
+    aQueuedScenario.maxConcurrentDownloadsCount = 4;
+    aQueuedScenario.bytesPerSecond = 4 * 1024 * 1024;
+    aQueuedScenario.cancelRate = 0.1;
+    aQueuedScenario.pauseRate = 0.1;
+    aQueuedScenario.cancelAndPauseInterval = 30.0;
+    
+    NSMutableArray<BenchmarkScenario *> *aScenariosArray = [NSMutableArray arrayWithObjects:aSmallFilesScenario, aLargeFilesScenario, aQueuedScenario, nil];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog cacheStoreScenario]];
+    [aScenariosArray addObjectsFromArray:[BenchmarkScenarioCatalog lookupScenarios]];
+    [aScenariosArray addObjectsFromArray:[BenchmarkScenarioCatalog progressScenarios]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog waitingQueueScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog digestScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog throttleScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog journalReplayScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog resumeDataScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog adaptiveWindowScenario]];
+    [aScenariosArray addObjectsFromArray:[BenchmarkScenarioCatalog gzipScenarios]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog finalizationScenario]];
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog slowDiskScenario]];
+    // killing the process ends the first launch, so this scenario is the last one
+    [aScenariosArray addObject:[BenchmarkScenarioCatalog resumeAfterKillScenarioWithBenchmarkDirectoryURL:aBenchmarkDirectoryURL restoresQueueJournal:NO]];
+    return aScenariosArray;
+}
+
+
++ (nonnull BenchmarkScenario *)resumeAfterKillScenarioWithBenchmarkDirectoryURL:(nonnull NSURL *)aBenchmarkDirectoryURL restoresQueueJournal:(BOOL)aRestoresQueueJournalFlag
+{
+    // the process is killed while half of the downloads are still waiting
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:BenchmarkScenarioCatalogResumeAfterKillScenarioName downloadsCount:200 fileSize:(4 * 1024 * 1024) entriesCounts:@[]];
+    aScenario.maxConcurrentDownloadsCount = 4;
+    aScenario.bytesPerSecond = 4 * 1024 * 1024;
+    aScenario.queueJournalFileURL = [aBenchmarkDirectoryURL URLByAppendingPathComponent:@"QueueJournal" isDirectory:NO];
+    if (aRestoresQueueJournalFlag)
+    {
+        aScenario.restoresQueueJournal = YES;
+    }
+    else
+    {
+        aScenario.killDelay = 5.0;
+    }
+    return aScenario;
+}
+
+
+#pragma mark - Cache
+
+
++ (nonnull BenchmarkScenario *)cacheStoreScenario
+{
+    // the same remote URL and contents are stored several times, as when a stale entry is downloaded again unchanged
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"cacheStore" downloadsCount:0 fileSize:(1024 * 1024) entriesCounts:@[@(2)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        NSURL *aDirectoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:@"BenchmarkCache" isDirectory:YES];
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+        HWIFileDownloadCache *aCache = [[HWIFileDownloadCache alloc] initWithDirectoryURL:aDirectoryURL maximumSize:(int64_t)INT32_MAX];
+        NSURL *aDownloadedFileURL = [aDirectoryURL URLByAppendingPathComponent:@"downloaded" isDirectory:NO];
+        NSURL *aLinkedFileURL = [aDirectoryURL URLByAppendingPathComponent:@"linked" isDirectory:NO];
+        [[NSMutableData dataWithLength:(NSUInteger)aStartedScenario.fileSize] writeToURL:aDownloadedFileURL atomically:NO];
+        NSData *aDigestData = [HWIFileDownloadDigest digestOfFileAtURL:aDownloadedFileURL algorithm:HWIFileDownloadDigestAlgorithmSHA256 error:NULL];
+        NSString *aDigest = aDigestData ? [HWIFileDownloadDigest hexStringWithDigest:aDigestData] : @"";
+        NSURL *aRemoteURL = [aStartedScenario remoteURLForDownloadIdentifier:@"cached"];
+        NSUInteger aStoresCount = MAX([aStartedScenario.entriesCounts.firstObject unsignedIntegerValue], (NSUInteger)1);
+        NSUInteger aLinkedStoresCount = 0;
+        NSTimeInterval aStoreDuration = 0.0;
+        for (NSUInteger anIndex = 0; anIndex < aStoresCount; anIndex++)
+        {
+            NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+            NSURL *aStagedFileURL = [aCache stageFileAtURL:aDownloadedFileURL];
+            HWIFileDownloadCacheEntry *anEntry = aStagedFileURL ? [aCache storeStagedFileAtURL:aStagedFileURL digest:aDigest remoteURL:aRemoteURL eTag:nil lastModified:nil] : nil;
+            aStoreDuration += [NSProcessInfo processInfo].systemUptime - aStartTime;
+            // the stored file needs to exist after each store
+            if (anEntry && [aCache linkEntry:anEntry toFileURL:aLinkedFileURL notModified:NO error:NULL])
+            {
+                aLinkedStoresCount++;
+            }
+        }
+        [aStartedScenario.measurementsDictionary setObject:@(aStoresCount) forKey:@"storesCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(aLinkedStoresCount) forKey:@"linkedStoresCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(aStoreDuration / aStoresCount) forKey:@"storeDuration"];
+        [aStartedScenario.measurementsDictionary setObject:@(aCache.entriesCount) forKey:@"entriesCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(aCache.totalSize) forKey:@"totalSize"];
+        [aCache removeAllEntries];
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Lookup
+
+
++ (nonnull NSArray<BenchmarkScenario *> *)lookupScenarios
+{
+    NSMutableArray<BenchmarkScenario *> *aScenariosArray = [NSMutableArray array];
+    for (BenchmarkScenario *aScenario in [BenchmarkScenarioCatalog queuedScenariosWithName:@"lookup" entriesCounts:@[@(10), @(100), @(1000), @(10000), @(100000)]])
+    {
+        aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+            // identifiers spread over the active and the waiting downloads, formatted before the measurement
+            NSUInteger aLookupsCount = 10000;
+            NSMutableArray<NSString *> *anIdentifiersArray = [NSMutableArray arrayWithCapacity:aLookupsCount];
+            for (NSUInteger anIndex = 0; anIndex < aLookupsCount; anIndex++)
+            {
+                NSUInteger aDownloadIndex = (NSUInteger)(((unsigned long long)anIndex * aStartedScenario.downloadsCount) / aLookupsCount);
+                [anIdentifiersArray addObject:[NSString stringWithFormat:@"%@-%@", aStartedScenario.name, @(aDownloadIndex)]];
+            }
+            HWIFileDownloader *aFileDownloader = aStartedScenario.fileDownloader;
+            NSUInteger aFoundCount = 0;
+            NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSString *anIdentifier in anIdentifiersArray)
+            {
+                aFoundCount += [aFileDownloader isDownloadingIdentifier:anIdentifier] ? 1 : 0;
+            }
+            NSTimeInterval anIsDownloadingDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSString *anIdentifier in anIdentifiersArray)
+            {
+                [aFileDownloader isWaitingForDownloadOfIdentifier:anIdentifier];
+            }
+            NSTimeInterval anIsWaitingDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSString *anIdentifier in anIdentifiersArray)
+            {
+                [aFileDownloader downloadProgressForIdentifier:anIdentifier];
+            }
+            NSTimeInterval aProgressDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            [aStartedScenario.measurementsDictionary setObject:@(aStartedScenario.downloadsCount) forKey:@"queuedDownloadsCount"];
+            [aStartedScenario.measurementsDictionary setObject:@(aFoundCount) forKey:@"foundLookupsCount"];
+            [aStartedScenario.measurementsDictionary setObject:@(anIsDownloadingDuration / aLookupsCount) forKey:@"isDownloadingDuration"];
+            [aStartedScenario.measurementsDictionary setObject:@(anIsWaitingDuration / aLookupsCount) forKey:@"isWaitingDuration"];
+            [aStartedScenario.measurementsDictionary setObject:@(aProgressDuration / aLookupsCount) forKey:@"progressDuration"];
+            [aFileDownloader cancelDownloadsPassingTest:^BOOL(NSString * _Nonnull anIdentifier) {
+                return YES;
+            }];
+        };
+        [aScenariosArray addObject:aScenario];
+    }
+    return aScenariosArray;
+}
+
+
+#pragma mark - Progress
+
+
++ (nonnull NSArray<BenchmarkScenario *> *)progressScenarios
+{
+    NSMutableArray<BenchmarkScenario *> *aScenariosArray = [NSMutableArray array];
+    for (BenchmarkScenario *aScenario in [BenchmarkScenarioCatalog queuedScenariosWithName:@"progress" entriesCounts:@[@(10), @(100), @(1000)]])
+    {
+        // all downloads are active, as the rows of a list showing their progress
+        aScenario.maxConcurrentDownloadsCount = (NSInteger)aScenario.downloadsCount;
+        aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+            NSUInteger aRefreshesCount = 100;
+            NSMutableArray<NSString *> *anIdentifiersArray = [NSMutableArray arrayWithCapacity:aStartedScenario.downloadsCount];
+            for (NSUInteger anIndex = 0; anIndex < aStartedScenario.downloadsCount; anIndex++)
+            {
+                [anIdentifiersArray addObject:[NSString stringWithFormat:@"%@-%@", aStartedScenario.name, @(anIndex)]];
+            }
+            HWIFileDownloader *aFileDownloader = aStartedScenario.fileDownloader;
+            NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSUInteger aRefreshIndex = 0; aRefreshIndex < aRefreshesCount; aRefreshIndex++)
+            {
+                for (NSString *anIdentifier in anIdentifiersArray)
+                {
+                    [aFileDownloader downloadProgressForIdentifier:anIdentifier];
+                }
+            }
+            NSTimeInterval aPerIdentifierDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            NSUInteger aMaxCount = MAX(anIdentifiersArray.count, (NSUInteger)1);
+            HWIFileDownloadProgressSnapshot *aSnapshotsBuffer = calloc(aMaxCount, sizeof(HWIFileDownloadProgressSnapshot));
+            NSUInteger aSnapshotsCount = 0;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSUInteger aRefreshIndex = 0; aRefreshIndex < aRefreshesCount; aRefreshIndex++)
+            {
+                aSnapshotsCount = [aFileDownloader getProgressSnapshots:aSnapshotsBuffer maxCount:aMaxCount forIdentifiers:anIdentifiersArray];
+            }
+            NSTimeInterval aSnapshotsDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            NSMutableArray<NSString *> *aSnapshotIdentifiersArray = [NSMutableArray arrayWithCapacity:aMaxCount];
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSUInteger aRefreshIndex = 0; aRefreshIndex < aRefreshesCount; aRefreshIndex++)
+            {
+                [aFileDownloader getAllProgressSnapshots:aSnapshotsBuffer maxCount:aMaxCount identifiers:aSnapshotIdentifiersArray];
+            }
+            NSTimeInterval anAllSnapshotsDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            free(aSnapshotsBuffer);
+            [aStartedScenario.measurementsDictionary setObject:@(aStartedScenario.downloadsCount) forKey:@"activeDownloadsCount"];
+            [aStartedScenario.measurementsDictionary setObject:@(aSnapshotsCount) forKey:@"snapshotsCount"];
+            [aStartedScenario.measurementsDictionary setObject:@(aPerIdentifierDuration / aRefreshesCount) forKey:@"perIdentifierRefreshDuration"];
+            [aStartedScenario.measurementsDictionary setObject:@(aSnapshotsDuration / aRefreshesCount) forKey:@"snapshotsRefreshDuration"];
+            [aStartedScenario.measurementsDictionary setObject:@(anAllSnapshotsDuration / aRefreshesCount) forKey:@"allSnapshotsRefreshDuration"];
+            [aFileDownloader cancelDownloadsPassingTest:^BOOL(NSString * _Nonnull anIdentifier) {
+                return YES;
+            }];
+        };
+        [aScenariosArray addObject:aScenario];
+    }
+    return aScenariosArray;
+}
+
+
+#pragma mark - Waiting Queue
+
+
++ (nonnull BenchmarkScenario *)waitingQueueScenario
+{
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"waitingQueue" downloadsCount:0 fileSize:0 entriesCounts:@[@(10000), @(100000), @(1000000)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        // items of four priorities from four hosts, created before the measurement
+        NSMutableArray<HWIFileDownloadOptions *> *anOptionsArray = [NSMutableArray array];
+        NSMutableArray<NSURL *> *aRemoteURLsArray = [NSMutableArray array];
+        for (NSInteger aPriority = HWIFileDownloadPriorityBackground; aPriority <= HWIFileDownloadPriorityHigh; aPriority++)
+        {
+            HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+            anOptions.priority = (HWIFileDownloadPriority)aPriority;
+            [anOptionsArray addObject:anOptions];
+            [aRemoteURLsArray addObject:[NSURL URLWithString:[NSString stringWithFormat:@"http://host%@.loopback.invalid/file", @(aPriority)]]];
+        }
+        for (NSNumber *anEntriesCount in aStartedScenario.entriesCounts)
+        {
+            NSUInteger aCount = anEntriesCount.unsignedIntegerValue;
+            NSMutableArray<HWIFileDownloadWaitingItem *> *aWaitingItemsArray = [NSMutableArray arrayWithCapacity:aCount];
+            for (NSUInteger anIndex = 0; anIndex < aCount; anIndex++)
+            {
+                NSUInteger aRandomIndex = arc4random_uniform(4);
+                HWIFileDownloadWaitingItem *aWaitingItem = [[HWIFileDownloadWaitingItem alloc] initWithDownloadToken:[NSString stringWithFormat:@"%@", @(anIndex)] remoteURL:[aRemoteURLsArray objectAtIndex:aRandomIndex] resumeDataFileURL:nil options:[anOptionsArray objectAtIndex:aRandomIndex]];
+                [aWaitingItemsArray addObject:aWaitingItem];
+            }
+            HWIFileDownloadWaitingQueue *aWaitingQueue = [[HWIFileDownloadWaitingQueue alloc] init];
+            NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (HWIFileDownloadWaitingItem *aWaitingItem in aWaitingItemsArray)
+            {
+                [aWaitingQueue enqueueWaitingItem:aWaitingItem];
+            }
+            NSTimeInterval anEnqueueDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            // every tenth download changes its priority, another tenth is cancelled
+            NSUInteger aChangesCount = aCount / 10;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSUInteger anIndex = 0; anIndex < aChangesCount; anIndex++)
+            {
+                [aWaitingQueue setPriority:(HWIFileDownloadPriority)arc4random_uniform(4) forDownloadToken:[aWaitingItemsArray objectAtIndex:(anIndex * 10)].downloadToken];
+            }
+            NSTimeInterval aSetPriorityDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            for (NSUInteger anIndex = 0; anIndex < aChangesCount; anIndex++)
+            {
+                [aWaitingQueue removeWaitingItemForDownloadToken:[aWaitingItemsArray objectAtIndex:(anIndex * 10 + 5)].downloadToken];
+            }
+            NSTimeInterval aCancelDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            NSUInteger aDequeuesCount = 0;
+            aStartTime = [NSProcessInfo processInfo].systemUptime;
+            while ([aWaitingQueue dequeueWaitingItem])
+            {
+                aDequeuesCount++;
+            }
+            NSTimeInterval aDequeueDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            NSDictionary<NSString *, NSNumber *> *aMeasurementDictionary = @{@"enqueueDuration" : @(anEnqueueDuration / MAX(aCount, (NSUInteger)1)),
+                                                                             @"setPriorityDuration" : @(aSetPriorityDuration / MAX(aChangesCount, (NSUInteger)1)),
+                                                                             @"cancelDuration" : @(aCancelDuration / MAX(aChangesCount, (NSUInteger)1)),
+                                                                             @"dequeueDuration" : @(aDequeueDuration / MAX(aDequeuesCount, (NSUInteger)1))};
+            [aStartedScenario.measurementsDictionary setObject:aMeasurementDictionary forKey:anEntriesCount.stringValue];
+        }
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Digest
+
+
++ (nonnull BenchmarkScenario *)digestScenario
+{
+    // the file size is the number of bytes hashed, the entries counts are the sizes of the updates as received from a transfer
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"digest" downloadsCount:0 fileSize:(256 * 1024 * 1024) entriesCounts:@[@(16 * 1024), @(256 * 1024), @(1024 * 1024)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        NSMutableData *aData = [NSMutableData dataWithLength:(NSUInteger)(4 * 1024 * 1024)];
+        arc4random_buf(aData.mutableBytes, aData.length);
+        NSDictionary<NSString *, NSNumber *> *anAlgorithmsDictionary = @{@"sha256" : @(HWIFileDownloadDigestAlgorithmSHA256),
+                                                                        @"crc32c" : @(HWIFileDownloadDigestAlgorithmCRC32C)};
+        for (NSString *anAlgorithmName in anAlgorithmsDictionary)
+        {
+            HWIFileDownloadDigestAlgorithm anAlgorithm = (HWIFileDownloadDigestAlgorithm)[[anAlgorithmsDictionary objectForKey:anAlgorithmName] integerValue];
+            NSMutableDictionary<NSString *, NSNumber *> *aBytesPerSecondDictionary = [NSMutableDictionary dictionary];
+            for (NSNumber *anUpdateSize in aStartedScenario.entriesCounts)
+            {
+                NSUInteger aLength = MIN(anUpdateSize.unsignedIntegerValue, aData.length);
+                HWIFileDownloadDigest *aDigest = [[HWIFileDownloadDigest alloc] initWithAlgorithm:anAlgorithm];
+                NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+                while (aDigest.processedBytesCount < aStartedScenario.fileSize)
+                {
+                    NSUInteger anOffset = (NSUInteger)(aDigest.processedBytesCount % (int64_t)(aData.length - aLength + 1));
+                    [aDigest updateWithBytes:((const uint8_t *)aData.bytes + anOffset) length:aLength];
+                }
+                [aDigest finalDigest];
+                NSTimeInterval aDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+                [aBytesPerSecondDictionary setObject:@((double)aDigest.processedBytesCount / MAX(aDuration, 0.000001)) forKey:anUpdateSize.stringValue];
+            }
+            [aStartedScenario.measurementsDictionary setObject:aBytesPerSecondDictionary forKey:[anAlgorithmName stringByAppendingString:@"BytesPerSecond"]];
+        }
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Throttle
+
+
++ (nonnull BenchmarkScenario *)throttleScenario
+{
+    // all downloads are capped at 8 MB/s together and the first one at 2 MB/s, so the first and the other three finish at the same time
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"throttle" downloadsCount:4 fileSize:(32 * 1024 * 1024) entriesCounts:@[]];
+    aScenario.maxConcurrentDownloadsCount = 4;
+    int64_t aMaximumBytesPerSecond = 8 * 1024 * 1024;
+    int64_t aDownloadMaximumBytesPerSecond = 2 * 1024 * 1024;
+    NSString *aCappedDownloadIdentifier = [NSString stringWithFormat:@"%@-0", aScenario.name];
+    aScenario.configurationBlock = ^(BenchmarkScenario *aConfiguredScenario, HWIFileDownloader *aFileDownloader, HWIFileDownloadLoopbackTransport *aTransport) {
+        aFileDownloader.maximumBytesPerSecond = aMaximumBytesPerSecond;
+        [aFileDownloader setMaximumBytesPerSecond:aDownloadMaximumBytesPerSecond forDownloadWithIdentifier:aCappedDownloadIdentifier];
+    };
+    // samples of time, received bytes of all downloads and received bytes of the capped download while it is active
+    NSMutableArray<NSArray<NSNumber *> *> *aSamplesArray = [NSMutableArray array];
+    aScenario.sampleInterval = 1.0;
+    aScenario.sampleBlock = ^(BenchmarkScenario *aSampledScenario) {
+        HWIFileDownloadProgress *aProgress = [aSampledScenario.fileDownloader downloadProgressForIdentifier:aCappedDownloadIdentifier];
+        if (aProgress && (aProgress.receivedFileSize < aSampledScenario.fileSize))
+        {
+            NSNumber *aReceivedBytesCount = [aSampledScenario.fileDownloader.statisticsDictionary objectForKey:@"receivedBytesCount"];
+            [aSamplesArray addObject:@[@([NSProcessInfo processInfo].systemUptime), aReceivedBytesCount, @(aProgress.receivedFileSize)]];
+        }
+    };
+    aScenario.finishedBlock = ^(BenchmarkScenario *aFinishedScenario) {
+        // the first second is skipped while the token buckets are filled
+        if (aSamplesArray.count > 2)
+        {
+            NSArray<NSNumber *> *aFirstSample = [aSamplesArray objectAtIndex:1];
+            NSArray<NSNumber *> *aLastSample = aSamplesArray.lastObject;
+            double aDuration = [aLastSample.firstObject doubleValue] - [aFirstSample.firstObject doubleValue];
+            double aBytesPerSecond = ([[aLastSample objectAtIndex:1] doubleValue] - [[aFirstSample objectAtIndex:1] doubleValue]) / aDuration;
+            double aDownloadBytesPerSecond = ([[aLastSample objectAtIndex:2] doubleValue] - [[aFirstSample objectAtIndex:2] doubleValue]) / aDuration;
+            double aDeviation = aBytesPerSecond / aMaximumBytesPerSecond - 1.0;
+            double aDownloadDeviation = aDownloadBytesPerSecond / aDownloadMaximumBytesPerSecond - 1.0;
+            [aFinishedScenario.measurementsDictionary setObject:@(aBytesPerSecond) forKey:@"cappedBytesPerSecond"];
+            [aFinishedScenario.measurementsDictionary setObject:@(aDeviation) forKey:@"cappedDeviation"];
+            [aFinishedScenario.measurementsDictionary setObject:@(aDownloadBytesPerSecond) forKey:@"downloadCappedBytesPerSecond"];
+            [aFinishedScenario.measurementsDictionary setObject:@(aDownloadDeviation) forKey:@"downloadCappedDeviation"];
+            [aFinishedScenario.measurementsDictionary setObject:@((fabs(aDeviation) <= 0.05) && (fabs(aDownloadDeviation) <= 0.05)) forKey:@"isWithinTolerance"];
+        }
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Adaptive Window
+
+
++ (nonnull BenchmarkScenario *)adaptiveWindowScenario
+{
+    // each transfer is limited to 1 MB/s and the downloads together to a bandwidth changing every 20 seconds, so the best window changes from 8 to 2 to 12 downloads
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"adaptiveWindow" downloadsCount:400 fileSize:(1024 * 1024) entriesCounts:@[]];
+    aScenario.maxConcurrentDownloadsCount = 16;
+    aScenario.bytesPerSecond = 1024 * 1024;
+    aScenario.serverURL = nil;
+    NSArray<NSNumber *> *aBandwidthsArray = @[@(8 * 1024 * 1024), @(2 * 1024 * 1024), @(12 * 1024 * 1024)];
+    NSTimeInterval aPhaseDuration = 20.0;
+    aScenario.configurationBlock = ^(BenchmarkScenario *aConfiguredScenario, HWIFileDownloader *aFileDownloader, HWIFileDownloadLoopbackTransport *aTransport) {
+        aFileDownloader.adaptsConcurrentDownloadsCount = YES;
+        aFileDownloader.maximumBytesPerSecond = [aBandwidthsArray.firstObject longLongValue];
+    };
+    __block NSTimeInterval aStartTime = 0.0;
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        aStartTime = [NSProcessInfo processInfo].systemUptime;
+    };
+    NSMutableArray<NSDictionary<NSString *, NSNumber *> *> *aSamplesArray = [NSMutableArray array];
+    aScenario.sampleInterval = 1.0;
+    aScenario.sampleBlock = ^(BenchmarkScenario *aSampledScenario) {
+        NSTimeInterval anElapsedTime = [NSProcessInfo processInfo].systemUptime - aStartTime;
+        NSUInteger aPhaseIndex = MIN((NSUInteger)(anElapsedTime / aPhaseDuration), aBandwidthsArray.count - 1);
+        int64_t aBandwidth = [[aBandwidthsArray objectAtIndex:aPhaseIndex] longLongValue];
+        if (aSampledScenario.fileDownloader.maximumBytesPerSecond != aBandwidth)
+        {
+            aSampledScenario.fileDownloader.maximumBytesPerSecond = aBandwidth;
+        }
+        NSDictionary<NSString *, NSNumber *> *aStatisticsDictionary = aSampledScenario.fileDownloader.statisticsDictionary;
+        [aSamplesArray addObject:@{@"time" : @(anElapsedTime),
+                                   @"bandwidth" : @(aBandwidth),
+                                   @"window" : [aStatisticsDictionary objectForKey:@"concurrentDownloadsWindow"],
+                                   @"activeDownloadsCount" : [aStatisticsDictionary objectForKey:@"activeDownloadsCount"],
+                                   @"bytesPerSecondSpeed" : [aStatisticsDictionary objectForKey:@"bytesPerSecondSpeed"]}];
+    };
+    aScenario.finishedBlock = ^(BenchmarkScenario *aFinishedScenario) {
+        [aFinishedScenario.measurementsDictionary setObject:[aSamplesArray copy] forKey:@"samples"];
+        [aFinishedScenario.measurementsDictionary setObject:aFinishedScenario.fileDownloader.concurrencyDecisionsLog forKey:@"concurrencyDecisions"];
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Gzip
+
+
++ (nonnull NSArray<BenchmarkScenario *> *)gzipScenarios
+{
+    // the same gzip data is inflated while it is received and after the download; the file size is the size of the inflated data
+    __block NSData *aPayloadData = nil;
+    BenchmarkScenarioConfigurationBlock aConfigurationBlock = ^(BenchmarkScenario *aConfiguredScenario, HWIFileDownloader *aFileDownloader, HWIFileDownloadLoopbackTransport *aTransport) {
+        if (aPayloadData == nil)
+        {
+            aPayloadData = [BenchmarkScenarioCatalog gzipDataWithLength:(NSUInteger)aConfiguredScenario.fileSize];
+        }
+        aTransport.payloadData = aPayloadData;
+    };
+    BenchmarkScenarioBlock aFinishedBlock = ^(BenchmarkScenario *aFinishedScenario) {
+        NSNumber *aWrittenBytesCount = [aFinishedScenario.fileDownloader.statisticsDictionary objectForKey:@"writtenBytesCount"];
+        [aFinishedScenario.measurementsDictionary setObject:@(aPayloadData.length) forKey:@"gzipFileSize"];
+        [aFinishedScenario.measurementsDictionary setObject:@(aWrittenBytesCount.longLongValue + [[aFinishedScenario.measurementsDictionary objectForKey:@"extractedBytesCount"] longLongValue]) forKey:@"totalWrittenBytesCount"];
+    };
+    
+    BenchmarkScenario *aStreamedScenario = [BenchmarkScenarioCatalog scenarioWithName:@"gzipStreamed" downloadsCount:20 fileSize:(32 * 1024 * 1024) entriesCounts:@[]];
+    aStreamedScenario.serverURL = nil;
+    HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+    anOptions.transformKind = HWIFileDownloadTransformKindGzip;
+    aStreamedScenario.options = anOptions;
+    aStreamedScenario.configurationBlock = aConfigurationBlock;
+    aStreamedScenario.finishedBlock = aFinishedBlock;
+    
+    BenchmarkScenario *anExtractedScenario = [BenchmarkScenarioCatalog scenarioWithName:@"gzipExtracted" downloadsCount:aStreamedScenario.downloadsCount fileSize:aStreamedScenario.fileSize entriesCounts:@[]];
+    anExtractedScenario.serverURL = nil;
+    anExtractedScenario.configurationBlock = aConfigurationBlock;
+    anExtractedScenario.completedFileBlock = ^(BenchmarkScenario *aCompletedScenario, NSString *aDownloadIdentifier, NSURL *aLocalFileURL) {
+        NSURL *anOutputURL = [aLocalFileURL URLByAppendingPathExtension:@"out"];
+        HWIFileDownloadGzipTransform *aTransform = [[HWIFileDownloadGzipTransform alloc] initWithOutputURL:anOutputURL bufferSize:(256 * 1024)];
+        NSInputStream *anInputStream = [NSInputStream inputStreamWithURL:aLocalFileURL];
+        [anInputStream open];
+        NSMutableData *aBufferData = [NSMutableData dataWithLength:(1024 * 1024)];
+        BOOL aSuccessFlag = YES;
+        NSInteger aReadLength = 0;
+        while (aSuccessFlag && ((aReadLength = [anInputStream read:aBufferData.mutableBytes maxLength:aBufferData.length]) > 0))
+        {
+            aSuccessFlag = [aTransform transformData:[aBufferData subdataWithRange:NSMakeRange(0, (NSUInteger)aReadLength)] error:NULL];
+        }
+        [anInputStream close];
+        NSError *anError = nil;
+        if ((aReadLength < 0) || ([aTransform finishWithError:&anError] == NO))
+        {
+            NSLog(@"ERR: Unable to extract %@: %@ (%@, %d)", aDownloadIdentifier, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        int64_t anExtractedBytesCount = aTransform.writtenBytesCount;
+        [[NSFileManager defaultManager] removeItemAtURL:anOutputURL error:NULL];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            NSNumber *aTotalExtractedBytesCount = [aCompletedScenario.measurementsDictionary objectForKey:@"extractedBytesCount"];
+            [aCompletedScenario.measurementsDictionary setObject:@(aTotalExtractedBytesCount.longLongValue + anExtractedBytesCount) forKey:@"extractedBytesCount"];
+        });
+    };
+    anExtractedScenario.finishedBlock = aFinishedBlock;
+    
+    return @[aStreamedScenario, anExtractedScenario];
+}
+
+
++ (nonnull NSData *)gzipDataWithLength:(NSUInteger)aLength
+{
+    // text-like data of sixteen letters is compressed to about half
+    NSMutableData *anInflatedData = [NSMutableData dataWithLength:aLength];
+    uint8_t *anInflatedBytes = anInflatedData.mutableBytes;
+    arc4random_buf(anInflatedBytes, aLength);
+    for (NSUInteger anIndex = 0; anIndex < aLength; anIndex++)
+    {
+        anInflatedBytes[anIndex] = (uint8_t)('a' + (anInflatedBytes[anIndex] & 0x0F));
+    }
+    NSMutableData *aDeflatedData = [NSMutableData data];
+    z_stream aStream;
+    memset(&aStream, 0, sizeof(aStream));
+    // window bits of 15 + 16 write a gzip header
+    if (deflateInit2(&aStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+    {
+        aDeflatedData.length = deflateBound(&aStream, (uLong)aLength);
+        aStream.next_in = anInflatedBytes;
+        aStream.avail_in = (uInt)aLength;
+        aStream.next_out = aDeflatedData.mutableBytes;
+        aStream.avail_out = (uInt)aDeflatedData.length;
+        if (deflate(&aStream, Z_FINISH) == Z_STREAM_END)
+        {
+            aDeflatedData.length = aStream.total_out;
+        }
+        else
+        {
+            NSLog(@"ERR: Unable to deflate benchmark data (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            aDeflatedData.length = 0;
+        }
+        deflateEnd(&aStream);
+    }
+    return aDeflatedData;
+}
+
+
+#pragma mark - Finalization
+
+
++ (nonnull BenchmarkScenario *)finalizationScenario
+{
+    // the entries counts are the file sizes, each file is written once appended and once preallocated as by the downloader
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"finalization" downloadsCount:0 fileSize:(1024 * 1024) entriesCounts:@[@(1LL << 30), @(2LL << 30), @(4LL << 30)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        NSURL *aDirectoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:@"BenchmarkFinalization" isDirectory:YES];
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+        NSURL *aDestinationDirectoryURL = [aDirectoryURL URLByAppendingPathComponent:@"Destination" isDirectory:YES];
+        [[NSFileManager defaultManager] createDirectoryAtURL:aDestinationDirectoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+        NSURL *aTemporaryFileURL = [aDirectoryURL URLByAppendingPathComponent:@"download.tmp" isDirectory:NO];
+        NSURL *aDestinationFileURL = [aDestinationDirectoryURL URLByAppendingPathComponent:@"download" isDirectory:NO];
+        NSURL *aLinkedFileURL = [aDestinationDirectoryURL URLByAppendingPathComponent:@"linked" isDirectory:NO];
+        // the file size of the scenario is the size of the received chunks
+        NSData *aChunkData = [NSMutableData dataWithLength:(NSUInteger)MAX(aStartedScenario.fileSize, 1LL)];
+        for (NSNumber *aLength in aStartedScenario.entriesCounts)
+        {
+            NSMutableDictionary<NSString *, NSNumber *> *aMeasurementDictionary = [NSMutableDictionary dictionary];
+            for (NSNumber *aPreallocatesFlag in @[@(NO), @(YES)])
+            {
+                NSString *aPrefix = aPreallocatesFlag.boolValue ? @"preallocated" : @"appended";
+                NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+                HWIFileDownloadFileWriter *aFileWriter = [[HWIFileDownloadFileWriter alloc] initWithFileURL:aTemporaryFileURL bufferSize:(256 * 1024)];
+                if (aPreallocatesFlag.boolValue)
+                {
+                    aFileWriter.preallocationLength = aLength.longLongValue;
+                }
+                NSError *anError = nil;
+                BOOL aSuccessFlag = YES;
+                int64_t anAppendedBytesCount = 0;
+                while (aSuccessFlag && (anAppendedBytesCount < aLength.longLongValue))
+                {
+                    aSuccessFlag = [aFileWriter appendData:aChunkData error:&anError];
+                    anAppendedBytesCount += (int64_t)aChunkData.length;
+                }
+                aSuccessFlag = aSuccessFlag && [aFileWriter closeWithError:&anError];
+                NSTimeInterval aWriteDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+                NSInteger anExtentsCount = [BenchmarkScenarioCatalog extentsCountOfFileAtURL:aTemporaryFileURL];
+                int64_t aFileSize = 0;
+                aStartTime = [NSProcessInfo processInfo].systemUptime;
+                aSuccessFlag = aSuccessFlag && [HWIFileDownloadFileWriter moveItemAtURL:aTemporaryFileURL toURL:aDestinationFileURL fileSize:&aFileSize error:&anError];
+                NSTimeInterval aMoveDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+                aStartTime = [NSProcessInfo processInfo].systemUptime;
+                aSuccessFlag = aSuccessFlag && [HWIFileDownloadFileWriter linkItemAtURL:aDestinationFileURL toURL:aLinkedFileURL fileSize:NULL error:&anError];
+                NSTimeInterval aLinkDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+                if (aSuccessFlag == NO)
+                {
+                    NSLog(@"ERR: Benchmark finalization failed: %@ (%@, %d)", anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                }
+                [aMeasurementDictionary setObject:@(aWriteDuration) forKey:[aPrefix stringByAppendingString:@"WriteDuration"]];
+                [aMeasurementDictionary setObject:@(anExtentsCount) forKey:[aPrefix stringByAppendingString:@"ExtentsCount"]];
+                [aMeasurementDictionary setObject:@(aMoveDuration) forKey:[aPrefix stringByAppendingString:@"MoveDuration"]];
+                [aMeasurementDictionary setObject:@(aLinkDuration) forKey:[aPrefix stringByAppendingString:@"LinkDuration"]];
+                [aMeasurementDictionary setObject:@(aFileSize) forKey:[aPrefix stringByAppendingString:@"FileSize"]];
+                [[NSFileManager defaultManager] removeItemAtURL:aTemporaryFileURL error:NULL];
+                [[NSFileManager defaultManager] removeItemAtURL:aDestinationFileURL error:NULL];
+                [[NSFileManager defaultManager] removeItemAtURL:aLinkedFileURL error:NULL];
+            }
+            [aStartedScenario.measurementsDictionary setObject:aMeasurementDictionary forKey:aLength.stringValue];
+        }
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+    };
+    return aScenario;
+}
+
+
++ (NSInteger)extentsCountOfFileAtURL:(nonnull NSURL *)aFileURL
+{
+    // number of contiguous ranges on disk, -1 if unknown
+    NSInteger anExtentsCount = -1;
+#if defined(F_LOG2PHYS_EXT)
+    int aFileDescriptor = open(aFileURL.fileSystemRepresentation, O_RDONLY);
+    struct stat aStat;
+    if ((aFileDescriptor >= 0) && (fstat(aFileDescriptor, &aStat) == 0))
+    {
+        anExtentsCount = 0;
+        off_t anOffset = 0;
+        while ((anExtentsCount >= 0) && (anOffset < aStat.st_size))
+        {
+            struct log2phys aLog2Phys = {0, aStat.st_size - anOffset, anOffset};
+            if ((fcntl(aFileDescriptor, F_LOG2PHYS_EXT, &aLog2Phys) == -1) || (aLog2Phys.l2p_contigbytes <= 0))
+            {
+                anExtentsCount = -1;
+            }
+            else
+            {
+                anExtentsCount++;
+                anOffset += aLog2Phys.l2p_contigbytes;
+            }
+        }
+    }
+    if (aFileDescriptor >= 0)
+    {
+        close(aFileDescriptor);
+    }
+#endif
+    return anExtentsCount;
+}
+
+
+#pragma mark - Slow Disk
+
+
++ (nonnull BenchmarkScenario *)slowDiskScenario
+{
+    // the loopback transport delivers faster than the disk writes, which is slowed further by synchronous writes of another file
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"slowDisk" downloadsCount:16 fileSize:(64 * 1024 * 1024) entriesCounts:@[]];
+    aScenario.serverURL = nil;
+    int64_t aMaximumPendingWriteBytesCount = 4 * 1024 * 1024;
+    aScenario.configurationBlock = ^(BenchmarkScenario *aConfiguredScenario, HWIFileDownloader *aFileDownloader, HWIFileDownloadLoopbackTransport *aTransport) {
+        aFileDownloader.maximumPendingWriteBytesCount = aMaximumPendingWriteBytesCount;
+    };
+    NSURL *aCompetingFileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:@"BenchmarkSlowDisk" isDirectory:NO];
+    __block dispatch_source_t aCompetingWriteTimer = nil;
+    __block int64_t aCompetingWrittenBytesCount = 0;
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        int aFileDescriptor = open(aCompetingFileURL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (aFileDescriptor < 0)
+        {
+            NSLog(@"ERR: Unable to open %@: %s (%@, %d)", aCompetingFileURL, strerror(errno), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        else
+        {
+            // 1 MB written and flushed to the disk as often as possible, cycling through 256 MB of the file
+            NSData *aChunkData = [NSMutableData dataWithLength:(1024 * 1024)];
+            aCompetingWriteTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_queue_create("BenchmarkScenarioCatalog.slowDisk", DISPATCH_QUEUE_SERIAL));
+            dispatch_source_set_timer(aCompetingWriteTimer, DISPATCH_TIME_NOW, NSEC_PER_MSEC, NSEC_PER_MSEC);
+            dispatch_source_set_event_handler(aCompetingWriteTimer, ^{
+                off_t anOffset = (off_t)(aCompetingWrittenBytesCount % (256 * 1024 * 1024));
+                ssize_t aWrittenLength = pwrite(aFileDescriptor, aChunkData.bytes, aChunkData.length, anOffset);
+                if (aWrittenLength > 0)
+                {
+                    fcntl(aFileDescriptor, F_FULLFSYNC);
+                    aCompetingWrittenBytesCount += aWrittenLength;
+                }
+            });
+            dispatch_source_set_cancel_handler(aCompetingWriteTimer, ^{
+                close(aFileDescriptor);
+                unlink(aCompetingFileURL.fileSystemRepresentation);
+            });
+            dispatch_resume(aCompetingWriteTimer);
+        }
+    };
+    aScenario.finishedBlock = ^(BenchmarkScenario *aFinishedScenario) {
+        if (aCompetingWriteTimer)
+        {
+            dispatch_source_cancel(aCompetingWriteTimer);
+            aCompetingWriteTimer = nil;
+        }
+        NSDictionary<NSString *, NSNumber *> *aStatisticsDictionary = aFinishedScenario.fileDownloader.statisticsDictionary;
+        [aFinishedScenario.measurementsDictionary setObject:@(aMaximumPendingWriteBytesCount) forKey:@"maximumPendingWriteBytesCount"];
+        for (NSString *aKey in @[@"pendingWriteBytesHighWaterMark", @"writeStallsCount", @"writeStallDuration", @"processPeakResidentSize"])
+        {
+            [aFinishedScenario.measurementsDictionary setObject:([aStatisticsDictionary objectForKey:aKey] ?: @(0)) forKey:aKey];
+        }
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Journal
+
+
++ (nonnull BenchmarkScenario *)journalReplayScenario
+{
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"journalReplay" downloadsCount:0 fileSize:0 entriesCounts:@[@(100000)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        // the replayed journals compact their files asynchronously, so each entries count has its own file, removed by the next run
+        NSURL *aDirectoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:@"BenchmarkJournal" isDirectory:YES];
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+        HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+        for (NSNumber *anEntriesCount in aStartedScenario.entriesCounts)
+        {
+            NSURL *aJournalFileURL = [aDirectoryURL URLByAppendingPathComponent:[NSString stringWithFormat:@"QueueJournal%@", anEntriesCount] isDirectory:NO];
+            // records as of a queue of waiting downloads: some have changed priority, some have started or been cancelled
+            HWIFileDownloadJournal *aJournal = [[HWIFileDownloadJournal alloc] initWithFileURL:aJournalFileURL];
+            for (NSUInteger anIndex = 0; anIndex < anEntriesCount.unsignedIntegerValue; anIndex++)
+            {
+                NSString *aDownloadToken = [NSString stringWithFormat:@"%@-%@", aStartedScenario.name, @(anIndex)];
+                [aJournal recordEnqueueOfDownloadToken:aDownloadToken remoteURL:[aStartedScenario remoteURLForDownloadIdentifier:aDownloadToken] resumeDataFileName:nil options:anOptions];
+                if ((anIndex % 4) == 1)
+                {
+                    [aJournal recordPriority:HWIFileDownloadPriorityHigh ofDownloadToken:aDownloadToken];
+                }
+                if ((anIndex % 10) == 2)
+                {
+                    [aJournal recordEvent:HWIFileDownloadJournalEventStart ofDownloadToken:aDownloadToken];
+                }
+                if ((anIndex % 20) == 3)
+                {
+                    [aJournal recordEvent:HWIFileDownloadJournalEventCancel ofDownloadToken:aDownloadToken];
+                }
+            }
+            NSUInteger aRecordsCount = aJournal.recordsCount;
+            [aJournal flush];
+            aJournal = nil;
+            // the records are written on a private queue of the journal; the file is complete when its size has settled
+            unsigned long long aFileSize = 0;
+            NSUInteger aSettledChecksCount = 0;
+            for (NSUInteger aCheckIndex = 0; (aCheckIndex < 1000) && (aSettledChecksCount < 5); aCheckIndex++)
+            {
+                [NSThread sleepForTimeInterval:0.01];
+                unsigned long long aCurrentFileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:aJournalFileURL.path error:NULL] fileSize];
+                aSettledChecksCount = ((aCurrentFileSize > 0) && (aCurrentFileSize == aFileSize)) ? (aSettledChecksCount + 1) : 0;
+                aFileSize = aCurrentFileSize;
+            }
+            NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+            HWIFileDownloadJournal *aReplayedJournal = [[HWIFileDownloadJournal alloc] initWithFileURL:aJournalFileURL];
+            NSTimeInterval aReplayDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+            NSDictionary<NSString *, NSNumber *> *aMeasurementDictionary = @{@"recordsCount" : @(aRecordsCount),
+                                                                             @"fileSize" : @(aFileSize),
+                                                                             @"replayedEntriesCount" : @(aReplayedJournal.entriesCount),
+                                                                             @"replayDuration" : @(aReplayDuration)};
+            [aStartedScenario.measurementsDictionary setObject:aMeasurementDictionary forKey:anEntriesCount.stringValue];
+        }
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Resume Data
+
+
++ (nonnull BenchmarkScenario *)resumeDataScenario
+{
+    // the file size is the size of each resume data, the entries count the number of waiting downloads with resume data
+    BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:@"resumeData" downloadsCount:0 fileSize:(64 * 1024) entriesCounts:@[@(1000)]];
+    aScenario.startedBlock = ^(BenchmarkScenario *aStartedScenario) {
+        NSUInteger aCount = [aStartedScenario.entriesCounts.firstObject unsignedIntegerValue];
+        NSUInteger aLength = (NSUInteger)aStartedScenario.fileSize;
+        NSURL *aDirectoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:@"BenchmarkResumeData" isDirectory:YES];
+        [[NSFileManager defaultManager] removeItemAtURL:aDirectoryURL error:NULL];
+        
+        // stored in files, as resume data of waiting downloads is kept now; measured first, as freed memory is not always returned to the system
+        int64_t aStartResidentSize = [BenchmarkScenario residentSize];
+        HWIFileDownloadResumeDataStore *aResumeDataStore = [[HWIFileDownloadResumeDataStore alloc] initWithDirectoryURL:aDirectoryURL];
+        NSMutableArray<NSURL *> *aFileURLsArray = [NSMutableArray arrayWithCapacity:aCount];
+        for (NSUInteger anIndex = 0; anIndex < aCount; anIndex++)
+        {
+            @autoreleasepool
+            {
+                NSMutableData *aResumeData = [NSMutableData dataWithLength:aLength];
+                arc4random_buf(aResumeData.mutableBytes, aLength);
+                [aFileURLsArray addObject:[aResumeDataStore storeResumeData:aResumeData]];
+            }
+        }
+        // reading waits for the pending write of a file
+        NSTimeInterval aStartTime = [NSProcessInfo processInfo].systemUptime;
+        NSUInteger aReadBytesCount = 0;
+        for (NSURL *aFileURL in aFileURLsArray)
+        {
+            aReadBytesCount += [aResumeDataStore resumeDataAtFileURL:aFileURL].length;
+        }
+        NSTimeInterval aReadDuration = [NSProcessInfo processInfo].systemUptime - aStartTime;
+        int64_t aStoredResidentSize = [BenchmarkScenario residentSize] - aStartResidentSize;
+        int64_t aStoredBytesCount = aResumeDataStore.storedBytesCount;
+        for (NSURL *aFileURL in aFileURLsArray)
+        {
+            [aResumeDataStore removeResumeDataAtFileURL:aFileURL];
+        }
+        
+        // held in memory, as resume data of waiting downloads was kept before
+        aStartResidentSize = [BenchmarkScenario residentSize];
+        NSMutableArray<NSData *> *aResumeDataArray = [NSMutableArray arrayWithCapacity:aCount];
+        for (NSUInteger anIndex = 0; anIndex < aCount; anIndex++)
+        {
+            NSMutableData *aResumeData = [NSMutableData dataWithLength:aLength];
+            arc4random_buf(aResumeData.mutableBytes, aLength);
+            [aResumeDataArray addObject:aResumeData];
+        }
+        int64_t anInMemoryResidentSize = [BenchmarkScenario residentSize] - aStartResidentSize;
+        [aResumeDataArray removeAllObjects];
+        
+        [aStartedScenario.measurementsDictionary setObject:@(aCount) forKey:@"resumeDataCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(anInMemoryResidentSize) forKey:@"inMemoryResidentSize"];
+        [aStartedScenario.measurementsDictionary setObject:@(aStoredResidentSize) forKey:@"storedResidentSize"];
+        [aStartedScenario.measurementsDictionary setObject:@(aStoredBytesCount) forKey:@"storedResumeDataBytesCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(aReadBytesCount) forKey:@"readBytesCount"];
+        [aStartedScenario.measurementsDictionary setObject:@(aReadDuration / MAX(aCount, (NSUInteger)1)) forKey:@"readDuration"];
+    };
+    return aScenario;
+}
+
+
+#pragma mark - Launch Arguments
+
+
++ (nonnull NSArray<BenchmarkScenario *> *)queuedScenariosWithName:(nonnull NSString *)aName entriesCounts:(nonnull NSArray<NSNumber *> *)anEntriesCountsArray
+{
+    // one scenario per number of queued downloads, e.g. lookup100000; the downloads are slow, so they stay queued while measured and are cancelled by the started block
+    BenchmarkScenario *aTemplateScenario = [BenchmarkScenarioCatalog scenarioWithName:aName downloadsCount:0 fileSize:(1024 * 1024) entriesCounts:anEntriesCountsArray];
+    NSMutableArray<BenchmarkScenario *> *aScenariosArray = [NSMutableArray arrayWithCapacity:aTemplateScenario.entriesCounts.count];
+    for (NSNumber *anEntriesCount in aTemplateScenario.entriesCounts)
+    {
+        NSString *aScenarioName = [NSString stringWithFormat:@"%@%@", aName, anEntriesCount];
+        BenchmarkScenario *aScenario = [BenchmarkScenarioCatalog scenarioWithName:aScenarioName downloadsCount:anEntriesCount.unsignedIntegerValue fileSize:aTemplateScenario.fileSize entriesCounts:@[]];
+        aScenario.bytesPerSecond = 1024;
+        aScenario.serverURL = nil;
+        [aScenariosArray addObject:aScenario];
+    }
+    return aScenariosArray;
+}
+
+
+
++ (nonnull BenchmarkScenario *)scenarioWithName:(nonnull NSString *)aName
+                                 downloadsCount:(NSUInteger)aDownloadsCount
+                                       fileSize:(int64_t)aFileSize
+                                   entriesCounts:(nonnull NSArray<NSNumber *> *)anEntriesCountsArray
+{
+    // launch arguments are in the argument domain of the user defaults
+    NSUserDefaults *aUserDefaults = [NSUserDefaults standardUserDefaults];
+    NSString *aDownloadsCountString = [aUserDefaults stringForKey:[aName stringByAppendingString:@"DownloadsCount"]];
+    if (aDownloadsCountString.length > 0)
+    {
+        aDownloadsCount = (NSUInteger)MAX([aDownloadsCountString longLongValue], 0LL);
+    }
+    NSString *aFileSizeString = [aUserDefaults stringForKey:[aName stringByAppendingString:@"FileSize"]];
+    if (aFileSizeString.length > 0)
+    {
+        aFileSize = MAX([aFileSizeString longLongValue], 0LL);
+    }
+    NSString *anEntriesCountsString = [aUserDefaults stringForKey:[aName stringByAppendingString:@"EntriesCounts"]];
+    if (anEntriesCountsString.length > 0)
+    {
+        NSMutableArray<NSNumber *> *aParsedEntriesCountsArray = [NSMutableArray array];
+        for (NSString *anEntriesCountString in [anEntriesCountsString componentsSeparatedByString:@","])
+        {
+            long long anEntriesCount = [anEntriesCountString longLongValue];
+            if (anEntriesCount > 0)
+            {
+                [aParsedEntriesCountsArray addObject:@(anEntriesCount)];
+            }
+        }
+        anEntriesCountsArray = aParsedEntriesCountsArray;
+    }
+    BenchmarkScenario *aScenario = [[BenchmarkScenario alloc] initWithName:aName downloadsCount:aDownloadsCount fileSize:aFileSize];
+    aScenario.entriesCounts = anEntriesCountsArray;
+    NSString *aServerURLString = [aUserDefaults stringForKey:[aName stringByAppendingString:@"ServerURL"]];
+    if (aServerURLString.length == 0)
+    {
+        aServerURLString = [aUserDefaults stringForKey:@"BenchmarkServerURL"];
+    }
+    if (aServerURLString.length > 0)
+    {
+        aScenario.serverURL = [NSURL URLWithString:aServerURLString];
+    }
+    return aScenario;
+}
+
+
+@end
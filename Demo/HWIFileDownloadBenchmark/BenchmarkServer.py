@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+#
+# Project: HWIFileDownload (Benchmark App)
+#
+# File: BenchmarkServer.py
+#
+# Local HTTP server for the benchmark app: GET /<size>/<name> answers <size>
+# zero bytes, with byte ranges (206), ETag and If-None-Match (304) like a
+# file server. Run with: python3 BenchmarkServer.py [port] (default: 8000)
+# and launch the benchmark app with -BenchmarkServerURL http://localhost:8000
+#
+
+import re
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+CHUNK = bytes(64 * 1024)
+
+
+class BenchmarkRequestHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def do_HEAD(self):
+        self.answer(send_body=False)
+
+    def do_GET(self):
+        self.answer(send_body=True)
+
+    def answer(self, send_body):
+        match = re.match(r'^/(\d+)/', self.path)
+        if match is None:
+            self.send_error(404)
+            return
+        size = int(match.group(1))
+        etag = '"%d"' % size
+        if self.headers.get('If-None-Match') == etag:
+            self.send_response(304)
+            self.send_header('ETag', etag)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
+        start, end = 0, size - 1
+        range_match = re.match(r'^bytes=(\d+)-(\d*)$', self.headers.get('Range', ''))
+        if_range = self.headers.get('If-Range')
+        if range_match and (if_range is None or if_range == etag):
+            start = int(range_match.group(1))
+            if range_match.group(2):
+                end = min(int(range_match.group(2)), size - 1)
+            if start > end:
+                self.send_response(416)
+                self.send_header('Content-Range', 'bytes */%d' % size)
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, size))
+        else:
+            self.send_response(200)
+        self.send_header('ETag', etag)
+        self.send_header('Accept-Ranges', 'bytes')
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Content-Length', str(end - start + 1))
+        self.end_headers()
+        remaining = end - start + 1 if send_body else 0
+        while remaining > 0:
+            chunk = CHUNK[:min(remaining, len(CHUNK))]
+            self.wfile.write(chunk)
+            remaining -= len(chunk)
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == '__main__':
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else 8000
+    ThreadingHTTPServer(('', port), BenchmarkRequestHandler).serve_forever()
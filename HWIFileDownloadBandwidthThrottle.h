@@ -0,0 +1,109 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadBandwidthThrottle.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadPriority.h"
+
+
+/**
+ HWIFileDownloadBandwidthThrottle limits the received bytes per second with token buckets (overall, per priority and per download). It is used internally by HWIFileDownloader.
+ @discussion Received bytes are taken from all buckets that apply to a download. An empty bucket results in a delay until the bucket has been refilled; the download is suspended meanwhile. A limit of 0 means no limit. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadBandwidthThrottle : NSObject
+
+/**
+ Maximum number of bytes per second received by all downloads. Default: 0 (no limit).
+ */
+@property (nonatomic, assign) int64_t bytesPerSecondLimit;
+
+/**
+ YES if any limit is set.
+ */
+@property (nonatomic, assign, readonly) BOOL isEnabled;
+
+/**
+ Number of delays caused by empty buckets.
+ */
+@property (nonatomic, assign, readonly) NSUInteger delaysCount;
+
+/**
+ Sets the maximum number of bytes per second received by all downloads of a priority together.
+ @param aBytesPerSecondLimit Limit in bytes per second (0: no limit).
+ @param aPriority Priority.
+ */
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit forPriority:(HWIFileDownloadPriority)aPriority;
+
+/**
+ Maximum number of bytes per second received by all downloads of a priority together.
+ @param aPriority Priority.
+ @return Limit in bytes per second (0: no limit).
+ */
+- (int64_t)bytesPerSecondLimitForPriority:(HWIFileDownloadPriority)aPriority;
+
+/**
+ Sets the maximum number of bytes per second received by a download.
+ @param aBytesPerSecondLimit Limit in bytes per second (0: no limit).
+ @param aDownloadToken Download token.
+ */
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit forDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Maximum number of bytes per second received by a download.
+ @param aDownloadToken Download token.
+ @return Limit in bytes per second (0: no limit).
+ */
+- (int64_t)bytesPerSecondLimitForDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Takes received bytes from the buckets of a download.
+ @param aBytesCount Number of received bytes.
+ @param aDownloadToken Download token.
+ @param aPriority Priority of the download.
+ @param aTime Current time (time interval since reference date).
+ @return Time in seconds until the download may receive more data (0.0 if not limited).
+ */
+- (NSTimeInterval)delayAfterReceivingBytes:(int64_t)aBytesCount
+                             downloadToken:(nonnull NSString *)aDownloadToken
+                                  priority:(HWIFileDownloadPriority)aPriority
+                                    atTime:(NSTimeInterval)aTime;
+
+/**
+ Drops the limit and the bucket of a finished download.
+ @param aDownloadToken Download token.
+ */
+- (void)removeDownloadToken:(nonnull NSString *)aDownloadToken;
+
+@end
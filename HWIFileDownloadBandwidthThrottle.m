@@ -0,0 +1,228 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadBandwidthThrottle.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadBandwidthThrottle.h"
+
+
+static const NSTimeInterval HWIFileDownloadBandwidthThrottleBurstInterval = 0.5; // bucket capacity in seconds of the limit
+
+
+@interface HWIFileDownloadTokenBucket : NSObject
+@property (nonatomic, assign) int64_t bytesPerSecondLimit;
+@property (nonatomic, assign) double availableBytesCount;
+@property (nonatomic, assign) NSTimeInterval lastRefillTime;
+@end
+
+
+@implementation HWIFileDownloadTokenBucket
+
+
+- (NSTimeInterval)delayAfterTakingBytes:(int64_t)aBytesCount atTime:(NSTimeInterval)aTime
+{
+    NSTimeInterval aDelay = 0.0;
+    if (self.bytesPerSecondLimit > 0)
+    {
+        double aCapacity = (double)self.bytesPerSecondLimit * HWIFileDownloadBandwidthThrottleBurstInterval;
+        if (self.lastRefillTime > 0.0)
+        {
+            self.availableBytesCount = MIN(aCapacity, self.availableBytesCount + (MAX(aTime - self.lastRefillTime, 0.0) * (double)self.bytesPerSecondLimit));
+        }
+        else
+        {
+            self.availableBytesCount = aCapacity;
+        }
+        self.lastRefillTime = aTime;
+        // the balance might get negative; the download waits until it has been paid back
+        self.availableBytesCount -= (double)aBytesCount;
+        if (self.availableBytesCount < 0.0)
+        {
+            aDelay = -self.availableBytesCount / (double)self.bytesPerSecondLimit;
+        }
+    }
+    return aDelay;
+}
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.bytesPerSecondLimit) forKey:@"bytesPerSecondLimit"];
+    [aDescriptionDict setObject:@(self.availableBytesCount) forKey:@"availableBytesCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
+
+
+@interface HWIFileDownloadBandwidthThrottle()
+@property (nonatomic, strong, nonnull) HWIFileDownloadTokenBucket *globalBucket;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSNumber *, HWIFileDownloadTokenBucket *> *priorityBucketsDictionary;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, HWIFileDownloadTokenBucket *> *downloadBucketsDictionary;
+@property (nonatomic, assign, readwrite) NSUInteger delaysCount;
+@end
+
+
+@implementation HWIFileDownloadBandwidthThrottle
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.globalBucket = [[HWIFileDownloadTokenBucket alloc] init];
+        self.priorityBucketsDictionary = [NSMutableDictionary dictionary];
+        self.downloadBucketsDictionary = [NSMutableDictionary dictionary];
+        self.delaysCount = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Limits
+
+
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit
+{
+    self.globalBucket.bytesPerSecondLimit = MAX(aBytesPerSecondLimit, 0);
+}
+
+
+- (int64_t)bytesPerSecondLimit
+{
+    return self.globalBucket.bytesPerSecondLimit;
+}
+
+
+- (BOOL)isEnabled
+{
+    return ((self.globalBucket.bytesPerSecondLimit > 0) || (self.priorityBucketsDictionary.count > 0) || (self.downloadBucketsDictionary.count > 0));
+}
+
+
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit forPriority:(HWIFileDownloadPriority)aPriority
+{
+    [self setBytesPerSecondLimit:aBytesPerSecondLimit forKey:@(aPriority) inBucketsDictionary:self.priorityBucketsDictionary];
+}
+
+
+- (int64_t)bytesPerSecondLimitForPriority:(HWIFileDownloadPriority)aPriority
+{
+    return [self.priorityBucketsDictionary objectForKey:@(aPriority)].bytesPerSecondLimit;
+}
+
+
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit forDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    [self setBytesPerSecondLimit:aBytesPerSecondLimit forKey:aDownloadToken inBucketsDictionary:self.downloadBucketsDictionary];
+}
+
+
+- (int64_t)bytesPerSecondLimitForDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    return [self.downloadBucketsDictionary objectForKey:aDownloadToken].bytesPerSecondLimit;
+}
+
+
+#pragma mark - Throttling
+
+
+- (NSTimeInterval)delayAfterReceivingBytes:(int64_t)aBytesCount
+                             downloadToken:(nonnull NSString *)aDownloadToken
+                                  priority:(HWIFileDownloadPriority)aPriority
+                                    atTime:(NSTimeInterval)aTime
+{
+    NSTimeInterval aDelay = [self.globalBucket delayAfterTakingBytes:aBytesCount atTime:aTime];
+    aDelay = MAX(aDelay, [[self.priorityBucketsDictionary objectForKey:@(aPriority)] delayAfterTakingBytes:aBytesCount atTime:aTime]);
+    aDelay = MAX(aDelay, [[self.downloadBucketsDictionary objectForKey:aDownloadToken] delayAfterTakingBytes:aBytesCount atTime:aTime]);
+    if (aDelay > 0.0)
+    {
+        self.delaysCount++;
+    }
+    return aDelay;
+}
+
+
+- (void)removeDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    [self.downloadBucketsDictionary removeObjectForKey:aDownloadToken];
+}
+
+
+#pragma mark - Utilities
+
+
+- (void)setBytesPerSecondLimit:(int64_t)aBytesPerSecondLimit forKey:(nonnull id<NSCopying>)aKey inBucketsDictionary:(nonnull NSMutableDictionary *)aBucketsDictionary
+{
+    if (aBytesPerSecondLimit > 0)
+    {
+        HWIFileDownloadTokenBucket *aBucket = [aBucketsDictionary objectForKey:aKey];
+        if (aBucket == nil)
+        {
+            aBucket = [[HWIFileDownloadTokenBucket alloc] init];
+            [aBucketsDictionary setObject:aBucket forKey:aKey];
+        }
+        aBucket.bytesPerSecondLimit = aBytesPerSecondLimit;
+    }
+    else
+    {
+        [aBucketsDictionary removeObjectForKey:aKey];
+    }
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.globalBucket forKey:@"globalBucket"];
+    [aDescriptionDict setObject:self.priorityBucketsDictionary forKey:@"priorityBucketsDictionary"];
+    [aDescriptionDict setObject:self.downloadBucketsDictionary forKey:@"downloadBucketsDictionary"];
+    [aDescriptionDict setObject:@(self.delaysCount) forKey:@"delaysCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
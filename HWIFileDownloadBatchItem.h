@@ -0,0 +1,75 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadBatchItem.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadOptions.h"
+
+
+/**
+ HWIFileDownloadBatchItem is one download of a batch passed to startDownloadsWithBatchItems: of HWIFileDownloader.
+ */
+@interface HWIFileDownloadBatchItem : NSObject
+
+/**
+ Initializer for a download from a remote URL.
+ @param anIdentifier Download identifier of a download item.
+ @param aRemoteURL Remote URL from where data should be downloaded.
+ @param anOptions Options of the download (copied). Default options if nil.
+ @return Batch item.
+ */
+- (nonnull instancetype)initWithIdentifier:(nonnull NSString *)anIdentifier
+                                 remoteURL:(nonnull NSURL *)aRemoteURL
+                                   options:(nullable HWIFileDownloadOptions *)anOptions;
+
+/**
+ Initializer for a download continued with resume data.
+ @param anIdentifier Download identifier of a download item.
+ @param aResumeData Incomplete data from previous download with implicit remote source information.
+ @param anOptions Options of the download (copied). Default options if nil.
+ @return Batch item.
+ */
+- (nonnull instancetype)initWithIdentifier:(nonnull NSString *)anIdentifier
+                                resumeData:(nonnull NSData *)aResumeData
+                                   options:(nullable HWIFileDownloadOptions *)anOptions;
+- (nonnull instancetype)init __attribute__((unavailable("use initWithIdentifier:remoteURL:options: or initWithIdentifier:resumeData:options:")));
++ (nonnull instancetype)new __attribute__((unavailable("use initWithIdentifier:remoteURL:options: or initWithIdentifier:resumeData:options:")));
+
+@property (nonatomic, copy, readonly, nonnull) NSString *identifier;
+@property (nonatomic, strong, readonly, nullable) NSURL *remoteURL;
+@property (nonatomic, strong, readonly, nullable) NSData *resumeData;
+@property (nonatomic, strong, readonly, nonnull) HWIFileDownloadOptions *options;
+
+@end
@@ -0,0 +1,105 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadBatchItem.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadBatchItem.h"
+
+
+@interface HWIFileDownloadBatchItem()
+@property (nonatomic, copy, readwrite, nonnull) NSString *identifier;
+@property (nonatomic, strong, readwrite, nullable) NSURL *remoteURL;
+@property (nonatomic, strong, readwrite, nullable) NSData *resumeData;
+@property (nonatomic, strong, readwrite, nonnull) HWIFileDownloadOptions *options;
+@end
+
+
+@implementation HWIFileDownloadBatchItem
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithIdentifier:(nonnull NSString *)anIdentifier
+                                 remoteURL:(nonnull NSURL *)aRemoteURL
+                                   options:(nullable HWIFileDownloadOptions *)anOptions
+{
+    self = [super init];
+    if (self)
+    {
+        self.identifier = anIdentifier;
+        self.remoteURL = aRemoteURL;
+        self.options = anOptions ? [anOptions copy] : [[HWIFileDownloadOptions alloc] init];
+    }
+    return self;
+}
+
+
+- (nonnull instancetype)initWithIdentifier:(nonnull NSString *)anIdentifier
+                                resumeData:(nonnull NSData *)aResumeData
+                                   options:(nullable HWIFileDownloadOptions *)anOptions
+{
+    self = [super init];
+    if (self)
+    {
+        self.identifier = anIdentifier;
+        self.resumeData = aResumeData;
+        self.options = anOptions ? [anOptions copy] : [[HWIFileDownloadOptions alloc] init];
+    }
+    return self;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.identifier forKey:@"identifier"];
+    if (self.remoteURL)
+    {
+        [aDescriptionDict setObject:self.remoteURL forKey:@"remoteURL"];
+    }
+    if (self.resumeData)
+    {
+        [aDescriptionDict setObject:@(self.resumeData.length) forKey:@"resumeDataLength"];
+    }
+    [aDescriptionDict setObject:self.options forKey:@"options"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,196 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadCache.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadCacheEntry describes a cached download.
+ */
+@interface HWIFileDownloadCacheEntry : NSObject
+
+@property (nonatomic, strong, readonly, nonnull) NSURL *remoteURL;
+@property (nonatomic, copy, readonly, nullable) NSString *eTag;
+@property (nonatomic, copy, readonly, nullable) NSString *lastModified;
+@property (nonatomic, copy, readonly, nonnull) NSString *digest; // SHA-256 hex string of the file contents
+@property (nonatomic, assign, readonly) int64_t fileSize;
+@property (nonatomic, assign, readonly) NSTimeInterval lastAccessTime; // time interval since reference date
+@property (nonatomic, assign, readonly) NSTimeInterval lastValidationTime; // time interval since reference date
+
+- (nonnull HWIFileDownloadCacheEntry *)init __attribute__((unavailable("entries are created by HWIFileDownloadCache")));
++ (nonnull HWIFileDownloadCacheEntry *)new __attribute__((unavailable("entries are created by HWIFileDownloadCache")));
+
+@end
+
+
+/**
+ HWIFileDownloadCache is an on-disk cache of downloaded files in front of HWIFileDownloader.
+ @discussion Files are stored once per content (named by the SHA-256 digest of the contents) and indexed by remote URL together with the validators (ETag, Last-Modified) of the response. The index is a binary property list loaded on initialization. When the size of the stored files exceeds the maximum size, least recently used entries are evicted. The cache can be used from any thread.
+ */
+@interface HWIFileDownloadCache : NSObject
+
+/**
+ Designated initializer.
+ @param aDirectoryURL Local directory URL of the cache. It is created if needed.
+ @param aMaximumSize Maximum size of the cached files in bytes.
+ @return HWIFileDownloadCache.
+ */
+- (nonnull instancetype)initWithDirectoryURL:(nonnull NSURL *)aDirectoryURL maximumSize:(int64_t)aMaximumSize;
+- (nonnull HWIFileDownloadCache *)init __attribute__((unavailable("use initWithDirectoryURL:maximumSize:")));
++ (nonnull HWIFileDownloadCache *)new __attribute__((unavailable("use initWithDirectoryURL:maximumSize:")));
+
+/**
+ Local directory URL of the cache.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *directoryURL;
+
+/**
+ Maximum size of the cached files in bytes. Entries are evicted immediately when lowered.
+ */
+@property (nonatomic, assign) int64_t maximumSize;
+
+/**
+ Time in seconds after a validation during which an entry is used without asking the remote host. Default: 0.0 (every use is revalidated with a conditional request).
+ */
+@property (nonatomic, assign) NSTimeInterval maximumAge;
+
+/**
+ Size of the cached files in bytes.
+ */
+@property (nonatomic, assign, readonly) int64_t totalSize;
+
+/**
+ Number of entries.
+ */
+@property (nonatomic, assign, readonly) NSUInteger entriesCount;
+
+/**
+ Number of downloads completed from the cache (without request or after a "304 Not Modified" response).
+ */
+@property (nonatomic, assign, readonly) NSUInteger hitsCount;
+
+/**
+ Number of hits after a "304 Not Modified" response.
+ */
+@property (nonatomic, assign, readonly) NSUInteger notModifiedCount;
+
+/**
+ Number of downloads of a cachable remote URL that transferred the file.
+ */
+@property (nonatomic, assign, readonly) NSUInteger missesCount;
+
+/**
+ Hits in relation to hits and misses (0.0 ... 1.0).
+ */
+@property (nonatomic, assign, readonly) double hitRate;
+
+/**
+ Number of bytes provided by the cache instead of downloading them.
+ */
+@property (nonatomic, assign, readonly) int64_t savedBytesCount;
+
+/**
+ Returns the entry for a remote URL.
+ @param aRemoteURL Remote URL.
+ @return Entry or nil if not cached.
+ */
+- (nullable HWIFileDownloadCacheEntry *)entryForRemoteURL:(nonnull NSURL *)aRemoteURL;
+
+/**
+ Answers the question whether an entry can be used without revalidation.
+ @param anEntry Entry.
+ @return YES if validated within maximumAge, NO otherwise.
+ */
+- (BOOL)isFreshEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry;
+
+/**
+ Adds the conditional request headers (If-None-Match, If-Modified-Since) of an entry to a request.
+ @param anEntry Entry.
+ @param aRequest Request to change.
+ @return YES if the entry has validators, NO otherwise.
+ */
+- (BOOL)addConditionalHeadersForEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry toRequest:(nonnull NSMutableURLRequest *)aRequest;
+
+/**
+ Provides the cached file of an entry at a local file URL as hard link (or copy) and counts a hit.
+ @param anEntry Entry.
+ @param aFileURL Local file URL. An existing file is replaced.
+ @param aNotModifiedFlag YES if the entry has been revalidated with a "304 Not Modified" response.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise. On failure the entry is removed.
+ */
+- (BOOL)linkEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry toFileURL:(nonnull NSURL *)aFileURL notModified:(BOOL)aNotModifiedFlag error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Creates a hard link (or copy) of a downloaded file in the cache directory for storing it after the digest has been computed.
+ @param aFileURL Local file URL of the downloaded file.
+ @return Local file URL of the staged file or nil on failure.
+ */
+- (nullable NSURL *)stageFileAtURL:(nonnull NSURL *)aFileURL;
+
+/**
+ Stores a staged file and counts a miss. An existing entry for the remote URL is replaced.
+ @param aStagedFileURL Local file URL returned by stageFileAtURL:.
+ @param aDigest SHA-256 hex string of the file contents.
+ @param aRemoteURL Remote URL.
+ @param anETag ETag response header.
+ @param aLastModified Last-Modified response header.
+ @return Stored entry or nil on failure.
+ */
+- (nullable HWIFileDownloadCacheEntry *)storeStagedFileAtURL:(nonnull NSURL *)aStagedFileURL
+                                                      digest:(nonnull NSString *)aDigest
+                                                   remoteURL:(nonnull NSURL *)aRemoteURL
+                                                        eTag:(nullable NSString *)anETag
+                                                lastModified:(nullable NSString *)aLastModified;
+
+/**
+ Removes the entry for a remote URL.
+ @param aRemoteURL Remote URL.
+ */
+- (void)removeEntryForRemoteURL:(nonnull NSURL *)aRemoteURL;
+
+/**
+ Removes all entries and cached files.
+ */
+- (void)removeAllEntries;
+
+/**
+ Writes the index to the cache directory if it has been changed.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)saveIndexWithError:(NSError * _Nullable * _Nullable)anError;
+
+@end
@@ -0,0 +1,616 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadCache.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadCache.h"
+#import "HWIFileDownloadFileWriter.h"
+
+
+static NSString * const HWIFileDownloadCacheIndexFileName = @"index.plist";
+static NSString * const HWIFileDownloadCacheStagingPathExtension = @"staged";
+static const NSInteger HWIFileDownloadCacheIndexVersion = 1;
+
+
+@interface HWIFileDownloadCacheEntry()
+@property (nonatomic, strong, readwrite, nonnull) NSURL *remoteURL;
+@property (nonatomic, copy, readwrite, nullable) NSString *eTag;
+@property (nonatomic, copy, readwrite, nullable) NSString *lastModified;
+@property (nonatomic, copy, readwrite, nonnull) NSString *digest;
+@property (nonatomic, assign, readwrite) int64_t fileSize;
+@property (nonatomic, assign, readwrite) NSTimeInterval lastAccessTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval lastValidationTime;
+@end
+
+
+@implementation HWIFileDownloadCacheEntry
+
+
+- (nonnull instancetype)initWithRemoteURL:(nonnull NSURL *)aRemoteURL digest:(nonnull NSString *)aDigest fileSize:(int64_t)aFileSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.remoteURL = aRemoteURL;
+        self.digest = aDigest;
+        self.fileSize = aFileSize;
+        self.lastAccessTime = 0.0;
+        self.lastValidationTime = 0.0;
+    }
+    return self;
+}
+
+
+- (nullable instancetype)initWithIndexDictionary:(nonnull NSDictionary *)anIndexDictionary
+{
+    NSString *aRemoteURLString = [anIndexDictionary objectForKey:@"u"];
+    NSString *aDigest = [anIndexDictionary objectForKey:@"d"];
+    NSURL *aRemoteURL = aRemoteURLString ? [NSURL URLWithString:aRemoteURLString] : nil;
+    if ((aRemoteURL == nil) || (aDigest == nil))
+    {
+        return nil;
+    }
+    self = [self initWithRemoteURL:aRemoteURL digest:aDigest fileSize:[[anIndexDictionary objectForKey:@"s"] longLongValue]];
+    if (self)
+    {
+        self.eTag = [anIndexDictionary objectForKey:@"e"];
+        self.lastModified = [anIndexDictionary objectForKey:@"m"];
+        self.lastAccessTime = [[anIndexDictionary objectForKey:@"a"] doubleValue];
+        self.lastValidationTime = [[anIndexDictionary objectForKey:@"v"] doubleValue];
+    }
+    return self;
+}
+
+
+- (nonnull NSDictionary *)indexDictionary
+{
+    // short keys keep the index small
+    NSMutableDictionary *anIndexDictionary = [NSMutableDictionary dictionaryWithCapacity:7];
+    [anIndexDictionary setObject:self.remoteURL.absoluteString forKey:@"u"];
+    [anIndexDictionary setObject:self.digest forKey:@"d"];
+    [anIndexDictionary setObject:@(self.fileSize) forKey:@"s"];
+    [anIndexDictionary setObject:@(self.lastAccessTime) forKey:@"a"];
+    [anIndexDictionary setObject:@(self.lastValidationTime) forKey:@"v"];
+    if (self.eTag)
+    {
+        [anIndexDictionary setObject:self.eTag forKey:@"e"];
+    }
+    if (self.lastModified)
+    {
+        [anIndexDictionary setObject:self.lastModified forKey:@"m"];
+    }
+    return anIndexDictionary;
+}
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [[self indexDictionary] mutableCopy];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
+
+
+@interface HWIFileDownloadCache()
+@property (nonatomic, strong, readwrite, nonnull) NSURL *directoryURL;
+@property (nonatomic, strong, nonnull) dispatch_queue_t cacheDispatchQueue;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, HWIFileDownloadCacheEntry *> *entriesDictionary; // remote URL: entry
+@property (nonatomic, strong, nonnull) NSCountedSet<NSString *> *digestsCountedSet; // entries per stored file
+@property (nonatomic, assign) int64_t storedFilesSize;
+@property (nonatomic, assign) BOOL isIndexChanged;
+@property (nonatomic, assign) NSUInteger hitsCountValue;
+@property (nonatomic, assign) NSUInteger notModifiedCountValue;
+@property (nonatomic, assign) NSUInteger missesCountValue;
+@property (nonatomic, assign) int64_t savedBytesCountValue;
+@end
+
+
+@implementation HWIFileDownloadCache
+
+@synthesize maximumSize = _maximumSize;
+@synthesize maximumAge = _maximumAge;
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithDirectoryURL:(nonnull NSURL *)aDirectoryURL maximumSize:(int64_t)aMaximumSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.directoryURL = aDirectoryURL;
+        _maximumSize = aMaximumSize;
+        _maximumAge = 0.0;
+        self.cacheDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.cache", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+        self.entriesDictionary = [NSMutableDictionary dictionary];
+        self.digestsCountedSet = [NSCountedSet set];
+        self.storedFilesSize = 0;
+        self.isIndexChanged = NO;
+        self.hitsCountValue = 0;
+        self.notModifiedCountValue = 0;
+        self.missesCountValue = 0;
+        self.savedBytesCountValue = 0;
+        
+        NSError *anError = nil;
+        if ([[NSFileManager defaultManager] createDirectoryAtURL:aDirectoryURL withIntermediateDirectories:YES attributes:nil error:&anError] == NO)
+        {
+            NSLog(@"ERR: Unable to create cache directory %@: %@ (%@, %d)", aDirectoryURL, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        [aDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:NULL];
+        [self loadIndex];
+    }
+    return self;
+}
+
+
+#pragma mark - Settings
+
+
+- (void)setMaximumSize:(int64_t)aMaximumSize
+{
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        _maximumSize = aMaximumSize;
+        [self evictEntries];
+    });
+}
+
+
+- (int64_t)maximumSize
+{
+    __block int64_t aMaximumSize = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aMaximumSize = _maximumSize;
+    });
+    return aMaximumSize;
+}
+
+
+- (void)setMaximumAge:(NSTimeInterval)aMaximumAge
+{
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        _maximumAge = aMaximumAge;
+    });
+}
+
+
+- (NSTimeInterval)maximumAge
+{
+    __block NSTimeInterval aMaximumAge = 0.0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aMaximumAge = _maximumAge;
+    });
+    return aMaximumAge;
+}
+
+
+#pragma mark - Statistics
+
+
+- (int64_t)totalSize
+{
+    __block int64_t aTotalSize = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aTotalSize = self.storedFilesSize;
+    });
+    return aTotalSize;
+}
+
+
+- (NSUInteger)entriesCount
+{
+    __block NSUInteger anEntriesCount = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        anEntriesCount = self.entriesDictionary.count;
+    });
+    return anEntriesCount;
+}
+
+
+- (NSUInteger)hitsCount
+{
+    __block NSUInteger aHitsCount = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aHitsCount = self.hitsCountValue;
+    });
+    return aHitsCount;
+}
+
+
+- (NSUInteger)notModifiedCount
+{
+    __block NSUInteger aNotModifiedCount = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aNotModifiedCount = self.notModifiedCountValue;
+    });
+    return aNotModifiedCount;
+}
+
+
+- (NSUInteger)missesCount
+{
+    __block NSUInteger aMissesCount = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aMissesCount = self.missesCountValue;
+    });
+    return aMissesCount;
+}
+
+
+- (double)hitRate
+{
+    __block double aHitRate = 0.0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        NSUInteger aRequestsCount = self.hitsCountValue + self.missesCountValue;
+        if (aRequestsCount > 0)
+        {
+            aHitRate = (double)self.hitsCountValue / (double)aRequestsCount;
+        }
+    });
+    return aHitRate;
+}
+
+
+- (int64_t)savedBytesCount
+{
+    __block int64_t aSavedBytesCount = 0;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        aSavedBytesCount = self.savedBytesCountValue;
+    });
+    return aSavedBytesCount;
+}
+
+
+#pragma mark - Lookup
+
+
+- (nullable HWIFileDownloadCacheEntry *)entryForRemoteURL:(nonnull NSURL *)aRemoteURL
+{
+    __block HWIFileDownloadCacheEntry *anEntry = nil;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        anEntry = [self.entriesDictionary objectForKey:aRemoteURL.absoluteString];
+    });
+    return anEntry;
+}
+
+
+- (BOOL)isFreshEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry
+{
+    __block BOOL anIsFreshFlag = NO;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        anIsFreshFlag = (_maximumAge > 0.0) && ([NSDate timeIntervalSinceReferenceDate] - anEntry.lastValidationTime < _maximumAge);
+    });
+    return anIsFreshFlag;
+}
+
+
+- (BOOL)addConditionalHeadersForEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry toRequest:(nonnull NSMutableURLRequest *)aRequest
+{
+    __block BOOL aHasValidatorsFlag = NO;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        if (anEntry.eTag)
+        {
+            [aRequest setValue:anEntry.eTag forHTTPHeaderField:@"If-None-Match"];
+            aHasValidatorsFlag = YES;
+        }
+        if (anEntry.lastModified)
+        {
+            [aRequest setValue:anEntry.lastModified forHTTPHeaderField:@"If-Modified-Since"];
+            aHasValidatorsFlag = YES;
+        }
+    });
+    return aHasValidatorsFlag;
+}
+
+
+#pragma mark - Hits
+
+
+- (BOOL)linkEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry toFileURL:(nonnull NSURL *)aFileURL notModified:(BOOL)aNotModifiedFlag error:(NSError * _Nullable * _Nullable)anError
+{
+    __block BOOL aSuccessFlag = NO;
+    __block NSError *aLinkError = nil;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        NSURL *aStoredFileURL = [self storedFileURLForDigest:anEntry.digest];
+        aSuccessFlag = [HWIFileDownloadFileWriter linkItemAtURL:aStoredFileURL toURL:aFileURL fileSize:NULL error:&aLinkError];
+        if (aSuccessFlag)
+        {
+            NSTimeInterval aTime = [NSDate timeIntervalSinceReferenceDate];
+            anEntry.lastAccessTime = aTime;
+            if (aNotModifiedFlag)
+            {
+                anEntry.lastValidationTime = aTime;
+                self.notModifiedCountValue++;
+            }
+            self.hitsCountValue++;
+            self.savedBytesCountValue += anEntry.fileSize;
+            self.isIndexChanged = YES;
+        }
+        else
+        {
+            NSLog(@"ERR: Unable to link cached file %@ to %@: %@ (%@, %d)", aStoredFileURL, aFileURL, aLinkError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            [self removeEntry:anEntry];
+        }
+    });
+    if (anError)
+    {
+        *anError = aLinkError;
+    }
+    return aSuccessFlag;
+}
+
+
+#pragma mark - Storing
+
+
+- (nullable NSURL *)stageFileAtURL:(nonnull NSURL *)aFileURL
+{
+    NSURL *aStagedFileURL = [[self.directoryURL URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]] URLByAppendingPathExtension:HWIFileDownloadCacheStagingPathExtension];
+    NSError *aLinkError = nil;
+    if ([HWIFileDownloadFileWriter linkItemAtURL:aFileURL toURL:aStagedFileURL fileSize:NULL error:&aLinkError] == NO)
+    {
+        NSLog(@"ERR: Unable to stage file %@ for cache: %@ (%@, %d)", aFileURL, aLinkError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        aStagedFileURL = nil;
+    }
+    return aStagedFileURL;
+}
+
+
+- (nullable HWIFileDownloadCacheEntry *)storeStagedFileAtURL:(nonnull NSURL *)aStagedFileURL
+                                                      digest:(nonnull NSString *)aDigest
+                                                   remoteURL:(nonnull NSURL *)aRemoteURL
+                                                        eTag:(nullable NSString *)anETag
+                                                lastModified:(nullable NSString *)aLastModified
+{
+    __block HWIFileDownloadCacheEntry *aStoredEntry = nil;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        self.missesCountValue++;
+        int64_t aFileSize = (int64_t)[[[NSFileManager defaultManager] attributesOfItemAtPath:aStagedFileURL.path error:NULL] fileSize];
+        NSURL *aStoredFileURL = [self storedFileURLForDigest:aDigest];
+        BOOL aSuccessFlag = YES;
+        // removed first, the stored file of the same contents would be removed with the last entry of its digest
+        HWIFileDownloadCacheEntry *anExistingEntry = [self.entriesDictionary objectForKey:aRemoteURL.absoluteString];
+        if (anExistingEntry)
+        {
+            [self removeEntry:anExistingEntry];
+        }
+        if ([self.digestsCountedSet countForObject:aDigest] > 0)
+        {
+            // same contents are stored already
+            [[NSFileManager defaultManager] removeItemAtURL:aStagedFileURL error:NULL];
+        }
+        else
+        {
+            [[NSFileManager defaultManager] removeItemAtURL:aStoredFileURL error:NULL];
+            NSError *aMoveError = nil;
+            aSuccessFlag = [[NSFileManager defaultManager] moveItemAtURL:aStagedFileURL toURL:aStoredFileURL error:&aMoveError];
+            if (aSuccessFlag == NO)
+            {
+                NSLog(@"ERR: Unable to move file from %@ to %@ (%@) (%@, %d)", aStagedFileURL, aStoredFileURL, aMoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                [[NSFileManager defaultManager] removeItemAtURL:aStagedFileURL error:NULL];
+            }
+        }
+        if (aSuccessFlag)
+        {
+            aStoredEntry = [[HWIFileDownloadCacheEntry alloc] initWithRemoteURL:aRemoteURL digest:aDigest fileSize:aFileSize];
+            aStoredEntry.eTag = anETag;
+            aStoredEntry.lastModified = aLastModified;
+            aStoredEntry.lastAccessTime = [NSDate timeIntervalSinceReferenceDate];
+            aStoredEntry.lastValidationTime = aStoredEntry.lastAccessTime;
+            [self addEntry:aStoredEntry];
+            [self evictEntries];
+        }
+    });
+    return aStoredEntry;
+}
+
+
+- (void)removeEntryForRemoteURL:(nonnull NSURL *)aRemoteURL
+{
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        HWIFileDownloadCacheEntry *anEntry = [self.entriesDictionary objectForKey:aRemoteURL.absoluteString];
+        if (anEntry)
+        {
+            [self removeEntry:anEntry];
+        }
+    });
+}
+
+
+- (void)removeAllEntries
+{
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        for (HWIFileDownloadCacheEntry *anEntry in [self.entriesDictionary allValues])
+        {
+            [self removeEntry:anEntry];
+        }
+    });
+}
+
+
+#pragma mark - Index
+
+
+- (BOOL)saveIndexWithError:(NSError * _Nullable * _Nullable)anError
+{
+    __block BOOL aSuccessFlag = YES;
+    __block NSError *aSaveError = nil;
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        if (self.isIndexChanged)
+        {
+            NSMutableArray<NSDictionary *> *anEntriesArray = [NSMutableArray arrayWithCapacity:self.entriesDictionary.count];
+            for (HWIFileDownloadCacheEntry *anEntry in [self.entriesDictionary objectEnumerator])
+            {
+                [anEntriesArray addObject:[anEntry indexDictionary]];
+            }
+            NSDictionary *anIndexDictionary = @{@"version" : @(HWIFileDownloadCacheIndexVersion), @"entries" : anEntriesArray};
+            NSData *anIndexData = [NSPropertyListSerialization dataWithPropertyList:anIndexDictionary format:NSPropertyListBinaryFormat_v1_0 options:0 error:&aSaveError];
+            aSuccessFlag = anIndexData && [anIndexData writeToURL:[self.directoryURL URLByAppendingPathComponent:HWIFileDownloadCacheIndexFileName] options:NSDataWritingAtomic error:&aSaveError];
+            if (aSuccessFlag)
+            {
+                self.isIndexChanged = NO;
+            }
+            else
+            {
+                NSLog(@"ERR: Unable to save cache index: %@ (%@, %d)", aSaveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            }
+        }
+    });
+    if (anError)
+    {
+        *anError = aSaveError;
+    }
+    return aSuccessFlag;
+}
+
+
+- (void)loadIndex
+{
+    NSData *anIndexData = [NSData dataWithContentsOfURL:[self.directoryURL URLByAppendingPathComponent:HWIFileDownloadCacheIndexFileName]];
+    if (anIndexData)
+    {
+        NSDictionary *anIndexDictionary = [NSPropertyListSerialization propertyListWithData:anIndexData options:NSPropertyListImmutable format:NULL error:NULL];
+        if ([anIndexDictionary isKindOfClass:[NSDictionary class]] && ([[anIndexDictionary objectForKey:@"version"] integerValue] == HWIFileDownloadCacheIndexVersion))
+        {
+            for (NSDictionary *anEntryDictionary in [anIndexDictionary objectForKey:@"entries"])
+            {
+                HWIFileDownloadCacheEntry *anEntry = [[HWIFileDownloadCacheEntry alloc] initWithIndexDictionary:anEntryDictionary];
+                if (anEntry)
+                {
+                    [self addEntry:anEntry];
+                }
+            }
+            // files are checked lazily on use; a missing file removes its entry
+            self.isIndexChanged = NO;
+        }
+        else
+        {
+            NSLog(@"ERR: Invalid cache index in %@ (%@, %d)", self.directoryURL, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+    }
+    // staged files of an interrupted run are not referenced
+    NSArray<NSURL *> *aFileURLsArray = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:self.directoryURL includingPropertiesForKeys:nil options:0 error:NULL];
+    for (NSURL *aFileURL in aFileURLsArray)
+    {
+        if ([aFileURL.pathExtension isEqualToString:HWIFileDownloadCacheStagingPathExtension])
+        {
+            [[NSFileManager defaultManager] removeItemAtURL:aFileURL error:NULL];
+        }
+    }
+}
+
+
+#pragma mark - Utilities
+
+
+- (void)addEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry
+{
+    // called on cacheDispatchQueue
+    [self.entriesDictionary setObject:anEntry forKey:anEntry.remoteURL.absoluteString];
+    if ([self.digestsCountedSet countForObject:anEntry.digest] == 0)
+    {
+        self.storedFilesSize += anEntry.fileSize;
+    }
+    [self.digestsCountedSet addObject:anEntry.digest];
+    self.isIndexChanged = YES;
+}
+
+
+- (void)removeEntry:(nonnull HWIFileDownloadCacheEntry *)anEntry
+{
+    // called on cacheDispatchQueue
+    [self.entriesDictionary removeObjectForKey:anEntry.remoteURL.absoluteString];
+    [self.digestsCountedSet removeObject:anEntry.digest];
+    if ([self.digestsCountedSet countForObject:anEntry.digest] == 0)
+    {
+        self.storedFilesSize -= anEntry.fileSize;
+        [[NSFileManager defaultManager] removeItemAtURL:[self storedFileURLForDigest:anEntry.digest] error:NULL];
+    }
+    self.isIndexChanged = YES;
+}
+
+
+- (void)evictEntries
+{
+    // called on cacheDispatchQueue
+    if (self.storedFilesSize > _maximumSize)
+    {
+        NSArray<HWIFileDownloadCacheEntry *> *anEntriesArray = [[self.entriesDictionary allValues] sortedArrayUsingComparator:^NSComparisonResult(HWIFileDownloadCacheEntry *anEntry, HWIFileDownloadCacheEntry *anotherEntry) {
+            return [@(anEntry.lastAccessTime) compare:@(anotherEntry.lastAccessTime)];
+        }];
+        for (HWIFileDownloadCacheEntry *anEntry in anEntriesArray)
+        {
+            if (self.storedFilesSize <= _maximumSize)
+            {
+                break;
+            }
+            [self removeEntry:anEntry];
+        }
+    }
+}
+
+
+- (nonnull NSURL *)storedFileURLForDigest:(nonnull NSString *)aDigest
+{
+    return [self.directoryURL URLByAppendingPathComponent:aDigest isDirectory:NO];
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    dispatch_sync(self.cacheDispatchQueue, ^{
+        [aDescriptionDict setObject:self.directoryURL forKey:@"directoryURL"];
+        [aDescriptionDict setObject:@(_maximumSize) forKey:@"maximumSize"];
+        [aDescriptionDict setObject:@(_maximumAge) forKey:@"maximumAge"];
+        [aDescriptionDict setObject:@(self.storedFilesSize) forKey:@"totalSize"];
+        [aDescriptionDict setObject:@(self.entriesDictionary.count) forKey:@"entriesCount"];
+        [aDescriptionDict setObject:@(self.hitsCountValue) forKey:@"hitsCount"];
+        [aDescriptionDict setObject:@(self.notModifiedCountValue) forKey:@"notModifiedCount"];
+        [aDescriptionDict setObject:@(self.missesCountValue) forKey:@"missesCount"];
+        [aDescriptionDict setObject:@(self.savedBytesCountValue) forKey:@"savedBytesCount"];
+    });
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,95 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadConcurrencyController.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadConcurrencyController tunes the number of concurrent downloads from the observed throughput and latency. It is used internally by HWIFileDownloader.
+ @discussion Additive increase, multiplicative decrease: while downloads are waiting the window grows by one per evaluation interval; it shrinks by a quarter when the time to first byte rises far above the lowest one observed or the throughput drops noticeably. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadConcurrencyController : NSObject
+
+/**
+ Designated initializer.
+ @param aMinimumWindow Lowest number of concurrent downloads (at least 1).
+ @param aMaximumWindow Highest number of concurrent downloads.
+ @return HWIFileDownloadConcurrencyController starting with the minimum window.
+ */
+- (nonnull instancetype)initWithMinimumWindow:(NSUInteger)aMinimumWindow maximumWindow:(NSUInteger)aMaximumWindow;
+- (nonnull HWIFileDownloadConcurrencyController *)init __attribute__((unavailable("use initWithMinimumWindow:maximumWindow:")));
++ (nonnull HWIFileDownloadConcurrencyController *)new __attribute__((unavailable("use initWithMinimumWindow:maximumWindow:")));
+
+/**
+ Current number of concurrent downloads.
+ */
+@property (nonatomic, assign, readonly) NSUInteger window;
+
+/**
+ Lowest number of concurrent downloads.
+ */
+@property (nonatomic, assign, readonly) NSUInteger minimumWindow;
+
+/**
+ Highest number of concurrent downloads.
+ */
+@property (nonatomic, assign, readonly) NSUInteger maximumWindow;
+
+/**
+ Minimum time between two evaluations in seconds. Default: 2.0.
+ */
+@property (nonatomic, assign) NSTimeInterval evaluationInterval;
+
+/**
+ Recent decisions, oldest first, each with the keys time (time interval since reference date), window, previousWindow, bytesPerSecondSpeed, latency (seconds, 0 without samples) and reason (increase, hold, latency, throughput).
+ */
+@property (nonatomic, strong, readonly, nonnull) NSArray<NSDictionary<NSString *, id> *> *decisionsLog;
+
+/**
+ Records the time from starting a request until receiving its first byte.
+ @param aLatency Latency in seconds.
+ */
+- (void)addLatency:(NSTimeInterval)aLatency;
+
+/**
+ Adjusts the window if the evaluation interval has passed.
+ @param aBytesPerSecondSpeed Throughput of all downloads together.
+ @param aHasWaitingDownloadsFlag Flag whether downloads are waiting for a free slot; the window is not changed without.
+ @param aTime Current time (time interval since reference date).
+ @return YES if the window has been changed.
+ */
+- (BOOL)evaluateWithBytesPerSecondSpeed:(double)aBytesPerSecondSpeed hasWaitingDownloads:(BOOL)aHasWaitingDownloadsFlag atTime:(NSTimeInterval)aTime;
+
+@end
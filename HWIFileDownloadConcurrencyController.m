@@ -0,0 +1,185 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadConcurrencyController.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadConcurrencyController.h"
+
+
+static const double HWIFileDownloadConcurrencyControllerDecreaseFactor = 0.75;
+static const double HWIFileDownloadConcurrencyControllerLatencyTolerance = 2.0; // multiple of the lowest latency observed
+static const double HWIFileDownloadConcurrencyControllerThroughputTolerance = 0.9; // fraction of the throughput of the previous interval
+static const NSUInteger HWIFileDownloadConcurrencyControllerDecisionsLogCapacity = 64;
+
+
+@interface HWIFileDownloadConcurrencyController()
+@property (nonatomic, assign, readwrite) NSUInteger window;
+@property (nonatomic, assign, readwrite) NSUInteger minimumWindow;
+@property (nonatomic, assign, readwrite) NSUInteger maximumWindow;
+@property (nonatomic, strong, nonnull) NSMutableArray<NSDictionary<NSString *, id> *> *decisionsLogArray;
+@property (nonatomic, assign) NSTimeInterval lastEvaluationTime;
+@property (nonatomic, assign) double previousBytesPerSecondSpeed;
+@property (nonatomic, assign) NSTimeInterval latencySum;
+@property (nonatomic, assign) NSUInteger latencySamplesCount;
+@property (nonatomic, assign) NSTimeInterval lowestLatency;
+@end
+
+
+@implementation HWIFileDownloadConcurrencyController
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithMinimumWindow:(NSUInteger)aMinimumWindow maximumWindow:(NSUInteger)aMaximumWindow
+{
+    self = [super init];
+    if (self)
+    {
+        self.minimumWindow = MAX(aMinimumWindow, (NSUInteger)1);
+        self.maximumWindow = MAX(aMaximumWindow, self.minimumWindow);
+        self.window = self.minimumWindow;
+        self.evaluationInterval = 2.0;
+        self.decisionsLogArray = [NSMutableArray array];
+        self.lastEvaluationTime = 0.0;
+        self.previousBytesPerSecondSpeed = 0.0;
+        self.latencySum = 0.0;
+        self.latencySamplesCount = 0;
+        self.lowestLatency = 0.0;
+    }
+    return self;
+}
+
+
+#pragma mark - Evaluation
+
+
+- (nonnull NSArray<NSDictionary<NSString *, id> *> *)decisionsLog
+{
+    return [self.decisionsLogArray copy];
+}
+
+
+- (void)addLatency:(NSTimeInterval)aLatency
+{
+    if (aLatency > 0.0)
+    {
+        self.latencySum += aLatency;
+        self.latencySamplesCount++;
+        if ((self.lowestLatency <= 0.0) || (aLatency < self.lowestLatency))
+        {
+            self.lowestLatency = aLatency;
+        }
+    }
+}
+
+
+- (BOOL)evaluateWithBytesPerSecondSpeed:(double)aBytesPerSecondSpeed hasWaitingDownloads:(BOOL)aHasWaitingDownloadsFlag atTime:(NSTimeInterval)aTime
+{
+    if (self.lastEvaluationTime <= 0.0)
+    {
+        // the first interval starts now
+        self.lastEvaluationTime = aTime;
+        return NO;
+    }
+    if (aTime - self.lastEvaluationTime < self.evaluationInterval)
+    {
+        return NO;
+    }
+    
+    NSTimeInterval aLatency = (self.latencySamplesCount > 0) ? (self.latencySum / self.latencySamplesCount) : 0.0;
+    double aPreviousBytesPerSecondSpeed = self.previousBytesPerSecondSpeed;
+    self.lastEvaluationTime = aTime;
+    self.previousBytesPerSecondSpeed = aBytesPerSecondSpeed;
+    self.latencySum = 0.0;
+    self.latencySamplesCount = 0;
+    if (aHasWaitingDownloadsFlag == NO)
+    {
+        // the window is not the limit, nothing to learn
+        return NO;
+    }
+    
+    NSUInteger aPreviousWindow = self.window;
+    NSString *aReason = nil;
+    if ((aLatency > 0.0) && (aLatency > self.lowestLatency * HWIFileDownloadConcurrencyControllerLatencyTolerance))
+    {
+        aReason = @"latency";
+        self.window = MAX(self.minimumWindow, (NSUInteger)floor(self.window * HWIFileDownloadConcurrencyControllerDecreaseFactor));
+    }
+    else if ((aPreviousBytesPerSecondSpeed > 0.0) && (aBytesPerSecondSpeed < aPreviousBytesPerSecondSpeed * HWIFileDownloadConcurrencyControllerThroughputTolerance))
+    {
+        aReason = @"throughput";
+        self.window = MAX(self.minimumWindow, (NSUInteger)floor(self.window * HWIFileDownloadConcurrencyControllerDecreaseFactor));
+    }
+    else if (self.window < self.maximumWindow)
+    {
+        aReason = @"increase";
+        self.window++;
+    }
+    else
+    {
+        aReason = @"hold";
+    }
+    
+    [self.decisionsLogArray addObject:@{@"time" : @(aTime),
+                                        @"window" : @(self.window),
+                                        @"previousWindow" : @(aPreviousWindow),
+                                        @"bytesPerSecondSpeed" : @(aBytesPerSecondSpeed),
+                                        @"latency" : @(aLatency),
+                                        @"reason" : aReason}];
+    if (self.decisionsLogArray.count > HWIFileDownloadConcurrencyControllerDecisionsLogCapacity)
+    {
+        [self.decisionsLogArray removeObjectAtIndex:0];
+    }
+    
+    return (self.window != aPreviousWindow);
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.window) forKey:@"window"];
+    [aDescriptionDict setObject:@(self.minimumWindow) forKey:@"minimumWindow"];
+    [aDescriptionDict setObject:@(self.maximumWindow) forKey:@"maximumWindow"];
+    [aDescriptionDict setObject:@(self.lowestLatency) forKey:@"lowestLatency"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,122 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadDeduplicator.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadDeduplicator keeps track of downloads attached to a running or waiting download of the same remote URL. It is used internally by HWIFileDownloader.
+ @discussion The download that fetches the remote URL is the primary download. Downloads started later for the same remote URL are attached to it and get a link to its file on completion. A cancelled primary download with attached downloads is detached: its transfer continues for the attached downloads without informing the primary download identifier. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadDeduplicator : NSObject
+
+/**
+ Number of downloads attached to another download (requests not sent).
+ */
+@property (nonatomic, assign, readonly) NSUInteger savedRequestsCount;
+
+/**
+ Number of bytes of files linked for attached downloads (bytes not downloaded).
+ */
+@property (nonatomic, assign, readonly) int64_t savedBytesCount;
+
+/**
+ Primary download of a remote URL.
+ @param aRemoteURL Remote URL.
+ @return Download token of the primary download or nil.
+ */
+- (nullable NSString *)primaryDownloadTokenForRemoteURL:(nonnull NSURL *)aRemoteURL;
+
+/**
+ Registers the primary download of a remote URL.
+ @param aDownloadToken Download token.
+ @param aRemoteURL Remote URL.
+ */
+- (void)registerPrimaryDownloadToken:(nonnull NSString *)aDownloadToken forRemoteURL:(nonnull NSURL *)aRemoteURL;
+
+/**
+ Attaches a download to a primary download.
+ @param aDownloadToken Download token of the attached download.
+ @param aPrimaryDownloadToken Download token of the primary download.
+ */
+- (void)attachDownloadToken:(nonnull NSString *)aDownloadToken toPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken;
+
+/**
+ Primary download of an attached download.
+ @param aDownloadToken Download token of the attached download.
+ @return Download token of the primary download or nil if the download is not attached.
+ */
+- (nullable NSString *)primaryDownloadTokenForAttachedDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Attached downloads of a primary download.
+ @param aPrimaryDownloadToken Download token of the primary download.
+ @return Download tokens of the attached downloads (might be empty).
+ */
+- (nonnull NSArray<NSString *> *)attachedDownloadTokensForPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken;
+
+/**
+ Detaches an attached download from its primary download.
+ @param aDownloadToken Download token of the attached download.
+ */
+- (void)detachDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Marks a primary download as detached. Its transfer is continued for the attached downloads only.
+ @param aPrimaryDownloadToken Download token of the primary download.
+ */
+- (void)detachPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken;
+
+/**
+ Answers the question whether a primary download has been detached.
+ @param aPrimaryDownloadToken Download token of the primary download.
+ @return YES if detached, NO otherwise.
+ */
+- (BOOL)isDetachedPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken;
+
+/**
+ Removes a finished primary download.
+ @param aPrimaryDownloadToken Download token of the primary download.
+ @return Download tokens of the attached downloads (might be empty).
+ */
+- (nonnull NSArray<NSString *> *)removePrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken;
+
+/**
+ Counts bytes of a file linked for an attached download.
+ @param aBytesCount Number of bytes.
+ */
+- (void)addSavedBytesCount:(int64_t)aBytesCount;
+
+@end
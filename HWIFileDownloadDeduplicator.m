@@ -0,0 +1,191 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadDeduplicator.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadDeduplicator.h"
+
+
+@interface HWIFileDownloadDeduplicator()
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSString *> *primaryDownloadTokensDictionary; // remote URL: primary download token
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSString *> *remoteURLsDictionary; // primary download token: remote URL
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *attachedDownloadTokensDictionary; // primary download token: attached download tokens
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSString *> *attachmentsDictionary; // attached download token: primary download token
+@property (nonatomic, strong, nonnull) NSMutableSet<NSString *> *detachedPrimaryDownloadTokensSet;
+@property (nonatomic, assign, readwrite) NSUInteger savedRequestsCount;
+@property (nonatomic, assign, readwrite) int64_t savedBytesCount;
+@end
+
+
+@implementation HWIFileDownloadDeduplicator
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.primaryDownloadTokensDictionary = [NSMutableDictionary dictionary];
+        self.remoteURLsDictionary = [NSMutableDictionary dictionary];
+        self.attachedDownloadTokensDictionary = [NSMutableDictionary dictionary];
+        self.attachmentsDictionary = [NSMutableDictionary dictionary];
+        self.detachedPrimaryDownloadTokensSet = [NSMutableSet set];
+        self.savedRequestsCount = 0;
+        self.savedBytesCount = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Primary Downloads
+
+
+- (nullable NSString *)primaryDownloadTokenForRemoteURL:(nonnull NSURL *)aRemoteURL
+{
+    return [self.primaryDownloadTokensDictionary objectForKey:aRemoteURL.absoluteString];
+}
+
+
+- (void)registerPrimaryDownloadToken:(nonnull NSString *)aDownloadToken forRemoteURL:(nonnull NSURL *)aRemoteURL
+{
+    [self.primaryDownloadTokensDictionary setObject:aDownloadToken forKey:aRemoteURL.absoluteString];
+    [self.remoteURLsDictionary setObject:aRemoteURL.absoluteString forKey:aDownloadToken];
+}
+
+
+- (void)detachPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    [self.detachedPrimaryDownloadTokensSet addObject:aPrimaryDownloadToken];
+}
+
+
+- (BOOL)isDetachedPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    return [self.detachedPrimaryDownloadTokensSet containsObject:aPrimaryDownloadToken];
+}
+
+
+- (nonnull NSArray<NSString *> *)removePrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    NSString *aRemoteURLString = [self.remoteURLsDictionary objectForKey:aPrimaryDownloadToken];
+    if (aRemoteURLString && [[self.primaryDownloadTokensDictionary objectForKey:aRemoteURLString] isEqualToString:aPrimaryDownloadToken])
+    {
+        [self.primaryDownloadTokensDictionary removeObjectForKey:aRemoteURLString];
+    }
+    [self.remoteURLsDictionary removeObjectForKey:aPrimaryDownloadToken];
+    [self.detachedPrimaryDownloadTokensSet removeObject:aPrimaryDownloadToken];
+    NSArray<NSString *> *anAttachedDownloadTokensArray = [self attachedDownloadTokensForPrimaryDownloadToken:aPrimaryDownloadToken];
+    for (NSString *anAttachedDownloadToken in anAttachedDownloadTokensArray)
+    {
+        [self.attachmentsDictionary removeObjectForKey:anAttachedDownloadToken];
+    }
+    [self.attachedDownloadTokensDictionary removeObjectForKey:aPrimaryDownloadToken];
+    return anAttachedDownloadTokensArray;
+}
+
+
+#pragma mark - Attached Downloads
+
+
+- (void)attachDownloadToken:(nonnull NSString *)aDownloadToken toPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    NSMutableArray<NSString *> *anAttachedDownloadTokensArray = [self.attachedDownloadTokensDictionary objectForKey:aPrimaryDownloadToken];
+    if (anAttachedDownloadTokensArray == nil)
+    {
+        anAttachedDownloadTokensArray = [NSMutableArray array];
+        [self.attachedDownloadTokensDictionary setObject:anAttachedDownloadTokensArray forKey:aPrimaryDownloadToken];
+    }
+    if ([anAttachedDownloadTokensArray containsObject:aDownloadToken] == NO)
+    {
+        [anAttachedDownloadTokensArray addObject:aDownloadToken];
+        [self.attachmentsDictionary setObject:aPrimaryDownloadToken forKey:aDownloadToken];
+        self.savedRequestsCount++;
+    }
+}
+
+
+- (nullable NSString *)primaryDownloadTokenForAttachedDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    return [self.attachmentsDictionary objectForKey:aDownloadToken];
+}
+
+
+- (nonnull NSArray<NSString *> *)attachedDownloadTokensForPrimaryDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    NSArray<NSString *> *anAttachedDownloadTokensArray = [[self.attachedDownloadTokensDictionary objectForKey:aPrimaryDownloadToken] copy];
+    if (anAttachedDownloadTokensArray == nil)
+    {
+        anAttachedDownloadTokensArray = @[];
+    }
+    return anAttachedDownloadTokensArray;
+}
+
+
+- (void)detachDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    NSString *aPrimaryDownloadToken = [self.attachmentsDictionary objectForKey:aDownloadToken];
+    if (aPrimaryDownloadToken)
+    {
+        [[self.attachedDownloadTokensDictionary objectForKey:aPrimaryDownloadToken] removeObject:aDownloadToken];
+        [self.attachmentsDictionary removeObjectForKey:aDownloadToken];
+    }
+}
+
+
+- (void)addSavedBytesCount:(int64_t)aBytesCount
+{
+    self.savedBytesCount += aBytesCount;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.primaryDownloadTokensDictionary forKey:@"primaryDownloadTokensDictionary"];
+    [aDescriptionDict setObject:self.attachedDownloadTokensDictionary forKey:@"attachedDownloadTokensDictionary"];
+    [aDescriptionDict setObject:self.detachedPrimaryDownloadTokensSet forKey:@"detachedPrimaryDownloadTokensSet"];
+    [aDescriptionDict setObject:@(self.savedRequestsCount) forKey:@"savedRequestsCount"];
+    [aDescriptionDict setObject:@(self.savedBytesCount) forKey:@"savedBytesCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
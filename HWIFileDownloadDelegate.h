@@ -37,6 +37,8 @@
 
 
 @class NSURLSessionConfiguration;
+@class HWIFileDownloadProgress;
+@class HWIFileDownloadMetrics;
 
 
 /**
@@ -90,11 +92,43 @@
 - (void)downloadProgressChangedForIdentifier:(nonnull NSString *)identifier;
 
 
+/**
+ Optionally called with the coalesced progress changes of several download items.
+ @param downloadProgresses Download progress snapshots by download identifier of the download items changed since the last call.
+ @discussion Called instead of downloadProgressChangedForIdentifier: if a maximum progress delivery rate is set on the HWIFileDownloader.
+ */
+- (void)downloadProgressChangedForIdentifiers:(nonnull NSDictionary<NSString *, HWIFileDownloadProgress *> *)downloadProgresses;
+
+
+/**
+ Optionally called on successful download of a streamed download item without local file (see persistsStreamedData of HWIFileDownloadOptions).
+ @param identifier Download identifier of the download item.
+ */
+- (void)streamedDownloadDidCompleteWithIdentifier:(nonnull NSString *)identifier;
+
+
+/**
+ Optionally called on successful download of a decoded download item (see transformKind of HWIFileDownloadOptions) before downloadDidCompleteWithIdentifier:localFileURL:.
+ @param identifier Download identifier of the download item.
+ @param fileURLs Local file URLs of the extracted files of a zip archive, the local file URL of the inflated file otherwise.
+ */
+- (void)downloadDidExtractFilesWithIdentifier:(nonnull NSString *)identifier fileURLs:(nonnull NSArray<NSURL *> *)fileURLs;
+
+
+/**
+ Optionally called with the timing metrics of a download right before its completion or failure is notified.
+ @param identifier Download identifier of the download item.
+ @param metrics Timing phases of the download.
+ */
+- (void)downloadMetricsCollectedWithIdentifier:(nonnull NSString *)identifier
+                                       metrics:(nonnull HWIFileDownloadMetrics *)metrics;
+
+
 /**
  Optionally called on a paused download.
  @param identifier Download identifier of the download item.
  @param resumeData Incompletely downloaded data that can be reused later if the download is started again.
- @discussion Since iOS 9 resume data is managed by the system. For iOS 7 and iOS 8 resume data is passed with the parameter.
+ @discussion Since iOS 9 resume data is managed by the system. For iOS 7 and iOS 8 resume data is passed with the parameter. Resume data of a segmented download (the received ranges of its preallocated file) is always passed.
  */
 - (void)downloadPausedWithIdentifier:(nonnull NSString *)identifier
                           resumeData:(nullable NSData *)resumeData;
@@ -125,6 +159,7 @@
  @param downloadIdentifier Download identifier of the download item.
  @return True if downloaded data in local file passed validation test.
  @discussion The download might finish successfully with an error explanation string as downloaded data. This method can be used to check whether the downloaded data is the expected content and data type. If not implemented, every download is valid.
+ Called on all transports after the file has been moved to its local file URL, after digest verification and after decompression (see HWIFileDownloadOptions transformKind): a decoded download passes the decoded file, or the directory of the extracted files of a zip archive. An invalid download fails with NSURLErrorCannotDecodeRawData.
  */
 - (BOOL)downloadAtLocalFileURL:(nonnull NSURL *)localFileURL isValidForDownloadIdentifier:(nonnull NSString *)downloadIdentifier;
 
@@ -0,0 +1,122 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadDigest.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadDigestAlgorithm determines the checksum used for verifying a downloaded file.
+ */
+typedef NS_ENUM(NSInteger, HWIFileDownloadDigestAlgorithm) {
+    HWIFileDownloadDigestAlgorithmNone = 0,
+    HWIFileDownloadDigestAlgorithmSHA256, // 32 bytes
+    HWIFileDownloadDigestAlgorithmCRC32C // 4 bytes, big endian
+};
+
+
+/**
+ HWIFileDownloadDigest computes the digest of downloaded data incrementally. It is used internally by HWIFileDownloader.
+ @discussion All methods of an instance need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadDigest : NSObject
+
+/**
+ Designated initializer.
+ @param anAlgorithm Digest algorithm.
+ @return Digest.
+ */
+- (nonnull instancetype)initWithAlgorithm:(HWIFileDownloadDigestAlgorithm)anAlgorithm;
+- (nonnull HWIFileDownloadDigest *)init __attribute__((unavailable("use initWithAlgorithm:")));
++ (nonnull HWIFileDownloadDigest *)new __attribute__((unavailable("use initWithAlgorithm:")));
+
+/**
+ Digest algorithm.
+ */
+@property (nonatomic, assign, readonly) HWIFileDownloadDigestAlgorithm algorithm;
+
+/**
+ Number of bytes added to the digest.
+ */
+@property (nonatomic, assign, readonly) int64_t processedBytesCount;
+
+/**
+ Adds bytes to the digest.
+ @param aBytes Bytes to add.
+ @param aLength Number of bytes.
+ */
+- (void)updateWithBytes:(nonnull const void *)aBytes length:(size_t)aLength;
+
+/**
+ Adds data to the digest.
+ @param aData Data to add.
+ */
+- (void)updateWithData:(nonnull NSData *)aData;
+
+/**
+ Finishes the computation. Further updates are ignored.
+ @return Digest of all added bytes.
+ */
+- (nonnull NSData *)finalDigest;
+
+
+/**
+ Computes the digest of a file in one pass, reading it in chunks of 1 MB.
+ @param aFileURL Local file URL of the file.
+ @param anAlgorithm Digest algorithm.
+ @param anError Error on failure.
+ @return Digest or nil on failure.
+ */
++ (nullable NSData *)digestOfFileAtURL:(nonnull NSURL *)aFileURL algorithm:(HWIFileDownloadDigestAlgorithm)anAlgorithm error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Converts a hex string (e.g. as published next to a download) to digest data.
+ @param aHexString String of hex digits.
+ @return Digest or nil if the string is not a valid hex string.
+ */
++ (nullable NSData *)digestWithHexString:(nonnull NSString *)aHexString;
+
+/**
+ Converts digest data to a lowercase hex string.
+ @param aDigest Digest data.
+ @return Hex string.
+ */
++ (nonnull NSString *)hexStringWithDigest:(nonnull NSData *)aDigest;
+
+/**
+ YES if CRC32C is computed with CPU instructions, NO if it is computed with lookup tables.
+ */
++ (BOOL)isCRC32CHardwareAccelerated;
+
+@end
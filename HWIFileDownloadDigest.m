@@ -0,0 +1,347 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadDigest.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadDigest.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define HWI_FILE_DOWNLOAD_CRC32C_HARDWARE 1
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define HWI_FILE_DOWNLOAD_CRC32C_HARDWARE 1
+#else
+#define HWI_FILE_DOWNLOAD_CRC32C_HARDWARE 0
+#endif
+
+
+// CC_SHA256_Update takes a 32 bit length
+static const size_t HWIFileDownloadDigestMaxUpdateLength = 1024 * 1024 * 1024;
+static const NSUInteger HWIFileDownloadDigestReadBufferSize = 1024 * 1024;
+
+
+#if !HWI_FILE_DOWNLOAD_CRC32C_HARDWARE
+static uint32_t HWIFileDownloadCRC32CTable[8][256];
+
+
+static void HWIFileDownloadCRC32CTableSetup(void)
+{
+    // reflected Castagnoli polynomial
+    for (uint32_t anIndex = 0; anIndex < 256; anIndex++)
+    {
+        uint32_t aCRC = anIndex;
+        for (int aBit = 0; aBit < 8; aBit++)
+        {
+            aCRC = (aCRC & 1) ? ((aCRC >> 1) ^ 0x82F63B78) : (aCRC >> 1);
+        }
+        HWIFileDownloadCRC32CTable[0][anIndex] = aCRC;
+    }
+    for (uint32_t anIndex = 0; anIndex < 256; anIndex++)
+    {
+        for (int aSlice = 1; aSlice < 8; aSlice++)
+        {
+            uint32_t aPreviousCRC = HWIFileDownloadCRC32CTable[aSlice - 1][anIndex];
+            HWIFileDownloadCRC32CTable[aSlice][anIndex] = (aPreviousCRC >> 8) ^ HWIFileDownloadCRC32CTable[0][aPreviousCRC & 0xFF];
+        }
+    }
+}
+#endif
+
+
+static uint32_t HWIFileDownloadCRC32CUpdate(uint32_t aCRC, const uint8_t *aBytes, size_t aLength)
+{
+#if HWI_FILE_DOWNLOAD_CRC32C_HARDWARE
+    while ((aLength > 0) && (((uintptr_t)aBytes & 7) != 0))
+    {
+#if defined(__ARM_FEATURE_CRC32)
+        aCRC = __crc32cb(aCRC, *aBytes);
+#else
+        aCRC = _mm_crc32_u8(aCRC, *aBytes);
+#endif
+        aBytes++;
+        aLength--;
+    }
+    while (aLength >= 8)
+    {
+        uint64_t aWord;
+        memcpy(&aWord, aBytes, 8);
+#if defined(__ARM_FEATURE_CRC32)
+        aCRC = __crc32cd(aCRC, aWord);
+#else
+        aCRC = (uint32_t)_mm_crc32_u64(aCRC, aWord);
+#endif
+        aBytes += 8;
+        aLength -= 8;
+    }
+    while (aLength > 0)
+    {
+#if defined(__ARM_FEATURE_CRC32)
+        aCRC = __crc32cb(aCRC, *aBytes);
+#else
+        aCRC = _mm_crc32_u8(aCRC, *aBytes);
+#endif
+        aBytes++;
+        aLength--;
+    }
+#else
+    static dispatch_once_t aTableSetupOnceToken;
+    dispatch_once(&aTableSetupOnceToken, ^{
+        HWIFileDownloadCRC32CTableSetup();
+    });
+    // slicing by 8; little endian byte order is assumed (arm and x86)
+    while (aLength >= 8)
+    {
+        uint32_t aLow;
+        uint32_t aHigh;
+        memcpy(&aLow, aBytes, 4);
+        memcpy(&aHigh, aBytes + 4, 4);
+        aLow ^= aCRC;
+        aCRC = HWIFileDownloadCRC32CTable[7][aLow & 0xFF] ^
+               HWIFileDownloadCRC32CTable[6][(aLow >> 8) & 0xFF] ^
+               HWIFileDownloadCRC32CTable[5][(aLow >> 16) & 0xFF] ^
+               HWIFileDownloadCRC32CTable[4][aLow >> 24] ^
+               HWIFileDownloadCRC32CTable[3][aHigh & 0xFF] ^
+               HWIFileDownloadCRC32CTable[2][(aHigh >> 8) & 0xFF] ^
+               HWIFileDownloadCRC32CTable[1][(aHigh >> 16) & 0xFF] ^
+               HWIFileDownloadCRC32CTable[0][aHigh >> 24];
+        aBytes += 8;
+        aLength -= 8;
+    }
+    while (aLength > 0)
+    {
+        aCRC = (aCRC >> 8) ^ HWIFileDownloadCRC32CTable[0][(aCRC ^ *aBytes) & 0xFF];
+        aBytes++;
+        aLength--;
+    }
+#endif
+    return aCRC;
+}
+
+
+@interface HWIFileDownloadDigest()
+{
+    CC_SHA256_CTX _sha256Context;
+    uint32_t _crc32c;
+}
+@property (nonatomic, assign, readwrite) HWIFileDownloadDigestAlgorithm algorithm;
+@property (nonatomic, assign, readwrite) int64_t processedBytesCount;
+@property (nonatomic, strong, nullable) NSData *computedDigest;
+@end
+
+
+@implementation HWIFileDownloadDigest
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithAlgorithm:(HWIFileDownloadDigestAlgorithm)anAlgorithm
+{
+    self = [super init];
+    if (self)
+    {
+        self.algorithm = anAlgorithm;
+        self.processedBytesCount = 0;
+        CC_SHA256_Init(&_sha256Context);
+        _crc32c = 0xFFFFFFFF;
+    }
+    return self;
+}
+
+
+#pragma mark - Digest
+
+
+- (void)updateWithBytes:(nonnull const void *)aBytes length:(size_t)aLength
+{
+    if (self.computedDigest == nil)
+    {
+        self.processedBytesCount += aLength;
+        switch (self.algorithm)
+        {
+            case HWIFileDownloadDigestAlgorithmSHA256:
+            {
+                const uint8_t *aRemainingBytes = aBytes;
+                while (aLength > 0)
+                {
+                    size_t anUpdateLength = MIN(aLength, HWIFileDownloadDigestMaxUpdateLength);
+                    CC_SHA256_Update(&_sha256Context, aRemainingBytes, (CC_LONG)anUpdateLength);
+                    aRemainingBytes += anUpdateLength;
+                    aLength -= anUpdateLength;
+                }
+                break;
+            }
+            case HWIFileDownloadDigestAlgorithmCRC32C:
+                _crc32c = HWIFileDownloadCRC32CUpdate(_crc32c, aBytes, aLength);
+                break;
+            case HWIFileDownloadDigestAlgorithmNone:
+                break;
+        }
+    }
+}
+
+
+- (void)updateWithData:(nonnull NSData *)aData
+{
+    [aData enumerateByteRangesUsingBlock:^(const void *aBytes, NSRange aByteRange, BOOL *aStopFlag) {
+        [self updateWithBytes:aBytes length:aByteRange.length];
+    }];
+}
+
+
+- (nonnull NSData *)finalDigest
+{
+    if (self.computedDigest == nil)
+    {
+        switch (self.algorithm)
+        {
+            case HWIFileDownloadDigestAlgorithmSHA256:
+            {
+                uint8_t aDigestBytes[CC_SHA256_DIGEST_LENGTH];
+                CC_SHA256_Final(aDigestBytes, &_sha256Context);
+                self.computedDigest = [NSData dataWithBytes:aDigestBytes length:CC_SHA256_DIGEST_LENGTH];
+                break;
+            }
+            case HWIFileDownloadDigestAlgorithmCRC32C:
+            {
+                uint32_t aBigEndianCRC = CFSwapInt32HostToBig(_crc32c ^ 0xFFFFFFFF);
+                self.computedDigest = [NSData dataWithBytes:&aBigEndianCRC length:sizeof(aBigEndianCRC)];
+                break;
+            }
+            case HWIFileDownloadDigestAlgorithmNone:
+                self.computedDigest = [NSData data];
+                break;
+        }
+    }
+    return self.computedDigest;
+}
+
+
+#pragma mark - Utilities
+
+
++ (nullable NSData *)digestOfFileAtURL:(nonnull NSURL *)aFileURL algorithm:(HWIFileDownloadDigestAlgorithm)anAlgorithm error:(NSError * _Nullable * _Nullable)anError
+{
+    // read in chunks, a mapped file of several GB does not fit into the address space of 32 bit devices
+    NSData *aDigest = nil;
+    HWIFileDownloadDigest *aFileDigest = [[HWIFileDownloadDigest alloc] initWithAlgorithm:anAlgorithm];
+    NSInputStream *anInputStream = [NSInputStream inputStreamWithURL:aFileURL];
+    [anInputStream open];
+    NSMutableData *aReadBuffer = [NSMutableData dataWithLength:HWIFileDownloadDigestReadBufferSize];
+    NSInteger aReadLength = 0;
+    while ((aReadLength = [anInputStream read:aReadBuffer.mutableBytes maxLength:aReadBuffer.length]) > 0)
+    {
+        [aFileDigest updateWithData:[NSData dataWithBytesNoCopy:aReadBuffer.mutableBytes length:(NSUInteger)aReadLength freeWhenDone:NO]];
+    }
+    if (aReadLength == 0)
+    {
+        aDigest = [aFileDigest finalDigest];
+    }
+    else
+    {
+        if (anError)
+        {
+            *anError = anInputStream.streamError;
+        }
+        NSLog(@"ERR: Unable to read file %@: %@ (%@, %d)", aFileURL, anInputStream.streamError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    [anInputStream close];
+    return aDigest;
+}
+
+
++ (nullable NSData *)digestWithHexString:(nonnull NSString *)aHexString
+{
+    NSMutableData *aDigest = nil;
+    const char *aHexCharacters = [aHexString UTF8String];
+    size_t aHexLength = strlen(aHexCharacters);
+    if ((aHexLength % 2) == 0)
+    {
+        aDigest = [NSMutableData dataWithCapacity:aHexLength / 2];
+        for (size_t anIndex = 0; anIndex < aHexLength; anIndex += 2)
+        {
+            char aByteCharacters[3] = {aHexCharacters[anIndex], aHexCharacters[anIndex + 1], '\0'};
+            char *anEnd = NULL;
+            uint8_t aByte = (uint8_t)strtoul(aByteCharacters, &anEnd, 16);
+            if ((anEnd != aByteCharacters + 2) || (isxdigit(aByteCharacters[0]) == 0))
+            {
+                aDigest = nil;
+                break;
+            }
+            [aDigest appendBytes:&aByte length:1];
+        }
+    }
+    return aDigest;
+}
+
+
++ (nonnull NSString *)hexStringWithDigest:(nonnull NSData *)aDigest
+{
+    NSMutableString *aHexString = [NSMutableString stringWithCapacity:aDigest.length * 2];
+    const uint8_t *aBytes = aDigest.bytes;
+    for (NSUInteger anIndex = 0; anIndex < aDigest.length; anIndex++)
+    {
+        [aHexString appendFormat:@"%02x", aBytes[anIndex]];
+    }
+    return aHexString;
+}
+
+
++ (BOOL)isCRC32CHardwareAccelerated
+{
+    return (HWI_FILE_DOWNLOAD_CRC32C_HARDWARE == 1);
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.algorithm) forKey:@"algorithm"];
+    [aDescriptionDict setObject:@(self.processedBytesCount) forKey:@"processedBytesCount"];
+    if (self.computedDigest)
+    {
+        [aDescriptionDict setObject:[HWIFileDownloadDigest hexStringWithDigest:self.computedDigest] forKey:@"computedDigest"];
+    }
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
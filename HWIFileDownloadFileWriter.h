@@ -0,0 +1,144 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadFileWriter.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadFileWriter appends downloaded data to a file. It is used internally by HWIFileDownloader.
+ @discussion The file is opened once and kept open until the writer is closed. Small chunks are coalesced in a write buffer which is written to the file in writes of the buffer size. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadFileWriter : NSObject
+
+/**
+ Designated initializer.
+ @param aFileURL Local file URL of the file to write. An existing file is truncated on first write unless appendsToExistingFile is set.
+ @param aBufferSize Size of the write buffer in bytes. With 0 every chunk is written directly.
+ @return File writer.
+ */
+- (nonnull instancetype)initWithFileURL:(nonnull NSURL *)aFileURL bufferSize:(NSUInteger)aBufferSize;
+- (nonnull HWIFileDownloadFileWriter *)init __attribute__((unavailable("use initWithFileURL:bufferSize:")));
++ (nonnull HWIFileDownloadFileWriter *)new __attribute__((unavailable("use initWithFileURL:bufferSize:")));
+
+/**
+ Local file URL of the written file.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *fileURL;
+
+/**
+ Flag whether data is appended to an existing file instead of truncating it, e.g. when a partial download is continued (default: NO). Needs to be set before the first write.
+ */
+@property (nonatomic, assign) BOOL appendsToExistingFile;
+
+/**
+ Number of bytes reserved beyond the end of the file when it is opened, e.g. the expected remaining size of the download (default: 0, no reservation). Reserving contiguous space avoids growing the file one append at a time; unused space is released when the file is closed. Needs to be set before the first write.
+ */
+@property (nonatomic, assign) int64_t preallocationLength;
+
+/**
+ Number of bytes written to the file (without data still held in the write buffer).
+ */
+@property (nonatomic, assign, readonly) int64_t writtenBytesCount;
+
+/**
+ Number of system calls (open, write, close) issued.
+ */
+@property (nonatomic, assign, readonly) NSUInteger systemCallsCount;
+
+/**
+ Appends data to the file.
+ @param aData Data to append.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)appendData:(nonnull NSData *)aData error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Writes the buffered data to the file.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)flushWithError:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Writes the buffered data to the file and closes the file.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)closeWithError:(NSError * _Nullable * _Nullable)anError;
+
+
+/**
+ Creates a file and preallocates its size.
+ @param aFileURL Local file URL of the file to create. An existing file is truncated.
+ @param aLength File size in bytes.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
++ (BOOL)preallocateFileAtURL:(nonnull NSURL *)aFileURL length:(int64_t)aLength error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Writes data into the (preallocated) file at an offset with positional writes, e.g. a chunk of a byte range segment.
+ @discussion The data is written directly without the write buffer. The file is opened on first write without creating or truncating it; a writer is used either for appending or for positional writes.
+ @param aData Data to write.
+ @param anOffset Offset in the file in bytes.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)writeData:(nonnull NSData *)aData atOffset:(int64_t)anOffset error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Moves a downloaded file (or directory) to its final location, replacing an existing item.
+ @discussion On the same volume the item is renamed over the destination atomically without copying. On another volume the file is cloned or copied in the kernel (copyfile) into a sibling of the destination, which is then renamed over the destination, and the source is removed.
+ @param aSourceURL Local file URL of the item to move.
+ @param aDestinationURL Local file URL of the final location.
+ @param aFileSize Size of the moved file in bytes (taken before the move, no further stat needed), may be NULL.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
++ (BOOL)moveItemAtURL:(nonnull NSURL *)aSourceURL toURL:(nonnull NSURL *)aDestinationURL fileSize:(nullable int64_t *)aFileSize error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Gives a file (or directory) a second location without copying its contents where possible, replacing an existing item.
+ @discussion A hard link is created next to the destination and renamed over it. On another volume (or for a directory) the item is cloned or copied in the kernel (copyfile) instead. The source is kept. Blocks for a copy; not to be called on the main queue.
+ @param aSourceURL Local file URL of the item.
+ @param aDestinationURL Local file URL of the second location.
+ @param aFileSize Size of the file in bytes, may be NULL.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise.
+ */
++ (BOOL)linkItemAtURL:(nonnull NSURL *)aSourceURL toURL:(nonnull NSURL *)aDestinationURL fileSize:(nullable int64_t *)aFileSize error:(NSError * _Nullable * _Nullable)anError;
+
+@end
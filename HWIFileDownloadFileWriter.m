@@ -0,0 +1,476 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadFileWriter.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadFileWriter.h"
+
+#include <copyfile.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+static NSError *HWIFileDownloadFileWriterPOSIXError(NSURL *aFileURL)
+{
+    int anErrorNumber = errno;
+    NSLog(@"ERR: File operation failed for %@: %s (%@, %d)", aFileURL, strerror(anErrorNumber), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    return [[NSError alloc] initWithDomain:NSPOSIXErrorDomain code:anErrorNumber userInfo:@{NSFilePathErrorKey: aFileURL.path}];
+}
+
+
+static void HWIFileDownloadFileWriterPreallocate(int aFileDescriptor, int64_t aLength)
+{
+#if defined(F_PREALLOCATE)
+    // reserve contiguous space beyond the end of the file if possible to avoid fragmentation; best effort
+    fstore_t aStore = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, aLength, 0};
+    if (fcntl(aFileDescriptor, F_PREALLOCATE, &aStore) == -1)
+    {
+        aStore.fst_flags = F_ALLOCATEALL;
+        fcntl(aFileDescriptor, F_PREALLOCATE, &aStore);
+    }
+#endif
+}
+
+
+static NSURL *HWIFileDownloadFileWriterPartialURL(NSURL *aDestinationURL)
+{
+    // hidden sibling of the destination, renamed over it when complete
+    NSString *aPartialFileName = [NSString stringWithFormat:@".%@.partial", aDestinationURL.lastPathComponent];
+    return [[aDestinationURL URLByDeletingLastPathComponent] URLByAppendingPathComponent:aPartialFileName];
+}
+
+
+static BOOL HWIFileDownloadFileWriterRename(NSURL *aSourceURL, NSURL *aDestinationURL)
+{
+    // replaces an existing file atomically; an existing directory needs to be removed first
+    BOOL aSuccessFlag = (rename(aSourceURL.fileSystemRepresentation, aDestinationURL.fileSystemRepresentation) == 0);
+    if ((aSuccessFlag == NO) && ((errno == EEXIST) || (errno == ENOTEMPTY) || (errno == EISDIR) || (errno == ENOTDIR)))
+    {
+        [[NSFileManager defaultManager] removeItemAtURL:aDestinationURL error:NULL];
+        aSuccessFlag = (rename(aSourceURL.fileSystemRepresentation, aDestinationURL.fileSystemRepresentation) == 0);
+    }
+    return aSuccessFlag;
+}
+
+
+@interface HWIFileDownloadFileWriter()
+{
+    uint8_t *_buffer;
+    NSUInteger _bufferSize;
+    NSUInteger _bufferedLength;
+    int _fileDescriptor;
+}
+@property (nonatomic, strong, readwrite, nonnull) NSURL *fileURL;
+@property (nonatomic, assign, readwrite) int64_t writtenBytesCount;
+@property (nonatomic, assign, readwrite) NSUInteger systemCallsCount;
+@end
+
+
+@implementation HWIFileDownloadFileWriter
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithFileURL:(nonnull NSURL *)aFileURL bufferSize:(NSUInteger)aBufferSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.fileURL = aFileURL;
+        self.writtenBytesCount = 0;
+        self.systemCallsCount = 0;
+        self.appendsToExistingFile = NO;
+        self.preallocationLength = 0;
+        _buffer = NULL;
+        _bufferSize = aBufferSize;
+        _bufferedLength = 0;
+        _fileDescriptor = -1;
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    if (_fileDescriptor > -1)
+    {
+        close(_fileDescriptor);
+    }
+    free(_buffer);
+}
+
+
+#pragma mark - Writing
+
+
+- (BOOL)appendData:(nonnull NSData *)aData error:(NSError * _Nullable * _Nullable)anError
+{
+    const uint8_t *aBytes = aData.bytes;
+    NSUInteger aRemainingLength = aData.length;
+    BOOL aSuccessFlag = [self openWithError:anError];
+    if (aSuccessFlag && (_bufferSize == 0))
+    {
+        aSuccessFlag = [self writeBytes:aBytes length:aRemainingLength error:anError];
+        aRemainingLength = 0;
+    }
+    while (aSuccessFlag && (aRemainingLength > 0))
+    {
+        if ((_bufferedLength == 0) && (aRemainingLength >= _bufferSize))
+        {
+            // the file offset is a multiple of the buffer size; write whole buffer sized blocks without copying
+            NSUInteger aDirectLength = aRemainingLength - (aRemainingLength % _bufferSize);
+            aSuccessFlag = [self writeBytes:aBytes length:aDirectLength error:anError];
+            aBytes += aDirectLength;
+            aRemainingLength -= aDirectLength;
+        }
+        else
+        {
+            if (_buffer == NULL)
+            {
+                _buffer = malloc(_bufferSize);
+            }
+            NSUInteger aCopyLength = MIN(_bufferSize - _bufferedLength, aRemainingLength);
+            memcpy(_buffer + _bufferedLength, aBytes, aCopyLength);
+            _bufferedLength += aCopyLength;
+            aBytes += aCopyLength;
+            aRemainingLength -= aCopyLength;
+            if (_bufferedLength == _bufferSize)
+            {
+                aSuccessFlag = [self flushWithError:anError];
+            }
+        }
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)flushWithError:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = YES;
+    if (_bufferedLength > 0)
+    {
+        aSuccessFlag = [self writeBytes:_buffer length:_bufferedLength error:anError];
+        _bufferedLength = 0;
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)closeWithError:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = YES;
+    if (_fileDescriptor > -1)
+    {
+        aSuccessFlag = [self flushWithError:anError];
+        self.systemCallsCount++;
+        if ((close(_fileDescriptor) != 0) && aSuccessFlag)
+        {
+            aSuccessFlag = NO;
+            [self setPOSIXError:anError];
+        }
+        _fileDescriptor = -1;
+    }
+    free(_buffer);
+    _buffer = NULL;
+    _bufferedLength = 0;
+    return aSuccessFlag;
+}
+
+
+#pragma mark - Utilities
+
+
+- (BOOL)openWithError:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = YES;
+    if (_fileDescriptor < 0)
+    {
+        self.systemCallsCount++;
+        _fileDescriptor = open(self.fileURL.fileSystemRepresentation, O_WRONLY | O_CREAT | (self.appendsToExistingFile ? O_APPEND : O_TRUNC), 0644);
+        if (_fileDescriptor < 0)
+        {
+            aSuccessFlag = NO;
+            [self setPOSIXError:anError];
+        }
+        else if (self.preallocationLength > 0)
+        {
+            self.systemCallsCount++;
+            HWIFileDownloadFileWriterPreallocate(_fileDescriptor, self.preallocationLength);
+        }
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)writeBytes:(const uint8_t *)aBytes length:(NSUInteger)aLength error:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = YES;
+    while (aLength > 0)
+    {
+        self.systemCallsCount++;
+        ssize_t aWrittenLength = write(_fileDescriptor, aBytes, aLength);
+        if (aWrittenLength < 0)
+        {
+            if (errno != EINTR)
+            {
+                aSuccessFlag = NO;
+                [self setPOSIXError:anError];
+                break;
+            }
+        }
+        else
+        {
+            aBytes += aWrittenLength;
+            aLength -= (NSUInteger)aWrittenLength;
+            self.writtenBytesCount += aWrittenLength;
+        }
+    }
+    return aSuccessFlag;
+}
+
+
+- (void)setPOSIXError:(NSError * _Nullable * _Nullable)anError
+{
+    NSError *aPOSIXError = HWIFileDownloadFileWriterPOSIXError(self.fileURL);
+    if (anError)
+    {
+        *anError = aPOSIXError;
+    }
+}
+
+
+#pragma mark - Positional Writing
+
+
++ (BOOL)preallocateFileAtURL:(nonnull NSURL *)aFileURL length:(int64_t)aLength error:(NSError * _Nullable * _Nullable)anError
+{
+    NSError *aPOSIXError = nil;
+    int aFileDescriptor = open(aFileURL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (aFileDescriptor < 0)
+    {
+        aPOSIXError = HWIFileDownloadFileWriterPOSIXError(aFileURL);
+    }
+    else
+    {
+        // ftruncate sets the size in any case
+        HWIFileDownloadFileWriterPreallocate(aFileDescriptor, aLength);
+        if (ftruncate(aFileDescriptor, (off_t)aLength) != 0)
+        {
+            aPOSIXError = HWIFileDownloadFileWriterPOSIXError(aFileURL);
+        }
+        close(aFileDescriptor);
+    }
+    if (aPOSIXError && anError)
+    {
+        *anError = aPOSIXError;
+    }
+    return (aPOSIXError == nil);
+}
+
+
+- (BOOL)writeData:(nonnull NSData *)aData atOffset:(int64_t)anOffset error:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = YES;
+    if (_fileDescriptor < 0)
+    {
+        // the preallocated file is neither created nor truncated
+        self.systemCallsCount++;
+        _fileDescriptor = open(self.fileURL.fileSystemRepresentation, O_WRONLY);
+        if (_fileDescriptor < 0)
+        {
+            aSuccessFlag = NO;
+            [self setPOSIXError:anError];
+        }
+    }
+    const uint8_t *aBytes = aData.bytes;
+    NSUInteger aRemainingLength = aData.length;
+    while (aSuccessFlag && (aRemainingLength > 0))
+    {
+        self.systemCallsCount++;
+        ssize_t aWrittenLength = pwrite(_fileDescriptor, aBytes, aRemainingLength, (off_t)anOffset);
+        if (aWrittenLength < 0)
+        {
+            if (errno != EINTR)
+            {
+                aSuccessFlag = NO;
+                [self setPOSIXError:anError];
+            }
+        }
+        else
+        {
+            aBytes += aWrittenLength;
+            anOffset += aWrittenLength;
+            aRemainingLength -= (NSUInteger)aWrittenLength;
+            self.writtenBytesCount += aWrittenLength;
+        }
+    }
+    return aSuccessFlag;
+}
+
+
+#pragma mark - Finalization
+
+
++ (BOOL)moveItemAtURL:(nonnull NSURL *)aSourceURL toURL:(nonnull NSURL *)aDestinationURL fileSize:(nullable int64_t *)aFileSize error:(NSError * _Nullable * _Nullable)anError
+{
+    NSError *aMoveError = nil;
+    struct stat aSourceStat;
+    if (lstat(aSourceURL.fileSystemRepresentation, &aSourceStat) != 0)
+    {
+        aMoveError = HWIFileDownloadFileWriterPOSIXError(aSourceURL);
+    }
+    else if (HWIFileDownloadFileWriterRename(aSourceURL, aDestinationURL) == NO)
+    {
+        if (errno == EXDEV)
+        {
+            aMoveError = [HWIFileDownloadFileWriter copyItemAtURL:aSourceURL replacingItemAtURL:aDestinationURL isDirectory:S_ISDIR(aSourceStat.st_mode)];
+            if (aMoveError == nil)
+            {
+                [[NSFileManager defaultManager] removeItemAtURL:aSourceURL error:NULL];
+            }
+        }
+        else
+        {
+            aMoveError = HWIFileDownloadFileWriterPOSIXError(aDestinationURL);
+        }
+    }
+    if (aMoveError == nil)
+    {
+        if (aFileSize)
+        {
+            *aFileSize = (int64_t)aSourceStat.st_size;
+        }
+    }
+    else if (anError)
+    {
+        *anError = aMoveError;
+    }
+    return (aMoveError == nil);
+}
+
+
++ (BOOL)linkItemAtURL:(nonnull NSURL *)aSourceURL toURL:(nonnull NSURL *)aDestinationURL fileSize:(nullable int64_t *)aFileSize error:(NSError * _Nullable * _Nullable)anError
+{
+    NSError *aLinkError = nil;
+    struct stat aSourceStat;
+    if (lstat(aSourceURL.fileSystemRepresentation, &aSourceStat) != 0)
+    {
+        aLinkError = HWIFileDownloadFileWriterPOSIXError(aSourceURL);
+    }
+    else
+    {
+        // a hard link shares the file contents; it is created next to the destination and renamed over it
+        NSURL *aPartialURL = HWIFileDownloadFileWriterPartialURL(aDestinationURL);
+        [[NSFileManager defaultManager] removeItemAtURL:aPartialURL error:NULL];
+        if ((S_ISDIR(aSourceStat.st_mode) == NO) && (link(aSourceURL.fileSystemRepresentation, aPartialURL.fileSystemRepresentation) == 0))
+        {
+            if (HWIFileDownloadFileWriterRename(aPartialURL, aDestinationURL) == NO)
+            {
+                aLinkError = HWIFileDownloadFileWriterPOSIXError(aDestinationURL);
+                [[NSFileManager defaultManager] removeItemAtURL:aPartialURL error:NULL];
+            }
+        }
+        else
+        {
+            // other volume or no hard links (e.g. directories)
+            aLinkError = [HWIFileDownloadFileWriter copyItemAtURL:aSourceURL replacingItemAtURL:aDestinationURL isDirectory:S_ISDIR(aSourceStat.st_mode)];
+        }
+    }
+    if (aLinkError == nil)
+    {
+        if (aFileSize)
+        {
+            *aFileSize = (int64_t)aSourceStat.st_size;
+        }
+    }
+    else if (anError)
+    {
+        *anError = aLinkError;
+    }
+    return (aLinkError == nil);
+}
+
+
++ (nullable NSError *)copyItemAtURL:(nonnull NSURL *)aSourceURL replacingItemAtURL:(nonnull NSURL *)aDestinationURL isDirectory:(BOOL)anIsDirectoryFlag
+{
+    // the destination is replaced atomically by renaming a complete copy next to it
+    NSError *aCopyError = nil;
+    NSURL *aPartialURL = HWIFileDownloadFileWriterPartialURL(aDestinationURL);
+    [[NSFileManager defaultManager] removeItemAtURL:aPartialURL error:NULL];
+    copyfile_flags_t aCopyFlags = COPYFILE_ALL;
+    if (anIsDirectoryFlag)
+    {
+        aCopyFlags = COPYFILE_ALL | COPYFILE_RECURSIVE;
+    }
+#if defined(COPYFILE_CLONE)
+    else
+    {
+        // clones where the file system supports it and falls back to a data copy
+        aCopyFlags = COPYFILE_CLONE;
+    }
+#endif
+    if (copyfile(aSourceURL.fileSystemRepresentation, aPartialURL.fileSystemRepresentation, NULL, aCopyFlags) != 0)
+    {
+        aCopyError = HWIFileDownloadFileWriterPOSIXError(aPartialURL);
+        [[NSFileManager defaultManager] removeItemAtURL:aPartialURL error:NULL];
+    }
+    else if (HWIFileDownloadFileWriterRename(aPartialURL, aDestinationURL) == NO)
+    {
+        aCopyError = HWIFileDownloadFileWriterPOSIXError(aDestinationURL);
+        [[NSFileManager defaultManager] removeItemAtURL:aPartialURL error:NULL];
+    }
+    return aCopyError;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.fileURL forKey:@"fileURL"];
+    [aDescriptionDict setObject:@(_bufferSize) forKey:@"bufferSize"];
+    [aDescriptionDict setObject:@(self.writtenBytesCount) forKey:@"writtenBytesCount"];
+    [aDescriptionDict setObject:@(self.systemCallsCount) forKey:@"systemCallsCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,285 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadGzipTransform.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <zlib.h>
+
+#import "HWIFileDownloadGzipTransform.h"
+#import "HWIFileDownloadFileWriter.h"
+
+
+static const NSUInteger HWIFileDownloadGzipTransformOutputBufferSize = 64 * 1024;
+
+
+@interface HWIFileDownloadGzipTransform()
+{
+    z_stream _stream;
+    uint8_t *_outputBuffer;
+}
+@property (nonatomic, strong, readwrite, nonnull) NSURL *outputURL;
+@property (nonatomic, strong, nonnull) HWIFileDownloadFileWriter *fileWriter;
+@property (nonatomic, strong, nullable) NSMutableData *leadingData; // received before the format has been detected
+@property (nonatomic, assign) BOOL isStreamInitialized;
+@property (nonatomic, assign) BOOL isGzipFormat; // concatenated members are inflated one after the other
+@property (nonatomic, assign) BOOL isStreamEnded;
+@property (nonatomic, strong, nullable) NSError *transformError;
+@end
+
+
+@implementation HWIFileDownloadGzipTransform
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithOutputURL:(nonnull NSURL *)anOutputURL bufferSize:(NSUInteger)aBufferSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.outputURL = anOutputURL;
+        self.fileWriter = [[HWIFileDownloadFileWriter alloc] initWithFileURL:anOutputURL bufferSize:aBufferSize];
+        self.isStreamInitialized = NO;
+        self.isGzipFormat = NO;
+        self.isStreamEnded = NO;
+        _outputBuffer = NULL;
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    if (self.isStreamInitialized)
+    {
+        inflateEnd(&_stream);
+    }
+    free(_outputBuffer);
+}
+
+
+#pragma mark - HWIFileDownloadTransform
+
+
+- (nonnull NSArray<NSString *> *)outputRelativePaths
+{
+    return @[];
+}
+
+
+- (int64_t)writtenBytesCount
+{
+    return self.fileWriter.writtenBytesCount;
+}
+
+
+- (NSUInteger)systemCallsCount
+{
+    return self.fileWriter.systemCallsCount;
+}
+
+
+- (BOOL)transformData:(nonnull NSData *)aData error:(NSError * _Nullable * _Nullable)anError
+{
+    BOOL aSuccessFlag = (self.transformError == nil);
+    NSData *anInputData = aData;
+    if (aSuccessFlag && (self.isStreamInitialized == NO))
+    {
+        // the format is detected from the first two bytes
+        if (self.leadingData == nil)
+        {
+            self.leadingData = [NSMutableData data];
+        }
+        [self.leadingData appendData:aData];
+        anInputData = nil;
+        if (self.leadingData.length >= 2)
+        {
+            anInputData = self.leadingData;
+            self.leadingData = nil;
+            aSuccessFlag = [self initializeStreamWithFirstBytesOfData:anInputData];
+        }
+    }
+    if (aSuccessFlag && (anInputData.length > 0))
+    {
+        _stream.next_in = (Bytef *)anInputData.bytes;
+        _stream.avail_in = (uInt)anInputData.length;
+        while (aSuccessFlag && (_stream.avail_in > 0))
+        {
+            if (self.isStreamEnded)
+            {
+                if (self.isGzipFormat)
+                {
+                    // next member of a concatenated gzip file
+                    inflateReset(&_stream);
+                    self.isStreamEnded = NO;
+                }
+                else
+                {
+                    // trailing data after a zlib or raw deflate stream is ignored
+                    _stream.avail_in = 0;
+                    break;
+                }
+            }
+            aSuccessFlag = [self inflateAvailableInput];
+        }
+        _stream.next_in = NULL;
+    }
+    if ((aSuccessFlag == NO) && anError)
+    {
+        *anError = self.transformError;
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)finishWithError:(NSError * _Nullable * _Nullable)anError
+{
+    if ((self.transformError == nil) && (self.isStreamEnded == NO))
+    {
+        // truncated (or empty) compressed data
+        self.transformError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+    }
+    NSError *aCloseError = nil;
+    if (([self.fileWriter closeWithError:&aCloseError] == NO) && (self.transformError == nil))
+    {
+        self.transformError = aCloseError;
+    }
+    if (self.isStreamInitialized)
+    {
+        inflateEnd(&_stream);
+        self.isStreamInitialized = NO;
+    }
+    free(_outputBuffer);
+    _outputBuffer = NULL;
+    if (self.transformError && anError)
+    {
+        *anError = self.transformError;
+    }
+    return (self.transformError == nil);
+}
+
+
+#pragma mark - Utilities
+
+
+- (BOOL)initializeStreamWithFirstBytesOfData:(nonnull NSData *)aData
+{
+    const uint8_t *aBytes = aData.bytes;
+    int aWindowBits = -MAX_WBITS; // raw deflate
+    if ((aBytes[0] == 0x1f) && (aBytes[1] == 0x8b))
+    {
+        aWindowBits = MAX_WBITS + 16;
+        self.isGzipFormat = YES;
+    }
+    else if (((aBytes[0] & 0x0f) == Z_DEFLATED) && ((((uint16_t)aBytes[0] << 8) | aBytes[1]) % 31 == 0))
+    {
+        aWindowBits = MAX_WBITS;
+    }
+    memset(&_stream, 0, sizeof(_stream));
+    if (inflateInit2(&_stream, aWindowBits) != Z_OK)
+    {
+        self.transformError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+        return NO;
+    }
+    self.isStreamInitialized = YES;
+    _outputBuffer = malloc(HWIFileDownloadGzipTransformOutputBufferSize);
+    return YES;
+}
+
+
+- (BOOL)inflateAvailableInput
+{
+    BOOL aSuccessFlag = YES;
+    int anInflateResult = Z_OK;
+    do
+    {
+        _stream.next_out = _outputBuffer;
+        _stream.avail_out = (uInt)HWIFileDownloadGzipTransformOutputBufferSize;
+        anInflateResult = inflate(&_stream, Z_NO_FLUSH);
+        if ((anInflateResult != Z_OK) && (anInflateResult != Z_STREAM_END) && (anInflateResult != Z_BUF_ERROR))
+        {
+            NSLog(@"ERR: Unable to inflate data: %s (%@, %d)", _stream.msg ? _stream.msg : "unknown", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            self.transformError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+            aSuccessFlag = NO;
+        }
+        else
+        {
+            NSUInteger anInflatedLength = HWIFileDownloadGzipTransformOutputBufferSize - _stream.avail_out;
+            if (anInflatedLength > 0)
+            {
+                NSError *aWriteError = nil;
+                aSuccessFlag = [self.fileWriter appendData:[NSData dataWithBytesNoCopy:_outputBuffer length:anInflatedLength freeWhenDone:NO] error:&aWriteError];
+                if (aSuccessFlag == NO)
+                {
+                    self.transformError = aWriteError;
+                }
+            }
+            if (anInflateResult == Z_STREAM_END)
+            {
+                self.isStreamEnded = YES;
+            }
+        }
+    }
+    while (aSuccessFlag && (anInflateResult == Z_OK) && ((_stream.avail_in > 0) || (_stream.avail_out == 0)));
+    if (aSuccessFlag && (anInflateResult == Z_BUF_ERROR) && (_stream.avail_in > 0))
+    {
+        // no progress possible with the remaining input
+        self.transformError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+        aSuccessFlag = NO;
+    }
+    return aSuccessFlag;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.outputURL forKey:@"outputURL"];
+    [aDescriptionDict setObject:@(self.isGzipFormat) forKey:@"isGzipFormat"];
+    [aDescriptionDict setObject:@(self.isStreamEnded) forKey:@"isStreamEnded"];
+    [aDescriptionDict setObject:@(self.writtenBytesCount) forKey:@"writtenBytesCount"];
+    if (self.transformError)
+    {
+        [aDescriptionDict setObject:self.transformError forKey:@"transformError"];
+    }
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
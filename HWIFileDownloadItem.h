@@ -35,6 +35,18 @@
 
 #import <Foundation/Foundation.h>
 
+#import "HWIFileDownloadPriority.h"
+#import "HWIFileDownloadTransform.h"
+
+
+@class HWIFileDownloadCacheEntry;
+@class HWIFileDownloadDigest;
+@class HWIFileDownloadFileWriter;
+@class HWIFileDownloadOptions;
+@class HWIFileDownloadSegment;
+@class HWIFileDownloadStream;
+@class HWIFileDownloadThroughputEstimator;
+
 
 /**
  HWIFileDownloadItem is used internally by HWIFileDownloader.
@@ -45,22 +57,65 @@
                           sessionDownloadTask:(nullable NSURLSessionDownloadTask *)aSessionDownloadTask
                                 urlConnection:(nullable NSURLConnection *)aURLConnection;
 
+- (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken
+                          sessionDownloadTask:(nullable NSURLSessionDownloadTask *)aSessionDownloadTask
+                                urlConnection:(nullable NSURLConnection *)aURLConnection
+                                     progress:(nullable NSProgress *)aProgress; // continues the progress of a retried download instead of creating a child of the current progress
+
 
 @property (nonatomic, strong, nullable) NSDate *downloadStartDate;
 @property (nonatomic, assign) int64_t receivedFileSizeInBytes;
 @property (nonatomic, assign) int64_t expectedFileSizeInBytes;
 @property (nonatomic, assign) int64_t resumedFileSizeInBytes;
 @property (nonatomic, assign) NSUInteger bytesPerSecondSpeed;
+@property (nonatomic, strong, readonly, nonnull) HWIFileDownloadThroughputEstimator *throughputEstimator;
+@property (nonatomic, assign) HWIFileDownloadPriority priority;
 @property (nonatomic, strong, readonly, nonnull) NSProgress *progress;
 @property (nonatomic, strong, readonly, nonnull) NSString *downloadToken;
 
-@property (nonatomic, strong, readonly, nullable) NSURLSessionDownloadTask *sessionDownloadTask;
+@property (nonatomic, strong, nullable) NSURLSessionDownloadTask *sessionDownloadTask;
 
 @property (nonatomic, strong, readonly, nullable) NSURLConnection *urlConnection;
+@property (nonatomic, strong, nullable) HWIFileDownloadFileWriter *fileWriter;
+@property (nonatomic, strong, nullable) NSError *fileWriteError; // first error writing the temporary file, accessed on the file writer queue
+@property (nonatomic, strong, nullable) HWIFileDownloadDigest *digest;
+@property (nonatomic, assign) NSUInteger transferIdentifier; // download id of a transport transfer
 
 @property (nonatomic, strong, nullable) NSArray<NSString *> *errorMessagesStack;
 @property (nonatomic, assign) NSInteger lastHttpStatusCode;
 @property (nonatomic, strong, nullable) NSURL *finalLocalFileURL;
+@property (nonatomic, strong, nullable) NSURL *remoteURL;
+@property (nonatomic, copy, nullable) NSString *hostKey; // counted in the active downloads per host
+@property (nonatomic, strong, nullable) HWIFileDownloadOptions *options;
+
+@property (nonatomic, strong, nullable) HWIFileDownloadCacheEntry *cacheEntry; // revalidated cache entry
+@property (nonatomic, assign) BOOL isNotModified;
+@property (nonatomic, copy, nullable) NSString *responseETag;
+@property (nonatomic, copy, nullable) NSString *responseLastModified;
+
+@property (nonatomic, assign) NSTimeInterval queueWaitTime;
+@property (nonatomic, assign) NSTimeInterval transferStartTime; // time interval since reference date, 0.0: unknown
+@property (nonatomic, assign) NSTimeInterval firstByteTime;
+@property (nonatomic, assign) NSTimeInterval lastByteTime;
+@property (nonatomic, assign) NSUInteger redirectsCount;
+@property (nonatomic, assign) NSUInteger retriesCount;
+@property (nonatomic, strong, nullable) NSURLSessionTaskMetrics *sessionTaskMetrics NS_AVAILABLE_IOS(10_0);
+
+@property (nonatomic, assign) BOOL isThrottled;
+@property (nonatomic, strong, nullable) HWIFileDownloadStream *stream;
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *streamDataTask; // foreground session task of a streamed download
+@property (nonatomic, assign) BOOL isStreamBacklogFull;
+@property (nonatomic, assign) BOOL isWaitingForWriter; // held while the write budget of the downloader is exhausted
+@property (nonatomic, strong, nullable) id<HWIFileDownloadTransform> transform; // decodes the received data on the file writer queue
+@property (nonatomic, assign) BOOL isSegmented;
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *segmentProbeTask;
+@property (nonatomic, strong, nullable) NSArray<HWIFileDownloadSegment *> *segmentsArray;
+@property (nonatomic, strong, nullable) NSURL *segmentedFileURL;
+@property (nonatomic, strong, nullable) HWIFileDownloadFileWriter *segmentedFileWriter; // positional writes of the segments on the file writer queue
+@property (nonatomic, copy, nullable) NSString *segmentsResumeDataFileName; // file of the resume data store with the received ranges, for continuing after relaunch
+@property (nonatomic, assign) BOOL isSegmentsResumeDataSaveScheduled;
+
+- (nullable HWIFileDownloadSegment *)segmentForTaskIdentifier:(NSUInteger)aTaskIdentifier;
 
 
 - (nonnull HWIFileDownloadItem *)init __attribute__((unavailable("use initWithDownloadToken:sessionDownloadTask:urlConnection:")));
@@ -34,13 +34,15 @@
 
 
 #import "HWIFileDownloadItem.h"
+#import "HWIFileDownloadSegment.h"
+#import "HWIFileDownloadThroughputEstimator.h"
 
 
 @interface HWIFileDownloadItem()
 @property (nonatomic, strong, readwrite, nonnull) NSString *downloadToken;
-@property (nonatomic, strong, readwrite, nullable) NSURLSessionDownloadTask *sessionDownloadTask;
 @property (nonatomic, strong, readwrite, nullable) NSURLConnection *urlConnection;
 @property (nonatomic, strong, readwrite, nonnull) NSProgress *progress;
+@property (nonatomic, strong, readwrite, nonnull) HWIFileDownloadThroughputEstimator *throughputEstimator;
 @end
 
 
@@ -53,6 +55,15 @@
 - (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken
                           sessionDownloadTask:(nullable NSURLSessionDownloadTask *)aSessionDownloadTask
                                 urlConnection:(nullable NSURLConnection *)aURLConnection
+{
+    return [self initWithDownloadToken:aDownloadToken sessionDownloadTask:aSessionDownloadTask urlConnection:aURLConnection progress:nil];
+}
+
+
+- (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken
+                          sessionDownloadTask:(nullable NSURLSessionDownloadTask *)aSessionDownloadTask
+                                urlConnection:(nullable NSURLConnection *)aURLConnection
+                                     progress:(nullable NSProgress *)aProgress
 {
     self = [super init];
     if (self)
@@ -63,10 +74,31 @@
         self.receivedFileSizeInBytes = 0;
         self.expectedFileSizeInBytes = 0;
         self.bytesPerSecondSpeed = 0;
+        self.throughputEstimator = [[HWIFileDownloadThroughputEstimator alloc] init];
         self.resumedFileSizeInBytes = 0;
         self.lastHttpStatusCode = 0;
+        self.priority = HWIFileDownloadPriorityDefault;
+        self.isThrottled = NO;
+        self.isStreamBacklogFull = NO;
+        self.isWaitingForWriter = NO;
+        self.isSegmented = NO;
+        self.isSegmentsResumeDataSaveScheduled = NO;
+        self.isNotModified = NO;
+        self.queueWaitTime = 0.0;
+        self.transferStartTime = 0.0;
+        self.firstByteTime = 0.0;
+        self.lastByteTime = 0.0;
+        self.redirectsCount = 0;
+        self.retriesCount = 0;
         
-        self.progress = [[NSProgress alloc] initWithParent:[NSProgress currentProgress] userInfo:nil];
+        if (aProgress)
+        {
+            self.progress = aProgress;
+        }
+        else
+        {
+            self.progress = [[NSProgress alloc] initWithParent:[NSProgress currentProgress] userInfo:nil];
+        }
         if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
         {
             self.progress.kind = NSProgressKindFile;
@@ -112,6 +144,24 @@
 }
 
 
+#pragma mark - Segments
+
+
+- (nullable HWIFileDownloadSegment *)segmentForTaskIdentifier:(NSUInteger)aTaskIdentifier
+{
+    HWIFileDownloadSegment *aFoundSegment = nil;
+    for (HWIFileDownloadSegment *aSegment in self.segmentsArray)
+    {
+        if (aSegment.sessionDataTask && (aSegment.sessionDataTask.taskIdentifier == aTaskIdentifier))
+        {
+            aFoundSegment = aSegment;
+            break;
+        }
+    }
+    return aFoundSegment;
+}
+
+
 #pragma mark - Description
 
 
@@ -121,6 +171,7 @@
     [aDescriptionDict setObject:@(self.receivedFileSizeInBytes) forKey:@"receivedFileSizeInBytes"];
     [aDescriptionDict setObject:@(self.expectedFileSizeInBytes) forKey:@"expectedFileSizeInBytes"];
     [aDescriptionDict setObject:@(self.bytesPerSecondSpeed) forKey:@"bytesPerSecondSpeed"];
+    [aDescriptionDict setObject:@(self.priority) forKey:@"priority"];
     [aDescriptionDict setObject:self.downloadToken forKey:@"downloadToken"];
     [aDescriptionDict setObject:self.progress forKey:@"progress"];
     if (self.sessionDownloadTask)
@@ -131,6 +182,18 @@
     {
         [aDescriptionDict setObject:@(YES) forKey:@"hasUrlConnection"];
     }
+    if (self.segmentsArray)
+    {
+        [aDescriptionDict setObject:self.segmentsArray forKey:@"segmentsArray"];
+    }
+    if (self.stream)
+    {
+        [aDescriptionDict setObject:self.stream forKey:@"stream"];
+    }
+    if (self.transform)
+    {
+        [aDescriptionDict setObject:self.transform forKey:@"transform"];
+    }
     
     NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
     
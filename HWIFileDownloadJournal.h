@@ -0,0 +1,177 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadJournal.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadPriority.h"
+
+
+@class HWIFileDownloadOptions;
+
+
+/**
+ HWIFileDownloadJournalEvent is the type of a record of the journal.
+ */
+typedef NS_ENUM(uint8_t, HWIFileDownloadJournalEvent) {
+    HWIFileDownloadJournalEventEnqueue = 1,
+    HWIFileDownloadJournalEventStart,
+    HWIFileDownloadJournalEventPriority,
+    HWIFileDownloadJournalEventPause,
+    HWIFileDownloadJournalEventComplete,
+    HWIFileDownloadJournalEventCancel,
+    HWIFileDownloadJournalEventFail,
+    HWIFileDownloadJournalEventResumeData,
+    HWIFileDownloadJournalEventRetry
+};
+
+
+/**
+ HWIFileDownloadJournalEntry is a download recorded in the journal that has not finished yet. It is used internally by HWIFileDownloader.
+ */
+@interface HWIFileDownloadJournalEntry : NSObject
+
+@property (nonatomic, copy, readonly, nonnull) NSString *downloadToken;
+@property (nonatomic, strong, readonly, nullable) NSURL *remoteURL;
+@property (nonatomic, copy, readonly, nullable) NSString *resumeDataFileName; // file of the resume data store of the downloader
+@property (nonatomic, strong, readonly, nonnull) HWIFileDownloadOptions *options;
+@property (nonatomic, assign, readonly) BOOL isStarted;
+@property (nonatomic, assign, readonly) NSUInteger retriesCount;
+@property (nonatomic, assign, readonly) int64_t partialFileSize; // partial file of a download waiting for a retry
+@property (nonatomic, assign, readonly) uint64_t sequenceNumber; // order of enqueueing
+
+- (nonnull HWIFileDownloadJournalEntry *)init __attribute__((unavailable("entries are created by HWIFileDownloadJournal")));
++ (nonnull HWIFileDownloadJournalEntry *)new __attribute__((unavailable("entries are created by HWIFileDownloadJournal")));
+
+@end
+
+
+/**
+ HWIFileDownloadJournal is an append-only file of download events for restoring waiting downloads after relaunch. It is used internally by HWIFileDownloader.
+ @discussion Each record is a length-prefixed event with the download token; enqueue records carry remote URL, options (including the retry policy) and the file name of stored resume data, which a resume data record replaces. A retry record returns a started download to waiting with its retries count. The journal keeps the unfinished downloads in memory. Records are buffered and written on a private serial queue with flush. When the file holds many more records than unfinished downloads, it is compacted by writing the unfinished downloads to a new file. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadJournal : NSObject
+
+/**
+ Designated initializer. Replays an existing journal file; a truncated last record is ignored.
+ @param aFileURL Local file URL of the journal. The directory is created if needed.
+ @return HWIFileDownloadJournal.
+ */
+- (nonnull instancetype)initWithFileURL:(nonnull NSURL *)aFileURL;
+- (nonnull HWIFileDownloadJournal *)init __attribute__((unavailable("use initWithFileURL:")));
++ (nonnull HWIFileDownloadJournal *)new __attribute__((unavailable("use initWithFileURL:")));
+
+/**
+ Local file URL of the journal.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *fileURL;
+
+/**
+ Number of records in the journal file (including buffered records).
+ */
+@property (nonatomic, assign, readonly) NSUInteger recordsCount;
+
+/**
+ Number of unfinished downloads.
+ */
+@property (nonatomic, assign, readonly) NSUInteger entriesCount;
+
+/**
+ Number of bytes of buffered records not yet written.
+ */
+@property (nonatomic, assign, readonly) NSUInteger pendingBytesCount;
+
+/**
+ Unfinished downloads in the order of enqueueing.
+ */
+- (nonnull NSArray<HWIFileDownloadJournalEntry *> *)entries;
+
+/**
+ Returns the entry of a download token.
+ @param aDownloadToken Download token.
+ @return Entry or nil if the download token is not in the journal.
+ */
+- (nullable HWIFileDownloadJournalEntry *)entryForDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Records a download that has been enqueued or started. Ignored if the download token is already in the journal.
+ @param aDownloadToken Download token.
+ @param aRemoteURL Remote URL (nil with resume data).
+ @param aResumeDataFileName File name of the stored resume data (nil without resume data).
+ @param anOptions Options of the download.
+ */
+- (void)recordEnqueueOfDownloadToken:(nonnull NSString *)aDownloadToken
+                           remoteURL:(nullable NSURL *)aRemoteURL
+                  resumeDataFileName:(nullable NSString *)aResumeDataFileName
+                             options:(nonnull HWIFileDownloadOptions *)anOptions;
+
+/**
+ Records a changed priority of a waiting download.
+ @param aPriority New priority.
+ @param aDownloadToken Download token.
+ */
+- (void)recordPriority:(HWIFileDownloadPriority)aPriority ofDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Records the file name of stored resume data of a download, e.g. the received ranges of a running segmented download.
+ @param aResumeDataFileName File name of the stored resume data.
+ @param aDownloadToken Download token.
+ */
+- (void)recordResumeDataFileName:(nonnull NSString *)aResumeDataFileName ofDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Records a download that waits for a retry. The download is restored as waiting.
+ @param aRetriesCount Number of the retry.
+ @param aResumeDataFileName File name of the stored resume data (nil without resume data).
+ @param aPartialFileSize Size of the partial file continued with a range request (0 without partial file).
+ @param aDownloadToken Download token.
+ */
+- (void)recordRetry:(NSUInteger)aRetriesCount
+ resumeDataFileName:(nullable NSString *)aResumeDataFileName
+    partialFileSize:(int64_t)aPartialFileSize
+    ofDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Records the start or the end (pause, complete, cancel, fail) of a download. Ended downloads are removed from the journal.
+ @param anEvent Event (not enqueue or priority).
+ @param aDownloadToken Download token.
+ */
+- (void)recordEvent:(HWIFileDownloadJournalEvent)anEvent ofDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Writes the buffered records asynchronously and compacts the file if needed.
+ */
+- (void)flush;
+
+@end
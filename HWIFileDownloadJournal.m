@@ -0,0 +1,623 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadJournal.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadJournal.h"
+#import "HWIFileDownloadOptions.h"
+
+#include <errno.h>
+
+
+static const NSUInteger HWIFileDownloadJournalMinimumRecordsCountForCompaction = 1024;
+static const NSUInteger HWIFileDownloadJournalCompactionFactor = 4; // records per unfinished download
+static const NSUInteger HWIFileDownloadJournalMaximumPendingBytesCount = 64 * 1024;
+
+
+@interface HWIFileDownloadJournalEntry()
+@property (nonatomic, copy, readwrite, nonnull) NSString *downloadToken;
+@property (nonatomic, strong, readwrite, nullable) NSURL *remoteURL;
+@property (nonatomic, copy, readwrite, nullable) NSString *resumeDataFileName;
+@property (nonatomic, strong, readwrite, nonnull) HWIFileDownloadOptions *options;
+@property (nonatomic, assign, readwrite) BOOL isStarted;
+@property (nonatomic, assign, readwrite) NSUInteger retriesCount;
+@property (nonatomic, assign, readwrite) int64_t partialFileSize;
+@property (nonatomic, assign, readwrite) uint64_t sequenceNumber;
+@end
+
+
+@implementation HWIFileDownloadJournalEntry
+
+
+- (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken options:(nonnull HWIFileDownloadOptions *)anOptions sequenceNumber:(uint64_t)aSequenceNumber
+{
+    self = [super init];
+    if (self)
+    {
+        self.downloadToken = aDownloadToken;
+        self.options = anOptions;
+        self.isStarted = NO;
+        self.retriesCount = 0;
+        self.partialFileSize = 0;
+        self.sequenceNumber = aSequenceNumber;
+    }
+    return self;
+}
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.downloadToken forKey:@"downloadToken"];
+    if (self.remoteURL)
+    {
+        [aDescriptionDict setObject:self.remoteURL forKey:@"remoteURL"];
+    }
+    if (self.resumeDataFileName)
+    {
+        [aDescriptionDict setObject:self.resumeDataFileName forKey:@"resumeDataFileName"];
+    }
+    [aDescriptionDict setObject:@(self.isStarted) forKey:@"isStarted"];
+    [aDescriptionDict setObject:@(self.retriesCount) forKey:@"retriesCount"];
+    [aDescriptionDict setObject:@(self.partialFileSize) forKey:@"partialFileSize"];
+    [aDescriptionDict setObject:@(self.sequenceNumber) forKey:@"sequenceNumber"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
+
+
+@interface HWIFileDownloadJournal()
+@property (nonatomic, strong, readwrite, nonnull) NSURL *fileURL;
+@property (nonatomic, strong, nonnull) dispatch_queue_t journalDispatchQueue; // file access
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, HWIFileDownloadJournalEntry *> *entriesDictionary;
+@property (nonatomic, strong, nonnull) NSMutableData *pendingRecordsData;
+@property (nonatomic, assign, readwrite) NSUInteger recordsCount;
+@property (nonatomic, assign) uint64_t nextSequenceNumber;
+@end
+
+
+@implementation HWIFileDownloadJournal
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithFileURL:(nonnull NSURL *)aFileURL
+{
+    self = [super init];
+    if (self)
+    {
+        self.fileURL = aFileURL;
+        self.journalDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.journal", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+        self.entriesDictionary = [NSMutableDictionary dictionary];
+        self.pendingRecordsData = [NSMutableData data];
+        self.recordsCount = 0;
+        self.nextSequenceNumber = 0;
+        
+        NSError *anError = nil;
+        if ([[NSFileManager defaultManager] createDirectoryAtURL:aFileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:&anError] == NO)
+        {
+            NSLog(@"ERR: Unable to create journal directory %@: %@ (%@, %d)", aFileURL.URLByDeletingLastPathComponent, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        [self replay];
+        // the replayed file is rewritten with the unfinished downloads only, a truncated last record is dropped
+        [self compact];
+    }
+    return self;
+}
+
+
+#pragma mark - Entries
+
+
+- (NSUInteger)entriesCount
+{
+    return self.entriesDictionary.count;
+}
+
+
+- (NSUInteger)pendingBytesCount
+{
+    return self.pendingRecordsData.length;
+}
+
+
+- (nonnull NSArray<HWIFileDownloadJournalEntry *> *)entries
+{
+    return [self.entriesDictionary.allValues sortedArrayUsingComparator:^NSComparisonResult(HWIFileDownloadJournalEntry *anEntry, HWIFileDownloadJournalEntry *anotherEntry) {
+        if (anEntry.sequenceNumber < anotherEntry.sequenceNumber)
+        {
+            return NSOrderedAscending;
+        }
+        else if (anEntry.sequenceNumber > anotherEntry.sequenceNumber)
+        {
+            return NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+}
+
+
+- (nullable HWIFileDownloadJournalEntry *)entryForDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    return [self.entriesDictionary objectForKey:aDownloadToken];
+}
+
+
+#pragma mark - Records
+
+
+- (void)recordEnqueueOfDownloadToken:(nonnull NSString *)aDownloadToken
+                           remoteURL:(nullable NSURL *)aRemoteURL
+                  resumeDataFileName:(nullable NSString *)aResumeDataFileName
+                             options:(nonnull HWIFileDownloadOptions *)anOptions
+{
+    if ([self.entriesDictionary objectForKey:aDownloadToken] == nil)
+    {
+        HWIFileDownloadJournalEntry *anEntry = [[HWIFileDownloadJournalEntry alloc] initWithDownloadToken:aDownloadToken options:[anOptions copy] sequenceNumber:self.nextSequenceNumber++];
+        anEntry.remoteURL = aRemoteURL;
+        anEntry.resumeDataFileName = aResumeDataFileName;
+        [self.entriesDictionary setObject:anEntry forKey:aDownloadToken];
+        [self appendRecordWithEvent:HWIFileDownloadJournalEventEnqueue payload:[HWIFileDownloadJournal payloadOfEntry:anEntry] toData:self.pendingRecordsData];
+        self.recordsCount++;
+        [self flushIfNeeded];
+    }
+}
+
+
+- (void)recordPriority:(HWIFileDownloadPriority)aPriority ofDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    HWIFileDownloadJournalEntry *anEntry = [self.entriesDictionary objectForKey:aDownloadToken];
+    if (anEntry)
+    {
+        anEntry.options.priority = aPriority;
+        NSMutableData *aPayload = [NSMutableData dataWithCapacity:aDownloadToken.length + 1];
+        uint8_t aPriorityByte = (uint8_t)aPriority;
+        [aPayload appendBytes:&aPriorityByte length:1];
+        [aPayload appendData:[aDownloadToken dataUsingEncoding:NSUTF8StringEncoding]];
+        [self appendRecordWithEvent:HWIFileDownloadJournalEventPriority payload:aPayload toData:self.pendingRecordsData];
+        self.recordsCount++;
+        [self flushIfNeeded];
+    }
+}
+
+
+- (void)recordResumeDataFileName:(nonnull NSString *)aResumeDataFileName ofDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    HWIFileDownloadJournalEntry *anEntry = [self.entriesDictionary objectForKey:aDownloadToken];
+    if (anEntry && ([anEntry.resumeDataFileName isEqualToString:aResumeDataFileName] == NO))
+    {
+        anEntry.resumeDataFileName = aResumeDataFileName;
+        NSData *aPayload = [NSPropertyListSerialization dataWithPropertyList:@{@"t": aDownloadToken, @"r": aResumeDataFileName} format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+        if (aPayload)
+        {
+            [self appendRecordWithEvent:HWIFileDownloadJournalEventResumeData payload:aPayload toData:self.pendingRecordsData];
+            self.recordsCount++;
+            [self flushIfNeeded];
+        }
+    }
+}
+
+
+- (void)recordRetry:(NSUInteger)aRetriesCount
+ resumeDataFileName:(nullable NSString *)aResumeDataFileName
+    partialFileSize:(int64_t)aPartialFileSize
+    ofDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    HWIFileDownloadJournalEntry *anEntry = [self.entriesDictionary objectForKey:aDownloadToken];
+    if (anEntry)
+    {
+        [HWIFileDownloadJournal applyRetry:aRetriesCount resumeDataFileName:aResumeDataFileName partialFileSize:aPartialFileSize toEntry:anEntry];
+        [self appendRecordWithEvent:HWIFileDownloadJournalEventRetry payload:[HWIFileDownloadJournal retryPayloadOfEntry:anEntry] toData:self.pendingRecordsData];
+        self.recordsCount++;
+        [self flushIfNeeded];
+    }
+}
+
+
+- (void)recordEvent:(HWIFileDownloadJournalEvent)anEvent ofDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    HWIFileDownloadJournalEntry *anEntry = [self.entriesDictionary objectForKey:aDownloadToken];
+    if (anEntry && ((anEvent != HWIFileDownloadJournalEventStart) || (anEntry.isStarted == NO)))
+    {
+        [self applyEvent:anEvent toEntry:anEntry];
+        [self appendRecordWithEvent:anEvent payload:[aDownloadToken dataUsingEncoding:NSUTF8StringEncoding] toData:self.pendingRecordsData];
+        self.recordsCount++;
+        [self flushIfNeeded];
+    }
+}
+
+
+- (void)applyEvent:(HWIFileDownloadJournalEvent)anEvent toEntry:(nonnull HWIFileDownloadJournalEntry *)anEntry
+{
+    if (anEvent == HWIFileDownloadJournalEventStart)
+    {
+        anEntry.isStarted = YES;
+    }
+    else
+    {
+        [self.entriesDictionary removeObjectForKey:anEntry.downloadToken];
+    }
+}
+
+
+#pragma mark - File
+
+
+- (void)flush
+{
+    if (self.recordsCount > MAX(HWIFileDownloadJournalMinimumRecordsCountForCompaction, HWIFileDownloadJournalCompactionFactor * self.entriesDictionary.count))
+    {
+        [self compact];
+    }
+    else if (self.pendingRecordsData.length > 0)
+    {
+        NSData *aRecordsData = self.pendingRecordsData;
+        self.pendingRecordsData = [NSMutableData data];
+        NSURL *aFileURL = self.fileURL;
+        dispatch_async(self.journalDispatchQueue, ^{
+            [HWIFileDownloadJournal appendData:aRecordsData toFileURL:aFileURL];
+        });
+    }
+}
+
+
+- (void)flushIfNeeded
+{
+    if (self.pendingRecordsData.length >= HWIFileDownloadJournalMaximumPendingBytesCount)
+    {
+        [self flush];
+    }
+}
+
+
+- (void)compact
+{
+    // the unfinished downloads replace the file; appends dispatched earlier are contained
+    NSMutableData *aCompactedData = [NSMutableData data];
+    NSUInteger aCompactedRecordsCount = 0;
+    for (HWIFileDownloadJournalEntry *anEntry in [self entries])
+    {
+        [self appendRecordWithEvent:HWIFileDownloadJournalEventEnqueue payload:[HWIFileDownloadJournal payloadOfEntry:anEntry] toData:aCompactedData];
+        aCompactedRecordsCount++;
+        if (anEntry.retriesCount > 0)
+        {
+            [self appendRecordWithEvent:HWIFileDownloadJournalEventRetry payload:[HWIFileDownloadJournal retryPayloadOfEntry:anEntry] toData:aCompactedData];
+            aCompactedRecordsCount++;
+        }
+        if (anEntry.isStarted)
+        {
+            [self appendRecordWithEvent:HWIFileDownloadJournalEventStart payload:[anEntry.downloadToken dataUsingEncoding:NSUTF8StringEncoding] toData:aCompactedData];
+            aCompactedRecordsCount++;
+        }
+    }
+    self.pendingRecordsData = [NSMutableData data];
+    self.recordsCount = aCompactedRecordsCount;
+    NSURL *aFileURL = self.fileURL;
+    dispatch_async(self.journalDispatchQueue, ^{
+        NSError *aWriteError = nil;
+        if ([aCompactedData writeToURL:aFileURL options:NSDataWritingAtomic error:&aWriteError] == NO)
+        {
+            NSLog(@"ERR: Unable to write journal %@: %@ (%@, %d)", aFileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+    });
+}
+
+
+- (void)replay
+{
+    NSData *aJournalData = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:NULL];
+    const uint8_t *aBytes = aJournalData.bytes;
+    NSUInteger aLength = aJournalData.length;
+    NSUInteger anOffset = 0;
+    while (anOffset + sizeof(uint32_t) + 1 <= aLength)
+    {
+        uint32_t aRecordLength = 0;
+        memcpy(&aRecordLength, aBytes + anOffset, sizeof(uint32_t));
+        aRecordLength = CFSwapInt32LittleToHost(aRecordLength);
+        if ((aRecordLength == 0) || (anOffset + sizeof(uint32_t) + aRecordLength > aLength))
+        {
+            NSLog(@"INFO: Truncated journal record at offset %@ (%@, %d)", @(anOffset), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            break;
+        }
+        HWIFileDownloadJournalEvent anEvent = aBytes[anOffset + sizeof(uint32_t)];
+        NSData *aPayload = [aJournalData subdataWithRange:NSMakeRange(anOffset + sizeof(uint32_t) + 1, aRecordLength - 1)];
+        [self replayEvent:anEvent payload:aPayload];
+        self.recordsCount++;
+        anOffset += sizeof(uint32_t) + aRecordLength;
+    }
+}
+
+
+- (void)replayEvent:(HWIFileDownloadJournalEvent)anEvent payload:(nonnull NSData *)aPayload
+{
+    if (anEvent == HWIFileDownloadJournalEventEnqueue)
+    {
+        NSDictionary *anEntryDictionary = [NSPropertyListSerialization propertyListWithData:aPayload options:NSPropertyListImmutable format:NULL error:NULL];
+        NSString *aDownloadToken = [anEntryDictionary objectForKey:@"t"];
+        if ([aDownloadToken isKindOfClass:[NSString class]] && ([self.entriesDictionary objectForKey:aDownloadToken] == nil))
+        {
+            HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+            anOptions.priority = [[anEntryDictionary objectForKey:@"p"] integerValue];
+            anOptions.segmentsCount = [[anEntryDictionary objectForKey:@"s"] unsignedIntegerValue];
+            anOptions.minimumSegmentSize = [[anEntryDictionary objectForKey:@"m"] longLongValue];
+            anOptions.digestAlgorithm = [[anEntryDictionary objectForKey:@"a"] integerValue];
+            anOptions.expectedDigest = [anEntryDictionary objectForKey:@"d"];
+            anOptions.groupTag = [anEntryDictionary objectForKey:@"g"];
+            anOptions.transformKind = [[anEntryDictionary objectForKey:@"x"] integerValue];
+            anOptions.retryPolicy = [HWIFileDownloadJournal retryPolicyWithDictionary:[anEntryDictionary objectForKey:@"y"]];
+            HWIFileDownloadJournalEntry *anEntry = [[HWIFileDownloadJournalEntry alloc] initWithDownloadToken:aDownloadToken options:anOptions sequenceNumber:self.nextSequenceNumber++];
+            NSString *aRemoteURLString = [anEntryDictionary objectForKey:@"u"];
+            if (aRemoteURLString)
+            {
+                anEntry.remoteURL = [NSURL URLWithString:aRemoteURLString];
+            }
+            anEntry.resumeDataFileName = [anEntryDictionary objectForKey:@"r"];
+            [self.entriesDictionary setObject:anEntry forKey:aDownloadToken];
+        }
+    }
+    else if (anEvent == HWIFileDownloadJournalEventPriority)
+    {
+        if (aPayload.length > 1)
+        {
+            HWIFileDownloadPriority aPriority = ((const uint8_t *)aPayload.bytes)[0];
+            NSString *aDownloadToken = [[NSString alloc] initWithData:[aPayload subdataWithRange:NSMakeRange(1, aPayload.length - 1)] encoding:NSUTF8StringEncoding];
+            HWIFileDownloadJournalEntry *anEntry = aDownloadToken ? [self.entriesDictionary objectForKey:aDownloadToken] : nil;
+            anEntry.options.priority = aPriority;
+        }
+    }
+    else if (anEvent == HWIFileDownloadJournalEventResumeData)
+    {
+        NSDictionary *aResumeDataDictionary = [NSPropertyListSerialization propertyListWithData:aPayload options:NSPropertyListImmutable format:NULL error:NULL];
+        NSString *aDownloadToken = [aResumeDataDictionary objectForKey:@"t"];
+        NSString *aResumeDataFileName = [aResumeDataDictionary objectForKey:@"r"];
+        HWIFileDownloadJournalEntry *anEntry = [aDownloadToken isKindOfClass:[NSString class]] ? [self.entriesDictionary objectForKey:aDownloadToken] : nil;
+        if ([aResumeDataFileName isKindOfClass:[NSString class]])
+        {
+            anEntry.resumeDataFileName = aResumeDataFileName;
+        }
+    }
+    else if (anEvent == HWIFileDownloadJournalEventRetry)
+    {
+        NSDictionary *aRetryDictionary = [NSPropertyListSerialization propertyListWithData:aPayload options:NSPropertyListImmutable format:NULL error:NULL];
+        NSString *aDownloadToken = [aRetryDictionary objectForKey:@"t"];
+        HWIFileDownloadJournalEntry *anEntry = [aDownloadToken isKindOfClass:[NSString class]] ? [self.entriesDictionary objectForKey:aDownloadToken] : nil;
+        if (anEntry)
+        {
+            NSString *aResumeDataFileName = [aRetryDictionary objectForKey:@"r"];
+            [HWIFileDownloadJournal applyRetry:[[aRetryDictionary objectForKey:@"c"] unsignedIntegerValue]
+                            resumeDataFileName:([aResumeDataFileName isKindOfClass:[NSString class]] ? aResumeDataFileName : nil)
+                               partialFileSize:[[aRetryDictionary objectForKey:@"f"] longLongValue]
+                                       toEntry:anEntry];
+        }
+    }
+    else
+    {
+        NSString *aDownloadToken = [[NSString alloc] initWithData:aPayload encoding:NSUTF8StringEncoding];
+        HWIFileDownloadJournalEntry *anEntry = aDownloadToken ? [self.entriesDictionary objectForKey:aDownloadToken] : nil;
+        if (anEntry)
+        {
+            // resume data files of removed entries are removed by the resume data store of the downloader
+            if (anEvent == HWIFileDownloadJournalEventStart)
+            {
+                anEntry.isStarted = YES;
+            }
+            else
+            {
+                [self.entriesDictionary removeObjectForKey:aDownloadToken];
+            }
+        }
+    }
+}
+
+
+#pragma mark - Utilities
+
+
+- (void)appendRecordWithEvent:(HWIFileDownloadJournalEvent)anEvent payload:(nonnull NSData *)aPayload toData:(nonnull NSMutableData *)aData
+{
+    // record: length (little endian, event and payload), event, payload
+    uint32_t aRecordLength = CFSwapInt32HostToLittle((uint32_t)aPayload.length + 1);
+    uint8_t anEventByte = anEvent;
+    [aData appendBytes:&aRecordLength length:sizeof(uint32_t)];
+    [aData appendBytes:&anEventByte length:1];
+    [aData appendData:aPayload];
+}
+
+
++ (nonnull NSData *)payloadOfEntry:(nonnull HWIFileDownloadJournalEntry *)anEntry
+{
+    NSMutableDictionary *anEntryDictionary = [NSMutableDictionary dictionary];
+    [anEntryDictionary setObject:anEntry.downloadToken forKey:@"t"];
+    if (anEntry.remoteURL)
+    {
+        [anEntryDictionary setObject:anEntry.remoteURL.absoluteString forKey:@"u"];
+    }
+    if (anEntry.resumeDataFileName)
+    {
+        [anEntryDictionary setObject:anEntry.resumeDataFileName forKey:@"r"];
+    }
+    [anEntryDictionary setObject:@(anEntry.options.priority) forKey:@"p"];
+    [anEntryDictionary setObject:@(anEntry.options.segmentsCount) forKey:@"s"];
+    [anEntryDictionary setObject:@(anEntry.options.minimumSegmentSize) forKey:@"m"];
+    [anEntryDictionary setObject:@(anEntry.options.digestAlgorithm) forKey:@"a"];
+    [anEntryDictionary setObject:@(anEntry.options.transformKind) forKey:@"x"];
+    if (anEntry.options.expectedDigest)
+    {
+        [anEntryDictionary setObject:anEntry.options.expectedDigest forKey:@"d"];
+    }
+    if (anEntry.options.groupTag)
+    {
+        [anEntryDictionary setObject:anEntry.options.groupTag forKey:@"g"];
+    }
+    if (anEntry.options.retryPolicy)
+    {
+        [anEntryDictionary setObject:[HWIFileDownloadJournal dictionaryOfRetryPolicy:anEntry.options.retryPolicy] forKey:@"y"];
+    }
+    NSData *aPayload = [NSPropertyListSerialization dataWithPropertyList:anEntryDictionary format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+    return aPayload ? aPayload : [NSData data];
+}
+
+
++ (nonnull NSData *)retryPayloadOfEntry:(nonnull HWIFileDownloadJournalEntry *)anEntry
+{
+    NSMutableDictionary *aRetryDictionary = [NSMutableDictionary dictionary];
+    [aRetryDictionary setObject:anEntry.downloadToken forKey:@"t"];
+    [aRetryDictionary setObject:@(anEntry.retriesCount) forKey:@"c"];
+    [aRetryDictionary setObject:@(anEntry.partialFileSize) forKey:@"f"];
+    if (anEntry.resumeDataFileName)
+    {
+        [aRetryDictionary setObject:anEntry.resumeDataFileName forKey:@"r"];
+    }
+    NSData *aPayload = [NSPropertyListSerialization dataWithPropertyList:aRetryDictionary format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+    return aPayload ? aPayload : [NSData data];
+}
+
+
++ (void)applyRetry:(NSUInteger)aRetriesCount
+resumeDataFileName:(nullable NSString *)aResumeDataFileName
+   partialFileSize:(int64_t)aPartialFileSize
+           toEntry:(nonnull HWIFileDownloadJournalEntry *)anEntry
+{
+    // waiting again until the retry starts
+    anEntry.isStarted = NO;
+    anEntry.retriesCount = aRetriesCount;
+    anEntry.partialFileSize = aPartialFileSize;
+    if (aResumeDataFileName)
+    {
+        anEntry.resumeDataFileName = aResumeDataFileName;
+    }
+}
+
+
++ (nonnull NSDictionary *)dictionaryOfRetryPolicy:(nonnull HWIFileDownloadRetryPolicy *)aRetryPolicy
+{
+    NSMutableArray<NSNumber *> *aStatusCodesArray = [NSMutableArray arrayWithCapacity:aRetryPolicy.retriedHttpStatusCodes.count];
+    [aRetryPolicy.retriedHttpStatusCodes enumerateIndexesUsingBlock:^(NSUInteger anIndex, BOOL *aStopFlag) {
+        [aStatusCodesArray addObject:@(anIndex)];
+    }];
+    return @{@"n": @(aRetryPolicy.maximumRetriesCount),
+             @"i": @(aRetryPolicy.initialBackoffInterval),
+             @"m": @(aRetryPolicy.backoffMultiplier),
+             @"x": @(aRetryPolicy.maximumBackoffInterval),
+             @"j": @(aRetryPolicy.jitterFactor),
+             @"e": aRetryPolicy.retriedErrorCodes.allObjects,
+             @"h": aStatusCodesArray};
+}
+
+
++ (nullable HWIFileDownloadRetryPolicy *)retryPolicyWithDictionary:(nullable NSDictionary *)aRetryPolicyDictionary
+{
+    HWIFileDownloadRetryPolicy *aRetryPolicy = nil;
+    if ([aRetryPolicyDictionary isKindOfClass:[NSDictionary class]])
+    {
+        aRetryPolicy = [[HWIFileDownloadRetryPolicy alloc] init];
+        aRetryPolicy.maximumRetriesCount = [[aRetryPolicyDictionary objectForKey:@"n"] unsignedIntegerValue];
+        aRetryPolicy.initialBackoffInterval = [[aRetryPolicyDictionary objectForKey:@"i"] doubleValue];
+        aRetryPolicy.backoffMultiplier = [[aRetryPolicyDictionary objectForKey:@"m"] doubleValue];
+        aRetryPolicy.maximumBackoffInterval = [[aRetryPolicyDictionary objectForKey:@"x"] doubleValue];
+        aRetryPolicy.jitterFactor = [[aRetryPolicyDictionary objectForKey:@"j"] doubleValue];
+        NSArray<NSNumber *> *anErrorCodesArray = [aRetryPolicyDictionary objectForKey:@"e"];
+        if ([anErrorCodesArray isKindOfClass:[NSArray class]])
+        {
+            aRetryPolicy.retriedErrorCodes = [NSSet setWithArray:anErrorCodesArray];
+        }
+        NSArray<NSNumber *> *aStatusCodesArray = [aRetryPolicyDictionary objectForKey:@"h"];
+        if ([aStatusCodesArray isKindOfClass:[NSArray class]])
+        {
+            NSMutableIndexSet *aStatusCodesIndexSet = [NSMutableIndexSet indexSet];
+            for (NSNumber *aStatusCode in aStatusCodesArray)
+            {
+                [aStatusCodesIndexSet addIndex:[aStatusCode unsignedIntegerValue]];
+            }
+            aRetryPolicy.retriedHttpStatusCodes = aStatusCodesIndexSet;
+        }
+    }
+    return aRetryPolicy;
+}
+
+
++ (void)appendData:(nonnull NSData *)aData toFileURL:(nonnull NSURL *)aFileURL
+{
+    int aFileDescriptor = open(aFileURL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (aFileDescriptor < 0)
+    {
+        NSLog(@"ERR: Unable to open journal %@ (errno: %d) (%@, %d)", aFileURL, errno, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    else
+    {
+        const uint8_t *aBytes = aData.bytes;
+        NSUInteger aLength = aData.length;
+        NSUInteger aWrittenLength = 0;
+        while (aWrittenLength < aLength)
+        {
+            ssize_t aResult = write(aFileDescriptor, aBytes + aWrittenLength, aLength - aWrittenLength);
+            if (aResult < 0)
+            {
+                if (errno != EINTR)
+                {
+                    NSLog(@"ERR: Unable to append to journal %@ (errno: %d) (%@, %d)", aFileURL, errno, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                    break;
+                }
+            }
+            else
+            {
+                aWrittenLength += (NSUInteger)aResult;
+            }
+        }
+        close(aFileDescriptor);
+    }
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.fileURL forKey:@"fileURL"];
+    [aDescriptionDict setObject:@(self.recordsCount) forKey:@"recordsCount"];
+    [aDescriptionDict setObject:@(self.entriesDictionary.count) forKey:@"entriesCount"];
+    [aDescriptionDict setObject:@(self.pendingRecordsData.length) forKey:@"pendingBytesCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,142 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadLoopbackTransport.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadTransport.h"
+
+
+/**
+ HWIFileDownloadLoopbackTransport is an in-memory transport producing synthetic data.
+ @discussion Each transfer responds after the latency with the status code and delivers fileSize bytes (zero-filled or of payloadData) in chunks of chunkSize bytes at bytesPerSecond. No network and no run loop is used, so the downloader can be measured without network and outside of an app. Like an HTTP server the transport answers byte range requests (206), conditional requests matching the ETag (304) and can omit the content length (as with chunked encoding). Faults (server errors, connection resets, stalls) are injected at random with the configured rates. Settings apply to transfers started afterwards.
+ */
+@interface HWIFileDownloadLoopbackTransport : NSObject <HWIFileDownloadTransport>
+
+/**
+ Secondary initializer.
+ @param aBytesPerSecond Transfer rate of each transfer (0: as fast as possible).
+ @param aLatency Delay until the response of a transfer.
+ @return Loopback transport.
+ */
+- (nonnull instancetype)initWithBytesPerSecond:(int64_t)aBytesPerSecond latency:(NSTimeInterval)aLatency;
+
+/**
+ Designated initializer with default settings (as fast as possible, no latency).
+ @return Loopback transport.
+ */
+- (nonnull instancetype)init NS_DESIGNATED_INITIALIZER;
+
+
+/**
+ Transfer rate of each transfer in bytes per second (default: 0, as fast as possible).
+ */
+@property (nonatomic, assign) int64_t bytesPerSecond;
+
+/**
+ Delay until the response of a transfer (default: 0.0).
+ */
+@property (nonatomic, assign) NSTimeInterval latency;
+
+/**
+ Number of bytes delivered per transfer (default: 1 MiB).
+ */
+@property (nonatomic, assign) int64_t fileSize;
+
+/**
+ Number of bytes delivered per chunk (default: 64 KiB).
+ */
+@property (nonatomic, assign) NSUInteger chunkSize;
+
+/**
+ Contents delivered by each transfer (default: nil, zero-filled data). Setting it sets fileSize to its length, e.g. for compressed data decoded by a transform.
+ */
+@property (nonatomic, copy, nullable) NSData *payloadData;
+
+/**
+ HTTP status code of the responses (default: 200).
+ */
+@property (nonatomic, assign) NSInteger statusCode;
+
+/**
+ ETag of the responses (default: nil). Requests with a matching If-None-Match header are answered with 304 (Not Modified).
+ */
+@property (nonatomic, copy, nullable) NSString *eTag;
+
+/**
+ Flag whether requests with a Range header (bytes=offset-) are answered with 206 (Partial Content) (default: YES).
+ */
+@property (nonatomic, assign) BOOL supportsByteRanges;
+
+/**
+ Flag whether responses contain a Content-Length header (default: YES). Without it the expected size is unknown, as with chunked encoding.
+ */
+@property (nonatomic, assign) BOOL sendsContentLength;
+
+/**
+ Share of transfers answered with 503 (Service Unavailable) and no data (range 0.0 ... 1.0, default: 0.0).
+ */
+@property (nonatomic, assign) double serverErrorRate;
+
+/**
+ Share of transfers failing with NSURLErrorNetworkConnectionLost at a random offset (range 0.0 ... 1.0, default: 0.0).
+ */
+@property (nonatomic, assign) double resetRate;
+
+/**
+ Share of transfers stalling once at a random offset for stallDuration (range 0.0 ... 1.0, default: 0.0).
+ */
+@property (nonatomic, assign) double stallRate;
+
+/**
+ Duration of a stall (default: 1.0).
+ */
+@property (nonatomic, assign) NSTimeInterval stallDuration;
+
+/**
+ Number of bytes delivered by all transfers.
+ */
+@property (nonatomic, assign, readonly) int64_t deliveredBytesCount;
+
+/**
+ Number of transfers started.
+ */
+@property (nonatomic, assign, readonly) NSUInteger startedTransfersCount;
+
+/**
+ Number of injected faults (server errors, resets and stalls).
+ */
+@property (nonatomic, assign, readonly) NSUInteger injectedFaultsCount;
+
+@end
@@ -0,0 +1,664 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadLoopbackTransport.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadLoopbackTransport.h"
+
+
+/**
+ HWIFileDownloadLoopbackTransfer is used internally by HWIFileDownloadLoopbackTransport.
+ */
+@interface HWIFileDownloadLoopbackTransfer : NSObject
+@property (nonatomic, strong, nonnull) NSURLRequest *request;
+@property (nonatomic, assign) int64_t fileSize;
+@property (nonatomic, strong, nullable) NSData *payloadData;
+@property (nonatomic, assign) int64_t sentBytesCount; // including the offset of a byte range
+@property (nonatomic, assign) int64_t resetOffset; // -1: no reset
+@property (nonatomic, assign) int64_t stallOffset; // -1: no stall
+@property (nonatomic, assign) NSTimeInterval stallDuration;
+@property (nonatomic, assign) NSUInteger chunkSize;
+@property (nonatomic, assign) NSTimeInterval chunkInterval;
+@property (nonatomic, assign) NSInteger statusCode;
+@property (nonatomic, strong, nonnull) NSDictionary<NSString *, NSString *> *responseHeaderFieldsDictionary;
+@property (nonatomic, assign) BOOL isResponseSent;
+@property (nonatomic, assign) BOOL isSuspended;
+@property (nonatomic, assign) BOOL isStepScheduled;
+@end
+
+
+@implementation HWIFileDownloadLoopbackTransfer
+@end
+
+
+@interface HWIFileDownloadLoopbackTransport()
+@property (nonatomic, strong, nonnull) dispatch_queue_t loopbackDispatchQueue;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSNumber *, HWIFileDownloadLoopbackTransfer *> *transfersDictionary;
+@property (nonatomic, strong, nullable) NSData *chunkData; // shared zero-filled chunk
+@property (nonatomic, weak, nullable) id<HWIFileDownloadTransportDelegate> transportDelegate;
+@property (nonatomic, strong, nullable) dispatch_queue_t transportDelegateQueue;
+@property (nonatomic, assign) int64_t deliveredBytesCountValue;
+@property (nonatomic, assign) NSUInteger startedTransfersCountValue;
+@property (nonatomic, assign) NSUInteger injectedFaultsCountValue;
+@end
+
+
+@implementation HWIFileDownloadLoopbackTransport
+
+@synthesize bytesPerSecond = _bytesPerSecond;
+@synthesize latency = _latency;
+@synthesize fileSize = _fileSize;
+@synthesize chunkSize = _chunkSize;
+@synthesize payloadData = _payloadData;
+@synthesize statusCode = _statusCode;
+@synthesize eTag = _eTag;
+@synthesize supportsByteRanges = _supportsByteRanges;
+@synthesize sendsContentLength = _sendsContentLength;
+@synthesize serverErrorRate = _serverErrorRate;
+@synthesize resetRate = _resetRate;
+@synthesize stallRate = _stallRate;
+@synthesize stallDuration = _stallDuration;
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithBytesPerSecond:(int64_t)aBytesPerSecond latency:(NSTimeInterval)aLatency
+{
+    self = [self init];
+    if (self)
+    {
+        _bytesPerSecond = MAX(aBytesPerSecond, 0);
+        _latency = MAX(aLatency, 0.0);
+    }
+    return self;
+}
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.loopbackDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.loopbackTransport", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+        self.transfersDictionary = [NSMutableDictionary dictionary];
+        _bytesPerSecond = 0;
+        _latency = 0.0;
+        _fileSize = 1024 * 1024;
+        _chunkSize = 64 * 1024;
+        _statusCode = 200;
+        _supportsByteRanges = YES;
+        _sendsContentLength = YES;
+        _serverErrorRate = 0.0;
+        _resetRate = 0.0;
+        _stallRate = 0.0;
+        _stallDuration = 1.0;
+        self.deliveredBytesCountValue = 0;
+        self.startedTransfersCountValue = 0;
+        self.injectedFaultsCountValue = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Settings
+
+
+- (void)setBytesPerSecond:(int64_t)aBytesPerSecond
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _bytesPerSecond = MAX(aBytesPerSecond, 0);
+    });
+}
+
+
+- (int64_t)bytesPerSecond
+{
+    __block int64_t aBytesPerSecond = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aBytesPerSecond = _bytesPerSecond;
+    });
+    return aBytesPerSecond;
+}
+
+
+- (void)setLatency:(NSTimeInterval)aLatency
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _latency = MAX(aLatency, 0.0);
+    });
+}
+
+
+- (NSTimeInterval)latency
+{
+    __block NSTimeInterval aLatency = 0.0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aLatency = _latency;
+    });
+    return aLatency;
+}
+
+
+- (void)setFileSize:(int64_t)aFileSize
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _fileSize = MAX(aFileSize, 0);
+    });
+}
+
+
+- (int64_t)fileSize
+{
+    __block int64_t aFileSize = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aFileSize = _fileSize;
+    });
+    return aFileSize;
+}
+
+
+- (void)setPayloadData:(nullable NSData *)aPayloadData
+{
+    NSData *aCopiedPayloadData = [aPayloadData copy];
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _payloadData = aCopiedPayloadData;
+        if (aCopiedPayloadData)
+        {
+            _fileSize = (int64_t)aCopiedPayloadData.length;
+        }
+    });
+}
+
+
+- (nullable NSData *)payloadData
+{
+    __block NSData *aPayloadData = nil;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aPayloadData = _payloadData;
+    });
+    return aPayloadData;
+}
+
+
+- (void)setChunkSize:(NSUInteger)aChunkSize
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _chunkSize = MAX(aChunkSize, (NSUInteger)1);
+    });
+}
+
+
+- (NSUInteger)chunkSize
+{
+    __block NSUInteger aChunkSize = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aChunkSize = _chunkSize;
+    });
+    return aChunkSize;
+}
+
+
+- (void)setStatusCode:(NSInteger)aStatusCode
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _statusCode = aStatusCode;
+    });
+}
+
+
+- (NSInteger)statusCode
+{
+    __block NSInteger aStatusCode = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aStatusCode = _statusCode;
+    });
+    return aStatusCode;
+}
+
+
+- (void)setETag:(nullable NSString *)anETag
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _eTag = [anETag copy];
+    });
+}
+
+
+- (nullable NSString *)eTag
+{
+    __block NSString *anETag = nil;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        anETag = _eTag;
+    });
+    return anETag;
+}
+
+
+- (void)setSupportsByteRanges:(BOOL)aSupportsByteRangesFlag
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _supportsByteRanges = aSupportsByteRangesFlag;
+    });
+}
+
+
+- (BOOL)supportsByteRanges
+{
+    __block BOOL aSupportsByteRangesFlag = NO;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aSupportsByteRangesFlag = _supportsByteRanges;
+    });
+    return aSupportsByteRangesFlag;
+}
+
+
+- (void)setSendsContentLength:(BOOL)aSendsContentLengthFlag
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _sendsContentLength = aSendsContentLengthFlag;
+    });
+}
+
+
+- (BOOL)sendsContentLength
+{
+    __block BOOL aSendsContentLengthFlag = NO;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aSendsContentLengthFlag = _sendsContentLength;
+    });
+    return aSendsContentLengthFlag;
+}
+
+
+- (void)setServerErrorRate:(double)aServerErrorRate
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _serverErrorRate = MIN(MAX(aServerErrorRate, 0.0), 1.0);
+    });
+}
+
+
+- (double)serverErrorRate
+{
+    __block double aServerErrorRate = 0.0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aServerErrorRate = _serverErrorRate;
+    });
+    return aServerErrorRate;
+}
+
+
+- (void)setResetRate:(double)aResetRate
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _resetRate = MIN(MAX(aResetRate, 0.0), 1.0);
+    });
+}
+
+
+- (double)resetRate
+{
+    __block double aResetRate = 0.0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aResetRate = _resetRate;
+    });
+    return aResetRate;
+}
+
+
+- (void)setStallRate:(double)aStallRate
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _stallRate = MIN(MAX(aStallRate, 0.0), 1.0);
+    });
+}
+
+
+- (double)stallRate
+{
+    __block double aStallRate = 0.0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aStallRate = _stallRate;
+    });
+    return aStallRate;
+}
+
+
+- (void)setStallDuration:(NSTimeInterval)aStallDuration
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        _stallDuration = MAX(aStallDuration, 0.0);
+    });
+}
+
+
+- (NSTimeInterval)stallDuration
+{
+    __block NSTimeInterval aStallDuration = 0.0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aStallDuration = _stallDuration;
+    });
+    return aStallDuration;
+}
+
+
+#pragma mark - Statistics
+
+
+- (int64_t)deliveredBytesCount
+{
+    __block int64_t aDeliveredBytesCount = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aDeliveredBytesCount = self.deliveredBytesCountValue;
+    });
+    return aDeliveredBytesCount;
+}
+
+
+- (NSUInteger)startedTransfersCount
+{
+    __block NSUInteger aStartedTransfersCount = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        aStartedTransfersCount = self.startedTransfersCountValue;
+    });
+    return aStartedTransfersCount;
+}
+
+
+- (NSUInteger)injectedFaultsCount
+{
+    __block NSUInteger anInjectedFaultsCount = 0;
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        anInjectedFaultsCount = self.injectedFaultsCountValue;
+    });
+    return anInjectedFaultsCount;
+}
+
+
+#pragma mark - HWIFileDownloadTransport
+
+
+- (void)setTransportDelegate:(nullable id<HWIFileDownloadTransportDelegate>)aDelegate delegateQueue:(nonnull dispatch_queue_t)aDelegateQueue
+{
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        self.transportDelegate = aDelegate;
+        self.transportDelegateQueue = aDelegateQueue;
+    });
+}
+
+
+- (void)startTransferWithIdentifier:(NSUInteger)aTransferID request:(nonnull NSURLRequest *)aRequest
+{
+    dispatch_async(self.loopbackDispatchQueue, ^{
+        HWIFileDownloadLoopbackTransfer *aTransfer = [[HWIFileDownloadLoopbackTransfer alloc] init];
+        aTransfer.request = aRequest;
+        aTransfer.fileSize = _fileSize;
+        aTransfer.payloadData = _payloadData;
+        aTransfer.sentBytesCount = 0;
+        aTransfer.resetOffset = -1;
+        aTransfer.stallOffset = -1;
+        aTransfer.stallDuration = _stallDuration;
+        aTransfer.chunkSize = _chunkSize;
+        aTransfer.chunkInterval = (_bytesPerSecond > 0) ? ((NSTimeInterval)_chunkSize / (NSTimeInterval)_bytesPerSecond) : 0.0;
+        aTransfer.statusCode = _statusCode;
+        NSString *anIfNoneMatchString = [aRequest valueForHTTPHeaderField:@"If-None-Match"];
+        int64_t aRangeOffset = _supportsByteRanges ? [HWIFileDownloadLoopbackTransport offsetOfByteRangeHeader:[aRequest valueForHTTPHeaderField:@"Range"]] : -1;
+        if ([HWIFileDownloadLoopbackTransport randomEventWithRate:_serverErrorRate])
+        {
+            aTransfer.statusCode = 503;
+            aTransfer.sentBytesCount = aTransfer.fileSize;
+            self.injectedFaultsCountValue++;
+        }
+        else if (_eTag && [anIfNoneMatchString isEqualToString:_eTag])
+        {
+            aTransfer.statusCode = 304;
+            aTransfer.sentBytesCount = aTransfer.fileSize;
+        }
+        else if ((aRangeOffset >= 0) && (aRangeOffset < aTransfer.fileSize))
+        {
+            aTransfer.statusCode = 206;
+            aTransfer.sentBytesCount = aRangeOffset;
+        }
+        int64_t aRemainingBytesCount = aTransfer.fileSize - aTransfer.sentBytesCount;
+        if ((aRemainingBytesCount > 0) && [HWIFileDownloadLoopbackTransport randomEventWithRate:_resetRate])
+        {
+            aTransfer.resetOffset = aTransfer.sentBytesCount + (int64_t)arc4random_uniform((uint32_t)MIN(aRemainingBytesCount, (int64_t)UINT32_MAX));
+        }
+        if ((aRemainingBytesCount > 0) && [HWIFileDownloadLoopbackTransport randomEventWithRate:_stallRate])
+        {
+            aTransfer.stallOffset = aTransfer.sentBytesCount + (int64_t)arc4random_uniform((uint32_t)MIN(aRemainingBytesCount, (int64_t)UINT32_MAX));
+        }
+        NSMutableDictionary<NSString *, NSString *> *aHeaderFieldsDictionary = [NSMutableDictionary dictionary];
+        if (_sendsContentLength)
+        {
+            [aHeaderFieldsDictionary setObject:[NSString stringWithFormat:@"%lld", aRemainingBytesCount] forKey:@"Content-Length"];
+        }
+        if (aTransfer.statusCode == 206)
+        {
+            [aHeaderFieldsDictionary setObject:[NSString stringWithFormat:@"bytes %lld-%lld/%lld", aTransfer.sentBytesCount, aTransfer.fileSize - 1, aTransfer.fileSize] forKey:@"Content-Range"];
+        }
+        if (_supportsByteRanges)
+        {
+            [aHeaderFieldsDictionary setObject:@"bytes" forKey:@"Accept-Ranges"];
+        }
+        if (_eTag)
+        {
+            [aHeaderFieldsDictionary setObject:_eTag forKey:@"ETag"];
+        }
+        aTransfer.responseHeaderFieldsDictionary = aHeaderFieldsDictionary;
+        aTransfer.isResponseSent = NO;
+        aTransfer.isSuspended = NO;
+        aTransfer.isStepScheduled = NO;
+        if ((self.chunkData == nil) || (self.chunkData.length != _chunkSize))
+        {
+            self.chunkData = [NSMutableData dataWithLength:_chunkSize];
+        }
+        [self.transfersDictionary setObject:aTransfer forKey:@(aTransferID)];
+        self.startedTransfersCountValue++;
+        [self scheduleStepOfTransfer:aTransfer transferID:aTransferID afterDelay:_latency];
+    });
+}
+
+
+- (void)suspendTransferWithIdentifier:(NSUInteger)aTransferID
+{
+    dispatch_async(self.loopbackDispatchQueue, ^{
+        HWIFileDownloadLoopbackTransfer *aTransfer = [self.transfersDictionary objectForKey:@(aTransferID)];
+        aTransfer.isSuspended = YES;
+    });
+}
+
+
+- (void)resumeTransferWithIdentifier:(NSUInteger)aTransferID
+{
+    dispatch_async(self.loopbackDispatchQueue, ^{
+        HWIFileDownloadLoopbackTransfer *aTransfer = [self.transfersDictionary objectForKey:@(aTransferID)];
+        if (aTransfer.isSuspended)
+        {
+            aTransfer.isSuspended = NO;
+            [self scheduleStepOfTransfer:aTransfer transferID:aTransferID afterDelay:aTransfer.chunkInterval];
+        }
+    });
+}
+
+
+- (void)cancelTransferWithIdentifier:(NSUInteger)aTransferID
+{
+    dispatch_async(self.loopbackDispatchQueue, ^{
+        [self.transfersDictionary removeObjectForKey:@(aTransferID)];
+    });
+}
+
+
+#pragma mark - Transfer Steps
+
+
+- (void)scheduleStepOfTransfer:(nonnull HWIFileDownloadLoopbackTransfer *)aTransfer transferID:(NSUInteger)aTransferID afterDelay:(NSTimeInterval)aDelay
+{
+    // called on loopbackDispatchQueue
+    if (aTransfer.isStepScheduled == NO)
+    {
+        aTransfer.isStepScheduled = YES;
+        __weak HWIFileDownloadLoopbackTransport *weakSelf = self;
+        dispatch_block_t aStepBlock = ^{
+            HWIFileDownloadLoopbackTransport *strongSelf = weakSelf;
+            aTransfer.isStepScheduled = NO;
+            [strongSelf performStepOfTransfer:aTransfer transferID:aTransferID];
+        };
+        if (aDelay > 0.0)
+        {
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(aDelay * NSEC_PER_SEC)), self.loopbackDispatchQueue, aStepBlock);
+        }
+        else
+        {
+            dispatch_async(self.loopbackDispatchQueue, aStepBlock);
+        }
+    }
+}
+
+
+- (void)performStepOfTransfer:(nonnull HWIFileDownloadLoopbackTransfer *)aTransfer transferID:(NSUInteger)aTransferID
+{
+    // called on loopbackDispatchQueue
+    if (([self.transfersDictionary objectForKey:@(aTransferID)] != aTransfer) || aTransfer.isSuspended)
+    {
+        // cancelled meanwhile or continued on resume
+        return;
+    }
+    id<HWIFileDownloadTransportDelegate> aDelegate = self.transportDelegate;
+    dispatch_queue_t aDelegateQueue = self.transportDelegateQueue;
+    if (aTransfer.isResponseSent == NO)
+    {
+        aTransfer.isResponseSent = YES;
+        NSHTTPURLResponse *aResponse = [[NSHTTPURLResponse alloc] initWithURL:aTransfer.request.URL statusCode:aTransfer.statusCode HTTPVersion:@"HTTP/1.1" headerFields:aTransfer.responseHeaderFieldsDictionary];
+        dispatch_async(aDelegateQueue, ^{
+            [aDelegate transport:self transferWithIdentifier:aTransferID didReceiveResponse:aResponse];
+        });
+        [self scheduleStepOfTransfer:aTransfer transferID:aTransferID afterDelay:0.0];
+    }
+    else if ((aTransfer.resetOffset >= 0) && (aTransfer.sentBytesCount >= aTransfer.resetOffset))
+    {
+        [self.transfersDictionary removeObjectForKey:@(aTransferID)];
+        self.injectedFaultsCountValue++;
+        NSError *aResetError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:@{NSURLErrorFailingURLErrorKey: aTransfer.request.URL}];
+        dispatch_async(aDelegateQueue, ^{
+            [aDelegate transport:self transferWithIdentifier:aTransferID didCompleteWithError:aResetError];
+        });
+    }
+    else if ((aTransfer.stallOffset >= 0) && (aTransfer.sentBytesCount >= aTransfer.stallOffset))
+    {
+        aTransfer.stallOffset = -1;
+        self.injectedFaultsCountValue++;
+        [self scheduleStepOfTransfer:aTransfer transferID:aTransferID afterDelay:aTransfer.stallDuration];
+    }
+    else if (aTransfer.sentBytesCount < aTransfer.fileSize)
+    {
+        int64_t aChunkLength = MIN((int64_t)aTransfer.chunkSize, aTransfer.fileSize - aTransfer.sentBytesCount);
+        NSData *aChunkData = self.chunkData;
+        if (aTransfer.payloadData && ((aTransfer.sentBytesCount + aChunkLength) <= (int64_t)aTransfer.payloadData.length))
+        {
+            aChunkData = [aTransfer.payloadData subdataWithRange:NSMakeRange((NSUInteger)aTransfer.sentBytesCount, (NSUInteger)aChunkLength)];
+        }
+        else if ((NSUInteger)aChunkLength != aChunkData.length)
+        {
+            aChunkData = [NSMutableData dataWithLength:(NSUInteger)aChunkLength];
+        }
+        aTransfer.sentBytesCount += aChunkLength;
+        self.deliveredBytesCountValue += aChunkLength;
+        dispatch_async(aDelegateQueue, ^{
+            [aDelegate transport:self transferWithIdentifier:aTransferID didReceiveData:aChunkData];
+        });
+        [self scheduleStepOfTransfer:aTransfer transferID:aTransferID afterDelay:aTransfer.chunkInterval];
+    }
+    else
+    {
+        [self.transfersDictionary removeObjectForKey:@(aTransferID)];
+        dispatch_async(aDelegateQueue, ^{
+            [aDelegate transport:self transferWithIdentifier:aTransferID didCompleteWithError:nil];
+        });
+    }
+}
+
+
+#pragma mark - Utilities
+
+
++ (int64_t)offsetOfByteRangeHeader:(nullable NSString *)aRangeHeaderString
+{
+    // only open ranges (bytes=offset-) are answered; -1: no range
+    int64_t anOffset = -1;
+    if ([aRangeHeaderString hasPrefix:@"bytes="] && [aRangeHeaderString hasSuffix:@"-"])
+    {
+        NSString *anOffsetString = [aRangeHeaderString substringWithRange:NSMakeRange(6, aRangeHeaderString.length - 7)];
+        NSScanner *aScanner = [NSScanner scannerWithString:anOffsetString];
+        long long aScannedOffset = 0;
+        if ([aScanner scanLongLong:&aScannedOffset] && aScanner.isAtEnd && (aScannedOffset >= 0))
+        {
+            anOffset = aScannedOffset;
+        }
+    }
+    return anOffset;
+}
+
+
++ (BOOL)randomEventWithRate:(double)aRate
+{
+    return (aRate > 0.0) && ((double)arc4random_uniform(1000000) < (aRate * 1000000.0));
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    dispatch_sync(self.loopbackDispatchQueue, ^{
+        [aDescriptionDict setObject:@(_bytesPerSecond) forKey:@"bytesPerSecond"];
+        [aDescriptionDict setObject:@(_latency) forKey:@"latency"];
+        [aDescriptionDict setObject:@(_fileSize) forKey:@"fileSize"];
+        [aDescriptionDict setObject:@(_chunkSize) forKey:@"chunkSize"];
+        [aDescriptionDict setObject:@(_statusCode) forKey:@"statusCode"];
+        [aDescriptionDict setObject:@(self.transfersDictionary.count) forKey:@"transfersCount"];
+        [aDescriptionDict setObject:@(self.deliveredBytesCountValue) forKey:@"deliveredBytesCount"];
+        [aDescriptionDict setObject:@(self.startedTransfersCountValue) forKey:@"startedTransfersCount"];
+        [aDescriptionDict setObject:@(self.injectedFaultsCountValue) forKey:@"injectedFaultsCount"];
+    });
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
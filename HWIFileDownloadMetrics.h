@@ -0,0 +1,107 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadMetrics.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadMetrics are the timing phases of a finished (completed or failed) download.
+ @discussion Durations are in seconds; phases that are not known are negative. DNS, connect and TLS durations are available from NSURLSession on iOS 10 (and later); they are zero for a reused connection.
+ */
+@interface HWIFileDownloadMetrics : NSObject
+
+/**
+ Designated initializer.
+ @param aHost Host of the remote URL.
+ @param aQueueWaitTime Time waiting for a free download slot.
+ @param aDomainLookupDuration Duration of the DNS lookup.
+ @param aConnectDuration Duration of establishing the connection (including TLS).
+ @param aSecureConnectionDuration Duration of the TLS handshake.
+ @param aTimeToFirstByte Time from sending the request until the first byte of the response.
+ @param aTransferDuration Time from the first until the last byte of the response.
+ @param aReceivedBytesCount Number of bytes received.
+ @param aRedirectsCount Number of redirects followed.
+ @return Download metrics.
+ */
+- (nonnull instancetype)initWithHost:(nullable NSString *)aHost
+                       queueWaitTime:(NSTimeInterval)aQueueWaitTime
+                domainLookupDuration:(NSTimeInterval)aDomainLookupDuration
+                     connectDuration:(NSTimeInterval)aConnectDuration
+            secureConnectionDuration:(NSTimeInterval)aSecureConnectionDuration
+                     timeToFirstByte:(NSTimeInterval)aTimeToFirstByte
+                    transferDuration:(NSTimeInterval)aTransferDuration
+                  receivedBytesCount:(int64_t)aReceivedBytesCount
+                      redirectsCount:(NSUInteger)aRedirectsCount;
+- (nonnull instancetype)init __attribute__((unavailable("use initWithHost:queueWaitTime:domainLookupDuration:connectDuration:secureConnectionDuration:timeToFirstByte:transferDuration:receivedBytesCount:redirectsCount:")));
++ (nonnull instancetype)new __attribute__((unavailable("use initWithHost:queueWaitTime:domainLookupDuration:connectDuration:secureConnectionDuration:timeToFirstByte:transferDuration:receivedBytesCount:redirectsCount:")));
+
+/**
+ Host of the remote URL.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *host;
+/**
+ Time waiting for a free download slot (0.0 if started immediately).
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval queueWaitTime;
+/**
+ Duration of the DNS lookup.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval domainLookupDuration;
+/**
+ Duration of establishing the connection (including TLS).
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval connectDuration;
+/**
+ Duration of the TLS handshake.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval secureConnectionDuration;
+/**
+ Time from sending the request until the first byte of the response.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval timeToFirstByte;
+/**
+ Time from the first until the last byte of the response.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval transferDuration;
+/**
+ Number of bytes received.
+ */
+@property (nonatomic, assign, readonly) int64_t receivedBytesCount;
+/**
+ Number of redirects followed.
+ */
+@property (nonatomic, assign, readonly) NSUInteger redirectsCount;
+
+@end
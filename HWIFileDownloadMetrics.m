@@ -0,0 +1,109 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadMetrics.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadMetrics.h"
+
+
+@interface HWIFileDownloadMetrics()
+@property (nonatomic, copy, readwrite, nullable) NSString *host;
+@property (nonatomic, assign, readwrite) NSTimeInterval queueWaitTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval domainLookupDuration;
+@property (nonatomic, assign, readwrite) NSTimeInterval connectDuration;
+@property (nonatomic, assign, readwrite) NSTimeInterval secureConnectionDuration;
+@property (nonatomic, assign, readwrite) NSTimeInterval timeToFirstByte;
+@property (nonatomic, assign, readwrite) NSTimeInterval transferDuration;
+@property (nonatomic, assign, readwrite) int64_t receivedBytesCount;
+@property (nonatomic, assign, readwrite) NSUInteger redirectsCount;
+@end
+
+
+@implementation HWIFileDownloadMetrics
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithHost:(nullable NSString *)aHost
+                       queueWaitTime:(NSTimeInterval)aQueueWaitTime
+                domainLookupDuration:(NSTimeInterval)aDomainLookupDuration
+                     connectDuration:(NSTimeInterval)aConnectDuration
+            secureConnectionDuration:(NSTimeInterval)aSecureConnectionDuration
+                     timeToFirstByte:(NSTimeInterval)aTimeToFirstByte
+                    transferDuration:(NSTimeInterval)aTransferDuration
+                  receivedBytesCount:(int64_t)aReceivedBytesCount
+                      redirectsCount:(NSUInteger)aRedirectsCount
+{
+    self = [super init];
+    if (self)
+    {
+        self.host = aHost;
+        self.queueWaitTime = aQueueWaitTime;
+        self.domainLookupDuration = aDomainLookupDuration;
+        self.connectDuration = aConnectDuration;
+        self.secureConnectionDuration = aSecureConnectionDuration;
+        self.timeToFirstByte = aTimeToFirstByte;
+        self.transferDuration = aTransferDuration;
+        self.receivedBytesCount = aReceivedBytesCount;
+        self.redirectsCount = aRedirectsCount;
+    }
+    return self;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    if (self.host)
+    {
+        [aDescriptionDict setObject:self.host forKey:@"host"];
+    }
+    [aDescriptionDict setObject:@(self.queueWaitTime) forKey:@"queueWaitTime"];
+    [aDescriptionDict setObject:@(self.domainLookupDuration) forKey:@"domainLookupDuration"];
+    [aDescriptionDict setObject:@(self.connectDuration) forKey:@"connectDuration"];
+    [aDescriptionDict setObject:@(self.secureConnectionDuration) forKey:@"secureConnectionDuration"];
+    [aDescriptionDict setObject:@(self.timeToFirstByte) forKey:@"timeToFirstByte"];
+    [aDescriptionDict setObject:@(self.transferDuration) forKey:@"transferDuration"];
+    [aDescriptionDict setObject:@(self.receivedBytesCount) forKey:@"receivedBytesCount"];
+    [aDescriptionDict setObject:@(self.redirectsCount) forKey:@"redirectsCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
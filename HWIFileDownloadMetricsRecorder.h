@@ -0,0 +1,65 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadMetricsRecorder.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+@class HWIFileDownloadMetrics;
+
+
+/**
+ HWIFileDownloadMetricsRecorder aggregates download metrics in histograms per host and phase. It is used internally by HWIFileDownloader.
+ @discussion Histograms have fixed logarithmic buckets (8 per power of two, from 1 microsecond to more than an hour), so recording does not allocate memory once a host is known and percentiles have a relative error of less than 9 %. Negative (unknown) durations are not recorded. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadMetricsRecorder : NSObject
+
+/**
+ Adds the durations of download metrics to the histograms of their host.
+ @param aMetrics Download metrics.
+ */
+- (void)recordMetrics:(nonnull HWIFileDownloadMetrics *)aMetrics;
+
+/**
+ Percentiles of all recorded phases.
+ @return Dictionary by host with dictionaries by phase (queueWaitTime, domainLookupDuration, connectDuration, secureConnectionDuration, timeToFirstByte, transferDuration) with the keys count, p50, p95 and p99 (seconds).
+ */
+- (nonnull NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *)percentilesDictionary;
+
+/**
+ Removes all recorded durations.
+ */
+- (void)removeAllMetrics;
+
+@end
@@ -0,0 +1,185 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadMetricsRecorder.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadMetricsRecorder.h"
+#import "HWIFileDownloadMetrics.h"
+
+
+#define HWIFileDownloadHistogramBucketsCount 256
+static const double HWIFileDownloadHistogramBucketsPerPowerOfTwo = 8.0;
+
+
+@interface HWIFileDownloadHistogram : NSObject
+{
+    uint64_t _bucketCounts[HWIFileDownloadHistogramBucketsCount]; // bucket 0: below 1 microsecond
+}
+@property (nonatomic, assign) uint64_t count;
+@end
+
+
+@implementation HWIFileDownloadHistogram
+
+
+- (void)addDuration:(NSTimeInterval)aDuration
+{
+    double aMicroseconds = aDuration * 1000000.0;
+    NSUInteger aBucketIndex = 0;
+    if (aMicroseconds >= 1.0)
+    {
+        aBucketIndex = MIN((NSUInteger)(log2(aMicroseconds) * HWIFileDownloadHistogramBucketsPerPowerOfTwo) + 1, (NSUInteger)(HWIFileDownloadHistogramBucketsCount - 1));
+    }
+    _bucketCounts[aBucketIndex]++;
+    self.count++;
+}
+
+
+- (NSTimeInterval)durationAtPercentile:(double)aPercentile
+{
+    // upper bound of the bucket containing the percentile
+    NSTimeInterval aDuration = 0.0;
+    if (self.count > 0)
+    {
+        uint64_t aRank = MAX((uint64_t)ceil(aPercentile / 100.0 * (double)self.count), (uint64_t)1);
+        uint64_t aCumulativeCount = 0;
+        for (NSUInteger aBucketIndex = 0; aBucketIndex < HWIFileDownloadHistogramBucketsCount; aBucketIndex++)
+        {
+            aCumulativeCount += _bucketCounts[aBucketIndex];
+            if (aCumulativeCount >= aRank)
+            {
+                aDuration = (aBucketIndex == 0) ? 0.000001 : (exp2((double)aBucketIndex / HWIFileDownloadHistogramBucketsPerPowerOfTwo) / 1000000.0);
+                break;
+            }
+        }
+    }
+    return aDuration;
+}
+
+@end
+
+
+@interface HWIFileDownloadMetricsRecorder()
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSDictionary<NSString *, HWIFileDownloadHistogram *> *> *hostHistogramsDictionary;
+@end
+
+
+@implementation HWIFileDownloadMetricsRecorder
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.hostHistogramsDictionary = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+
+- (void)recordMetrics:(nonnull HWIFileDownloadMetrics *)aMetrics
+{
+    NSString *aHost = aMetrics.host ? aMetrics.host : @"";
+    NSDictionary<NSString *, HWIFileDownloadHistogram *> *aHistogramsDictionary = [self.hostHistogramsDictionary objectForKey:aHost];
+    if (aHistogramsDictionary == nil)
+    {
+        NSMutableDictionary<NSString *, HWIFileDownloadHistogram *> *aNewHistogramsDictionary = [NSMutableDictionary dictionary];
+        for (NSString *aPhase in [HWIFileDownloadMetricsRecorder phases])
+        {
+            [aNewHistogramsDictionary setObject:[[HWIFileDownloadHistogram alloc] init] forKey:aPhase];
+        }
+        aHistogramsDictionary = aNewHistogramsDictionary;
+        [self.hostHistogramsDictionary setObject:aHistogramsDictionary forKey:aHost];
+    }
+    NSTimeInterval aDurations[] = {aMetrics.queueWaitTime, aMetrics.domainLookupDuration, aMetrics.connectDuration, aMetrics.secureConnectionDuration, aMetrics.timeToFirstByte, aMetrics.transferDuration};
+    NSArray<NSString *> *aPhasesArray = [HWIFileDownloadMetricsRecorder phases];
+    for (NSUInteger aPhaseIndex = 0; aPhaseIndex < aPhasesArray.count; aPhaseIndex++)
+    {
+        if (aDurations[aPhaseIndex] >= 0.0)
+        {
+            [[aHistogramsDictionary objectForKey:[aPhasesArray objectAtIndex:aPhaseIndex]] addDuration:aDurations[aPhaseIndex]];
+        }
+    }
+}
+
+
+- (nonnull NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *)percentilesDictionary
+{
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *aPercentilesDictionary = [NSMutableDictionary dictionary];
+    [self.hostHistogramsDictionary enumerateKeysAndObjectsUsingBlock:^(NSString *aHost, NSDictionary<NSString *, HWIFileDownloadHistogram *> *aHistogramsDictionary, BOOL *aStopFlag) {
+        NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *aPhasesDictionary = [NSMutableDictionary dictionary];
+        [aHistogramsDictionary enumerateKeysAndObjectsUsingBlock:^(NSString *aPhase, HWIFileDownloadHistogram *aHistogram, BOOL *anotherStopFlag) {
+            if (aHistogram.count > 0)
+            {
+                [aPhasesDictionary setObject:@{@"count" : @(aHistogram.count),
+                                               @"p50" : @([aHistogram durationAtPercentile:50.0]),
+                                               @"p95" : @([aHistogram durationAtPercentile:95.0]),
+                                               @"p99" : @([aHistogram durationAtPercentile:99.0])}
+                                      forKey:aPhase];
+            }
+        }];
+        [aPercentilesDictionary setObject:aPhasesDictionary forKey:aHost];
+    }];
+    return aPercentilesDictionary;
+}
+
+
+- (void)removeAllMetrics
+{
+    [self.hostHistogramsDictionary removeAllObjects];
+}
+
+
++ (nonnull NSArray<NSString *> *)phases
+{
+    static NSArray<NSString *> *aPhasesArray = nil;
+    static dispatch_once_t aPhasesOnceToken;
+    dispatch_once(&aPhasesOnceToken, ^{
+        aPhasesArray = @[@"queueWaitTime", @"domainLookupDuration", @"connectDuration", @"secureConnectionDuration", @"timeToFirstByte", @"transferDuration"];
+    });
+    return aPhasesArray;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", [self percentilesDictionary]];
+    
+    return aDescriptionString;
+}
+
+@end
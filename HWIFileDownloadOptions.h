@@ -0,0 +1,115 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadOptions.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadPriority.h"
+#import "HWIFileDownloadDigest.h"
+#import "HWIFileDownloadRetryPolicy.h"
+#import "HWIFileDownloadStreamConsumer.h"
+#import "HWIFileDownloadTransform.h"
+
+
+/**
+ HWIFileDownloadOptions holds the options of an individual download.
+ @discussion Options are copied when a download is started. Later changes to the options object do not affect the started download.
+ */
+@interface HWIFileDownloadOptions : NSObject <NSCopying>
+
+/**
+ Priority of the download. Default: HWIFileDownloadPriorityDefault.
+ */
+@property (nonatomic, assign) HWIFileDownloadPriority priority;
+
+/**
+ Maximum number of byte range segments downloaded in parallel. Default: 1 (no segmentation).
+ @discussion If greater than 1 the remote host is asked with a HEAD request whether byte ranges are accepted. If so, the file is split into segments that are downloaded in parallel with data tasks of a foreground session; each received chunk is written into one preallocated file at its offset. Segmented downloads are available with NSURLSession (iOS 7 and later) only. They are not continued in the background; they are paused with resume data of the received ranges and continued after relaunch with a queue journal.
+ */
+@property (nonatomic, assign) NSUInteger segmentsCount;
+
+/**
+ Minimum size of a segment in bytes. Default: 4 MB.
+ @discussion The number of segments is reduced so that no segment is smaller than this size. Files smaller than twice this size are downloaded without segmentation.
+ */
+@property (nonatomic, assign) int64_t minimumSegmentSize;
+
+/**
+ Algorithm of the expected digest. Default: HWIFileDownloadDigestAlgorithmNone.
+ */
+@property (nonatomic, assign) HWIFileDownloadDigestAlgorithm digestAlgorithm;
+
+/**
+ Expected digest of the downloaded file (see HWIFileDownloadDigest digestWithHexString:). Default: nil (no verification).
+ @discussion With NSURLConnection (iOS 6) the digest is computed while the data is received, with NSURLSession in one pass over the downloaded file. On mismatch the download fails with NSURLErrorCannotDecodeRawData and the digests on the error messages stack. Downloads continued after the app has been relaunched are not verified.
+ */
+@property (nonatomic, strong, nullable) NSData *expectedDigest;
+
+/**
+ Tag of a group of downloads, e.g. the downloads of one album. Default: nil (no group).
+ @discussion The downloads of a group can be paused and cancelled together with pauseDownloadsWithGroupTag: and cancelDownloadsWithGroupTag: of HWIFileDownloader.
+ */
+@property (nonatomic, copy, nullable) NSString *groupTag;
+
+/**
+ Policy for retrying the download after a transient failure. Default: nil (no retry).
+ @discussion Retried downloads continue from their resume data (NSURLSession) or their partial file with a range request (NSURLConnection and custom transports, without expected digest). While waiting for a retry the download does not use a download slot. The delegate is only informed about the final outcome.
+ */
+@property (nonatomic, copy, nullable) HWIFileDownloadRetryPolicy *retryPolicy;
+
+/**
+ Consumer of the data of the download while it is received. Default: nil (no streaming).
+ @discussion Streamed downloads are transferred with a data task of a foreground session (NSURLSession), NSURLConnection (iOS 6) or the custom transport. They are not continued after the app has been terminated, not recorded in the queue journal, not completed from the download cache, not coalesced, not segmented and not retried.
+ */
+@property (nonatomic, strong, nullable) id<HWIFileDownloadStreamConsumer> streamConsumer;
+
+/**
+ Maximum number of bytes delivered to the stream consumer and not yet processed. Default: 2 MB.
+ @discussion The transfer is suspended when the backlog is reached and resumed when the consumer has processed half of it.
+ */
+@property (nonatomic, assign) int64_t maximumStreamBacklogSize;
+
+/**
+ Whether the streamed data is written to the local file as well. Default: YES.
+ @discussion Without local file the delegate is informed with streamedDownloadDidCompleteWithIdentifier: instead of downloadDidCompleteWithIdentifier:localFileURL:, and the expected digest is not verified.
+ */
+@property (nonatomic, assign) BOOL persistsStreamedData;
+
+/**
+ Decoding of the received data. Default: HWIFileDownloadTransformKindNone.
+ @discussion With NSURLConnection (iOS 6), streamed downloads and the custom transport the data is decoded while it is received, with NSURLSession in one pass over the downloaded file. A zip archive is extracted into a directory at the local file URL, the extracted files are reported with downloadDidExtractFilesWithIdentifier:fileURLs: of the delegate. The expected digest is verified against the received (encoded) data. On invalid data the download fails with NSURLErrorCannotDecodeContentData. Decoded downloads are not completed from the download cache, not coalesced and not continued from a partial file.
+ */
+@property (nonatomic, assign) HWIFileDownloadTransformKind transformKind;
+
+@end
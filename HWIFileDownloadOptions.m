@@ -0,0 +1,118 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadOptions.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadOptions.h"
+
+
+@implementation HWIFileDownloadOptions
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.priority = HWIFileDownloadPriorityDefault;
+        self.segmentsCount = 1;
+        self.minimumSegmentSize = 4 * 1024 * 1024;
+        self.digestAlgorithm = HWIFileDownloadDigestAlgorithmNone;
+        self.maximumStreamBacklogSize = 2 * 1024 * 1024;
+        self.persistsStreamedData = YES;
+        self.transformKind = HWIFileDownloadTransformKindNone;
+    }
+    return self;
+}
+
+
+#pragma mark - NSCopying
+
+
+- (nonnull id)copyWithZone:(nullable NSZone *)aZone
+{
+    HWIFileDownloadOptions *anOptionsCopy = [[[self class] allocWithZone:aZone] init];
+    anOptionsCopy.priority = self.priority;
+    anOptionsCopy.segmentsCount = self.segmentsCount;
+    anOptionsCopy.minimumSegmentSize = self.minimumSegmentSize;
+    anOptionsCopy.digestAlgorithm = self.digestAlgorithm;
+    anOptionsCopy.expectedDigest = [self.expectedDigest copy];
+    anOptionsCopy.groupTag = self.groupTag;
+    anOptionsCopy.retryPolicy = self.retryPolicy;
+    anOptionsCopy.streamConsumer = self.streamConsumer;
+    anOptionsCopy.maximumStreamBacklogSize = self.maximumStreamBacklogSize;
+    anOptionsCopy.persistsStreamedData = self.persistsStreamedData;
+    anOptionsCopy.transformKind = self.transformKind;
+    return anOptionsCopy;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.priority) forKey:@"priority"];
+    [aDescriptionDict setObject:@(self.segmentsCount) forKey:@"segmentsCount"];
+    [aDescriptionDict setObject:@(self.minimumSegmentSize) forKey:@"minimumSegmentSize"];
+    [aDescriptionDict setObject:@(self.digestAlgorithm) forKey:@"digestAlgorithm"];
+    if (self.expectedDigest)
+    {
+        [aDescriptionDict setObject:[HWIFileDownloadDigest hexStringWithDigest:self.expectedDigest] forKey:@"expectedDigest"];
+    }
+    if (self.groupTag)
+    {
+        [aDescriptionDict setObject:self.groupTag forKey:@"groupTag"];
+    }
+    if (self.retryPolicy)
+    {
+        [aDescriptionDict setObject:self.retryPolicy forKey:@"retryPolicy"];
+    }
+    if (self.streamConsumer)
+    {
+        [aDescriptionDict setObject:NSStringFromClass([self.streamConsumer class]) forKey:@"streamConsumer"];
+        [aDescriptionDict setObject:@(self.maximumStreamBacklogSize) forKey:@"maximumStreamBacklogSize"];
+        [aDescriptionDict setObject:@(self.persistsStreamedData) forKey:@"persistsStreamedData"];
+    }
+    [aDescriptionDict setObject:@(self.transformKind) forKey:@"transformKind"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,48 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadPriority.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadPriority determines the order in which waiting downloads are started.
+ @discussion Waiting downloads with a higher priority are started first. Downloads with the same priority are started in the order they have been queued.
+ */
+typedef NS_ENUM(NSInteger, HWIFileDownloadPriority) {
+    HWIFileDownloadPriorityBackground = 0,
+    HWIFileDownloadPriorityLow,
+    HWIFileDownloadPriorityDefault,
+    HWIFileDownloadPriorityHigh
+};
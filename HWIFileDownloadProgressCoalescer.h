@@ -0,0 +1,96 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadProgressCoalescer.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadProgressCoalescer collects progress changes of downloads and decides when they are due for delivery. It is used internally by HWIFileDownloader.
+ @discussion Any number of changes of a download between two deliveries result in one delivered change. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadProgressCoalescer : NSObject
+
+/**
+ Minimum time between two deliveries in seconds. Default: 0.0.
+ */
+@property (nonatomic, assign) NSTimeInterval deliveryInterval;
+
+/**
+ Minimum time between two deliveries of the same download in seconds. Default: 0.0.
+ */
+@property (nonatomic, assign) NSTimeInterval deliveryIntervalPerDownload;
+
+/**
+ YES if one of the delivery intervals is greater than 0.0.
+ */
+@property (nonatomic, assign, readonly) BOOL isEnabled;
+
+/**
+ Number of downloads with changes waiting for delivery.
+ */
+@property (nonatomic, assign, readonly) NSUInteger pendingDownloadTokensCount;
+
+/**
+ Number of changes that have been merged into another delivery or dropped.
+ */
+@property (nonatomic, assign, readonly) NSUInteger suppressedChangesCount;
+
+/**
+ Records a progress change.
+ @param aDownloadToken Download token of the changed download.
+ */
+- (void)addChangedDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Time until the next pending change is due.
+ @param aTime Current time (time interval since reference date).
+ @return Delay in seconds (0.0 if due now).
+ */
+- (NSTimeInterval)deliveryDelayAtTime:(NSTimeInterval)aTime;
+
+/**
+ Removes and returns the download tokens with changes due for delivery.
+ @param aTime Current time (time interval since reference date).
+ @return Download tokens (might be empty).
+ */
+- (nonnull NSArray<NSString *> *)removeDueDownloadTokensAtTime:(NSTimeInterval)aTime;
+
+/**
+ Drops pending changes and the delivery history of a finished download.
+ @param aDownloadToken Download token.
+ */
+- (void)removeDownloadToken:(nonnull NSString *)aDownloadToken;
+
+@end
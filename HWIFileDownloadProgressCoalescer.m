@@ -0,0 +1,172 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadProgressCoalescer.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadProgressCoalescer.h"
+
+
+@interface HWIFileDownloadProgressCoalescer()
+@property (nonatomic, strong, nonnull) NSMutableOrderedSet<NSString *> *pendingDownloadTokensOrderedSet;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSNumber *> *lastDeliveryTimesDictionary;
+@property (nonatomic, assign) NSTimeInterval lastDeliveryTime;
+@property (nonatomic, assign) NSUInteger changesCount;
+@property (nonatomic, assign) NSUInteger deliveredChangesCount;
+@end
+
+
+@implementation HWIFileDownloadProgressCoalescer
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.deliveryInterval = 0.0;
+        self.deliveryIntervalPerDownload = 0.0;
+        self.pendingDownloadTokensOrderedSet = [NSMutableOrderedSet orderedSet];
+        self.lastDeliveryTimesDictionary = [NSMutableDictionary dictionary];
+        self.lastDeliveryTime = 0.0;
+        self.changesCount = 0;
+        self.deliveredChangesCount = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Status
+
+
+- (BOOL)isEnabled
+{
+    return ((self.deliveryInterval > 0.0) || (self.deliveryIntervalPerDownload > 0.0));
+}
+
+
+- (NSUInteger)pendingDownloadTokensCount
+{
+    return self.pendingDownloadTokensOrderedSet.count;
+}
+
+
+- (NSUInteger)suppressedChangesCount
+{
+    // pending changes are delivered later as one change per download
+    return self.changesCount - self.deliveredChangesCount - self.pendingDownloadTokensOrderedSet.count;
+}
+
+
+#pragma mark - Changes
+
+
+- (void)addChangedDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    self.changesCount++;
+    [self.pendingDownloadTokensOrderedSet addObject:aDownloadToken];
+}
+
+
+- (NSTimeInterval)deliveryDelayAtTime:(NSTimeInterval)aTime
+{
+    NSTimeInterval aDueTime = self.lastDeliveryTime + self.deliveryInterval;
+    if (self.deliveryIntervalPerDownload > 0.0)
+    {
+        NSTimeInterval anEarliestDownloadDueTime = DBL_MAX;
+        for (NSString *aDownloadToken in self.pendingDownloadTokensOrderedSet)
+        {
+            NSTimeInterval aDownloadDueTime = [[self.lastDeliveryTimesDictionary objectForKey:aDownloadToken] doubleValue] + self.deliveryIntervalPerDownload;
+            anEarliestDownloadDueTime = MIN(anEarliestDownloadDueTime, aDownloadDueTime);
+        }
+        aDueTime = MAX(aDueTime, anEarliestDownloadDueTime);
+    }
+    return MAX(aDueTime - aTime, 0.0);
+}
+
+
+- (nonnull NSArray<NSString *> *)removeDueDownloadTokensAtTime:(NSTimeInterval)aTime
+{
+    NSMutableArray<NSString *> *aDueDownloadTokensArray = [NSMutableArray arrayWithCapacity:self.pendingDownloadTokensOrderedSet.count];
+    if (aTime >= self.lastDeliveryTime + self.deliveryInterval)
+    {
+        for (NSString *aDownloadToken in self.pendingDownloadTokensOrderedSet)
+        {
+            NSNumber *aLastDeliveryTime = [self.lastDeliveryTimesDictionary objectForKey:aDownloadToken];
+            if ((aLastDeliveryTime == nil) || (aTime >= [aLastDeliveryTime doubleValue] + self.deliveryIntervalPerDownload))
+            {
+                [aDueDownloadTokensArray addObject:aDownloadToken];
+            }
+        }
+        for (NSString *aDownloadToken in aDueDownloadTokensArray)
+        {
+            [self.pendingDownloadTokensOrderedSet removeObject:aDownloadToken];
+            [self.lastDeliveryTimesDictionary setObject:@(aTime) forKey:aDownloadToken];
+        }
+        if (aDueDownloadTokensArray.count > 0)
+        {
+            self.lastDeliveryTime = aTime;
+            self.deliveredChangesCount += aDueDownloadTokensArray.count;
+        }
+    }
+    return aDueDownloadTokensArray;
+}
+
+
+- (void)removeDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    [self.pendingDownloadTokensOrderedSet removeObject:aDownloadToken];
+    [self.lastDeliveryTimesDictionary removeObjectForKey:aDownloadToken];
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.deliveryInterval) forKey:@"deliveryInterval"];
+    [aDescriptionDict setObject:@(self.deliveryIntervalPerDownload) forKey:@"deliveryIntervalPerDownload"];
+    [aDescriptionDict setObject:@(self.pendingDownloadTokensOrderedSet.count) forKey:@"pendingDownloadTokensCount"];
+    [aDescriptionDict setObject:@(self.changesCount) forKey:@"changesCount"];
+    [aDescriptionDict setObject:@(self.deliveredChangesCount) forKey:@"deliveredChangesCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,59 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadProgressSnapshot.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadProgressSnapshotState is the state of a download in a progress snapshot.
+ */
+typedef NS_ENUM(NSInteger, HWIFileDownloadProgressSnapshotState) {
+    HWIFileDownloadProgressSnapshotStateWaiting = 0,
+    HWIFileDownloadProgressSnapshotStateActive
+};
+
+
+/**
+ HWIFileDownloadProgressSnapshot is the progress of one download filled in by getProgressSnapshots:maxCount:forIdentifiers: or getAllProgressSnapshots:maxCount:identifiers: of HWIFileDownloader.
+ @discussion The snapshot is a plain C struct, so a buffer of snapshots can be allocated once and refilled without creating objects.
+ */
+typedef struct {
+    NSUInteger identifierIndex; // index of the download identifier in the passed (or returned) identifiers
+    HWIFileDownloadProgressSnapshotState state;
+    int64_t receivedFileSize;
+    int64_t expectedFileSize; // 0: unknown
+    double bytesPerSecondSpeed;
+    NSTimeInterval estimatedRemainingTime; // 0.0: unknown
+} HWIFileDownloadProgressSnapshot;
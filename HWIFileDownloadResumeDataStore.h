@@ -0,0 +1,111 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadResumeDataStore.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadResumeDataStore keeps resume data of waiting downloads in files instead of memory. It is used internally by HWIFileDownloader.
+ @discussion Resume data is written on a private serial queue and read (memory mapped) when the download is started. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadResumeDataStore : NSObject
+
+/**
+ Designated initializer.
+ @param aDirectoryURL Local directory URL for the resume data files. It is created if needed.
+ @return HWIFileDownloadResumeDataStore.
+ */
+- (nonnull instancetype)initWithDirectoryURL:(nonnull NSURL *)aDirectoryURL;
+- (nonnull HWIFileDownloadResumeDataStore *)init __attribute__((unavailable("use initWithDirectoryURL:")));
++ (nonnull HWIFileDownloadResumeDataStore *)new __attribute__((unavailable("use initWithDirectoryURL:")));
+
+/**
+ Local directory URL of the resume data files.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *directoryURL;
+
+/**
+ Number of bytes of resume data stored by this store and not removed yet.
+ */
+@property (nonatomic, assign, readonly) int64_t storedBytesCount;
+
+/**
+ Writes resume data to a new file.
+ @param aResumeData Resume data.
+ @return Local file URL of the resume data; the file is written asynchronously.
+ */
+- (nonnull NSURL *)storeResumeData:(nonnull NSData *)aResumeData;
+
+/**
+ Writes resume data to a file of the store, replacing earlier resume data of the file name.
+ @param aResumeData Resume data.
+ @param aFileName File name in the directory of the store.
+ @return Local file URL of the resume data; the file is written asynchronously.
+ */
+- (nonnull NSURL *)storeResumeData:(nonnull NSData *)aResumeData fileName:(nonnull NSString *)aFileName;
+
+/**
+ Returns the local file URL of a file name in the directory of the store.
+ @param aFileName File name.
+ @return Local file URL.
+ */
+- (nonnull NSURL *)fileURLForFileName:(nonnull NSString *)aFileName;
+
+/**
+ Reads resume data, waiting for a pending write of the file.
+ @param aFileURL Local file URL of the resume data.
+ @return Resume data (memory mapped) or nil.
+ */
+- (nullable NSData *)resumeDataAtFileURL:(nonnull NSURL *)aFileURL;
+
+/**
+ Removes a resume data file asynchronously.
+ @param aFileURL Local file URL of the resume data.
+ */
+- (void)removeResumeDataAtFileURL:(nonnull NSURL *)aFileURL;
+
+/**
+ Removes all files of the directory except the given ones, e.g. files left by a terminated app.
+ @param aFileNamesSet File names to keep.
+ */
+- (void)removeAllResumeDataExceptFileNames:(nonnull NSSet<NSString *> *)aFileNamesSet;
+
+/**
+ Removes all files of the directory last modified before a date, e.g. files left by a previous app launch in a directory shared by several stores.
+ @param aDate Files modified at or after this date are kept.
+ */
+- (void)removeAllResumeDataModifiedBeforeDate:(nonnull NSDate *)aDate;
+
+@end
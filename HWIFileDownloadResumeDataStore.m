@@ -0,0 +1,191 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadResumeDataStore.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadResumeDataStore.h"
+
+
+@interface HWIFileDownloadResumeDataStore()
+@property (nonatomic, strong, readwrite, nonnull) NSURL *directoryURL;
+@property (nonatomic, strong, nonnull) dispatch_queue_t resumeDataDispatchQueue; // file access
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSNumber *> *storedFileSizesDictionary;
+@property (nonatomic, assign, readwrite) int64_t storedBytesCount;
+@end
+
+
+@implementation HWIFileDownloadResumeDataStore
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithDirectoryURL:(nonnull NSURL *)aDirectoryURL
+{
+    self = [super init];
+    if (self)
+    {
+        self.directoryURL = aDirectoryURL;
+        self.resumeDataDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.resumedata", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+        self.storedFileSizesDictionary = [NSMutableDictionary dictionary];
+        self.storedBytesCount = 0;
+        
+        NSError *anError = nil;
+        if ([[NSFileManager defaultManager] createDirectoryAtURL:aDirectoryURL withIntermediateDirectories:YES attributes:nil error:&anError] == NO)
+        {
+            NSLog(@"ERR: Unable to create resume data directory %@: %@ (%@, %d)", aDirectoryURL, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+        [aDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:NULL];
+    }
+    return self;
+}
+
+
+#pragma mark - Resume Data
+
+
+- (nonnull NSURL *)storeResumeData:(nonnull NSData *)aResumeData
+{
+    return [self storeResumeData:aResumeData fileName:[[NSUUID UUID] UUIDString]];
+}
+
+
+- (nonnull NSURL *)storeResumeData:(nonnull NSData *)aResumeData fileName:(nonnull NSString *)aFileName
+{
+    NSURL *aFileURL = [self fileURLForFileName:aFileName];
+    NSNumber *aReplacedFileSize = [self.storedFileSizesDictionary objectForKey:aFileName];
+    if (aReplacedFileSize)
+    {
+        self.storedBytesCount -= [aReplacedFileSize longLongValue];
+    }
+    [self.storedFileSizesDictionary setObject:@(aResumeData.length) forKey:aFileName];
+    self.storedBytesCount += (int64_t)aResumeData.length;
+    dispatch_async(self.resumeDataDispatchQueue, ^{
+        // the resume data is released when it has been written
+        NSError *aWriteError = nil;
+        if ([aResumeData writeToURL:aFileURL options:NSDataWritingAtomic error:&aWriteError] == NO)
+        {
+            NSLog(@"ERR: Unable to write resume data to %@: %@ (%@, %d)", aFileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+    });
+    return aFileURL;
+}
+
+
+- (nonnull NSURL *)fileURLForFileName:(nonnull NSString *)aFileName
+{
+    return [self.directoryURL URLByAppendingPathComponent:aFileName];
+}
+
+
+- (nullable NSData *)resumeDataAtFileURL:(nonnull NSURL *)aFileURL
+{
+    __block NSData *aResumeData = nil;
+    dispatch_sync(self.resumeDataDispatchQueue, ^{
+        NSError *aReadError = nil;
+        aResumeData = [NSData dataWithContentsOfURL:aFileURL options:NSDataReadingMappedIfSafe error:&aReadError];
+        if (aResumeData == nil)
+        {
+            NSLog(@"ERR: Unable to read resume data from %@: %@ (%@, %d)", aFileURL, aReadError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        }
+    });
+    return aResumeData;
+}
+
+
+- (void)removeResumeDataAtFileURL:(nonnull NSURL *)aFileURL
+{
+    NSNumber *aFileSize = [self.storedFileSizesDictionary objectForKey:aFileURL.lastPathComponent];
+    if (aFileSize)
+    {
+        self.storedBytesCount -= [aFileSize longLongValue];
+        [self.storedFileSizesDictionary removeObjectForKey:aFileURL.lastPathComponent];
+    }
+    dispatch_async(self.resumeDataDispatchQueue, ^{
+        // mapped resume data stays readable after removing the file
+        [[NSFileManager defaultManager] removeItemAtURL:aFileURL error:NULL];
+    });
+}
+
+
+- (void)removeAllResumeDataExceptFileNames:(nonnull NSSet<NSString *> *)aFileNamesSet
+{
+    NSURL *aDirectoryURL = self.directoryURL;
+    NSSet<NSString *> *aKeptFileNamesSet = [aFileNamesSet setByAddingObjectsFromArray:self.storedFileSizesDictionary.allKeys];
+    dispatch_async(self.resumeDataDispatchQueue, ^{
+        NSArray<NSURL *> *aFileURLsArray = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:aDirectoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:NULL];
+        for (NSURL *aFileURL in aFileURLsArray)
+        {
+            if ([aKeptFileNamesSet containsObject:aFileURL.lastPathComponent] == NO)
+            {
+                [[NSFileManager defaultManager] removeItemAtURL:aFileURL error:NULL];
+            }
+        }
+    });
+}
+
+
+- (void)removeAllResumeDataModifiedBeforeDate:(nonnull NSDate *)aDate
+{
+    NSURL *aDirectoryURL = self.directoryURL;
+    dispatch_async(self.resumeDataDispatchQueue, ^{
+        NSArray<NSURL *> *aFileURLsArray = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:aDirectoryURL includingPropertiesForKeys:@[NSURLContentModificationDateKey] options:NSDirectoryEnumerationSkipsHiddenFiles error:NULL];
+        for (NSURL *aFileURL in aFileURLsArray)
+        {
+            NSDate *aModificationDate = nil;
+            [aFileURL getResourceValue:&aModificationDate forKey:NSURLContentModificationDateKey error:NULL];
+            if (aModificationDate && ([aModificationDate compare:aDate] == NSOrderedAscending))
+            {
+                [[NSFileManager defaultManager] removeItemAtURL:aFileURL error:NULL];
+            }
+        }
+    });
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.directoryURL forKey:@"directoryURL"];
+    [aDescriptionDict setObject:@(self.storedFileSizesDictionary.count) forKey:@"storedFilesCount"];
+    [aDescriptionDict setObject:@(self.storedBytesCount) forKey:@"storedBytesCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,95 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadRetryPolicy.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadRetryPolicy describes which failed downloads are retried and how long to wait before each retry.
+ @discussion The wait grows exponentially from initialBackoffInterval by backoffMultiplier up to maximumBackoffInterval; a random part of up to jitterFactor of the wait is subtracted so that many failed downloads are not retried at the same time. Retry policies are copied with the download options.
+ */
+@interface HWIFileDownloadRetryPolicy : NSObject <NSCopying>
+
+/**
+ Maximum number of retries of a download. Default: 3.
+ */
+@property (nonatomic, assign) NSUInteger maximumRetriesCount;
+
+/**
+ Wait before the first retry in seconds. Default: 1.0.
+ */
+@property (nonatomic, assign) NSTimeInterval initialBackoffInterval;
+
+/**
+ Factor of the wait from one retry to the next. Default: 2.0.
+ */
+@property (nonatomic, assign) double backoffMultiplier;
+
+/**
+ Longest wait before a retry in seconds. Default: 60.0.
+ */
+@property (nonatomic, assign) NSTimeInterval maximumBackoffInterval;
+
+/**
+ Largest fraction of the wait that is subtracted at random (0.0 - 1.0). Default: 0.5.
+ */
+@property (nonatomic, assign) double jitterFactor;
+
+/**
+ Codes of errors in NSURLErrorDomain that are retried. Default: timed out, cannot find host, cannot connect to host, network connection lost, DNS lookup failed and not connected to internet.
+ */
+@property (nonatomic, copy, nonnull) NSSet<NSNumber *> *retriedErrorCodes;
+
+/**
+ HTTP status codes that are retried. Default: 408, 429, 500, 502, 503 and 504.
+ */
+@property (nonatomic, copy, nonnull) NSIndexSet *retriedHttpStatusCodes;
+
+/**
+ Checks whether a failed download is retried by the policy (without checking the number of retries).
+ @param anError Error of the failed download.
+ @param aHttpStatusCode Last HTTP status code of the download (0 if not known).
+ @return YES if the download is retried, NO otherwise. Cancelled downloads are never retried.
+ */
+- (BOOL)shouldRetryAfterError:(nonnull NSError *)anError httpStatusCode:(NSInteger)aHttpStatusCode;
+
+/**
+ Returns the wait before a retry.
+ @param aRetryNumber Number of the retry, 1 for the first retry.
+ @return Wait in seconds including jitter.
+ */
+- (NSTimeInterval)backoffIntervalForRetryNumber:(NSUInteger)aRetryNumber;
+
+@end
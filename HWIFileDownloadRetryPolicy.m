@@ -0,0 +1,140 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadRetryPolicy.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadRetryPolicy.h"
+
+
+@implementation HWIFileDownloadRetryPolicy
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.maximumRetriesCount = 3;
+        self.initialBackoffInterval = 1.0;
+        self.backoffMultiplier = 2.0;
+        self.maximumBackoffInterval = 60.0;
+        self.jitterFactor = 0.5;
+        self.retriedErrorCodes = [NSSet setWithObjects:@(NSURLErrorTimedOut),
+                                                       @(NSURLErrorCannotFindHost),
+                                                       @(NSURLErrorCannotConnectToHost),
+                                                       @(NSURLErrorNetworkConnectionLost),
+                                                       @(NSURLErrorDNSLookupFailed),
+                                                       @(NSURLErrorNotConnectedToInternet),
+                                                       nil];
+        NSMutableIndexSet *aRetriedHttpStatusCodes = [NSMutableIndexSet indexSet];
+        [aRetriedHttpStatusCodes addIndex:408];
+        [aRetriedHttpStatusCodes addIndex:429];
+        [aRetriedHttpStatusCodes addIndex:500];
+        [aRetriedHttpStatusCodes addIndexesInRange:NSMakeRange(502, 3)];
+        self.retriedHttpStatusCodes = aRetriedHttpStatusCodes;
+    }
+    return self;
+}
+
+
+#pragma mark - NSCopying
+
+
+- (nonnull id)copyWithZone:(nullable NSZone *)aZone
+{
+    HWIFileDownloadRetryPolicy *aRetryPolicyCopy = [[[self class] allocWithZone:aZone] init];
+    aRetryPolicyCopy.maximumRetriesCount = self.maximumRetriesCount;
+    aRetryPolicyCopy.initialBackoffInterval = self.initialBackoffInterval;
+    aRetryPolicyCopy.backoffMultiplier = self.backoffMultiplier;
+    aRetryPolicyCopy.maximumBackoffInterval = self.maximumBackoffInterval;
+    aRetryPolicyCopy.jitterFactor = self.jitterFactor;
+    aRetryPolicyCopy.retriedErrorCodes = self.retriedErrorCodes;
+    aRetryPolicyCopy.retriedHttpStatusCodes = self.retriedHttpStatusCodes;
+    return aRetryPolicyCopy;
+}
+
+
+#pragma mark - Retry
+
+
+- (BOOL)shouldRetryAfterError:(nonnull NSError *)anError httpStatusCode:(NSInteger)aHttpStatusCode
+{
+    BOOL aRetryFlag = NO;
+    BOOL anIsURLErrorFlag = [anError.domain isEqualToString:NSURLErrorDomain];
+    if ((anIsURLErrorFlag && (anError.code == NSURLErrorCancelled)) == NO)
+    {
+        if ((aHttpStatusCode > 0) && [self.retriedHttpStatusCodes containsIndex:(NSUInteger)aHttpStatusCode])
+        {
+            aRetryFlag = YES;
+        }
+        else if (anIsURLErrorFlag && [self.retriedErrorCodes containsObject:@(anError.code)])
+        {
+            aRetryFlag = YES;
+        }
+    }
+    return aRetryFlag;
+}
+
+
+- (NSTimeInterval)backoffIntervalForRetryNumber:(NSUInteger)aRetryNumber
+{
+    NSTimeInterval aBackoffInterval = self.initialBackoffInterval * pow(MAX(self.backoffMultiplier, 1.0), (double)(MAX(aRetryNumber, (NSUInteger)1) - 1));
+    aBackoffInterval = MIN(aBackoffInterval, self.maximumBackoffInterval);
+    double aJitter = MAX(0.0, MIN(1.0, self.jitterFactor)) * ((double)arc4random_uniform(1001) / 1000.0);
+    return MAX(0.0, aBackoffInterval * (1.0 - aJitter));
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.maximumRetriesCount) forKey:@"maximumRetriesCount"];
+    [aDescriptionDict setObject:@(self.initialBackoffInterval) forKey:@"initialBackoffInterval"];
+    [aDescriptionDict setObject:@(self.backoffMultiplier) forKey:@"backoffMultiplier"];
+    [aDescriptionDict setObject:@(self.maximumBackoffInterval) forKey:@"maximumBackoffInterval"];
+    [aDescriptionDict setObject:@(self.jitterFactor) forKey:@"jitterFactor"];
+    [aDescriptionDict setObject:self.retriedErrorCodes forKey:@"retriedErrorCodes"];
+    [aDescriptionDict setObject:self.retriedHttpStatusCodes forKey:@"retriedHttpStatusCodes"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
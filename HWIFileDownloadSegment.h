@@ -0,0 +1,58 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadSegment.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadSegment is a byte range of a segmented download. It is used internally by HWIFileDownloader.
+ @discussion The range is transferred with a data task; each received chunk is written at the offset of the segment plus the number of bytes received before. A continued segment requests the remaining range only.
+ */
+@interface HWIFileDownloadSegment : NSObject
+
+- (nonnull instancetype)initWithOffset:(int64_t)anOffset
+                                length:(int64_t)aLength
+               receivedFileSizeInBytes:(int64_t)aReceivedFileSizeInBytes;
+
+@property (nonatomic, assign, readonly) int64_t offset;
+@property (nonatomic, assign, readonly) int64_t length;
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *sessionDataTask;
+@property (nonatomic, assign) int64_t receivedFileSizeInBytes; // received and scheduled for writing
+@property (nonatomic, assign) BOOL isCompleted;
+
+- (nonnull HWIFileDownloadSegment *)init __attribute__((unavailable("use initWithOffset:length:receivedFileSizeInBytes:")));
++ (nonnull HWIFileDownloadSegment *)new __attribute__((unavailable("use initWithOffset:length:receivedFileSizeInBytes:")));
+
+@end
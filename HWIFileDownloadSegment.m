@@ -0,0 +1,87 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadSegment.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadSegment.h"
+
+
+@interface HWIFileDownloadSegment()
+@property (nonatomic, assign, readwrite) int64_t offset;
+@property (nonatomic, assign, readwrite) int64_t length;
+@end
+
+
+@implementation HWIFileDownloadSegment
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithOffset:(int64_t)anOffset
+                                length:(int64_t)aLength
+               receivedFileSizeInBytes:(int64_t)aReceivedFileSizeInBytes
+{
+    self = [super init];
+    if (self)
+    {
+        self.offset = anOffset;
+        self.length = aLength;
+        self.receivedFileSizeInBytes = aReceivedFileSizeInBytes;
+        self.isCompleted = (aReceivedFileSizeInBytes >= aLength);
+    }
+    return self;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.offset) forKey:@"offset"];
+    [aDescriptionDict setObject:@(self.length) forKey:@"length"];
+    if (self.sessionDataTask)
+    {
+        [aDescriptionDict setObject:@(self.sessionDataTask.taskIdentifier) forKey:@"taskIdentifier"];
+    }
+    [aDescriptionDict setObject:@(self.receivedFileSizeInBytes) forKey:@"receivedFileSizeInBytes"];
+    [aDescriptionDict setObject:@(self.isCompleted) forKey:@"isCompleted"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
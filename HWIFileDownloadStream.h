@@ -0,0 +1,95 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadStream.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadStreamConsumer.h"
+
+
+/**
+ HWIFileDownloadStream delivers the received data of a download to a stream consumer. It is used internally by HWIFileDownloader.
+ @discussion The consumer is called on a private serial queue. Delivered data is counted as backlog until the consumer has processed it. All methods need to be called on the same serial queue, the callback queue.
+ */
+@interface HWIFileDownloadStream : NSObject
+
+/**
+ Designated initializer.
+ @param aConsumer Stream consumer (retained until the stream has finished).
+ @param aDownloadToken Download token passed to the consumer.
+ @param aBacklogCapacity Number of delivered and not yet processed bytes at which the stream is full.
+ @param aCallbackQueue Serial queue for the drain handler.
+ @return HWIFileDownloadStream.
+ */
+- (nonnull instancetype)initWithConsumer:(nonnull id<HWIFileDownloadStreamConsumer>)aConsumer
+                           downloadToken:(nonnull NSString *)aDownloadToken
+                         backlogCapacity:(int64_t)aBacklogCapacity
+                           callbackQueue:(nonnull dispatch_queue_t)aCallbackQueue;
+- (nonnull HWIFileDownloadStream *)init __attribute__((unavailable("use initWithConsumer:downloadToken:backlogCapacity:callbackQueue:")));
++ (nonnull HWIFileDownloadStream *)new __attribute__((unavailable("use initWithConsumer:downloadToken:backlogCapacity:callbackQueue:")));
+
+/**
+ Called on the callback queue when the backlog of a full stream has been processed down to half of the capacity.
+ */
+@property (nonatomic, copy, nullable) void (^drainHandler)(void);
+
+/**
+ Number of delivered bytes not yet processed by the consumer.
+ */
+@property (nonatomic, assign, readonly) int64_t backlogBytesCount;
+
+/**
+ True from reaching the backlog capacity until the backlog has been drained.
+ */
+@property (nonatomic, assign, readonly) BOOL isFull;
+
+/**
+ Delivers the response to the consumer.
+ @param aResponse Response of the download.
+ */
+- (void)deliverResponse:(nonnull NSURLResponse *)aResponse;
+
+/**
+ Delivers a chunk of data to the consumer.
+ @param aData Received data.
+ */
+- (void)deliverData:(nonnull NSData *)aData;
+
+/**
+ Delivers the end of the stream to the consumer after all delivered data. Later calls are ignored.
+ @param anError Error of a failed download, nil on success.
+ */
+- (void)finishWithError:(nullable NSError *)anError;
+
+@end
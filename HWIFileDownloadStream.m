@@ -0,0 +1,163 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadStream.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadStream.h"
+
+
+@interface HWIFileDownloadStream()
+@property (nonatomic, strong, nullable) id<HWIFileDownloadStreamConsumer> consumer; // nil: finished
+@property (nonatomic, copy, nonnull) NSString *downloadToken;
+@property (nonatomic, assign) int64_t backlogCapacity;
+@property (nonatomic, strong, nonnull) dispatch_queue_t callbackQueue;
+@property (nonatomic, strong, nonnull) dispatch_queue_t deliveryDispatchQueue; // consumer calls
+@property (nonatomic, assign, readwrite) int64_t backlogBytesCount;
+@property (nonatomic, assign, readwrite) BOOL isFull;
+@end
+
+
+@implementation HWIFileDownloadStream
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithConsumer:(nonnull id<HWIFileDownloadStreamConsumer>)aConsumer
+                           downloadToken:(nonnull NSString *)aDownloadToken
+                         backlogCapacity:(int64_t)aBacklogCapacity
+                           callbackQueue:(nonnull dispatch_queue_t)aCallbackQueue
+{
+    self = [super init];
+    if (self)
+    {
+        self.consumer = aConsumer;
+        self.downloadToken = aDownloadToken;
+        self.backlogCapacity = MAX(aBacklogCapacity, 1);
+        self.callbackQueue = aCallbackQueue;
+        self.deliveryDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.stream", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+        self.backlogBytesCount = 0;
+        self.isFull = NO;
+    }
+    return self;
+}
+
+
+#pragma mark - Delivery
+
+
+- (void)deliverResponse:(nonnull NSURLResponse *)aResponse
+{
+    id<HWIFileDownloadStreamConsumer> aConsumer = self.consumer;
+    if ([aConsumer respondsToSelector:@selector(downloadWithIdentifier:didReceiveStreamResponse:)])
+    {
+        NSString *aDownloadToken = self.downloadToken;
+        dispatch_async(self.deliveryDispatchQueue, ^{
+            [aConsumer downloadWithIdentifier:aDownloadToken didReceiveStreamResponse:aResponse];
+        });
+    }
+}
+
+
+- (void)deliverData:(nonnull NSData *)aData
+{
+    id<HWIFileDownloadStreamConsumer> aConsumer = self.consumer;
+    if (aConsumer && (aData.length > 0))
+    {
+        int64_t aBytesCount = (int64_t)aData.length;
+        self.backlogBytesCount += aBytesCount;
+        if (self.backlogBytesCount >= self.backlogCapacity)
+        {
+            self.isFull = YES;
+        }
+        NSString *aDownloadToken = self.downloadToken;
+        dispatch_queue_t aCallbackQueue = self.callbackQueue;
+        __weak HWIFileDownloadStream *weakSelf = self;
+        dispatch_async(self.deliveryDispatchQueue, ^{
+            [aConsumer downloadWithIdentifier:aDownloadToken didReceiveStreamData:aData];
+            dispatch_async(aCallbackQueue, ^{
+                HWIFileDownloadStream *strongSelf = weakSelf;
+                [strongSelf handleProcessedBytesCount:aBytesCount];
+            });
+        });
+    }
+}
+
+
+- (void)finishWithError:(nullable NSError *)anError
+{
+    id<HWIFileDownloadStreamConsumer> aConsumer = self.consumer;
+    if (aConsumer)
+    {
+        self.consumer = nil;
+        self.drainHandler = nil;
+        NSString *aDownloadToken = self.downloadToken;
+        dispatch_async(self.deliveryDispatchQueue, ^{
+            [aConsumer downloadWithIdentifier:aDownloadToken didFinishStreamWithError:anError];
+        });
+    }
+}
+
+
+- (void)handleProcessedBytesCount:(int64_t)aBytesCount
+{
+    self.backlogBytesCount -= aBytesCount;
+    if (self.isFull && (self.backlogBytesCount <= self.backlogCapacity / 2))
+    {
+        self.isFull = NO;
+        if (self.drainHandler)
+        {
+            self.drainHandler();
+        }
+    }
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.downloadToken forKey:@"downloadToken"];
+    [aDescriptionDict setObject:@(self.backlogCapacity) forKey:@"backlogCapacity"];
+    [aDescriptionDict setObject:@(self.backlogBytesCount) forKey:@"backlogBytesCount"];
+    [aDescriptionDict setObject:@(self.isFull) forKey:@"isFull"];
+    [aDescriptionDict setObject:@(self.consumer == nil) forKey:@"isFinished"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,71 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadStreamConsumer.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadStreamConsumer is a protocol for processing the data of a download while it is received.
+ @discussion All methods of a download are called in order on a serial queue of the download, the data in the order of the file. While the consumer has not processed more than the maximum stream backlog size (see HWIFileDownloadOptions) the transfer is suspended.
+ */
+@protocol HWIFileDownloadStreamConsumer <NSObject>
+
+/**
+ Called with each received chunk of data of a download.
+ @param aDownloadIdentifier Download identifier of the download item.
+ @param aData Received data.
+ */
+- (void)downloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier didReceiveStreamData:(nonnull NSData *)aData;
+
+/**
+ Called once after the last chunk of data of a download.
+ @param aDownloadIdentifier Download identifier of the download item.
+ @param anError Error of a failed or cancelled download, nil on success.
+ @discussion The delegate of the downloader is informed about the completion independently.
+ */
+- (void)downloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier didFinishStreamWithError:(nullable NSError *)anError;
+
+
+@optional
+
+
+/**
+ Optionally called once before any data of a download is received.
+ @param aDownloadIdentifier Download identifier of the download item.
+ @param aResponse Response (usually NSHTTPURLResponse) of the download.
+ */
+- (void)downloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier didReceiveStreamResponse:(nonnull NSURLResponse *)aResponse;
+
+@end
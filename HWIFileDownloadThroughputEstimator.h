@@ -0,0 +1,81 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadThroughputEstimator.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadThroughputEstimator estimates the download speed from the bytes received in a recent time window. It is used internally by HWIFileDownloader.
+ @discussion Samples of received bytes are kept in a ring buffer of fixed size, so adding a sample does not allocate memory. Samples closer together than the window divided by the capacity are merged. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadThroughputEstimator : NSObject
+
+/**
+ Duration of the sliding window in seconds. Default: 5.0.
+ */
+@property (nonatomic, assign) NSTimeInterval windowDuration;
+
+/**
+ Number of bytes added in total.
+ */
+@property (nonatomic, assign, readonly) int64_t receivedBytesCount;
+
+/**
+ Records received bytes.
+ @param aBytesCount Number of bytes received.
+ @param aTime Time of receiving (time interval since reference date).
+ @return YES if a new sample has been started, NO if the bytes have been merged into the newest sample.
+ */
+- (BOOL)addReceivedBytes:(int64_t)aBytesCount atTime:(NSTimeInterval)aTime;
+
+/**
+ Speed between the last two samples.
+ @return Bytes per second (0.0 if not enough samples).
+ */
+- (double)instantaneousBytesPerSecond;
+
+/**
+ Speed within the sliding window ending at the given time.
+ @param aTime Current time (time interval since reference date).
+ @return Bytes per second (0.0 if not enough samples), decaying when no bytes are received.
+ */
+- (double)windowedBytesPerSecondAtTime:(NSTimeInterval)aTime;
+
+/**
+ Removes all samples, e.g. after a download has been resumed.
+ */
+- (void)reset;
+
+@end
@@ -0,0 +1,185 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadThroughputEstimator.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadThroughputEstimator.h"
+
+
+#define HWIFileDownloadThroughputSamplesCount 32
+
+
+typedef struct
+{
+    NSTimeInterval time;
+    int64_t receivedBytesCount; // cumulative
+} HWIFileDownloadThroughputSample;
+
+
+@interface HWIFileDownloadThroughputEstimator()
+{
+    HWIFileDownloadThroughputSample _samples[HWIFileDownloadThroughputSamplesCount];
+}
+@property (nonatomic, assign, readwrite) int64_t receivedBytesCount;
+@property (nonatomic, assign) NSUInteger newestSampleIndex;
+@property (nonatomic, assign) NSUInteger samplesCount;
+@end
+
+
+@implementation HWIFileDownloadThroughputEstimator
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.windowDuration = 5.0;
+        self.receivedBytesCount = 0;
+        self.newestSampleIndex = 0;
+        self.samplesCount = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Samples
+
+
+- (BOOL)addReceivedBytes:(int64_t)aBytesCount atTime:(NSTimeInterval)aTime
+{
+    BOOL aNewSampleFlag = NO;
+    self.receivedBytesCount += aBytesCount;
+    NSTimeInterval aSampleInterval = self.windowDuration / HWIFileDownloadThroughputSamplesCount;
+    if ((self.samplesCount > 1) && (aTime - _samples[[self sampleIndexAtAge:1]].time < aSampleInterval))
+    {
+        // the newest sample is still open: move it forward instead of using the next slot
+        _samples[self.newestSampleIndex].time = aTime;
+        _samples[self.newestSampleIndex].receivedBytesCount = self.receivedBytesCount;
+    }
+    else
+    {
+        if (self.samplesCount > 0)
+        {
+            self.newestSampleIndex = (self.newestSampleIndex + 1) % HWIFileDownloadThroughputSamplesCount;
+        }
+        _samples[self.newestSampleIndex].time = aTime;
+        _samples[self.newestSampleIndex].receivedBytesCount = self.receivedBytesCount;
+        self.samplesCount = MIN(self.samplesCount + 1, (NSUInteger)HWIFileDownloadThroughputSamplesCount);
+        aNewSampleFlag = YES;
+    }
+    return aNewSampleFlag;
+}
+
+
+- (void)reset
+{
+    self.receivedBytesCount = 0;
+    self.newestSampleIndex = 0;
+    self.samplesCount = 0;
+}
+
+
+#pragma mark - Speed
+
+
+- (double)instantaneousBytesPerSecond
+{
+    double aBytesPerSecond = 0.0;
+    if (self.samplesCount > 1)
+    {
+        HWIFileDownloadThroughputSample aNewestSample = _samples[self.newestSampleIndex];
+        HWIFileDownloadThroughputSample aPreviousSample = _samples[[self sampleIndexAtAge:1]];
+        NSTimeInterval aDuration = aNewestSample.time - aPreviousSample.time;
+        if (aDuration > 0.0)
+        {
+            aBytesPerSecond = (double)(aNewestSample.receivedBytesCount - aPreviousSample.receivedBytesCount) / aDuration;
+        }
+    }
+    return aBytesPerSecond;
+}
+
+
+- (double)windowedBytesPerSecondAtTime:(NSTimeInterval)aTime
+{
+    double aBytesPerSecond = 0.0;
+    if (self.samplesCount > 1)
+    {
+        // oldest sample inside the window; the bytes of the first sample were received before it
+        NSUInteger anOldestAge = 1;
+        while ((anOldestAge + 1 < self.samplesCount) && (_samples[[self sampleIndexAtAge:anOldestAge + 1]].time >= aTime - self.windowDuration))
+        {
+            anOldestAge++;
+        }
+        HWIFileDownloadThroughputSample aNewestSample = _samples[self.newestSampleIndex];
+        HWIFileDownloadThroughputSample anOldestSample = _samples[[self sampleIndexAtAge:anOldestAge]];
+        NSTimeInterval aDuration = MAX(aTime, aNewestSample.time) - anOldestSample.time;
+        if (aDuration > 0.0)
+        {
+            aBytesPerSecond = (double)(aNewestSample.receivedBytesCount - anOldestSample.receivedBytesCount) / aDuration;
+        }
+    }
+    return aBytesPerSecond;
+}
+
+
+#pragma mark - Utilities
+
+
+- (NSUInteger)sampleIndexAtAge:(NSUInteger)anAge
+{
+    // age 0: newest sample
+    return (self.newestSampleIndex + HWIFileDownloadThroughputSamplesCount - anAge) % HWIFileDownloadThroughputSamplesCount;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.windowDuration) forKey:@"windowDuration"];
+    [aDescriptionDict setObject:@(self.receivedBytesCount) forKey:@"receivedBytesCount"];
+    [aDescriptionDict setObject:@(self.samplesCount) forKey:@"samplesCount"];
+    [aDescriptionDict setObject:@([self instantaneousBytesPerSecond]) forKey:@"instantaneousBytesPerSecond"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
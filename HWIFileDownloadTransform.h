@@ -0,0 +1,98 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadTransform.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadTransformKind determines how the received data of a download is decoded before it is written.
+ */
+typedef NS_ENUM(NSInteger, HWIFileDownloadTransformKind) {
+    HWIFileDownloadTransformKindNone = 0, // data is written as received
+    HWIFileDownloadTransformKindGzip, // gzip, zlib or raw deflate data is inflated into one file
+    HWIFileDownloadTransformKindZip // zip archive entries (stored or deflated) are extracted into a directory
+};
+
+
+/**
+ HWIFileDownloadTransform is a protocol for decoding the data of a download on the file writer queue of HWIFileDownloader.
+ @discussion Data is passed in the order of the file. All methods need to be called on the same serial queue.
+ */
+@protocol HWIFileDownloadTransform <NSObject>
+
+/**
+ Initializer.
+ @param anOutputURL Local file URL of the output (file or directory). It must not exist yet.
+ @param aBufferSize Size of the write buffer of the output files in bytes.
+ @return Transform.
+ */
+- (nonnull instancetype)initWithOutputURL:(nonnull NSURL *)anOutputURL bufferSize:(NSUInteger)aBufferSize;
+
+/**
+ Local file URL of the output.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *outputURL;
+
+/**
+ Paths of the extracted files relative to the output URL. Empty if the output is a single file.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSArray<NSString *> *outputRelativePaths;
+
+/**
+ Number of bytes written to the output files.
+ */
+@property (nonatomic, assign, readonly) int64_t writtenBytesCount;
+
+/**
+ Number of system calls (open, write, close) issued for the output files.
+ */
+@property (nonatomic, assign, readonly) NSUInteger systemCallsCount;
+
+/**
+ Decodes a chunk of received data and writes the decoded data.
+ @param aData Received data.
+ @param anError Error on failure.
+ @return YES on success, NO otherwise. After a failure later data is ignored.
+ */
+- (BOOL)transformData:(nonnull NSData *)aData error:(NSError * _Nullable * _Nullable)anError;
+
+/**
+ Checks that the received data was complete and closes the output files.
+ @param anError Error on failure (including an earlier failure of transformData:error:).
+ @return YES on success, NO otherwise.
+ */
+- (BOOL)finishWithError:(NSError * _Nullable * _Nullable)anError;
+
+@end
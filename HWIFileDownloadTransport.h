@@ -0,0 +1,114 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadTransport.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+@protocol HWIFileDownloadTransport;
+
+
+/**
+ HWIFileDownloadTransportDelegate is a protocol for receiving the events of transfers of a transport.
+ @discussion All methods are called on the delegate queue set on the transport. No events are delivered for a transfer after it has completed or has been cancelled.
+ */
+@protocol HWIFileDownloadTransportDelegate <NSObject>
+
+/**
+ Called once before any data of a transfer is received.
+ @param aTransport Transport of the transfer.
+ @param aTransferID Identifier of the transfer.
+ @param aResponse Response (usually NSHTTPURLResponse) of the transfer.
+ */
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didReceiveResponse:(nonnull NSURLResponse *)aResponse;
+
+/**
+ Called with each received chunk of data of a transfer.
+ @param aTransport Transport of the transfer.
+ @param aTransferID Identifier of the transfer.
+ @param aData Received data.
+ */
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didReceiveData:(nonnull NSData *)aData;
+
+/**
+ Called once when a transfer has finished.
+ @param aTransport Transport of the transfer.
+ @param aTransferID Identifier of the transfer.
+ @param anError Error of a failed transfer, nil on success.
+ */
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didCompleteWithError:(nullable NSError *)anError;
+
+@end
+
+
+/**
+ HWIFileDownloadTransport is a protocol for transferring the data of downloads.
+ @discussion A transport passed to HWIFileDownloader replaces NSURLSession (iOS 7 and later) and NSURLConnection (iOS 6). The downloader schedules the downloads and writes the received data to files. Transfers are identified by the download ids of the downloader.
+ */
+@protocol HWIFileDownloadTransport <NSObject>
+
+/**
+ Sets the receiver of transfer events.
+ @param aDelegate Receiver of transfer events (not retained).
+ @param aDelegateQueue Serial queue for calling the delegate.
+ */
+- (void)setTransportDelegate:(nullable id<HWIFileDownloadTransportDelegate>)aDelegate delegateQueue:(nonnull dispatch_queue_t)aDelegateQueue;
+
+/**
+ Starts a transfer.
+ @param aTransferID Identifier of the transfer.
+ @param aRequest Request of the transfer.
+ */
+- (void)startTransferWithIdentifier:(NSUInteger)aTransferID request:(nonnull NSURLRequest *)aRequest;
+
+/**
+ Stops delivering data of a transfer until it is resumed.
+ @param aTransferID Identifier of the transfer.
+ */
+- (void)suspendTransferWithIdentifier:(NSUInteger)aTransferID;
+
+/**
+ Continues delivering data of a suspended transfer.
+ @param aTransferID Identifier of the transfer.
+ */
+- (void)resumeTransferWithIdentifier:(NSUInteger)aTransferID;
+
+/**
+ Cancels a transfer.
+ @discussion The delegate is not called for the cancelled transfer anymore.
+ @param aTransferID Identifier of the transfer.
+ */
+- (void)cancelTransferWithIdentifier:(NSUInteger)aTransferID;
+
+@end
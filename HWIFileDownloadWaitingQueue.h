@@ -0,0 +1,138 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadWaitingQueue.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadPriority.h"
+#import "HWIFileDownloadOptions.h"
+
+
+/**
+ HWIFileDownloadWaitingItem is a download waiting for start. It is used internally by HWIFileDownloader.
+ */
+@interface HWIFileDownloadWaitingItem : NSObject
+
+- (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken
+                                    remoteURL:(nullable NSURL *)aRemoteURL
+                            resumeDataFileURL:(nullable NSURL *)aResumeDataFileURL
+                                      options:(nonnull HWIFileDownloadOptions *)anOptions;
+
+@property (nonatomic, strong, readonly, nonnull) NSString *downloadToken;
+@property (nonatomic, strong, readonly, nullable) NSURL *remoteURL;
+@property (nonatomic, strong, readonly, nullable) NSURL *resumeDataFileURL; // resume data is kept in a file while waiting
+@property (nonatomic, copy, readonly, nonnull) NSString *hostKey; // lowercase host of the remote URL, empty without remote URL
+@property (nonatomic, strong, readonly, nonnull) HWIFileDownloadOptions *options;
+@property (nonatomic, assign, readonly) HWIFileDownloadPriority priority;
+@property (nonatomic, assign, readonly) NSTimeInterval enqueueTime; // time interval since reference date
+@property (nonatomic, assign) NSUInteger retriesCount;
+@property (nonatomic, assign) int64_t partialFileSize; // partial file continued with a range request
+@property (nonatomic, strong, nullable) NSProgress *progress; // progress of a retried download, continued on restart
+
+- (nonnull HWIFileDownloadWaitingItem *)init __attribute__((unavailable("use initWithDownloadToken:remoteURL:resumeDataFileURL:options:")));
++ (nonnull HWIFileDownloadWaitingItem *)new __attribute__((unavailable("use initWithDownloadToken:remoteURL:resumeDataFileURL:options:")));
+
+@end
+
+
+/**
+ HWIFileDownloadWaitingQueue holds the downloads waiting for start. It is used internally by HWIFileDownloader.
+ @discussion Each priority level holds a doubly linked FIFO list per host; the hosts of a level are served round-robin. Enqueue and removal by download token take constant time (removing the last item of a host takes time proportional to the number of hosts of the level), dequeue takes time proportional to the number of priority levels and hosts.
+ */
+@interface HWIFileDownloadWaitingQueue : NSObject
+
+/**
+ Number of waiting items.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ Appends a waiting item to the end of its priority level.
+ @param aWaitingItem Waiting item. A waiting item with the same download token is replaced.
+ */
+- (void)enqueueWaitingItem:(nonnull HWIFileDownloadWaitingItem *)aWaitingItem;
+
+/**
+ Number of waiting items of a host.
+ @param aHostKey Host key of waiting items.
+ @return Number of waiting items.
+ */
+- (NSUInteger)countForHostKey:(nonnull NSString *)aHostKey;
+
+/**
+ Host keys of all waiting items.
+ */
+- (nonnull NSSet<NSString *> *)hostKeys;
+
+/**
+ Removes and returns the first waiting item of the next host of the highest non-empty priority level.
+ @return Waiting item or nil if the queue is empty.
+ */
+- (nullable HWIFileDownloadWaitingItem *)dequeueWaitingItem;
+
+/**
+ Removes and returns the first waiting item of the next host passing the test, starting with the highest priority level.
+ @param aHostTest Block returning YES if a download of the host can be started, nil to accept all hosts.
+ @return Waiting item or nil if no waiting item passes the test.
+ */
+- (nullable HWIFileDownloadWaitingItem *)dequeueWaitingItemPassingHostTest:(nullable BOOL (^)(NSString * _Nonnull aHostKey))aHostTest;
+
+/**
+ Returns the waiting item for a download token.
+ @param aDownloadToken Download token.
+ @return Waiting item or nil if not waiting.
+ */
+- (nullable HWIFileDownloadWaitingItem *)waitingItemForDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Removes the waiting item for a download token.
+ @param aDownloadToken Download token.
+ @return Removed waiting item or nil if not waiting.
+ */
+- (nullable HWIFileDownloadWaitingItem *)removeWaitingItemForDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ Moves a waiting item to the end of another priority level.
+ @param aPriority New priority.
+ @param aDownloadToken Download token.
+ @return YES if the download token is waiting, NO otherwise.
+ */
+- (BOOL)setPriority:(HWIFileDownloadPriority)aPriority forDownloadToken:(nonnull NSString *)aDownloadToken;
+
+/**
+ All waiting items in start order.
+ */
+- (nonnull NSArray<HWIFileDownloadWaitingItem *> *)allWaitingItems;
+
+@end
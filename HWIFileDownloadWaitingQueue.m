@@ -0,0 +1,397 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadWaitingQueue.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadWaitingQueue.h"
+
+
+static const NSInteger HWIFileDownloadPriorityLevelsCount = HWIFileDownloadPriorityHigh + 1;
+
+
+@interface HWIFileDownloadWaitingItem()
+@property (nonatomic, strong, readwrite, nonnull) NSString *downloadToken;
+@property (nonatomic, strong, readwrite, nullable) NSURL *remoteURL;
+@property (nonatomic, strong, readwrite, nullable) NSURL *resumeDataFileURL;
+@property (nonatomic, copy, readwrite, nonnull) NSString *hostKey;
+@property (nonatomic, strong, readwrite, nonnull) HWIFileDownloadOptions *options;
+@property (nonatomic, assign, readwrite) HWIFileDownloadPriority priority;
+@property (nonatomic, assign, readwrite) NSTimeInterval enqueueTime;
+@property (nonatomic, strong, nullable) HWIFileDownloadWaitingItem *nextItem;
+@property (nonatomic, unsafe_unretained, nullable) HWIFileDownloadWaitingItem *previousItem;
+@end
+
+
+@implementation HWIFileDownloadWaitingItem
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithDownloadToken:(nonnull NSString *)aDownloadToken
+                                    remoteURL:(nullable NSURL *)aRemoteURL
+                            resumeDataFileURL:(nullable NSURL *)aResumeDataFileURL
+                                      options:(nonnull HWIFileDownloadOptions *)anOptions
+{
+    self = [super init];
+    if (self)
+    {
+        self.downloadToken = aDownloadToken;
+        self.remoteURL = aRemoteURL;
+        self.resumeDataFileURL = aResumeDataFileURL;
+        self.hostKey = aRemoteURL.host.lowercaseString ? aRemoteURL.host.lowercaseString : @"";
+        self.options = anOptions;
+        self.priority = MAX(HWIFileDownloadPriorityBackground, MIN(HWIFileDownloadPriorityHigh, anOptions.priority));
+        self.enqueueTime = [NSDate timeIntervalSinceReferenceDate];
+        self.retriesCount = 0;
+        self.partialFileSize = 0;
+    }
+    return self;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.downloadToken forKey:@"downloadToken"];
+    [aDescriptionDict setObject:@(self.priority) forKey:@"priority"];
+    [aDescriptionDict setObject:self.hostKey forKey:@"hostKey"];
+    [aDescriptionDict setObject:@(self.retriesCount) forKey:@"retriesCount"];
+    if (self.partialFileSize > 0)
+    {
+        [aDescriptionDict setObject:@(self.partialFileSize) forKey:@"partialFileSize"];
+    }
+    [aDescriptionDict setObject:self.options forKey:@"options"];
+    if (self.remoteURL)
+    {
+        [aDescriptionDict setObject:self.remoteURL forKey:@"remoteURL"];
+    }
+    if (self.resumeDataFileURL)
+    {
+        [aDescriptionDict setObject:self.resumeDataFileURL forKey:@"resumeDataFileURL"];
+    }
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
+
+
+/**
+ HWIFileDownloadWaitingHostList is the FIFO list of the waiting items of one host within a priority level.
+ */
+@interface HWIFileDownloadWaitingHostList : NSObject
+@property (nonatomic, strong, nullable) HWIFileDownloadWaitingItem *headItem;
+@property (nonatomic, unsafe_unretained, nullable) HWIFileDownloadWaitingItem *tailItem;
+@end
+
+
+@implementation HWIFileDownloadWaitingHostList
+@end
+
+
+@interface HWIFileDownloadWaitingQueue()
+{
+    NSMutableDictionary<NSString *, HWIFileDownloadWaitingHostList *> *_hostLists[HWIFileDownloadPriorityLevelsCount];
+    NSMutableArray<NSString *> *_hostKeys[HWIFileDownloadPriorityLevelsCount]; // round-robin order
+    NSUInteger _nextHostIndexes[HWIFileDownloadPriorityLevelsCount];
+}
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, HWIFileDownloadWaitingItem *> *waitingItemsDictionary;
+@property (nonatomic, strong, nonnull) NSCountedSet<NSString *> *hostKeysCountedSet;
+@end
+
+
+@implementation HWIFileDownloadWaitingQueue
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        self.waitingItemsDictionary = [NSMutableDictionary dictionary];
+        self.hostKeysCountedSet = [NSCountedSet set];
+        for (NSInteger aLevel = 0; aLevel < HWIFileDownloadPriorityLevelsCount; aLevel++)
+        {
+            _hostLists[aLevel] = [NSMutableDictionary dictionary];
+            _hostKeys[aLevel] = [NSMutableArray array];
+            _nextHostIndexes[aLevel] = 0;
+        }
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    // unlink iteratively to avoid a deep recursive release chain
+    for (NSInteger aLevel = 0; aLevel < HWIFileDownloadPriorityLevelsCount; aLevel++)
+    {
+        for (HWIFileDownloadWaitingHostList *aHostList in _hostLists[aLevel].allValues)
+        {
+            HWIFileDownloadWaitingItem *anItem = aHostList.headItem;
+            aHostList.headItem = nil;
+            aHostList.tailItem = nil;
+            while (anItem)
+            {
+                HWIFileDownloadWaitingItem *aNextItem = anItem.nextItem;
+                anItem.nextItem = nil;
+                anItem = aNextItem;
+            }
+        }
+    }
+}
+
+
+#pragma mark - Queue
+
+
+- (NSUInteger)count
+{
+    return self.waitingItemsDictionary.count;
+}
+
+
+- (NSUInteger)countForHostKey:(nonnull NSString *)aHostKey
+{
+    return [self.hostKeysCountedSet countForObject:aHostKey];
+}
+
+
+- (nonnull NSSet<NSString *> *)hostKeys
+{
+    return [NSSet setWithArray:self.hostKeysCountedSet.allObjects];
+}
+
+
+- (void)enqueueWaitingItem:(nonnull HWIFileDownloadWaitingItem *)aWaitingItem
+{
+    [self removeWaitingItemForDownloadToken:aWaitingItem.downloadToken];
+    [self linkWaitingItem:aWaitingItem];
+    [self.waitingItemsDictionary setObject:aWaitingItem forKey:aWaitingItem.downloadToken];
+}
+
+
+- (nullable HWIFileDownloadWaitingItem *)dequeueWaitingItem
+{
+    return [self dequeueWaitingItemPassingHostTest:nil];
+}
+
+
+- (nullable HWIFileDownloadWaitingItem *)dequeueWaitingItemPassingHostTest:(nullable BOOL (^)(NSString * _Nonnull aHostKey))aHostTest
+{
+    HWIFileDownloadWaitingItem *aWaitingItem = nil;
+    for (NSInteger aLevel = HWIFileDownloadPriorityLevelsCount - 1; (aLevel >= 0) && (aWaitingItem == nil); aLevel--)
+    {
+        NSMutableArray<NSString *> *aHostKeysArray = _hostKeys[aLevel];
+        NSUInteger aHostKeysCount = aHostKeysArray.count;
+        for (NSUInteger anOffset = 0; anOffset < aHostKeysCount; anOffset++)
+        {
+            NSUInteger aHostIndex = (_nextHostIndexes[aLevel] + anOffset) % aHostKeysCount;
+            NSString *aHostKey = [aHostKeysArray objectAtIndex:aHostIndex];
+            if ((aHostTest == nil) || aHostTest(aHostKey))
+            {
+                aWaitingItem = [_hostLists[aLevel] objectForKey:aHostKey].headItem;
+                // the next dequeue starts with the following host
+                _nextHostIndexes[aLevel] = aHostIndex + 1;
+                break;
+            }
+        }
+    }
+    if (aWaitingItem)
+    {
+        [self unlinkWaitingItem:aWaitingItem];
+        [self.waitingItemsDictionary removeObjectForKey:aWaitingItem.downloadToken];
+    }
+    return aWaitingItem;
+}
+
+
+- (nullable HWIFileDownloadWaitingItem *)waitingItemForDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    return [self.waitingItemsDictionary objectForKey:aDownloadToken];
+}
+
+
+- (nullable HWIFileDownloadWaitingItem *)removeWaitingItemForDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    HWIFileDownloadWaitingItem *aWaitingItem = [self.waitingItemsDictionary objectForKey:aDownloadToken];
+    if (aWaitingItem)
+    {
+        [self unlinkWaitingItem:aWaitingItem];
+        [self.waitingItemsDictionary removeObjectForKey:aDownloadToken];
+    }
+    return aWaitingItem;
+}
+
+
+- (BOOL)setPriority:(HWIFileDownloadPriority)aPriority forDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    BOOL aFoundFlag = NO;
+    HWIFileDownloadWaitingItem *aWaitingItem = [self.waitingItemsDictionary objectForKey:aDownloadToken];
+    if (aWaitingItem)
+    {
+        aFoundFlag = YES;
+        HWIFileDownloadPriority aClampedPriority = MAX(HWIFileDownloadPriorityBackground, MIN(HWIFileDownloadPriorityHigh, aPriority));
+        if (aWaitingItem.priority != aClampedPriority)
+        {
+            [self unlinkWaitingItem:aWaitingItem];
+            aWaitingItem.priority = aClampedPriority;
+            [self linkWaitingItem:aWaitingItem];
+        }
+    }
+    return aFoundFlag;
+}
+
+
+- (nonnull NSArray<HWIFileDownloadWaitingItem *> *)allWaitingItems
+{
+    NSMutableArray<HWIFileDownloadWaitingItem *> *aWaitingItemsArray = [NSMutableArray arrayWithCapacity:self.waitingItemsDictionary.count];
+    for (NSInteger aLevel = HWIFileDownloadPriorityLevelsCount - 1; aLevel >= 0; aLevel--)
+    {
+        // round-robin over the hosts, starting with the next one
+        NSArray<NSString *> *aHostKeysArray = _hostKeys[aLevel];
+        NSUInteger aHostKeysCount = aHostKeysArray.count;
+        NSMutableArray<HWIFileDownloadWaitingItem *> *aCurrentItemsArray = [NSMutableArray arrayWithCapacity:aHostKeysCount];
+        for (NSUInteger anOffset = 0; anOffset < aHostKeysCount; anOffset++)
+        {
+            NSString *aHostKey = [aHostKeysArray objectAtIndex:(_nextHostIndexes[aLevel] + anOffset) % aHostKeysCount];
+            [aCurrentItemsArray addObject:[_hostLists[aLevel] objectForKey:aHostKey].headItem];
+        }
+        while (aCurrentItemsArray.count > 0)
+        {
+            NSMutableArray<HWIFileDownloadWaitingItem *> *aNextItemsArray = [NSMutableArray arrayWithCapacity:aCurrentItemsArray.count];
+            for (HWIFileDownloadWaitingItem *anItem in aCurrentItemsArray)
+            {
+                [aWaitingItemsArray addObject:anItem];
+                if (anItem.nextItem)
+                {
+                    [aNextItemsArray addObject:anItem.nextItem];
+                }
+            }
+            aCurrentItemsArray = aNextItemsArray;
+        }
+    }
+    return aWaitingItemsArray;
+}
+
+
+#pragma mark - Linked List
+
+
+- (void)linkWaitingItem:(nonnull HWIFileDownloadWaitingItem *)aWaitingItem
+{
+    NSInteger aLevel = aWaitingItem.priority;
+    NSString *aHostKey = aWaitingItem.hostKey;
+    HWIFileDownloadWaitingHostList *aHostList = [_hostLists[aLevel] objectForKey:aHostKey];
+    if (aHostList == nil)
+    {
+        aHostList = [[HWIFileDownloadWaitingHostList alloc] init];
+        [_hostLists[aLevel] setObject:aHostList forKey:aHostKey];
+        // a new host is served after the hosts already waiting
+        NSUInteger aHostIndex = _nextHostIndexes[aLevel] % MAX(_hostKeys[aLevel].count, (NSUInteger)1);
+        [_hostKeys[aLevel] insertObject:aHostKey atIndex:aHostIndex];
+        _nextHostIndexes[aLevel] = aHostIndex + 1;
+    }
+    HWIFileDownloadWaitingItem *aTailItem = aHostList.tailItem;
+    aWaitingItem.nextItem = nil;
+    aWaitingItem.previousItem = aTailItem;
+    if (aTailItem)
+    {
+        aTailItem.nextItem = aWaitingItem;
+    }
+    else
+    {
+        aHostList.headItem = aWaitingItem;
+    }
+    aHostList.tailItem = aWaitingItem;
+    [self.hostKeysCountedSet addObject:aHostKey];
+}
+
+
+- (void)unlinkWaitingItem:(nonnull HWIFileDownloadWaitingItem *)aWaitingItem
+{
+    NSInteger aLevel = aWaitingItem.priority;
+    NSString *aHostKey = aWaitingItem.hostKey;
+    HWIFileDownloadWaitingHostList *aHostList = [_hostLists[aLevel] objectForKey:aHostKey];
+    HWIFileDownloadWaitingItem *aPreviousItem = aWaitingItem.previousItem;
+    HWIFileDownloadWaitingItem *aNextItem = aWaitingItem.nextItem;
+    if (aPreviousItem)
+    {
+        aPreviousItem.nextItem = aNextItem;
+    }
+    else
+    {
+        aHostList.headItem = aNextItem;
+    }
+    if (aNextItem)
+    {
+        aNextItem.previousItem = aPreviousItem;
+    }
+    else
+    {
+        aHostList.tailItem = aPreviousItem;
+    }
+    aWaitingItem.nextItem = nil;
+    aWaitingItem.previousItem = nil;
+    [self.hostKeysCountedSet removeObject:aHostKey];
+    if (aHostList.headItem == nil)
+    {
+        [_hostLists[aLevel] removeObjectForKey:aHostKey];
+        NSUInteger aHostIndex = [_hostKeys[aLevel] indexOfObject:aHostKey];
+        [_hostKeys[aLevel] removeObjectAtIndex:aHostIndex];
+        if (aHostIndex < _nextHostIndexes[aLevel])
+        {
+            _nextHostIndexes[aLevel]--;
+        }
+    }
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@", [self allWaitingItems]];
+}
+
+@end
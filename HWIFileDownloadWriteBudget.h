@@ -0,0 +1,98 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadWriteBudget.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ HWIFileDownloadWriteBudget counts the received bytes that are queued for writing but not yet written, across all downloads. It is used internally by HWIFileDownloader.
+ @discussion Bytes are reserved when received data is queued to the file writer queue and released after they have been written. When the reserved bytes exceed the capacity the budget is exhausted until half of the capacity has been released; the downloader holds the transfers meanwhile. Reserving and releasing happen on different queues, so all methods may be called from any queue.
+ */
+@interface HWIFileDownloadWriteBudget : NSObject
+
+/**
+ Designated initializer.
+ @param aCapacity Maximum number of pending bytes (0: no limit).
+ @return Write budget.
+ */
+- (nonnull instancetype)initWithCapacity:(int64_t)aCapacity;
+- (nonnull HWIFileDownloadWriteBudget *)init __attribute__((unavailable("use initWithCapacity:")));
++ (nonnull HWIFileDownloadWriteBudget *)new __attribute__((unavailable("use initWithCapacity:")));
+
+/**
+ Maximum number of pending bytes (0: no limit).
+ */
+@property (atomic, assign) int64_t capacity;
+
+/**
+ Number of bytes reserved and not yet released.
+ */
+@property (atomic, assign, readonly) int64_t pendingBytesCount;
+
+/**
+ Highest number of pending bytes so far.
+ */
+@property (atomic, assign, readonly) int64_t highWaterMarkBytesCount;
+
+/**
+ YES while the budget is exhausted.
+ */
+@property (atomic, assign, readonly) BOOL isExhausted;
+
+/**
+ Number of times the budget has been exhausted.
+ */
+@property (atomic, assign, readonly) NSUInteger stallsCount;
+
+/**
+ Time in seconds the budget has been exhausted (including a current stall).
+ */
+@property (atomic, assign, readonly) NSTimeInterval stallDuration;
+
+/**
+ Reserves received bytes queued for writing.
+ @param aBytesCount Number of bytes.
+ @return YES if the budget has been exhausted by this reservation, NO otherwise.
+ */
+- (BOOL)reserveBytesCount:(int64_t)aBytesCount;
+
+/**
+ Releases written bytes.
+ @param aBytesCount Number of bytes.
+ @return YES if an exhausted budget has been drained by this release, NO otherwise.
+ */
+- (BOOL)releaseBytesCount:(int64_t)aBytesCount;
+
+@end
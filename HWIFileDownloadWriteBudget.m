@@ -0,0 +1,210 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadWriteBudget.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import "HWIFileDownloadWriteBudget.h"
+
+#include <pthread.h>
+
+
+@interface HWIFileDownloadWriteBudget()
+{
+    pthread_mutex_t _mutex;
+    int64_t _capacity;
+    int64_t _pendingBytesCount;
+    int64_t _highWaterMarkBytesCount;
+    BOOL _isExhausted;
+    NSUInteger _stallsCount;
+    NSTimeInterval _stallStartTime;
+    NSTimeInterval _finishedStallsDuration;
+}
+@end
+
+
+@implementation HWIFileDownloadWriteBudget
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithCapacity:(int64_t)aCapacity
+{
+    self = [super init];
+    if (self)
+    {
+        pthread_mutex_init(&_mutex, NULL);
+        _capacity = MAX(aCapacity, 0);
+        _pendingBytesCount = 0;
+        _highWaterMarkBytesCount = 0;
+        _isExhausted = NO;
+        _stallsCount = 0;
+        _stallStartTime = 0.0;
+        _finishedStallsDuration = 0.0;
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+}
+
+
+#pragma mark - Budget
+
+
+- (BOOL)reserveBytesCount:(int64_t)aBytesCount
+{
+    BOOL anExhaustedFlag = NO;
+    pthread_mutex_lock(&_mutex);
+    _pendingBytesCount += aBytesCount;
+    _highWaterMarkBytesCount = MAX(_highWaterMarkBytesCount, _pendingBytesCount);
+    if ((_isExhausted == NO) && (_capacity > 0) && (_pendingBytesCount > _capacity))
+    {
+        _isExhausted = YES;
+        _stallsCount++;
+        _stallStartTime = [NSDate timeIntervalSinceReferenceDate];
+        anExhaustedFlag = YES;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return anExhaustedFlag;
+}
+
+
+- (BOOL)releaseBytesCount:(int64_t)aBytesCount
+{
+    BOOL aDrainedFlag = NO;
+    pthread_mutex_lock(&_mutex);
+    _pendingBytesCount -= aBytesCount;
+    // half of the capacity is drained before the transfers continue, so they are not toggled with every chunk
+    if (_isExhausted && ((_capacity == 0) || (_pendingBytesCount <= _capacity / 2)))
+    {
+        _isExhausted = NO;
+        _finishedStallsDuration += [NSDate timeIntervalSinceReferenceDate] - _stallStartTime;
+        aDrainedFlag = YES;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return aDrainedFlag;
+}
+
+
+#pragma mark - Properties
+
+
+- (int64_t)capacity
+{
+    pthread_mutex_lock(&_mutex);
+    int64_t aCapacity = _capacity;
+    pthread_mutex_unlock(&_mutex);
+    return aCapacity;
+}
+
+
+- (void)setCapacity:(int64_t)aCapacity
+{
+    // applies with the next reservation or release
+    pthread_mutex_lock(&_mutex);
+    _capacity = MAX(aCapacity, 0);
+    pthread_mutex_unlock(&_mutex);
+}
+
+
+- (int64_t)pendingBytesCount
+{
+    pthread_mutex_lock(&_mutex);
+    int64_t aPendingBytesCount = _pendingBytesCount;
+    pthread_mutex_unlock(&_mutex);
+    return aPendingBytesCount;
+}
+
+
+- (int64_t)highWaterMarkBytesCount
+{
+    pthread_mutex_lock(&_mutex);
+    int64_t aHighWaterMarkBytesCount = _highWaterMarkBytesCount;
+    pthread_mutex_unlock(&_mutex);
+    return aHighWaterMarkBytesCount;
+}
+
+
+- (BOOL)isExhausted
+{
+    pthread_mutex_lock(&_mutex);
+    BOOL anIsExhaustedFlag = _isExhausted;
+    pthread_mutex_unlock(&_mutex);
+    return anIsExhaustedFlag;
+}
+
+
+- (NSUInteger)stallsCount
+{
+    pthread_mutex_lock(&_mutex);
+    NSUInteger aStallsCount = _stallsCount;
+    pthread_mutex_unlock(&_mutex);
+    return aStallsCount;
+}
+
+
+- (NSTimeInterval)stallDuration
+{
+    pthread_mutex_lock(&_mutex);
+    NSTimeInterval aStallDuration = _finishedStallsDuration;
+    if (_isExhausted)
+    {
+        aStallDuration += [NSDate timeIntervalSinceReferenceDate] - _stallStartTime;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return aStallDuration;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:@(self.capacity) forKey:@"capacity"];
+    [aDescriptionDict setObject:@(self.pendingBytesCount) forKey:@"pendingBytesCount"];
+    [aDescriptionDict setObject:@(self.highWaterMarkBytesCount) forKey:@"highWaterMarkBytesCount"];
+    [aDescriptionDict setObject:@(self.isExhausted) forKey:@"isExhausted"];
+    [aDescriptionDict setObject:@(self.stallsCount) forKey:@"stallsCount"];
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -0,0 +1,50 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadZipTransform.h
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+#import "HWIFileDownloadTransform.h"
+
+
+/**
+ HWIFileDownloadZipTransform extracts the entries of a zip archive into a directory while the archive is received. It is used internally by HWIFileDownloader.
+ @discussion The local file headers are read in the order of the archive; the central directory is not needed. Stored and deflated entries (also with data descriptor and zip64 sizes) are supported, the CRC-32 of each entry is verified. Encrypted entries and entry names leaving the directory fail the transform. All methods need to be called on the same serial queue.
+ */
+@interface HWIFileDownloadZipTransform : NSObject <HWIFileDownloadTransform>
+
+- (nonnull HWIFileDownloadZipTransform *)init __attribute__((unavailable("use initWithOutputURL:bufferSize:")));
++ (nonnull HWIFileDownloadZipTransform *)new __attribute__((unavailable("use initWithOutputURL:bufferSize:")));
+
+@end
@@ -0,0 +1,579 @@
+/*
+ * Project: HWIFileDownload
+ 
+ * File: HWIFileDownloadZipTransform.m
+ *
+ */
+
+/***************************************************************************
+ 
+ Copyright (c) 2014-2018 Heiko Wichmann
+ 
+ https://github.com/Heikowi/HWIFileDownload
+ 
+ This software is provided 'as-is', without any expressed or implied warranty.
+ In no event will the authors be held liable for any damages
+ arising from the use of this software.
+ 
+ Permission is granted to anyone to use this software for any purpose,
+ including commercial applications, and to alter it and redistribute it
+ freely, subject to the following restrictions:
+ 
+ 1. The origin of this software must not be misrepresented;
+ you must not claim that you wrote the original software.
+ If you use this software in a product, an acknowledgment
+ in the product documentation would be appreciated
+ but is not required.
+ 
+ 2. Altered source versions must be plainly marked as such,
+ and must not be misrepresented as being the original software.
+ 
+ 3. This notice may not be removed or altered from any source distribution.
+ 
+ ***************************************************************************/
+
+
+#import <zlib.h>
+
+#import "HWIFileDownloadZipTransform.h"
+#import "HWIFileDownloadFileWriter.h"
+
+
+static const NSUInteger HWIFileDownloadZipTransformOutputBufferSize = 64 * 1024;
+static const uint32_t HWIFileDownloadZipLocalFileHeaderSignature = 0x04034b50;
+static const uint32_t HWIFileDownloadZipCentralDirectorySignature = 0x02014b50;
+static const uint32_t HWIFileDownloadZipEndOfCentralDirectorySignature = 0x06054b50;
+static const uint32_t HWIFileDownloadZipDataDescriptorSignature = 0x08074b50;
+static const NSUInteger HWIFileDownloadZipLocalFileHeaderLength = 30;
+
+
+typedef NS_ENUM(NSUInteger, HWIFileDownloadZipTransformState) {
+    HWIFileDownloadZipTransformStateHeader = 0, // local file header or start of the central directory
+    HWIFileDownloadZipTransformStateStoredData,
+    HWIFileDownloadZipTransformStateDeflatedData,
+    HWIFileDownloadZipTransformStateDataDescriptor,
+    HWIFileDownloadZipTransformStateEnd // the central directory and all following data are ignored
+};
+
+
+static inline uint16_t HWIFileDownloadZipReadUInt16(const uint8_t *aBytes)
+{
+    return (uint16_t)(aBytes[0] | (aBytes[1] << 8));
+}
+
+
+static inline uint32_t HWIFileDownloadZipReadUInt32(const uint8_t *aBytes)
+{
+    return (uint32_t)aBytes[0] | ((uint32_t)aBytes[1] << 8) | ((uint32_t)aBytes[2] << 16) | ((uint32_t)aBytes[3] << 24);
+}
+
+
+static inline uint64_t HWIFileDownloadZipReadUInt64(const uint8_t *aBytes)
+{
+    return (uint64_t)HWIFileDownloadZipReadUInt32(aBytes) | ((uint64_t)HWIFileDownloadZipReadUInt32(aBytes + 4) << 32);
+}
+
+
+@interface HWIFileDownloadZipTransform()
+{
+    z_stream _stream;
+    uint8_t *_outputBuffer;
+}
+@property (nonatomic, strong, readwrite, nonnull) NSURL *outputURL;
+@property (nonatomic, assign) NSUInteger bufferSize;
+@property (nonatomic, assign) HWIFileDownloadZipTransformState state;
+@property (nonatomic, strong, nonnull) NSMutableData *headerData; // header or data descriptor being received
+@property (nonatomic, assign) NSUInteger requiredHeaderLength;
+@property (nonatomic, strong, nullable) HWIFileDownloadFileWriter *entryFileWriter; // nil for directory entries
+@property (nonatomic, assign) uLong entryCRC;
+@property (nonatomic, assign) uint32_t expectedEntryCRC;
+@property (nonatomic, assign) uint64_t remainingStoredLength;
+@property (nonatomic, assign) BOOL hasDataDescriptor;
+@property (nonatomic, assign) BOOL isZip64Entry;
+@property (nonatomic, assign) BOOL isStreamInitialized;
+@property (nonatomic, assign) NSUInteger entriesCount;
+@property (nonatomic, strong, nonnull) NSMutableArray<NSString *> *outputRelativePathsArray;
+@property (nonatomic, assign) int64_t closedFileWritersWrittenBytesCount;
+@property (nonatomic, assign) NSUInteger closedFileWritersSystemCallsCount;
+@property (nonatomic, strong, nullable) NSError *transformError;
+@end
+
+
+@implementation HWIFileDownloadZipTransform
+
+
+#pragma mark - Initialization
+
+
+- (nonnull instancetype)initWithOutputURL:(nonnull NSURL *)anOutputURL bufferSize:(NSUInteger)aBufferSize
+{
+    self = [super init];
+    if (self)
+    {
+        self.outputURL = anOutputURL;
+        self.bufferSize = aBufferSize;
+        self.state = HWIFileDownloadZipTransformStateHeader;
+        self.headerData = [NSMutableData dataWithCapacity:HWIFileDownloadZipLocalFileHeaderLength];
+        self.requiredHeaderLength = 4;
+        self.isStreamInitialized = NO;
+        self.entriesCount = 0;
+        self.outputRelativePathsArray = [NSMutableArray array];
+        self.closedFileWritersWrittenBytesCount = 0;
+        self.closedFileWritersSystemCallsCount = 0;
+        _outputBuffer = NULL;
+        // the directory is created with the first entry on the queue of the transform
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    if (self.isStreamInitialized)
+    {
+        inflateEnd(&_stream);
+    }
+    free(_outputBuffer);
+}
+
+
+#pragma mark - HWIFileDownloadTransform
+
+
+- (nonnull NSArray<NSString *> *)outputRelativePaths
+{
+    return [self.outputRelativePathsArray copy];
+}
+
+
+- (int64_t)writtenBytesCount
+{
+    return self.closedFileWritersWrittenBytesCount + self.entryFileWriter.writtenBytesCount;
+}
+
+
+- (NSUInteger)systemCallsCount
+{
+    return self.closedFileWritersSystemCallsCount + self.entryFileWriter.systemCallsCount;
+}
+
+
+- (BOOL)transformData:(nonnull NSData *)aData error:(NSError * _Nullable * _Nullable)anError
+{
+    const uint8_t *aBytes = aData.bytes;
+    NSUInteger aLength = aData.length;
+    NSUInteger anOffset = 0;
+    BOOL aSuccessFlag = (self.transformError == nil);
+    while (aSuccessFlag && (anOffset < aLength))
+    {
+        NSUInteger aConsumedLength = 0;
+        switch (self.state)
+        {
+            case HWIFileDownloadZipTransformStateHeader:
+                aSuccessFlag = [self consumeHeaderBytes:(aBytes + anOffset) length:(aLength - anOffset) consumedLength:&aConsumedLength];
+                break;
+            case HWIFileDownloadZipTransformStateStoredData:
+                aSuccessFlag = [self consumeStoredBytes:(aBytes + anOffset) length:(aLength - anOffset) consumedLength:&aConsumedLength];
+                break;
+            case HWIFileDownloadZipTransformStateDeflatedData:
+                aSuccessFlag = [self consumeDeflatedBytes:(aBytes + anOffset) length:(aLength - anOffset) consumedLength:&aConsumedLength];
+                break;
+            case HWIFileDownloadZipTransformStateDataDescriptor:
+                aSuccessFlag = [self consumeDataDescriptorBytes:(aBytes + anOffset) length:(aLength - anOffset) consumedLength:&aConsumedLength];
+                break;
+            case HWIFileDownloadZipTransformStateEnd:
+                aConsumedLength = aLength - anOffset;
+                break;
+        }
+        anOffset += aConsumedLength;
+    }
+    if ((aSuccessFlag == NO) && anError)
+    {
+        *anError = self.transformError;
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)finishWithError:(NSError * _Nullable * _Nullable)anError
+{
+    if (self.transformError == nil)
+    {
+        BOOL anIsCompleteFlag = ((self.state == HWIFileDownloadZipTransformStateEnd)
+                                 || ((self.state == HWIFileDownloadZipTransformStateHeader) && (self.headerData.length == 0) && (self.entriesCount > 0)));
+        if (anIsCompleteFlag == NO)
+        {
+            // truncated archive
+            [self failWithErrorString:@"Incomplete zip archive"];
+        }
+        else
+        {
+            // also for an archive without entries
+            NSError *aCreateError = nil;
+            if ([[NSFileManager defaultManager] createDirectoryAtURL:self.outputURL withIntermediateDirectories:YES attributes:nil error:&aCreateError] == NO)
+            {
+                self.transformError = aCreateError;
+            }
+        }
+    }
+    [self closeEntryFileWriter];
+    if (self.isStreamInitialized)
+    {
+        inflateEnd(&_stream);
+        self.isStreamInitialized = NO;
+    }
+    free(_outputBuffer);
+    _outputBuffer = NULL;
+    if (self.transformError && anError)
+    {
+        *anError = self.transformError;
+    }
+    return (self.transformError == nil);
+}
+
+
+#pragma mark - Headers
+
+
+- (BOOL)consumeHeaderBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength consumedLength:(nonnull NSUInteger *)aConsumedLength
+{
+    if ([self appendHeaderBytes:aBytes length:aLength consumedLength:aConsumedLength] == NO)
+    {
+        return YES;
+    }
+    const uint8_t *aHeaderBytes = self.headerData.bytes;
+    uint32_t aSignature = HWIFileDownloadZipReadUInt32(aHeaderBytes);
+    if (aSignature == HWIFileDownloadZipLocalFileHeaderSignature)
+    {
+        if (self.requiredHeaderLength < HWIFileDownloadZipLocalFileHeaderLength)
+        {
+            self.requiredHeaderLength = HWIFileDownloadZipLocalFileHeaderLength;
+            return YES;
+        }
+        NSUInteger aFullHeaderLength = HWIFileDownloadZipLocalFileHeaderLength + HWIFileDownloadZipReadUInt16(aHeaderBytes + 26) + HWIFileDownloadZipReadUInt16(aHeaderBytes + 28);
+        if (self.requiredHeaderLength < aFullHeaderLength)
+        {
+            // file name and extra field
+            self.requiredHeaderLength = aFullHeaderLength;
+            return YES;
+        }
+        return [self startEntryWithLocalFileHeader];
+    }
+    else if ((aSignature == HWIFileDownloadZipCentralDirectorySignature) || (aSignature == HWIFileDownloadZipEndOfCentralDirectorySignature))
+    {
+        self.state = HWIFileDownloadZipTransformStateEnd;
+        return YES;
+    }
+    return [self failWithErrorString:[NSString stringWithFormat:@"Unexpected zip signature: 0x%08x", aSignature]];
+}
+
+
+- (BOOL)appendHeaderBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength consumedLength:(nonnull NSUInteger *)aConsumedLength
+{
+    // returns YES when the required header length has been received
+    NSUInteger aCopyLength = MIN(aLength, self.requiredHeaderLength - self.headerData.length);
+    [self.headerData appendBytes:aBytes length:aCopyLength];
+    *aConsumedLength = aCopyLength;
+    return (self.headerData.length >= self.requiredHeaderLength);
+}
+
+
+- (BOOL)startEntryWithLocalFileHeader
+{
+    const uint8_t *aHeaderBytes = self.headerData.bytes;
+    uint16_t aFlags = HWIFileDownloadZipReadUInt16(aHeaderBytes + 6);
+    uint16_t aMethod = HWIFileDownloadZipReadUInt16(aHeaderBytes + 8);
+    uint32_t aCRC = HWIFileDownloadZipReadUInt32(aHeaderBytes + 14);
+    uint64_t aCompressedSize = HWIFileDownloadZipReadUInt32(aHeaderBytes + 18);
+    uint64_t anUncompressedSize = HWIFileDownloadZipReadUInt32(aHeaderBytes + 22);
+    uint16_t aNameLength = HWIFileDownloadZipReadUInt16(aHeaderBytes + 26);
+    uint16_t anExtraLength = HWIFileDownloadZipReadUInt16(aHeaderBytes + 28);
+    
+    self.isZip64Entry = NO;
+    const uint8_t *anExtraBytes = aHeaderBytes + HWIFileDownloadZipLocalFileHeaderLength + aNameLength;
+    NSUInteger anExtraOffset = 0;
+    while (anExtraOffset + 4 <= anExtraLength)
+    {
+        uint16_t aFieldID = HWIFileDownloadZipReadUInt16(anExtraBytes + anExtraOffset);
+        uint16_t aFieldLength = HWIFileDownloadZipReadUInt16(anExtraBytes + anExtraOffset + 2);
+        if ((aFieldID == 0x0001) && (anExtraOffset + 4 + aFieldLength <= anExtraLength))
+        {
+            // zip64 sizes replace the 32 bit sizes set to 0xffffffff
+            self.isZip64Entry = YES;
+            NSUInteger aFieldOffset = anExtraOffset + 4;
+            if ((anUncompressedSize == UINT32_MAX) && (aFieldOffset + 8 <= anExtraOffset + 4 + aFieldLength))
+            {
+                anUncompressedSize = HWIFileDownloadZipReadUInt64(anExtraBytes + aFieldOffset);
+                aFieldOffset += 8;
+            }
+            if ((aCompressedSize == UINT32_MAX) && (aFieldOffset + 8 <= anExtraOffset + 4 + aFieldLength))
+            {
+                aCompressedSize = HWIFileDownloadZipReadUInt64(anExtraBytes + aFieldOffset);
+            }
+        }
+        anExtraOffset += 4 + aFieldLength;
+    }
+    
+    NSString *anEntryName = [[NSString alloc] initWithBytes:(aHeaderBytes + HWIFileDownloadZipLocalFileHeaderLength) length:aNameLength encoding:NSUTF8StringEncoding];
+    if (anEntryName == nil)
+    {
+        anEntryName = [[NSString alloc] initWithBytes:(aHeaderBytes + HWIFileDownloadZipLocalFileHeaderLength) length:aNameLength encoding:NSISOLatin1StringEncoding];
+    }
+    if (aFlags & 0x0001)
+    {
+        return [self failWithErrorString:[NSString stringWithFormat:@"Encrypted zip entry: %@", anEntryName]];
+    }
+    if ((aMethod != Z_NO_COMPRESSION) && (aMethod != Z_DEFLATED))
+    {
+        return [self failWithErrorString:[NSString stringWithFormat:@"Unsupported compression method %@ of zip entry: %@", @(aMethod), anEntryName]];
+    }
+    if ((anEntryName.length == 0) || [anEntryName hasPrefix:@"/"] || [[anEntryName pathComponents] containsObject:@".."])
+    {
+        return [self failWithErrorString:[NSString stringWithFormat:@"Invalid zip entry name: %@", anEntryName]];
+    }
+    self.hasDataDescriptor = ((aFlags & 0x0008) != 0);
+    if ((aMethod == Z_NO_COMPRESSION) && self.hasDataDescriptor && (aCompressedSize == 0))
+    {
+        return [self failWithErrorString:[NSString stringWithFormat:@"Stored zip entry without size: %@", anEntryName]];
+    }
+    
+    NSURL *anEntryURL = [self.outputURL URLByAppendingPathComponent:anEntryName];
+    NSError *aCreateError = nil;
+    if ([anEntryName hasSuffix:@"/"])
+    {
+        if ([[NSFileManager defaultManager] createDirectoryAtURL:anEntryURL withIntermediateDirectories:YES attributes:nil error:&aCreateError] == NO)
+        {
+            self.transformError = aCreateError;
+            return NO;
+        }
+    }
+    else
+    {
+        if ([[NSFileManager defaultManager] createDirectoryAtURL:[anEntryURL URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:&aCreateError] == NO)
+        {
+            self.transformError = aCreateError;
+            return NO;
+        }
+        self.entryFileWriter = [[HWIFileDownloadFileWriter alloc] initWithFileURL:anEntryURL bufferSize:self.bufferSize];
+        // empty entries are created as well
+        NSError *aWriteError = nil;
+        if ([self.entryFileWriter appendData:[NSData data] error:&aWriteError] == NO)
+        {
+            self.transformError = aWriteError;
+            return NO;
+        }
+        [self.outputRelativePathsArray addObject:anEntryName];
+    }
+    
+    self.entryCRC = crc32(0L, Z_NULL, 0);
+    self.expectedEntryCRC = aCRC;
+    [self.headerData setLength:0];
+    self.requiredHeaderLength = 4;
+    if (aMethod == Z_DEFLATED)
+    {
+        if (self.isStreamInitialized)
+        {
+            inflateReset(&_stream);
+        }
+        else
+        {
+            memset(&_stream, 0, sizeof(_stream));
+            if (inflateInit2(&_stream, -MAX_WBITS) != Z_OK)
+            {
+                return [self failWithErrorString:@"Unable to initialize inflate stream"];
+            }
+            self.isStreamInitialized = YES;
+            _outputBuffer = malloc(HWIFileDownloadZipTransformOutputBufferSize);
+        }
+        self.state = HWIFileDownloadZipTransformStateDeflatedData;
+        return YES;
+    }
+    self.remainingStoredLength = aCompressedSize;
+    self.state = HWIFileDownloadZipTransformStateStoredData;
+    if (aCompressedSize == 0)
+    {
+        return [self finishEntryData];
+    }
+    return YES;
+}
+
+
+- (BOOL)consumeDataDescriptorBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength consumedLength:(nonnull NSUInteger *)aConsumedLength
+{
+    if ([self appendHeaderBytes:aBytes length:aLength consumedLength:aConsumedLength] == NO)
+    {
+        return YES;
+    }
+    const uint8_t *aDescriptorBytes = self.headerData.bytes;
+    BOOL aHasSignatureFlag = (HWIFileDownloadZipReadUInt32(aDescriptorBytes) == HWIFileDownloadZipDataDescriptorSignature);
+    NSUInteger aDescriptorLength = (aHasSignatureFlag ? 4 : 0) + 4 + (self.isZip64Entry ? 16 : 8);
+    if (self.requiredHeaderLength < aDescriptorLength)
+    {
+        self.requiredHeaderLength = aDescriptorLength;
+        return YES;
+    }
+    self.expectedEntryCRC = HWIFileDownloadZipReadUInt32(aDescriptorBytes + (aHasSignatureFlag ? 4 : 0));
+    [self.headerData setLength:0];
+    self.requiredHeaderLength = 4;
+    return [self completeEntry];
+}
+
+
+#pragma mark - Entry Data
+
+
+- (BOOL)consumeStoredBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength consumedLength:(nonnull NSUInteger *)aConsumedLength
+{
+    NSUInteger aCopyLength = (NSUInteger)MIN((uint64_t)aLength, self.remainingStoredLength);
+    *aConsumedLength = aCopyLength;
+    if ([self writeEntryBytes:aBytes length:aCopyLength] == NO)
+    {
+        return NO;
+    }
+    self.remainingStoredLength -= aCopyLength;
+    if (self.remainingStoredLength == 0)
+    {
+        return [self finishEntryData];
+    }
+    return YES;
+}
+
+
+- (BOOL)consumeDeflatedBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength consumedLength:(nonnull NSUInteger *)aConsumedLength
+{
+    BOOL aSuccessFlag = YES;
+    int anInflateResult = Z_OK;
+    _stream.next_in = (Bytef *)aBytes;
+    _stream.avail_in = (uInt)aLength;
+    do
+    {
+        _stream.next_out = _outputBuffer;
+        _stream.avail_out = (uInt)HWIFileDownloadZipTransformOutputBufferSize;
+        anInflateResult = inflate(&_stream, Z_NO_FLUSH);
+        if ((anInflateResult != Z_OK) && (anInflateResult != Z_STREAM_END) && (anInflateResult != Z_BUF_ERROR))
+        {
+            aSuccessFlag = [self failWithErrorString:[NSString stringWithFormat:@"Unable to inflate zip entry: %s", _stream.msg ? _stream.msg : "unknown"]];
+        }
+        else
+        {
+            aSuccessFlag = [self writeEntryBytes:_outputBuffer length:(HWIFileDownloadZipTransformOutputBufferSize - _stream.avail_out)];
+        }
+    }
+    while (aSuccessFlag && (anInflateResult == Z_OK) && ((_stream.avail_in > 0) || (_stream.avail_out == 0)));
+    *aConsumedLength = aLength - _stream.avail_in;
+    _stream.next_in = NULL;
+    _stream.avail_in = 0;
+    if (aSuccessFlag && (anInflateResult == Z_STREAM_END))
+    {
+        aSuccessFlag = [self finishEntryData];
+    }
+    else if (aSuccessFlag && (*aConsumedLength == 0))
+    {
+        // no progress possible with the remaining input
+        aSuccessFlag = [self failWithErrorString:@"Invalid deflate data of zip entry"];
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)writeEntryBytes:(nonnull const uint8_t *)aBytes length:(NSUInteger)aLength
+{
+    BOOL aSuccessFlag = YES;
+    if (aLength > 0)
+    {
+        self.entryCRC = crc32(self.entryCRC, aBytes, (uInt)aLength);
+        if (self.entryFileWriter)
+        {
+            NSError *aWriteError = nil;
+            aSuccessFlag = [self.entryFileWriter appendData:[NSData dataWithBytesNoCopy:(void *)aBytes length:aLength freeWhenDone:NO] error:&aWriteError];
+            if (aSuccessFlag == NO)
+            {
+                self.transformError = aWriteError;
+            }
+        }
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)finishEntryData
+{
+    if (self.hasDataDescriptor)
+    {
+        // the CRC-32 follows the data
+        self.state = HWIFileDownloadZipTransformStateDataDescriptor;
+        return YES;
+    }
+    return [self completeEntry];
+}
+
+
+- (BOOL)completeEntry
+{
+    BOOL aSuccessFlag = YES;
+    if ((uint32_t)self.entryCRC != self.expectedEntryCRC)
+    {
+        aSuccessFlag = [self failWithErrorString:[NSString stringWithFormat:@"CRC-32 mismatch of zip entry: %@", self.entryFileWriter.fileURL.lastPathComponent]];
+    }
+    else
+    {
+        aSuccessFlag = [self closeEntryFileWriter];
+        self.entriesCount++;
+        self.state = HWIFileDownloadZipTransformStateHeader;
+    }
+    return aSuccessFlag;
+}
+
+
+- (BOOL)closeEntryFileWriter
+{
+    BOOL aSuccessFlag = YES;
+    HWIFileDownloadFileWriter *anEntryFileWriter = self.entryFileWriter;
+    if (anEntryFileWriter)
+    {
+        NSError *aCloseError = nil;
+        aSuccessFlag = [anEntryFileWriter closeWithError:&aCloseError];
+        if ((aSuccessFlag == NO) && (self.transformError == nil))
+        {
+            self.transformError = aCloseError;
+        }
+        self.closedFileWritersWrittenBytesCount += anEntryFileWriter.writtenBytesCount;
+        self.closedFileWritersSystemCallsCount += anEntryFileWriter.systemCallsCount;
+        self.entryFileWriter = nil;
+    }
+    return aSuccessFlag;
+}
+
+
+#pragma mark - Utilities
+
+
+- (BOOL)failWithErrorString:(nonnull NSString *)anErrorString
+{
+    NSLog(@"ERR: %@ (%@, %d)", anErrorString, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    self.transformError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:@{NSLocalizedDescriptionKey: anErrorString}];
+    return NO;
+}
+
+
+#pragma mark - Description
+
+
+- (NSString *)description
+{
+    NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
+    [aDescriptionDict setObject:self.outputURL forKey:@"outputURL"];
+    [aDescriptionDict setObject:@(self.state) forKey:@"state"];
+    [aDescriptionDict setObject:@(self.entriesCount) forKey:@"entriesCount"];
+    [aDescriptionDict setObject:@(self.writtenBytesCount) forKey:@"writtenBytesCount"];
+    if (self.transformError)
+    {
+        [aDescriptionDict setObject:self.transformError forKey:@"transformError"];
+    }
+    
+    NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
+    
+    return aDescriptionString;
+}
+
+@end
@@ -38,6 +38,13 @@
 #import "HWIFileDownloadDelegate.h"
 #import "HWIBackgroundSessionCompletionHandlerBlock.h"
 #import "HWIFileDownloadProgress.h"
+#import "HWIFileDownloadPriority.h"
+#import "HWIFileDownloadOptions.h"
+#import "HWIFileDownloadBatchItem.h"
+#import "HWIFileDownloadCache.h"
+#import "HWIFileDownloadTransport.h"
+#import "HWIFileDownloadMetrics.h"
+#import "HWIFileDownloadProgressSnapshot.h"
 
 
 /**
@@ -61,6 +68,139 @@ typedef void (^HWIFileDownloaderPauseResumeDataBlock)(NSData * _Nullable resumeD
  */
 @property (readonly, nonatomic, nonnull) NSURLSessionConfiguration *backgroundSessionConfiguration;
 
+/**
+ Size of the write buffer in bytes for each download on the NSURLConnection data path (iOS 6). Default: 256 KB.
+ @discussion Received chunks are coalesced in the write buffer and written to the temporary file in writes of the buffer size. With 0 every chunk is written directly. Changes apply to downloads started afterwards.
+ */
+@property (nonatomic, assign) NSUInteger fileWriteBufferSize;
+
+/**
+ Number of bytes written to temporary files on the NSURLConnection data path (iOS 6).
+ */
+@property (readonly, nonatomic, assign) int64_t writtenBytesCount;
+
+/**
+ Number of file system calls (open, write, close) issued for temporary files on the NSURLConnection data path (iOS 6).
+ */
+@property (readonly, nonatomic, assign) NSUInteger fileSystemCallsCount;
+
+/**
+ Maximum number of progress deliveries per second over all downloads. Default: 0.0 (progress changes are delivered with every received chunk).
+ @discussion With a rate greater than 0.0 progress changes are coalesced: all downloads changed since the last delivery are delivered together with one call of the delegate's downloadProgressChangedForIdentifiers: (or downloadProgressChangedForIdentifier: for each download if not implemented).
+ */
+@property (nonatomic, assign) double maximumProgressDeliveryRate;
+
+/**
+ Maximum number of progress deliveries per second for an individual download. Default: 0.0 (no limit per download).
+ @discussion A rate greater than 0.0 enables coalescing of progress changes as well.
+ */
+@property (nonatomic, assign) double maximumProgressDeliveryRatePerDownload;
+
+/**
+ Number of progress changes that have not been delivered individually because of coalescing.
+ */
+@property (readonly, nonatomic, assign) NSUInteger suppressedProgressCallbacksCount;
+
+/**
+ Maximum number of bytes per second received by all downloads together. Default: 0 (no limit).
+ @discussion Received bytes are taken from token buckets. When a bucket is empty, the download is suspended until the bucket has been refilled (NSURLSessionTask suspend, NSURLConnection unscheduled from its run loop). Received data might exceed the limit for short periods by the size of the chunks delivered by the system. Changes apply immediately.
+ */
+@property (nonatomic, assign) int64_t maximumBytesPerSecond;
+
+/**
+ Maximum number of received bytes of all downloads queued for writing but not yet written. Default: 32 MB (0: no limit).
+ @discussion Applies to the data written by the downloader (NSURLConnection, custom transports and streamed downloads). When the disk is slower than the network the data would otherwise pile up in memory. When the budget is exceeded all transfers writing data are suspended until half of the budget has been written. The high-water mark and the stalls are available in statisticsDictionary. Changes apply immediately.
+ */
+@property (nonatomic, assign) int64_t maximumPendingWriteBytesCount;
+
+/**
+ Coalesce downloads of the same remote URL. Default: NO.
+ @discussion A download started for a remote URL that is already downloading or waiting is attached to that download instead of sending another request. On completion the attached download gets its own file (localFileURLForIdentifier:remoteURL:) as hard link to the downloaded file (or copy if linking fails). Cancelling an attached download only detaches it; cancelling the original download keeps the transfer running for the attached downloads. Pausing the original download fails the attached downloads. Downloads started with resume data are not coalesced.
+ */
+@property (nonatomic, assign) BOOL coalescesDownloadsWithSameRemoteURL;
+
+/**
+ Number of downloads attached to another download of the same remote URL (requests not sent).
+ */
+@property (readonly, nonatomic, assign) NSUInteger coalescedRequestsCount;
+
+/**
+ Number of bytes of files provided to attached downloads without downloading them.
+ */
+@property (readonly, nonatomic, assign) int64_t coalescedBytesCount;
+
+/**
+ Cache of downloaded files (default: nil, no caching).
+ @discussion Downloads of a remote URL with a fresh cache entry are completed from the cache without a request. Otherwise the request is sent with the validators of the cache entry and a 304 (Not Modified) response is completed from the cache. Files of successful (200) downloads are added to the cache.
+ */
+@property (nonatomic, strong, nullable) HWIFileDownloadCache *cache;
+
+/**
+ Local file URL of a journal of waiting downloads (default: nil, no journal).
+ @discussion Enqueued, started and finished downloads are recorded in an append-only file; resume data of waiting downloads is stored next to it. On setupWithCompletionBlock: downloads that have not been finished are queued again with their priority, options (including the retry policy), retries count and resume data or partial file (with NSURLSession only the downloads that had not been started or were waiting for a retry, started downloads are continued by the session). Records are written within half a second. Needs to be set before setupWithCompletionBlock: is called.
+ */
+@property (nonatomic, strong, nullable) NSURL *queueJournalFileURL;
+
+/**
+ Snapshot of counters for measuring the downloader, e.g. for regression benchmarks.
+ @discussion Keys: activeDownloadsCount, waitingDownloadsCount, storedResumeDataBytesCount (resume data of waiting downloads kept in files), concurrentDownloadsWindow, completedDownloadsCount, failedDownloadsCount, receivedBytesCount, bytesPerSecondSpeed, writtenBytesCount, fileSystemCallsCount, suppressedProgressCallbacksCount, coalescedRequestsCount, coalescedBytesCount, retriesCount, retryResumedBytesCount (bytes not downloaded again thanks to retries continuing partial data), streamedBytesCount, streamSuspensionsCount, pendingWriteBytesCount (received bytes not yet written), pendingWriteBytesHighWaterMark, writeStallsCount (times the write budget was exceeded), writeStallDuration (seconds the transfers were held for the writer), processCPUTime (seconds, user and system) and processPeakResidentSize (maximum resident set size of the process). Values are NSNumbers, so the dictionary can be serialized as JSON or property list.
+ */
+@property (readonly, nonatomic, strong, nonnull) NSDictionary<NSString *, NSNumber *> *statisticsDictionary;
+
+/**
+ Download speed of all active downloads together in bytes per second, measured over the last seconds.
+ */
+@property (readonly, nonatomic, assign) NSUInteger bytesPerSecondSpeed;
+
+/**
+ Flag whether the number of concurrent downloads is tuned from the observed throughput (default: NO).
+ @discussion The window of concurrent downloads starts with minimumConcurrentDownloadsCount and is evaluated every two seconds while downloads are waiting: it grows by one as long as throughput and time to first byte are stable and shrinks by a quarter when the throughput drops or the time to first byte doubles. The window stays within minimumConcurrentDownloadsCount and the maximum number of concurrent downloads of the initializer (8 without limit). Running downloads are not cancelled when the window shrinks.
+ */
+@property (nonatomic, assign) BOOL adaptsConcurrentDownloadsCount;
+
+/**
+ Lowest number of concurrent downloads with adaptsConcurrentDownloadsCount (default: 1).
+ */
+@property (nonatomic, assign) NSUInteger minimumConcurrentDownloadsCount;
+
+/**
+ Current maximum number of concurrent downloads, -1 for no limit.
+ */
+@property (readonly, nonatomic, assign) NSInteger concurrentDownloadsWindow;
+
+/**
+ Recent decisions of adaptsConcurrentDownloadsCount, oldest first.
+ @discussion Dictionaries with the keys time (time interval since reference date), window, previousWindow, bytesPerSecondSpeed, latency (average time to first byte in seconds) and reason (increase, hold, latency, throughput). Empty if adaptsConcurrentDownloadsCount is NO.
+ */
+@property (readonly, nonatomic, strong, nonnull) NSArray<NSDictionary<NSString *, id> *> *concurrencyDecisionsLog;
+
+/**
+ Maximum number of concurrent downloads of a single host (default: -1, no limit).
+ @discussion Waiting downloads of other hosts are started while a host is at its limit. Within a priority the hosts of waiting downloads take turns, so a large batch of one host does not hold back the downloads of other hosts. Downloads started with resume data have no host and are not limited.
+ */
+@property (nonatomic, assign) NSInteger maxConcurrentDownloadsPerHostCount;
+
+/**
+ Maximum numbers of concurrent downloads of single hosts by host name, overriding maxConcurrentDownloadsPerHostCount (default: empty).
+ */
+@property (nonatomic, copy, nonnull) NSDictionary<NSString *, NSNumber *> *maxConcurrentDownloadsCountsPerHostDictionary;
+
+/**
+ Current numbers of downloads by lowercase host name, each with the keys activeDownloadsCount and waitingDownloadsCount.
+ */
+@property (readonly, nonatomic, strong, nonnull) NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *hostDownloadsCountsDictionary;
+
+/**
+ Flag whether the timing metrics of finished downloads are aggregated in histograms per host (default: NO).
+ */
+@property (nonatomic, assign) BOOL collectsMetricsHistograms;
+
+/**
+ Percentiles of the timing metrics aggregated since collecting has been switched on.
+ @discussion Dictionary by host with dictionaries by phase (queueWaitTime, domainLookupDuration, connectDuration, secureConnectionDuration, timeToFirstByte, transferDuration) with the keys count, p50, p95 and p99 (seconds). Empty if collectsMetricsHistograms is NO.
+ */
+@property (readonly, nonatomic, strong, nonnull) NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *metricsPercentilesDictionary;
+
 
 #pragma mark - Initialization
 
@@ -88,6 +228,28 @@ typedef void (^HWIFileDownloaderPauseResumeDataBlock)(NSData * _Nullable resumeD
  @return HWIFileDownloader.
  */
 - (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)delegate maxConcurrentDownloads:(NSInteger)maxConcurrentFileDownloadsCount backgroundSessionIdentifier:(nonnull NSString *)backgroundSessionIdentifier;
+
+/**
+ Initializer for handling download events off the main queue.
+ On iOS 8 (and later) session events, file moves and the delegate's query methods (e.g. localFileURLForIdentifier:remoteURL:) are handled on a private serial queue. Notifications (increment/decrement, progress, completion, failure, pause) are dispatched to the delegate queue. On iOS 7 (and earlier) everything is handled on the main queue.
+ @param delegate Delegate for salient download events.
+ @param maxConcurrentFileDownloadsCount Maximum number of concurrent downloads. Default: no limit.
+ @param backgroundSessionIdentifier NSURLSession's configuration identifier
+ @param delegateQueue Serial queue for delegate notifications. Default: main queue.
+ @return HWIFileDownloader.
+ */
+- (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)delegate maxConcurrentDownloads:(NSInteger)maxConcurrentFileDownloadsCount backgroundSessionIdentifier:(nonnull NSString *)backgroundSessionIdentifier delegateQueue:(nullable dispatch_queue_t)delegateQueue;
+
+/**
+ Initializer for transferring data with a custom transport instead of NSURLSession/NSURLConnection.
+ Downloads are scheduled, written and finished as usual; the data is received from the transport (e.g. HWIFileDownloadLoopbackTransport for measuring without network). Downloads are not continued in the background, are paused without resume data and are not segmented. Events are handled on a private serial queue (iOS 8 and later) as with initWithDelegate:maxConcurrentDownloads:backgroundSessionIdentifier:delegateQueue:.
+ @param delegate Delegate for salient download events.
+ @param maxConcurrentFileDownloadsCount Maximum number of concurrent downloads. Default: no limit.
+ @param transport Transport for the data of downloads.
+ @param delegateQueue Serial queue for delegate notifications. Default: main queue.
+ @return HWIFileDownloader.
+ */
+- (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)delegate maxConcurrentDownloads:(NSInteger)maxConcurrentFileDownloadsCount transport:(nonnull id<HWIFileDownloadTransport>)transport delegateQueue:(nullable dispatch_queue_t)delegateQueue;
 - (nonnull HWIFileDownloader*)init __attribute__((unavailable("use initWithDelegate:maxConcurrentDownloads: or initWithDelegate:")));
 + (nonnull HWIFileDownloader*)new __attribute__((unavailable("use initWithDelegate:maxConcurrentDownloads: or initWithDelegate:")));
 
@@ -126,6 +288,63 @@ typedef void (^HWIFileDownloaderPauseResumeDataBlock)(NSData * _Nullable resumeD
 - (void)startDownloadWithIdentifier:(nonnull NSString *)identifier
                     usingResumeData:(nonnull NSData *)resumeData;
 
+/**
+ Starts a download with a priority.
+ @param identifier Download identifier of a download item.
+ @param remoteURL Remote URL from where data should be downloaded.
+ @param priority Priority of the download. Waiting downloads with a higher priority are started first.
+ */
+- (void)startDownloadWithIdentifier:(nonnull NSString *)identifier
+                      fromRemoteURL:(nonnull NSURL *)remoteURL
+                           priority:(HWIFileDownloadPriority)priority;
+
+/**
+ Starts a download with a priority.
+ @param identifier Download identifier of a download item.
+ @param resumeData Incomplete data from previous download with implicit remote source information.
+ @param priority Priority of the download. Waiting downloads with a higher priority are started first.
+ */
+- (void)startDownloadWithIdentifier:(nonnull NSString *)identifier
+                    usingResumeData:(nonnull NSData *)resumeData
+                           priority:(HWIFileDownloadPriority)priority;
+
+/**
+ Starts a download with options.
+ @param identifier Download identifier of a download item.
+ @param remoteURL Remote URL from where data should be downloaded.
+ @param options Options of the download (e.g. priority and segmentation). The options are copied.
+ */
+- (void)startDownloadWithIdentifier:(nonnull NSString *)identifier
+                      fromRemoteURL:(nonnull NSURL *)remoteURL
+                            options:(nonnull HWIFileDownloadOptions *)options;
+
+/**
+ Starts a download with options.
+ @param identifier Download identifier of a download item.
+ @param resumeData Incomplete data from previous download with implicit remote source information.
+ @param options Options of the download. The options are copied. Segmentation options are ignored when resuming; resume data of a segmented download continues its segments.
+ */
+- (void)startDownloadWithIdentifier:(nonnull NSString *)identifier
+                    usingResumeData:(nonnull NSData *)resumeData
+                            options:(nonnull HWIFileDownloadOptions *)options;
+
+/**
+ Starts a batch of downloads.
+ @param batchItems Downloads with identifier, remote URL or resume data and options.
+ @discussion The batch is scheduled in one pass: downloads with a higher priority are started first up to the maximum number of concurrent downloads, the others are queued. The total unit count of the root progress is adjusted once for the batch.
+ */
+- (void)startDownloadsWithBatchItems:(nonnull NSArray<HWIFileDownloadBatchItem *> *)batchItems;
+
+
+/**
+ Changes the priority of a download.
+ @param priority New priority of the download.
+ @param identifier Download identifier of the download item.
+ @return YES if a waiting or running download was found for the download item, NO otherwise.
+ @discussion A waiting download is moved to the end of the waiting downloads with the new priority. For a running download the priority is passed on to the NSURLSessionTask (iOS 8 and later).
+ */
+- (BOOL)setPriority:(HWIFileDownloadPriority)priority forDownloadWithIdentifier:(nonnull NSString *)identifier;
+
 
 /**
  Answers the question whether a download is currently running for a download item.
@@ -159,6 +378,70 @@ typedef void (^HWIFileDownloaderPauseResumeDataBlock)(NSData * _Nullable resumeD
 - (void)cancelDownloadWithIdentifier:(nonnull NSString *)identifier;
 
 
+/**
+ Cancels the downloads of download items.
+ @param identifiers Download identifiers of the download items.
+ @discussion Waiting downloads are removed first, so that no waiting download of the batch is started in place of a cancelled running download.
+ */
+- (void)cancelDownloadsWithIdentifiers:(nonnull NSArray<NSString *> *)identifiers;
+
+
+/**
+ Cancels the running and waiting downloads passing a test.
+ @param predicate Block called with the download identifier of each running and waiting download on the downloader queue.
+ */
+- (void)cancelDownloadsPassingTest:(nonnull BOOL (^)(NSString * _Nonnull identifier))predicate;
+
+
+/**
+ Cancels the running and waiting downloads of a group.
+ @param groupTag Group tag of the downloads (see HWIFileDownloadOptions).
+ */
+- (void)cancelDownloadsWithGroupTag:(nonnull NSString *)groupTag;
+
+
+/**
+ Pauses the downloads of download items.
+ @param identifiers Download identifiers of the download items.
+ @discussion Paused running downloads are passed to downloadPausedWithIdentifier:resumeData: of the delegate; waiting downloads are removed and fail as cancelled.
+ */
+- (void)pauseDownloadsWithIdentifiers:(nonnull NSArray<NSString *> *)identifiers;
+
+
+/**
+ Pauses the running and waiting downloads passing a test.
+ @param predicate Block called with the download identifier of each running and waiting download on the downloader queue.
+ */
+- (void)pauseDownloadsPassingTest:(nonnull BOOL (^)(NSString * _Nonnull identifier))predicate;
+
+
+/**
+ Pauses the running and waiting downloads of a group.
+ @param groupTag Group tag of the downloads (see HWIFileDownloadOptions).
+ */
+- (void)pauseDownloadsWithGroupTag:(nonnull NSString *)groupTag;
+
+
+#pragma mark - Bandwidth
+
+
+/**
+ Limits the bytes per second received by all downloads of a priority together.
+ @param maximumBytesPerSecond Limit in bytes per second (0: no limit).
+ @param priority Priority of the downloads.
+ */
+- (void)setMaximumBytesPerSecond:(int64_t)maximumBytesPerSecond forPriority:(HWIFileDownloadPriority)priority;
+
+
+/**
+ Limits the bytes per second received by a download.
+ @param maximumBytesPerSecond Limit in bytes per second (0: no limit).
+ @param identifier Download identifier of the download item.
+ @discussion The limit can be set before the download is started. It is kept across retries and removed when the download has completed, failed or been cancelled.
+ */
+- (void)setMaximumBytesPerSecond:(int64_t)maximumBytesPerSecond forDownloadWithIdentifier:(nonnull NSString *)identifier;
+
+
 #pragma mark - BackgroundSessionCompletionHandler
 
 
@@ -180,4 +463,30 @@ typedef void (^HWIFileDownloaderPauseResumeDataBlock)(NSData * _Nullable resumeD
 - (nullable HWIFileDownloadProgress *)downloadProgressForIdentifier:(nonnull NSString *)identifier;
 
 
+/**
+ Fills a buffer with the progress of the active and waiting downloads among the passed download identifiers.
+ @param snapshots Buffer for at least maxCount snapshots, e.g. allocated once for the number of rows of a list.
+ @param maxCount Capacity of the buffer.
+ @param identifiers Download identifiers, e.g. of the visible rows.
+ @return Number of filled snapshots (identifiers of downloads that are neither active nor waiting are left out).
+ @discussion The passed downloads are read in one pass on the downloader queue without creating progress objects and without changing the native progress, so the call is suited for refreshing many rows at a high rate. Downloads waiting for a retry are reported as waiting.
+ */
+- (NSUInteger)getProgressSnapshots:(nonnull HWIFileDownloadProgressSnapshot *)snapshots
+                          maxCount:(NSUInteger)maxCount
+                    forIdentifiers:(nonnull NSArray<NSString *> *)identifiers;
+
+
+/**
+ Fills a buffer with the progress of all active and waiting downloads.
+ @param snapshots Buffer for at least maxCount snapshots.
+ @param maxCount Capacity of the buffer.
+ @param identifiers Array receiving the download identifier of each filled snapshot (at its identifierIndex); previous contents are removed.
+ @return Number of filled snapshots; less than all downloads if the buffer is full.
+ @discussion All downloads are read in one pass on the downloader queue: active downloads first, then the waiting downloads in start order, then downloads waiting for a retry (reported as waiting). Coalesced downloads are reported with the progress of their shared transfer. No progress objects are created.
+ */
+- (NSUInteger)getAllProgressSnapshots:(nonnull HWIFileDownloadProgressSnapshot *)snapshots
+                             maxCount:(NSUInteger)maxCount
+                          identifiers:(nonnull NSMutableArray<NSString *> *)identifiers;
+
+
 @end
@@ -33,22 +33,100 @@
  ***************************************************************************/
 
 
+#import <sys/resource.h>
+
 #import "HWIFileDownloader.h"
 #import "HWIFileDownloadItem.h"
-
-
-@interface HWIFileDownloader()<NSURLSessionDelegate, NSURLSessionTaskDelegate, NSURLSessionDataDelegate, NSURLSessionDownloadDelegate, NSURLConnectionDelegate>
+#import "HWIFileDownloadWaitingQueue.h"
+#import "HWIFileDownloadFileWriter.h"
+#import "HWIFileDownloadSegment.h"
+#import "HWIFileDownloadProgressCoalescer.h"
+#import "HWIFileDownloadDigest.h"
+#import "HWIFileDownloadBandwidthThrottle.h"
+#import "HWIFileDownloadDeduplicator.h"
+#import "HWIFileDownloadMetricsRecorder.h"
+#import "HWIFileDownloadThroughputEstimator.h"
+#import "HWIFileDownloadJournal.h"
+#import "HWIFileDownloadResumeDataStore.h"
+#import "HWIFileDownloadConcurrencyController.h"
+#import "HWIFileDownloadStream.h"
+#import "HWIFileDownloadGzipTransform.h"
+#import "HWIFileDownloadZipTransform.h"
+#import "HWIFileDownloadWriteBudget.h"
+
+
+static const NSUInteger HWIFileDownloadSegmentedDownloadIDOffset = 1 << 30; // download ids of segmented downloads must not collide with task identifiers
+static const NSUInteger HWIFileDownloadStreamDownloadIDOffset = 1 << 29; // download ids of streamed downloads (NSURLSession) must not collide with task identifiers
+static NSString * const HWIFileDownloadSegmentsResumeDataVersionKey = @"HWIFileDownloadSegmentsResumeDataVersion"; // marks resume data of segmented downloads
+static void *HWIFileDownloaderDispatchQueueKey = &HWIFileDownloaderDispatchQueueKey;
+
+
+typedef NS_ENUM(NSUInteger, HWIFileDownloaderTransportKind) {
+    HWIFileDownloaderTransportKindSession = 0, // NSURLSession (iOS 7 and later)
+    HWIFileDownloaderTransportKindConnection, // NSURLConnection (iOS 6)
+    HWIFileDownloaderTransportKindCustom // HWIFileDownloadTransport
+};
+static const NSTimeInterval HWIFileDownloaderMinimumThrottleDelay = 0.01; // shorter delays are carried over to the next chunk
+static const NSTimeInterval HWIFileDownloaderCacheIndexSaveDelay = 2.0; // cache index changes are saved together
+static const NSTimeInterval HWIFileDownloaderQueueJournalFlushDelay = 0.5; // journal records are written together
+static const NSTimeInterval HWIFileDownloaderSegmentsResumeDataSaveDelay = 1.0; // received ranges of segmented downloads are saved together
+static const NSUInteger HWIFileDownloaderAdaptiveMaximumConcurrentDownloadsCount = 8; // upper bound of the window without maximum number of concurrent downloads
+static const NSUInteger HWIFileDownloaderDecodeReadBufferSize = 256 * 1024; // chunk size of decoding a downloaded file
+static const int64_t HWIFileDownloaderDefaultMaximumPendingWriteBytesCount = 32 * 1024 * 1024;
+
+
+@interface HWIFileDownloader()<NSURLSessionDelegate, NSURLSessionTaskDelegate, NSURLSessionDataDelegate, NSURLSessionDownloadDelegate, NSURLConnectionDelegate, HWIFileDownloadTransportDelegate>
 
 @property (nonatomic, copy, nonnull) NSString *backgroundSessionIdentifier;
+@property (nonatomic, assign) HWIFileDownloaderTransportKind transportKind; // settled on initialization
 @property (nonatomic, strong, nullable) NSURLSession *backgroundSession;
+@property (nonatomic, strong, nullable) id<HWIFileDownloadTransport> transport;
 @property (nonatomic, strong, nonnull) NSMutableDictionary<NSNumber *, HWIFileDownloadItem *> *activeDownloadsDictionary;
-@property (nonatomic, strong, nonnull) NSMutableArray<NSDictionary <NSString *, NSObject *> *> *waitingDownloadsArray;
+@property (nonatomic, strong, nonnull) HWIFileDownloadWaitingQueue *waitingDownloadsQueue;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSNumber *> *activeDownloadIDsDictionary;
+@property (nonatomic, strong, nonnull) NSMapTable<NSURLConnection *, NSNumber *> *connectionDownloadIDsMapTable;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSNumber *, NSNumber *> *segmentDownloadIDsDictionary;
+@property (nonatomic, strong, nullable) NSURLSession *segmentProbeSession;
+@property (nonatomic, strong, nullable) NSURLSession *streamSession; // data tasks of streamed and segmented downloads
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSNumber *, NSNumber *> *streamDataTaskDownloadIDsDictionary;
 @property (nonatomic, weak, nullable) NSObject<HWIFileDownloadDelegate>* fileDownloadDelegate;
 @property (nonatomic, copy, nullable) HWIBackgroundSessionCompletionHandlerBlock bgSessionCompletionHandlerBlock;
 @property (nonatomic, assign) NSInteger maxConcurrentFileDownloadsCount;
 
 @property (nonatomic, assign) NSUInteger highestDownloadID;
+@property (nonatomic, assign) int64_t reservedRootProgressUnitsCount; // added in advance for a batch
+@property (nonatomic, strong, nullable) NSProgress *retriedDownloadProgress; // taken over by the restart of a retried download
+@property (nonatomic, assign) NSUInteger retriedDownloadRetriesCount; // taken over by the restart of a retried download
 @property (nonatomic, strong, nullable) dispatch_queue_t downloadFileSerialWriterDispatchQueue;
+@property (nonatomic, strong, nonnull) NSMutableSet<HWIFileDownloadFileWriter *> *openFileWritersSet;
+@property (nonatomic, assign) int64_t closedFileWritersWrittenBytesCount;
+@property (nonatomic, assign) NSUInteger closedFileWritersSystemCallsCount;
+@property (nonatomic, strong, nonnull) HWIFileDownloadProgressCoalescer *progressCoalescer;
+@property (nonatomic, assign) BOOL isProgressDeliveryScheduled;
+@property (nonatomic, strong, nonnull) HWIFileDownloadBandwidthThrottle *bandwidthThrottle;
+@property (nonatomic, strong, nonnull) HWIFileDownloadDeduplicator *deduplicator;
+@property (nonatomic, assign) BOOL isCacheIndexSaveScheduled;
+@property (nonatomic, strong, nullable) HWIFileDownloadJournal *queueJournal;
+@property (nonatomic, assign) BOOL isQueueJournalFlushScheduled;
+@property (nonatomic, strong, nonnull) HWIFileDownloadResumeDataStore *resumeDataStore;
+@property (nonatomic, assign) NSUInteger completedDownloadsCount;
+@property (nonatomic, assign) NSUInteger failedDownloadsCount;
+@property (nonatomic, assign) int64_t receivedBytesCount;
+@property (nonatomic, strong, nonnull) HWIFileDownloadThroughputEstimator *throughputEstimator; // all downloads
+@property (nonatomic, strong, nullable) HWIFileDownloadMetricsRecorder *metricsRecorder;
+@property (nonatomic, strong, nullable) HWIFileDownloadConcurrencyController *concurrencyController;
+@property (nonatomic, strong, nonnull) NSCountedSet<NSString *> *activeHostKeysCountedSet;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, HWIFileDownloadWaitingItem *> *backingOffWaitingItemsDictionary; // downloads waiting for a retry
+@property (nonatomic, assign) NSUInteger retriesCount;
+@property (nonatomic, assign) int64_t retryResumedBytesCount;
+@property (nonatomic, assign) int64_t streamedBytesCount;
+@property (nonatomic, assign) NSUInteger streamSuspensionsCount;
+@property (nonatomic, strong, nonnull) HWIFileDownloadWriteBudget *writeBudget; // received data queued to downloadFileSerialWriterDispatchQueue
+
+@property (nonatomic, assign) BOOL usesPrivateDispatchQueue;
+@property (nonatomic, strong, nonnull) dispatch_queue_t downloaderDispatchQueue; // session events and download state
+@property (nonatomic, strong, nonnull) NSOperationQueue *sessionDelegateOperationQueue;
+@property (nonatomic, strong, nullable) dispatch_queue_t delegateCallbackDispatchQueue; // nil: delegate is called directly
 
 @end
 
@@ -71,10 +149,57 @@
 }
 
 - (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)aDelegate maxConcurrentDownloads:(NSInteger)aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:(nonnull NSString *)aBackgroundSessionIdentifier
+{
+    return [self initWithDelegate:aDelegate maxConcurrentDownloads:aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:aBackgroundSessionIdentifier usesPrivateDispatchQueue:NO transport:nil delegateQueue:nil];
+}
+
+- (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)aDelegate maxConcurrentDownloads:(NSInteger)aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:(nonnull NSString *)aBackgroundSessionIdentifier delegateQueue:(nullable dispatch_queue_t)aDelegateQueue
+{
+    return [self initWithDelegate:aDelegate maxConcurrentDownloads:aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:aBackgroundSessionIdentifier usesPrivateDispatchQueue:YES transport:nil delegateQueue:aDelegateQueue];
+}
+
+- (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)aDelegate maxConcurrentDownloads:(NSInteger)aMaxConcurrentFileDownloadsCount transport:(nonnull id<HWIFileDownloadTransport>)aTransport delegateQueue:(nullable dispatch_queue_t)aDelegateQueue
+{
+    NSString *aBackgroundDownloadSessionIdentifier = [NSString stringWithFormat:@"%@.HWIFileDownload.%@", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"], [NSUUID new].UUIDString];
+    return [self initWithDelegate:aDelegate maxConcurrentDownloads:aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:aBackgroundDownloadSessionIdentifier usesPrivateDispatchQueue:YES transport:aTransport delegateQueue:aDelegateQueue];
+}
+
+- (nonnull instancetype)initWithDelegate:(nonnull NSObject<HWIFileDownloadDelegate>*)aDelegate maxConcurrentDownloads:(NSInteger)aMaxConcurrentFileDownloadsCount backgroundSessionIdentifier:(nonnull NSString *)aBackgroundSessionIdentifier usesPrivateDispatchQueue:(BOOL)aUsesPrivateDispatchQueueFlag transport:(nullable id<HWIFileDownloadTransport>)aTransport delegateQueue:(nullable dispatch_queue_t)aDelegateQueue
 {
     self = [super init];
     if (self)
     {
+        if (aTransport)
+        {
+            self.transportKind = HWIFileDownloaderTransportKindCustom;
+        }
+        else if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+        {
+            self.transportKind = HWIFileDownloaderTransportKindSession;
+        }
+        else
+        {
+            self.transportKind = HWIFileDownloaderTransportKindConnection;
+        }
+        
+        // NSOperationQueue's underlyingQueue is available since iOS 8
+        self.usesPrivateDispatchQueue = (aUsesPrivateDispatchQueueFlag && (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1));
+        if (self.usesPrivateDispatchQueue)
+        {
+            self.downloaderDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.downloader", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+            dispatch_queue_set_specific(self.downloaderDispatchQueue, HWIFileDownloaderDispatchQueueKey, (__bridge void *)self, NULL);
+            self.sessionDelegateOperationQueue = [[NSOperationQueue alloc] init];
+            self.sessionDelegateOperationQueue.maxConcurrentOperationCount = 1;
+            self.sessionDelegateOperationQueue.underlyingQueue = self.downloaderDispatchQueue;
+            self.delegateCallbackDispatchQueue = aDelegateQueue ? aDelegateQueue : dispatch_get_main_queue();
+        }
+        else
+        {
+            self.downloaderDispatchQueue = dispatch_get_main_queue();
+            self.sessionDelegateOperationQueue = [NSOperationQueue mainQueue];
+            self.delegateCallbackDispatchQueue = nil;
+        }
+        
         self.backgroundSessionIdentifier = aBackgroundSessionIdentifier;
         self.maxConcurrentFileDownloadsCount = -1;
         if (aMaxConcurrentFileDownloadsCount > 0)
@@ -84,10 +209,45 @@
         
         self.fileDownloadDelegate = aDelegate;
         self.activeDownloadsDictionary = [NSMutableDictionary dictionary];
-        self.waitingDownloadsArray = [NSMutableArray array];
+        self.waitingDownloadsQueue = [[HWIFileDownloadWaitingQueue alloc] init];
+        self.activeDownloadIDsDictionary = [NSMutableDictionary dictionary];
+        self.connectionDownloadIDsMapTable = [NSMapTable strongToStrongObjectsMapTable];
+        self.segmentDownloadIDsDictionary = [NSMutableDictionary dictionary];
+        self.streamDataTaskDownloadIDsDictionary = [NSMutableDictionary dictionary];
         self.highestDownloadID = 0;
+        self.fileWriteBufferSize = 256 * 1024;
+        self.openFileWritersSet = [NSMutableSet set];
+        self.closedFileWritersWrittenBytesCount = 0;
+        self.closedFileWritersSystemCallsCount = 0;
+        self.progressCoalescer = [[HWIFileDownloadProgressCoalescer alloc] init];
+        self.bandwidthThrottle = [[HWIFileDownloadBandwidthThrottle alloc] init];
+        self.deduplicator = [[HWIFileDownloadDeduplicator alloc] init];
+        // one directory for all downloaders: the default session identifiers are unique per app launch
+        NSString *aResumeDataDirectoryName = [NSString stringWithFormat:@"%@.HWIFileDownload.resumedata", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]];
+        self.resumeDataStore = [[HWIFileDownloadResumeDataStore alloc] initWithDirectoryURL:[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:aResumeDataDirectoryName] isDirectory:YES]];
+        // without journal nobody refers to files of a previous app launch; files of other downloaders of this launch are kept
+        [self.resumeDataStore removeAllResumeDataModifiedBeforeDate:[HWIFileDownloader appLaunchDate]];
+        self.coalescesDownloadsWithSameRemoteURL = NO;
+        self.isProgressDeliveryScheduled = NO;
+        self.isCacheIndexSaveScheduled = NO;
+        self.completedDownloadsCount = 0;
+        self.failedDownloadsCount = 0;
+        self.receivedBytesCount = 0;
+        self.throughputEstimator = [[HWIFileDownloadThroughputEstimator alloc] init];
+        _minimumConcurrentDownloadsCount = 1;
+        _maxConcurrentDownloadsPerHostCount = -1;
+        _maxConcurrentDownloadsCountsPerHostDictionary = @{};
+        self.activeHostKeysCountedSet = [NSCountedSet set];
+        self.backingOffWaitingItemsDictionary = [NSMutableDictionary dictionary];
+        self.retriesCount = 0;
+        self.retryResumedBytesCount = 0;
+        self.streamedBytesCount = 0;
+        self.streamSuspensionsCount = 0;
+        self.writeBudget = [[HWIFileDownloadWriteBudget alloc] initWithCapacity:HWIFileDownloaderDefaultMaximumPendingWriteBytesCount];
+        _adaptsConcurrentDownloadsCount = NO;
+        self.collectsMetricsHistograms = NO;
         
-        if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+        if (self.transportKind == HWIFileDownloaderTransportKindSession)
         {
             NSURLSessionConfiguration *aBackgroundSessionConfiguration = nil;
             if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1)
@@ -107,12 +267,14 @@
             }
             self.backgroundSession = [NSURLSession sessionWithConfiguration:aBackgroundSessionConfiguration
                                                                    delegate:self
-                                                              delegateQueue:[NSOperationQueue mainQueue]];
+                                                              delegateQueue:self.sessionDelegateOperationQueue];
         }
-        else
+        else if (self.transportKind == HWIFileDownloaderTransportKindCustom)
         {
-            self.downloadFileSerialWriterDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.downloadFileWriter", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
+            self.transport = aTransport;
+            [aTransport setTransportDelegate:self delegateQueue:self.downloaderDispatchQueue];
         }
+        self.downloadFileSerialWriterDispatchQueue = dispatch_queue_create([[NSString stringWithFormat:@"%@.downloadFileWriter", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"]] UTF8String], DISPATCH_QUEUE_SERIAL);
         
     }
     return self;
@@ -121,7 +283,7 @@
 
 - (void)setupWithCompletionBlock:(nullable void (^)(void))aSetupCompletionBlock
 {
-    if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+    if (self.transportKind == HWIFileDownloaderTransportKindSession)
     {
         [self.backgroundSession getTasksWithCompletionHandler:^(NSArray * _Nonnull aDataTasksArray, NSArray * _Nonnull anUploadTasksArray, NSArray * _Nonnull aDownloadTasksArray) {
             for (NSURLSessionDownloadTask *aDownloadTask in aDownloadTasksArray)
@@ -142,46 +304,52 @@
                     [aRootProgress resignCurrent];
                     if (aDownloadItem)
                     {
-                        [self.activeDownloadsDictionary setObject:aDownloadItem forKey:@(aDownloadTask.taskIdentifier)];
+                        [self addActiveDownloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier];
                         NSString *aDownloadToken = [aDownloadItem.downloadToken copy];
                         [aDownloadItem.progress setPausingHandler:^{
-                            dispatch_async(dispatch_get_main_queue(), ^{
+                            dispatch_async(self.downloaderDispatchQueue, ^{
                                 [self pauseDownloadWithIdentifier:aDownloadToken];
                             });
                         }];
                         [aDownloadItem.progress setCancellationHandler:^{
-                            dispatch_async(dispatch_get_main_queue(), ^{
+                            dispatch_async(self.downloaderDispatchQueue, ^{
                                 [self cancelDownloadWithIdentifier:aDownloadToken];
                             });
                         }];
                         if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_8_4)
                         {
                             [aDownloadItem.progress setResumingHandler:^{
-                                dispatch_async(dispatch_get_main_queue(), ^{
+                                dispatch_async(self.downloaderDispatchQueue, ^{
                                     [self resumeDownloadWithIdentifier:aDownloadToken];
                                 });
                             }];
                         }
                     }
-                    [self.fileDownloadDelegate incrementNetworkActivityIndicatorActivityCount];
+                    [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                        [aDelegate incrementNetworkActivityIndicatorActivityCount];
+                    }];
                 }
                 else
                 {
                     NSLog(@"ERR: Missing task description (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
                 }
             }
+            [self restoreWaitingDownloadsFromQueueJournal];
             if (aSetupCompletionBlock)
             {
-                aSetupCompletionBlock();
+                [self performCallback:aSetupCompletionBlock];
             }
         }];
     }
     else
     {
-        if (aSetupCompletionBlock)
-        {
-            aSetupCompletionBlock();
-        }
+        [self performOnDownloaderQueue:^{
+            [self restoreWaitingDownloadsFromQueueJournal];
+            if (aSetupCompletionBlock)
+            {
+                [self performCallback:aSetupCompletionBlock];
+            }
+        }];
     }
 }
 
@@ -189,6 +357,8 @@
 - (void)dealloc
 {
     [self.backgroundSession finishTasksAndInvalidate];
+    [self.segmentProbeSession invalidateAndCancel];
+    [self.streamSession invalidateAndCancel];
 }
 
 
@@ -198,27 +368,141 @@
 - (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
                       fromRemoteURL:(nonnull NSURL *)aRemoteURL
 {
-    [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:aRemoteURL usingResumeData:nil];
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:aRemoteURL usingResumeData:nil options:[[HWIFileDownloadOptions alloc] init]];
+    }];
+}
+
+
+- (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                    usingResumeData:(nonnull NSData *)aResumeData
+{
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:nil usingResumeData:aResumeData options:[[HWIFileDownloadOptions alloc] init]];
+    }];
+}
+
+
+- (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                      fromRemoteURL:(nonnull NSURL *)aRemoteURL
+                           priority:(HWIFileDownloadPriority)aPriority
+{
+    HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+    anOptions.priority = aPriority;
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:aRemoteURL usingResumeData:nil options:anOptions];
+    }];
+}
+
+
+- (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                    usingResumeData:(nonnull NSData *)aResumeData
+                           priority:(HWIFileDownloadPriority)aPriority
+{
+    HWIFileDownloadOptions *anOptions = [[HWIFileDownloadOptions alloc] init];
+    anOptions.priority = aPriority;
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:nil usingResumeData:aResumeData options:anOptions];
+    }];
+}
+
+
+- (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+                      fromRemoteURL:(nonnull NSURL *)aRemoteURL
+                            options:(nonnull HWIFileDownloadOptions *)anOptions
+{
+    // later changes of the caller do not affect the download
+    HWIFileDownloadOptions *aCopiedOptions = [anOptions copy];
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:aRemoteURL usingResumeData:nil options:aCopiedOptions];
+    }];
 }
 
 
 - (void)startDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
                     usingResumeData:(nonnull NSData *)aResumeData
+                            options:(nonnull HWIFileDownloadOptions *)anOptions
+{
+    HWIFileDownloadOptions *aCopiedOptions = [anOptions copy];
+    [self performOnDownloaderQueue:^{
+        [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:nil usingResumeData:aResumeData options:aCopiedOptions];
+    }];
+}
+
+
+- (void)startDownloadWithDownloadToken:(nonnull NSString *)aDownloadToken
+                         fromRemoteURL:(nullable NSURL *)aRemoteURL
+                       usingResumeData:(nullable NSData *)aResumeData
+                               options:(nonnull HWIFileDownloadOptions *)anOptions
 {
-    [self startDownloadWithDownloadToken:aDownloadIdentifier fromRemoteURL:nil usingResumeData:aResumeData];
+    [self startDownloadWithDownloadToken:aDownloadToken fromRemoteURL:aRemoteURL usingResumeData:aResumeData partialFileSize:0 options:anOptions];
 }
 
 
 - (void)startDownloadWithDownloadToken:(nonnull NSString *)aDownloadToken
                          fromRemoteURL:(nullable NSURL *)aRemoteURL
                        usingResumeData:(nullable NSData *)aResumeData
+                       partialFileSize:(int64_t)aPartialFileSize
+                               options:(nonnull HWIFileDownloadOptions *)anOptions
 {
+    BOOL aStreamsFlag = (anOptions.streamConsumer && (aResumeData == nil));
+    BOOL aDecodesFlag = (anOptions.transformKind != HWIFileDownloadTransformKindNone);
+    HWIFileDownloadCacheEntry *aCacheEntry = nil;
+    if (aRemoteURL && (aResumeData == nil) && (aPartialFileSize == 0) && self.cache && (aStreamsFlag == NO) && (aDecodesFlag == NO))
+    {
+        aCacheEntry = [self.cache entryForRemoteURL:aRemoteURL];
+        if (aCacheEntry && [self.cache isFreshEntry:aCacheEntry])
+        {
+            if ([self completeDownloadWithDownloadToken:aDownloadToken fromRemoteURL:aRemoteURL cacheEntry:aCacheEntry])
+            {
+                return;
+            }
+            aCacheEntry = nil;
+        }
+    }
+    
+    if (aRemoteURL && (aResumeData == nil) && self.coalescesDownloadsWithSameRemoteURL && (aStreamsFlag == NO) && (aDecodesFlag == NO))
+    {
+        NSString *aPrimaryDownloadToken = [self.deduplicator primaryDownloadTokenForRemoteURL:aRemoteURL];
+        if (aPrimaryDownloadToken == nil)
+        {
+            [self.deduplicator registerPrimaryDownloadToken:aDownloadToken forRemoteURL:aRemoteURL];
+        }
+        else if ([aPrimaryDownloadToken isEqualToString:aDownloadToken] == NO)
+        {
+            // the running or waiting download of the remote URL provides the file
+            [self.deduplicator attachDownloadToken:aDownloadToken toPrimaryDownloadToken:aPrimaryDownloadToken];
+            [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                [aDelegate incrementNetworkActivityIndicatorActivityCount];
+            }];
+            return;
+        }
+    }
+    
+    BOOL aHasFreeSlotFlag = ([self hasFreeDownloadSlot] && [self hasFreeDownloadSlotForHostKey:[HWIFileDownloader hostKeyForRemoteURL:aRemoteURL]]);
+    NSURL *aResumeDataFileURL = nil;
+    if (aResumeData && (aHasFreeSlotFlag == NO))
+    {
+        // waiting downloads keep their resume data in a file instead of memory
+        aResumeDataFileURL = [self.resumeDataStore storeResumeData:aResumeData];
+    }
+    if (aStreamsFlag == NO)
+    {
+        // the stream consumer does not survive the app
+        [self.queueJournal recordEnqueueOfDownloadToken:aDownloadToken remoteURL:(aResumeData ? nil : aRemoteURL) resumeDataFileName:aResumeDataFileURL.lastPathComponent options:anOptions];
+        [self scheduleQueueJournalFlush];
+    }
+    
     NSUInteger aDownloadID = 0;
+    BOOL anIsSegmentedFlag = NO;
+    NSDictionary *aSegmentsResumeDataDictionary = nil;
     
-    if ((self.maxConcurrentFileDownloadsCount == -1) || ((NSInteger)self.activeDownloadsDictionary.count < self.maxConcurrentFileDownloadsCount))
+    if (aHasFreeSlotFlag)
     {
         NSURLSessionDownloadTask *aDownloadTask = nil;
+        NSURLSessionDataTask *aStreamDataTask = nil;
         NSURLConnection *aURLConnection = nil;
+        NSURLRequest *aTransferURLRequest = nil;
         
         HWIFileDownloadItem *aDownloadItem = nil;
         NSProgress *aRootProgress = nil;
@@ -226,24 +510,32 @@
         {
             aRootProgress = [self.fileDownloadDelegate rootProgress];
         }
-        if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+        if ((self.transportKind == HWIFileDownloaderTransportKindSession) && (aStreamsFlag == NO))
         {
             if (aResumeData)
             {
-                aDownloadTask = [self.backgroundSession downloadTaskWithResumeData:aResumeData];
-            }
-            else if (aRemoteURL)
-            {
-                NSURLRequest *aURLRequest = nil;
-                if ([self.fileDownloadDelegate respondsToSelector:@selector(urlRequestForRemoteURL:)])
+                aSegmentsResumeDataDictionary = [HWIFileDownloader segmentsResumeDataDictionaryOfResumeData:aResumeData];
+                if (aSegmentsResumeDataDictionary)
                 {
-                    aURLRequest = [self.fileDownloadDelegate urlRequestForRemoteURL:aRemoteURL];
+                    // the segments continue at their received ranges
+                    anIsSegmentedFlag = YES;
+                    aDownloadID = HWIFileDownloadSegmentedDownloadIDOffset + self.highestDownloadID++;
+                    aRemoteURL = [NSURL URLWithString:[aSegmentsResumeDataDictionary objectForKey:@"remoteURL"]];
                 }
                 else
                 {
-                    NSTimeInterval aRequestTimeoutInterval = 60.0; // iOS default value
-                    aURLRequest = [[NSURLRequest alloc] initWithURL:aRemoteURL cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:aRequestTimeoutInterval];
+                    aDownloadTask = [self.backgroundSession downloadTaskWithResumeData:aResumeData];
                 }
+            }
+            else if (aRemoteURL && (anOptions.segmentsCount > 1))
+            {
+                // the segment tasks are created after probing the remote host
+                anIsSegmentedFlag = YES;
+                aDownloadID = HWIFileDownloadSegmentedDownloadIDOffset + self.highestDownloadID++;
+            }
+            else if (aRemoteURL)
+            {
+                NSURLRequest *aURLRequest = [self urlRequestForDownloadFromRemoteURL:aRemoteURL cacheEntry:aCacheEntry];
                 if (aURLRequest)
                 {
                     aDownloadTask = [self.backgroundSession downloadTaskWithRequest:aURLRequest];
@@ -253,21 +545,22 @@
                     NSLog(@"ERR: No url request (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
                 }
             }
-            aDownloadID = aDownloadTask.taskIdentifier;
-            aDownloadTask.taskDescription = aDownloadToken;
+            if (anIsSegmentedFlag == NO)
+            {
+                aDownloadID = aDownloadTask.taskIdentifier;
+                aDownloadTask.taskDescription = aDownloadToken;
+            }
             
-            aRootProgress.totalUnitCount++;
-            [aRootProgress becomeCurrentWithPendingUnitCount:1];
-            aDownloadItem = [[HWIFileDownloadItem alloc] initWithDownloadToken:aDownloadToken
-                                                           sessionDownloadTask:aDownloadTask
-                                                                 urlConnection:nil];
-            if (aResumeData)
+            aDownloadItem = [self downloadItemWithDownloadToken:aDownloadToken
+                                            sessionDownloadTask:aDownloadTask
+                                                  urlConnection:nil
+                                                   rootProgress:aRootProgress];
+            if (aResumeData && (anIsSegmentedFlag == NO))
             {
                 aDownloadItem.resumedFileSizeInBytes = aResumeData.length;
                 aDownloadItem.downloadStartDate = [NSDate date];
                 aDownloadItem.bytesPerSecondSpeed = 0;
             }
-            [aRootProgress resignCurrent];
         }
         else
         {
@@ -277,30 +570,74 @@
             }
             else
             {
-                aDownloadID = self.highestDownloadID++;
-                NSURLRequest *aURLRequest = nil;
-                if ([self.fileDownloadDelegate respondsToSelector:@selector(urlRequestForRemoteURL:)])
+                if (self.transportKind == HWIFileDownloaderTransportKindSession)
                 {
-                    aURLRequest = [self.fileDownloadDelegate urlRequestForRemoteURL:aRemoteURL];
+                    aDownloadID = HWIFileDownloadStreamDownloadIDOffset + self.highestDownloadID++;
                 }
                 else
                 {
-                    NSTimeInterval aRequestTimeoutInterval = 60.0; // iOS default value
-                    aURLRequest = [[NSURLRequest alloc] initWithURL:aRemoteURL cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:aRequestTimeoutInterval];
+                    aDownloadID = self.highestDownloadID++;
+                }
+                NSURLRequest *aURLRequest = [self urlRequestForDownloadFromRemoteURL:aRemoteURL cacheEntry:aCacheEntry];
+                if (aURLRequest && (aPartialFileSize > 0))
+                {
+                    // continues the partial file of a retried download
+                    NSMutableURLRequest *aRangeURLRequest = [aURLRequest mutableCopy];
+                    [aRangeURLRequest setValue:[NSString stringWithFormat:@"bytes=%lld-", aPartialFileSize] forHTTPHeaderField:@"Range"];
+                    aURLRequest = aRangeURLRequest;
                 }
                 if (aURLRequest)
                 {
+                    if (self.transportKind == HWIFileDownloaderTransportKindConnection)
+                    {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-                    aURLConnection = [[NSURLConnection alloc] initWithRequest:aURLRequest delegate:self startImmediately:NO];
+                        aURLConnection = [[NSURLConnection alloc] initWithRequest:aURLRequest delegate:self startImmediately:NO];
 #pragma GCC diagnostic pop
+                    }
+                    else if (self.transportKind == HWIFileDownloaderTransportKindSession)
+                    {
+                        aStreamDataTask = [[self openStreamSession] dataTaskWithRequest:aURLRequest];
+                        aStreamDataTask.taskDescription = aDownloadToken;
+                        [self.streamDataTaskDownloadIDsDictionary setObject:@(aDownloadID) forKey:@(aStreamDataTask.taskIdentifier)];
+                    }
+                    else
+                    {
+                        // started on the transport when the download item has been registered
+                        aTransferURLRequest = aURLRequest;
+                    }
                     
-                    aRootProgress.totalUnitCount++;
-                    [aRootProgress becomeCurrentWithPendingUnitCount:1];
-                    aDownloadItem = [[HWIFileDownloadItem alloc] initWithDownloadToken:aDownloadToken
-                                                                   sessionDownloadTask:nil
-                                                                         urlConnection:aURLConnection];
-                    [aRootProgress resignCurrent];
+                    aDownloadItem = [self downloadItemWithDownloadToken:aDownloadToken
+                                                    sessionDownloadTask:nil
+                                                          urlConnection:aURLConnection
+                                                           rootProgress:aRootProgress];
+                    aDownloadItem.streamDataTask = aStreamDataTask;
+                    
+                    if ((aStreamsFlag == NO) || anOptions.persistsStreamedData)
+                    {
+                        NSURL *aTempFileURL = [self tempLocalFileURLForDownloadFromURL:aRemoteURL];
+                        HWIFileDownloadFileWriter *aFileWriter = [[HWIFileDownloadFileWriter alloc] initWithFileURL:aTempFileURL bufferSize:self.fileWriteBufferSize];
+                        if (aPartialFileSize > 0)
+                        {
+                            aFileWriter.appendsToExistingFile = YES;
+                            aDownloadItem.resumedFileSizeInBytes = aPartialFileSize;
+                            aDownloadItem.receivedFileSizeInBytes = aPartialFileSize;
+                        }
+                        aDownloadItem.fileWriter = aFileWriter;
+                        if (aDecodesFlag)
+                        {
+                            // the decoded data is written to the temporary file URL instead of the file writer
+                            aDownloadItem.transform = [HWIFileDownloader transformOfKind:anOptions.transformKind outputURL:aTempFileURL bufferSize:self.fileWriteBufferSize];
+                        }
+                        if (anOptions.expectedDigest && (anOptions.digestAlgorithm != HWIFileDownloadDigestAlgorithmNone))
+                        {
+                            // computed on the file writer queue while the data is received
+                            aDownloadItem.digest = [[HWIFileDownloadDigest alloc] initWithAlgorithm:anOptions.digestAlgorithm];
+                        }
+                        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                            [self.openFileWritersSet addObject:aFileWriter];
+                        });
+                    }
                 }
                 else
                 {
@@ -310,125 +647,291 @@
         }
         if (aDownloadItem)
         {
-            [self.activeDownloadsDictionary setObject:aDownloadItem forKey:@(aDownloadID)];
+            aDownloadItem.remoteURL = aRemoteURL;
+            aDownloadItem.transferIdentifier = aDownloadID;
+            aDownloadItem.transferStartTime = [NSDate timeIntervalSinceReferenceDate];
+            aDownloadItem.options = anOptions;
+            aDownloadItem.isSegmented = anIsSegmentedFlag;
+            aDownloadItem.priority = anOptions.priority;
+            if (anIsSegmentedFlag == NO)
+            {
+                aDownloadItem.cacheEntry = aCacheEntry;
+            }
+            if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1)
+            {
+                aDownloadTask.priority = [HWIFileDownloader sessionTaskPriorityForPriority:anOptions.priority];
+                aStreamDataTask.priority = [HWIFileDownloader sessionTaskPriorityForPriority:anOptions.priority];
+            }
+            if (aStreamsFlag)
+            {
+                [self attachStreamToDownloadItem:aDownloadItem downloadID:aDownloadID];
+            }
+            [self addActiveDownloadItem:aDownloadItem downloadID:aDownloadID];
+            [self.queueJournal recordEvent:HWIFileDownloadJournalEventStart ofDownloadToken:aDownloadItem.downloadToken];
             NSString *aDownloadToken = [aDownloadItem.downloadToken copy];
             [aDownloadItem.progress setPausingHandler:^{
-                dispatch_async(dispatch_get_main_queue(), ^{
+                dispatch_async(self.downloaderDispatchQueue, ^{
                     [self pauseDownloadWithIdentifier:aDownloadToken];
                 });
             }];
             [aDownloadItem.progress setCancellationHandler:^{
-                dispatch_async(dispatch_get_main_queue(), ^{
+                dispatch_async(self.downloaderDispatchQueue, ^{
                     [self cancelDownloadWithIdentifier:aDownloadToken];
                 });
             }];
             if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_8_4)
             {
                 [aDownloadItem.progress setResumingHandler:^{
-                    dispatch_async(dispatch_get_main_queue(), ^{
+                    dispatch_async(self.downloaderDispatchQueue, ^{
                         [self resumeDownloadWithIdentifier:aDownloadToken];
                     });
                 }];
             }
-            [self.fileDownloadDelegate incrementNetworkActivityIndicatorActivityCount];
+            [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                [aDelegate incrementNetworkActivityIndicatorActivityCount];
+            }];
             
-            if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+            if (aSegmentsResumeDataDictionary)
+            {
+                [self continueSegmentsOfDownloadItem:aDownloadItem downloadID:aDownloadID resumeDataDictionary:aSegmentsResumeDataDictionary];
+            }
+            else if (anIsSegmentedFlag)
+            {
+                [self startSegmentProbeForDownloadItem:aDownloadItem downloadID:aDownloadID];
+            }
+            else if (aStreamDataTask)
+            {
+                [aStreamDataTask resume];
+            }
+            else if (self.transportKind == HWIFileDownloaderTransportKindSession)
             {
                 [aDownloadTask resume];
             }
-            else
+            else if (self.transportKind == HWIFileDownloaderTransportKindConnection)
             {
                 [aURLConnection start];
             }
+            else
+            {
+                [self.transport startTransferWithIdentifier:aDownloadID request:aTransferURLRequest];
+            }
         }
         else
         {
             NSLog(@"ERR: No download item (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            NSError *aStartError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorUnknown userInfo:nil];
+            [self.queueJournal recordEvent:HWIFileDownloadJournalEventFail ofDownloadToken:aDownloadToken];
+            [self finishCoalescedDownloadsOfDownloadToken:aDownloadToken withError:aStartError httpStatusCode:0 errorMessagesStack:nil];
         }
     }
     else
     {
-        NSMutableDictionary *aWaitingDownloadDict = [NSMutableDictionary dictionary];
-        [aWaitingDownloadDict setObject:aDownloadToken forKey:@"downloadToken"];
-        if (aResumeData)
+        HWIFileDownloadWaitingItem *aWaitingItem = [[HWIFileDownloadWaitingItem alloc] initWithDownloadToken:aDownloadToken
+                                                                                                    remoteURL:(aResumeData ? nil : aRemoteURL)
+                                                                                            resumeDataFileURL:aResumeDataFileURL
+                                                                                                      options:anOptions];
+        [self.waitingDownloadsQueue enqueueWaitingItem:aWaitingItem];
+    }
+}
+
+
+- (void)startDownloadsWithBatchItems:(nonnull NSArray<HWIFileDownloadBatchItem *> *)aBatchItemsArray
+{
+    // the batch items copy their options
+    NSArray<HWIFileDownloadBatchItem *> *aCopiedBatchItemsArray = [aBatchItemsArray copy];
+    [self performOnDownloaderQueue:^{
+        // higher priorities first, the same priority in the order of the batch
+        NSArray<HWIFileDownloadBatchItem *> *aSortedBatchItemsArray = [aCopiedBatchItemsArray sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(HWIFileDownloadBatchItem *aBatchItem, HWIFileDownloadBatchItem *anotherBatchItem) {
+            if (aBatchItem.options.priority > anotherBatchItem.options.priority)
+            {
+                return NSOrderedAscending;
+            }
+            else if (aBatchItem.options.priority < anotherBatchItem.options.priority)
+            {
+                return NSOrderedDescending;
+            }
+            return NSOrderedSame;
+        }];
+        int64_t aStartedDownloadsCount = (int64_t)aSortedBatchItemsArray.count;
+        NSInteger aConcurrentDownloadsWindow = [self currentConcurrentDownloadsWindow];
+        if (aConcurrentDownloadsWindow > -1)
+        {
+            aStartedDownloadsCount = MIN(aStartedDownloadsCount, (int64_t)MAX(aConcurrentDownloadsWindow - (NSInteger)self.activeDownloadsDictionary.count, (NSInteger)0));
+        }
+        NSProgress *aRootProgress = nil;
+        if ([self.fileDownloadDelegate respondsToSelector:@selector(rootProgress)])
+        {
+            aRootProgress = [self.fileDownloadDelegate rootProgress];
+        }
+        aRootProgress.totalUnitCount += aStartedDownloadsCount;
+        self.reservedRootProgressUnitsCount = aStartedDownloadsCount;
+        for (HWIFileDownloadBatchItem *aBatchItem in aSortedBatchItemsArray)
         {
-            [aWaitingDownloadDict setObject:aResumeData forKey:@"resumeData"];
+            [self startDownloadWithDownloadToken:aBatchItem.identifier fromRemoteURL:aBatchItem.remoteURL usingResumeData:aBatchItem.resumeData options:[aBatchItem.options copy]];
         }
-        else if (aRemoteURL)
+        // downloads completed from the cache or coalesced with another download did not take their unit
+        if (self.reservedRootProgressUnitsCount > 0)
         {
-            [aWaitingDownloadDict setObject:aRemoteURL forKey:@"remoteURL"];
+            aRootProgress.totalUnitCount -= self.reservedRootProgressUnitsCount;
+            self.reservedRootProgressUnitsCount = 0;
         }
-        [self.waitingDownloadsArray addObject:aWaitingDownloadDict];
+    }];
+}
+
+
+- (void)incrementTotalUnitCountOfRootProgress:(nullable NSProgress *)aRootProgress
+{
+    if (self.reservedRootProgressUnitsCount > 0)
+    {
+        self.reservedRootProgressUnitsCount--;
+    }
+    else
+    {
+        aRootProgress.totalUnitCount++;
     }
 }
 
 
-- (void)resumeDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+- (nonnull HWIFileDownloadItem *)downloadItemWithDownloadToken:(nonnull NSString *)aDownloadToken
+                                         sessionDownloadTask:(nullable NSURLSessionDownloadTask *)aDownloadTask
+                                               urlConnection:(nullable NSURLConnection *)aURLConnection
+                                                rootProgress:(nullable NSProgress *)aRootProgress
 {
-    BOOL isDownloading = [self isDownloadingIdentifier:aDownloadIdentifier];
-    if (isDownloading == NO)
+    HWIFileDownloadItem *aDownloadItem = nil;
+    NSProgress *aRetriedDownloadProgress = self.retriedDownloadProgress;
+    if (aRetriedDownloadProgress)
     {
-        if ([self.fileDownloadDelegate respondsToSelector:@selector(resumeDownloadWithIdentifier:)])
-        {
-            [self.fileDownloadDelegate resumeDownloadWithIdentifier:aDownloadIdentifier];
-        }
-        else
-        {
-            NSLog(@"ERR: Resume action called without implementation (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-        }
+        // the unit of the root progress has been taken by the first attempt
+        self.retriedDownloadProgress = nil;
+        aDownloadItem = [[HWIFileDownloadItem alloc] initWithDownloadToken:aDownloadToken
+                                                       sessionDownloadTask:aDownloadTask
+                                                             urlConnection:aURLConnection
+                                                                  progress:aRetriedDownloadProgress];
     }
+    else
+    {
+        [self incrementTotalUnitCountOfRootProgress:aRootProgress];
+        [aRootProgress becomeCurrentWithPendingUnitCount:1];
+        aDownloadItem = [[HWIFileDownloadItem alloc] initWithDownloadToken:aDownloadToken
+                                                       sessionDownloadTask:aDownloadTask
+                                                             urlConnection:aURLConnection];
+        [aRootProgress resignCurrent];
+    }
+    // known before the first response of the restart
+    aDownloadItem.retriesCount = self.retriedDownloadRetriesCount;
+    self.retriedDownloadRetriesCount = 0;
+    return aDownloadItem;
 }
 
 
-#pragma mark - Download Stop
++ (void)completeProgress:(nullable NSProgress *)aProgress
+{
+    // a finished child progress adds its unit to the completed units of the root progress
+    if (aProgress && (aProgress.totalUnitCount <= 0))
+    {
+        aProgress.totalUnitCount = 1;
+    }
+    aProgress.completedUnitCount = aProgress.totalUnitCount;
+}
 
 
-- (void)pauseDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+- (nullable NSURLRequest *)urlRequestForDownloadFromRemoteURL:(nonnull NSURL *)aRemoteURL cacheEntry:(nullable HWIFileDownloadCacheEntry *)aCacheEntry
 {
-    BOOL isDownloading = [self isDownloadingIdentifier:aDownloadIdentifier];
-    if (isDownloading)
+    NSURLRequest *aURLRequest = [self urlRequestForDownloadFromRemoteURL:aRemoteURL];
+    if (aURLRequest && aCacheEntry)
     {
-        [self pauseDownloadWithIdentifier:aDownloadIdentifier resumeDataBlock:^(NSData *aResumeData) {
-            if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadPausedWithIdentifier:resumeData:)])
-            {
-                if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_8_4)
-                {
-                    // resume data is managed by the system and used when calling resume with NSProgress
-                    aResumeData = nil;
-                }
-                [self.fileDownloadDelegate downloadPausedWithIdentifier:aDownloadIdentifier
-                                                             resumeData:aResumeData];
-            }
-        }];
+        // conditional request: a 304 (Not Modified) response is completed from the cache
+        NSMutableURLRequest *aConditionalURLRequest = [aURLRequest mutableCopy];
+        [self.cache addConditionalHeadersForEntry:aCacheEntry toRequest:aConditionalURLRequest];
+        aURLRequest = aConditionalURLRequest;
     }
+    return aURLRequest;
 }
 
 
-- (void)pauseDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier resumeDataBlock:(nullable HWIFileDownloaderPauseResumeDataBlock)aResumeDataBlock
+- (nullable NSURLRequest *)urlRequestForDownloadFromRemoteURL:(nonnull NSURL *)aRemoteURL
 {
-    NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
-    if (aDownloadID > -1)
+    NSURLRequest *aURLRequest = nil;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(urlRequestForRemoteURL:)])
     {
-        [self pauseDownloadWithDownloadID:aDownloadID resumeDataBlock:aResumeDataBlock];
+        aURLRequest = [self.fileDownloadDelegate urlRequestForRemoteURL:aRemoteURL];
     }
     else
     {
-        NSInteger aFoundIndex = -1;
-        for (NSUInteger anIndex = 0; anIndex < self.waitingDownloadsArray.count; anIndex++)
+        NSTimeInterval aRequestTimeoutInterval = 60.0; // iOS default value
+        aURLRequest = [[NSURLRequest alloc] initWithURL:aRemoteURL cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:aRequestTimeoutInterval];
+    }
+    return aURLRequest;
+}
+
+
+- (void)resumeDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    [self performOnDownloaderQueue:^{
+        BOOL isDownloading = [self isDownloadingIdentifier:aDownloadIdentifier];
+        if (isDownloading == NO)
         {
-            NSDictionary *aWaitingDownloadDict = self.waitingDownloadsArray[anIndex];
-            if ([aWaitingDownloadDict[@"downloadToken"] isEqualToString:aDownloadIdentifier])
+            if ([self.fileDownloadDelegate respondsToSelector:@selector(resumeDownloadWithIdentifier:)])
             {
-                aFoundIndex = anIndex;
-                break;
+                [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                    [aDelegate resumeDownloadWithIdentifier:aDownloadIdentifier];
+                }];
+            }
+            else
+            {
+                NSLog(@"ERR: Resume action called without implementation (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
             }
-            aFoundIndex++;
         }
-        if (aFoundIndex > -1)
+    }];
+}
+
+
+#pragma mark - Download Stop
+
+
+- (void)pauseDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    [self performOnDownloaderQueue:^{
+        BOOL isDownloading = [self isDownloadingIdentifier:aDownloadIdentifier];
+        if (isDownloading)
         {
-            [self.waitingDownloadsArray removeObjectAtIndex:aFoundIndex];
+            [self pauseDownloadWithIdentifier:aDownloadIdentifier resumeDataBlock:^(NSData *aResumeData) {
+                if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadPausedWithIdentifier:resumeData:)])
+                {
+                    if ((floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_8_4) && ([HWIFileDownloader segmentsResumeDataDictionaryOfResumeData:aResumeData] == nil))
+                    {
+                        // resume data is managed by the system and used when calling resume with NSProgress
+                        aResumeData = nil;
+                    }
+                    [self.fileDownloadDelegate downloadPausedWithIdentifier:aDownloadIdentifier
+                                                                 resumeData:aResumeData];
+                }
+            }];
         }
-    }
+    }];
+}
+
+
+- (void)pauseDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier resumeDataBlock:(nullable HWIFileDownloaderPauseResumeDataBlock)aResumeDataBlock
+{
+    [self performOnDownloaderQueue:^{
+        [self.queueJournal recordEvent:HWIFileDownloadJournalEventPause ofDownloadToken:aDownloadIdentifier];
+        [self scheduleQueueJournalFlush];
+        NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
+        if (aDownloadID > -1)
+        {
+            [self pauseDownloadWithDownloadID:aDownloadID resumeDataBlock:aResumeDataBlock];
+        }
+        else
+        {
+            HWIFileDownloadWaitingItem *aRemovedWaitingItem = [self removeWaitingItemForDownloadToken:aDownloadIdentifier];
+            if (aRemovedWaitingItem)
+            {
+                NSError *aCancelledError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+                [self finishCoalescedDownloadsOfDownloadToken:aDownloadIdentifier withError:aCancelledError httpStatusCode:0 errorMessagesStack:nil];
+            }
+        }
+    }];
 }
 
 
@@ -438,12 +941,35 @@
     if (aDownloadItem)
     {
         NSURLSessionDownloadTask *aDownloadTask = aDownloadItem.sessionDownloadTask;
-        if (aDownloadTask)
+        if (aDownloadItem.isSegmented)
+        {
+            // the resume data holds the received ranges (none while probing the remote host)
+            NSData *aResumeData = [HWIFileDownloader resumeDataOfSegmentedDownloadItem:aDownloadItem];
+            NSError *aPauseError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+            [self handleDownloadWithError:aPauseError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:aResumeData];
+            if (aResumeDataBlock)
+            {
+                // passed on when the received data has been written
+                dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+                __weak HWIFileDownloader *weakSelf = self;
+                dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                    dispatch_async(aDownloaderDispatchQueue, ^{
+                        HWIFileDownloader *strongSelf = weakSelf;
+                        [strongSelf performCallback:^{
+                            aResumeDataBlock(aResumeData);
+                        }];
+                    });
+                });
+            }
+        }
+        else if (aDownloadTask)
         {
             if (aResumeDataBlock)
             {
                 [aDownloadTask cancelByProducingResumeData:^(NSData *aResumeData) {
-                    aResumeDataBlock(aResumeData);
+                    [self performCallback:^{
+                        aResumeDataBlock(aResumeData);
+                    }];
                 }];
             }
             else
@@ -453,6 +979,17 @@
             // NSURLSessionTaskDelegate method is called
             // URLSession:task:didCompleteWithError:
         }
+        else if ((self.transportKind == HWIFileDownloaderTransportKindCustom) || aDownloadItem.streamDataTask)
+        {
+            // transports and data tasks do not produce resume data
+            if (aResumeDataBlock)
+            {
+                [self performCallback:^{
+                    aResumeDataBlock(nil);
+                }];
+            }
+            [self cancelDataTransferWithDownloadID:aDownloadID];
+        }
         else
         {
             NSLog(@"INFO: NSURLSessionDownloadTask cancelled (task not found): %@ (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
@@ -465,54 +1002,194 @@
 
 - (void)cancelDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
 {
-    NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
-    if (aDownloadID > -1)
-    {
-        [self cancelDownloadWithDownloadID:aDownloadID];
-    }
-    else
-    {
-        NSInteger aFoundIndex = -1;
-        for (NSUInteger anIndex = 0; anIndex < self.waitingDownloadsArray.count; anIndex++)
+    [self performOnDownloaderQueue:^{
+        if ([self detachCoalescedDownloadWithDownloadToken:aDownloadIdentifier])
         {
-            NSDictionary *aWaitingDownloadDict = self.waitingDownloadsArray[anIndex];
-            if ([aWaitingDownloadDict[@"downloadToken"] isEqualToString:aDownloadIdentifier])
-            {
-                aFoundIndex = anIndex;
-                break;
-            }
-            aFoundIndex++;
+            return;
         }
-        if (aFoundIndex > -1)
+        NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
+        if (aDownloadID > -1)
+        {
+            [self cancelDownloadWithDownloadID:aDownloadID];
+        }
+        else if ([self cancelWaitingDownloadWithDownloadToken:aDownloadIdentifier])
         {
-            [self.waitingDownloadsArray removeObjectAtIndex:aFoundIndex];
-            
-            NSError *aCancelledError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
-            [self.fileDownloadDelegate downloadFailedWithIdentifier:aDownloadIdentifier
-                                                              error:aCancelledError
-                                                     httpStatusCode:0
-                                                 errorMessagesStack:nil
-                                                         resumeData:nil];
             [self startNextWaitingDownload];
         }
-    }
+    }];
 }
 
 
-- (void)cancelDownloadWithDownloadID:(NSUInteger)aDownloadID
+- (BOOL)cancelWaitingDownloadWithDownloadToken:(nonnull NSString *)aDownloadToken
 {
-    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
-    if (aDownloadItem)
+    HWIFileDownloadWaitingItem *aRemovedWaitingItem = [self removeWaitingItemForDownloadToken:aDownloadToken];
+    if (aRemovedWaitingItem)
     {
-        if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
-        {
-            NSURLSessionDownloadTask *aDownloadTask = aDownloadItem.sessionDownloadTask;
-            if (aDownloadTask)
-            {
-                [aDownloadTask cancel];
-                // NSURLSessionTaskDelegate method is called
+        NSError *aCancelledError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+        [self.queueJournal recordEvent:HWIFileDownloadJournalEventCancel ofDownloadToken:aDownloadToken];
+        [self scheduleQueueJournalFlush];
+        [self.deduplicator removePrimaryDownloadToken:aDownloadToken];
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            [aDelegate downloadFailedWithIdentifier:aDownloadToken
+                                              error:aCancelledError
+                                     httpStatusCode:0
+                                 errorMessagesStack:nil
+                                         resumeData:nil];
+        }];
+    }
+    return (aRemovedWaitingItem != nil);
+}
+
+
+- (void)cancelDownloadsWithIdentifiers:(nonnull NSArray<NSString *> *)aDownloadIdentifiersArray
+{
+    [self performOnDownloaderQueue:^{
+        // waiting downloads are removed first, no waiting download is started for the batch
+        NSMutableArray<NSNumber *> *anActiveDownloadIDsArray = [NSMutableArray arrayWithCapacity:aDownloadIdentifiersArray.count];
+        for (NSString *aDownloadIdentifier in aDownloadIdentifiersArray)
+        {
+            if ([self detachCoalescedDownloadWithDownloadToken:aDownloadIdentifier])
+            {
+                continue;
+            }
+            NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
+            if (aDownloadID > -1)
+            {
+                [anActiveDownloadIDsArray addObject:@(aDownloadID)];
+            }
+            else
+            {
+                [self cancelWaitingDownloadWithDownloadToken:aDownloadIdentifier];
+            }
+        }
+        for (NSNumber *aDownloadID in anActiveDownloadIDsArray)
+        {
+            [self cancelDownloadWithDownloadID:[aDownloadID unsignedIntegerValue]];
+        }
+    }];
+}
+
+
+- (void)cancelDownloadsPassingTest:(nonnull BOOL (^)(NSString * _Nonnull identifier))aPredicateBlock
+{
+    [self performOnDownloaderQueue:^{
+        NSArray<NSString *> *aDownloadTokensArray = [self downloadTokensPassingTest:^BOOL(NSString *aDownloadToken, HWIFileDownloadOptions *anOptions) {
+            return aPredicateBlock(aDownloadToken);
+        }];
+        [self cancelDownloadsWithIdentifiers:aDownloadTokensArray];
+    }];
+}
+
+
+- (void)cancelDownloadsWithGroupTag:(nonnull NSString *)aGroupTag
+{
+    [self performOnDownloaderQueue:^{
+        NSArray<NSString *> *aDownloadTokensArray = [self downloadTokensPassingTest:^BOOL(NSString *aDownloadToken, HWIFileDownloadOptions *anOptions) {
+            return [anOptions.groupTag isEqualToString:aGroupTag];
+        }];
+        [self cancelDownloadsWithIdentifiers:aDownloadTokensArray];
+    }];
+}
+
+
+- (void)pauseDownloadsWithIdentifiers:(nonnull NSArray<NSString *> *)aDownloadIdentifiersArray
+{
+    [self performOnDownloaderQueue:^{
+        // waiting downloads are removed first, no waiting download is started for the batch
+        NSMutableArray<NSString *> *anActiveDownloadTokensArray = [NSMutableArray arrayWithCapacity:aDownloadIdentifiersArray.count];
+        for (NSString *aDownloadIdentifier in aDownloadIdentifiersArray)
+        {
+            if ([self downloadIDForActiveDownloadToken:aDownloadIdentifier] > -1)
+            {
+                [anActiveDownloadTokensArray addObject:aDownloadIdentifier];
+            }
+            else
+            {
+                [self pauseDownloadWithIdentifier:aDownloadIdentifier];
+            }
+        }
+        for (NSString *aDownloadToken in anActiveDownloadTokensArray)
+        {
+            [self pauseDownloadWithIdentifier:aDownloadToken];
+        }
+    }];
+}
+
+
+- (void)pauseDownloadsPassingTest:(nonnull BOOL (^)(NSString * _Nonnull identifier))aPredicateBlock
+{
+    [self performOnDownloaderQueue:^{
+        NSArray<NSString *> *aDownloadTokensArray = [self downloadTokensPassingTest:^BOOL(NSString *aDownloadToken, HWIFileDownloadOptions *anOptions) {
+            return aPredicateBlock(aDownloadToken);
+        }];
+        [self pauseDownloadsWithIdentifiers:aDownloadTokensArray];
+    }];
+}
+
+
+- (void)pauseDownloadsWithGroupTag:(nonnull NSString *)aGroupTag
+{
+    [self performOnDownloaderQueue:^{
+        NSArray<NSString *> *aDownloadTokensArray = [self downloadTokensPassingTest:^BOOL(NSString *aDownloadToken, HWIFileDownloadOptions *anOptions) {
+            return [anOptions.groupTag isEqualToString:aGroupTag];
+        }];
+        [self pauseDownloadsWithIdentifiers:aDownloadTokensArray];
+    }];
+}
+
+
+- (nonnull NSArray<NSString *> *)downloadTokensPassingTest:(nonnull BOOL (^)(NSString * _Nonnull aDownloadToken, HWIFileDownloadOptions * _Nullable anOptions))aTestBlock
+{
+    // coalesced downloads are tested with the options of the download providing the file
+    NSMutableArray<NSString *> *aDownloadTokensArray = [NSMutableArray array];
+    for (HWIFileDownloadItem *aDownloadItem in self.activeDownloadsDictionary.allValues)
+    {
+        for (NSString *aDownloadToken in [self receivingDownloadTokensForDownloadToken:aDownloadItem.downloadToken])
+        {
+            if (aTestBlock(aDownloadToken, aDownloadItem.options))
+            {
+                [aDownloadTokensArray addObject:aDownloadToken];
+            }
+        }
+    }
+    for (HWIFileDownloadWaitingItem *aWaitingItem in [[self.waitingDownloadsQueue allWaitingItems] arrayByAddingObjectsFromArray:self.backingOffWaitingItemsDictionary.allValues])
+    {
+        for (NSString *aDownloadToken in [self receivingDownloadTokensForDownloadToken:aWaitingItem.downloadToken])
+        {
+            if (aTestBlock(aDownloadToken, aWaitingItem.options))
+            {
+                [aDownloadTokensArray addObject:aDownloadToken];
+            }
+        }
+    }
+    return aDownloadTokensArray;
+}
+
+
+- (void)cancelDownloadWithDownloadID:(NSUInteger)aDownloadID
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    if (aDownloadItem)
+    {
+        if (self.transportKind == HWIFileDownloaderTransportKindSession)
+        {
+            NSURLSessionDownloadTask *aDownloadTask = aDownloadItem.sessionDownloadTask;
+            if (aDownloadItem.isSegmented)
+            {
+                NSLog(@"INFO: Segmented download cancelled: %@ (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                NSError *aCancelError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+                [self handleDownloadWithError:aCancelError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+            }
+            else if (aDownloadTask)
+            {
+                [aDownloadTask cancel];
+                // NSURLSessionTaskDelegate method is called
                 // URLSession:task:didCompleteWithError:
             }
+            else if (aDownloadItem.streamDataTask)
+            {
+                [self cancelDataTransferWithDownloadID:aDownloadID];
+            }
             else
             {
                 NSLog(@"INFO: NSURLSessionDownloadTask cancelled (task not found): %@ (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
@@ -520,12 +1197,16 @@
                 [self handleDownloadWithError:aCancelError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
             }
         }
+        else if (self.transportKind == HWIFileDownloaderTransportKindCustom)
+        {
+            [self cancelDataTransferWithDownloadID:aDownloadID];
+        }
         else
         {
             NSURLConnection *aDownloadURLConnection = aDownloadItem.urlConnection;
             if (aDownloadURLConnection)
             {
-                [self cancelURLConnection:aDownloadURLConnection downloadID:aDownloadID];
+                [self cancelDataTransferWithDownloadID:aDownloadID];
             }
             else
             {
@@ -538,221 +1219,397 @@
 }
 
 
-- (void)cancelURLConnection:(NSURLConnection *)aDownloadURLConnection downloadID:(NSUInteger)aDownloadID
+- (void)cancelDataTransferWithDownloadID:(NSUInteger)aDownloadID
+{
+    NSError *aCancelError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+    [self cancelDataTransferWithDownloadID:aDownloadID error:aCancelError];
+}
+
+
+- (void)cancelDataTransferWithDownloadID:(NSUInteger)aDownloadID error:(nonnull NSError *)anError
 {
-    [aDownloadURLConnection cancel];
-    // delegate method is not necessarily called
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    if (aDownloadItem.urlConnection)
+    {
+        [aDownloadItem.urlConnection cancel];
+        // delegate method is not necessarily called
+    }
+    else if (aDownloadItem.streamDataTask)
+    {
+        NSURLSessionDataTask *aStreamDataTask = aDownloadItem.streamDataTask;
+        [self.streamDataTaskDownloadIDsDictionary removeObjectForKey:@(aStreamDataTask.taskIdentifier)];
+        [aStreamDataTask cancel];
+        // no more events are handled for the task
+    }
+    else
+    {
+        [self.transport cancelTransferWithIdentifier:aDownloadID];
+        // no more events are delivered for the transfer
+    }
     
-    NSURL *aTempFileURL = [self tempLocalFileURLForDownloadFromURL:aDownloadURLConnection.originalRequest.URL];
+    HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+    id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+    NSURL *aTempFileURL = aFileWriter.fileURL;
+    if ((aTempFileURL == nil) && aDownloadItem.remoteURL && (aDownloadItem.stream == nil))
+    {
+        aTempFileURL = [self tempLocalFileURLForDownloadFromURL:aDownloadItem.remoteURL];
+    }
+    dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
     __weak HWIFileDownloader *weakSelf = self;
     dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
         HWIFileDownloader *strongSelf = weakSelf;
-        NSError *aRemoveError = nil;
-        [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:&aRemoveError];
-        if (aRemoveError)
+        [strongSelf closeFileWriter:aFileWriter];
+        [strongSelf finishTransform:aTransform error:NULL];
+        if (aTempFileURL) // nil for streamed downloads without local file
         {
-            NSLog(@"ERR: Unable to remove file at %@: %@ (%@, %d)", aTempFileURL, aRemoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            NSError *aRemoveError = nil;
+            [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:&aRemoveError];
+            if (aRemoveError)
+            {
+                NSLog(@"ERR: Unable to remove file at %@: %@ (%@, %d)", aTempFileURL, aRemoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            }
         }
         __weak HWIFileDownloader *anotherWeakSelf = strongSelf;
-        dispatch_async(dispatch_get_main_queue(), ^{
+        dispatch_async(aDownloaderDispatchQueue, ^{
             HWIFileDownloader *anotherStrongSelf = anotherWeakSelf;
-            HWIFileDownloadItem *aFoundDownloadItem = [strongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+            HWIFileDownloadItem *aFoundDownloadItem = [anotherStrongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)];
             if (aFoundDownloadItem)
             {
-                NSLog(@"INFO: NSURLConnection cancelled: %@", aFoundDownloadItem.downloadToken);
-                NSError *aCancelError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
-                [anotherStrongSelf handleDownloadWithError:aCancelError downloadItem:aFoundDownloadItem downloadID:aDownloadID resumeData:nil];
+                NSLog(@"INFO: Transfer cancelled: %@", aFoundDownloadItem.downloadToken);
+                [anotherStrongSelf handleDownloadWithError:anError downloadItem:aFoundDownloadItem downloadID:aDownloadID resumeData:nil];
             }
         });
     });
 }
 
 
-#pragma mark - Download Status
+#pragma mark - Download Priority
 
 
-- (BOOL)isDownloadingIdentifier:(nonnull NSString *)aDownloadIdentifier
+- (BOOL)setPriority:(HWIFileDownloadPriority)aPriority forDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
 {
-    BOOL isDownloading = NO;
-    NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
-    if (aDownloadID > -1)
-    {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
-        if (aDownloadItem)
+    __block BOOL aFoundFlag = NO;
+    [self performOnDownloaderQueueAndWait:^{
+        aFoundFlag = [self.waitingDownloadsQueue setPriority:aPriority forDownloadToken:aDownloadIdentifier];
+        if (aFoundFlag)
         {
-            isDownloading = YES;
+            [self.queueJournal recordPriority:aPriority ofDownloadToken:aDownloadIdentifier];
+            [self scheduleQueueJournalFlush];
         }
-    }
-    if (isDownloading == NO)
-    {
-        for (NSDictionary *aWaitingDownloadDict in self.waitingDownloadsArray)
+        else
         {
-            if ([aWaitingDownloadDict[@"downloadToken"] isEqualToString:aDownloadIdentifier])
+            NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
+            if (aDownloadID > -1)
             {
-                isDownloading = YES;
-                break;
+                HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+                if (aDownloadItem)
+                {
+                    aFoundFlag = YES;
+                    aDownloadItem.priority = aPriority;
+                    if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1)
+                    {
+                        aDownloadItem.sessionDownloadTask.priority = [HWIFileDownloader sessionTaskPriorityForPriority:aPriority];
+                    }
+                }
             }
         }
+    }];
+    return aFoundFlag;
+}
+
+
++ (float)sessionTaskPriorityForPriority:(HWIFileDownloadPriority)aPriority
+{
+    float aSessionTaskPriority = NSURLSessionTaskPriorityDefault;
+    switch (aPriority) {
+        case HWIFileDownloadPriorityBackground:
+        case HWIFileDownloadPriorityLow:
+            aSessionTaskPriority = NSURLSessionTaskPriorityLow;
+            break;
+        case HWIFileDownloadPriorityHigh:
+            aSessionTaskPriority = NSURLSessionTaskPriorityHigh;
+            break;
+            
+        default:
+            break;
     }
-    return isDownloading;
+    return aSessionTaskPriority;
 }
 
 
-- (BOOL)isWaitingForDownloadOfIdentifier:(nonnull NSString *)aDownloadIdentifier
+#pragma mark - Segmented Download
+
+
+- (void)startSegmentProbeForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
 {
-    BOOL isWaitingForDownload = NO;
-    for (NSDictionary *aWaitingDownloadDict in self.waitingDownloadsArray)
+    NSMutableURLRequest *aProbeRequest = [[self urlRequestForDownloadFromRemoteURL:aDownloadItem.remoteURL] mutableCopy];
+    if (aProbeRequest)
     {
-        if ([aWaitingDownloadDict[@"downloadToken"] isEqualToString:aDownloadIdentifier])
+        aProbeRequest.HTTPMethod = @"HEAD";
+        if (self.segmentProbeSession == nil)
         {
-            isWaitingForDownload = YES;
-            break;
+            // background sessions do not support completion handlers
+            self.segmentProbeSession = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration ephemeralSessionConfiguration]
+                                                                     delegate:nil
+                                                                delegateQueue:self.sessionDelegateOperationQueue];
         }
+        __weak HWIFileDownloader *weakSelf = self;
+        aDownloadItem.segmentProbeTask = [self.segmentProbeSession dataTaskWithRequest:aProbeRequest completionHandler:^(NSData * _Nullable aData, NSURLResponse * _Nullable aResponse, NSError * _Nullable anError) {
+            HWIFileDownloader *strongSelf = weakSelf;
+            if ([strongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile cancelled download
+            {
+                aDownloadItem.segmentProbeTask = nil;
+                NSUInteger aSegmentsCount = 0;
+                int64_t anExpectedFileSize = aResponse.expectedContentLength;
+                if ((anError == nil) && [aResponse isKindOfClass:[NSHTTPURLResponse class]])
+                {
+                    NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aResponse;
+                    NSString *anAcceptRangesString = nil;
+                    for (NSString *aHeaderFieldName in aHttpResponse.allHeaderFields)
+                    {
+                        if ([aHeaderFieldName caseInsensitiveCompare:@"Accept-Ranges"] == NSOrderedSame)
+                        {
+                            anAcceptRangesString = [aHttpResponse.allHeaderFields objectForKey:aHeaderFieldName];
+                            break;
+                        }
+                    }
+                    if ((aHttpResponse.statusCode == 200) && ([anAcceptRangesString caseInsensitiveCompare:@"bytes"] == NSOrderedSame) && (anExpectedFileSize > 0))
+                    {
+                        // the ranges are requested for this version of the file only
+                        aDownloadItem.responseETag = [aHttpResponse.allHeaderFields objectForKey:@"ETag"];
+                        aDownloadItem.responseLastModified = [aHttpResponse.allHeaderFields objectForKey:@"Last-Modified"];
+                        int64_t aMinimumSegmentSize = MAX(aDownloadItem.options.minimumSegmentSize, 1);
+                        aSegmentsCount = (NSUInteger)MIN((int64_t)aDownloadItem.options.segmentsCount, anExpectedFileSize / aMinimumSegmentSize);
+                    }
+                }
+                if (aSegmentsCount > 1)
+                {
+                    [strongSelf startSegmentsForDownloadItem:aDownloadItem downloadID:aDownloadID expectedFileSize:anExpectedFileSize segmentsCount:aSegmentsCount];
+                }
+                else
+                {
+                    // byte ranges not supported (or probe failed, e.g. on authentication): download with one task
+                    [strongSelf startSingleDownloadTaskForDownloadItem:aDownloadItem downloadID:aDownloadID];
+                }
+            }
+        }];
+        [aDownloadItem.segmentProbeTask resume];
     }
-    NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
-    if (aDownloadID > -1)
+    else
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
-        if (aDownloadItem && (aDownloadItem.receivedFileSizeInBytes == 0))
-        {
-            isWaitingForDownload = YES;
-        }
+        NSLog(@"ERR: No url request (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        NSError *aRequestError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadURL userInfo:nil];
+        [self handleDownloadWithError:aRequestError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
     }
-    return isWaitingForDownload;
 }
 
 
-- (BOOL)hasActiveDownloads
+- (void)startSingleDownloadTaskForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
 {
-    BOOL aHasActiveDownloadsFlag = NO;
-    if ((self.activeDownloadsDictionary.count > 0) || (self.waitingDownloadsArray.count > 0))
+    NSURLSessionDownloadTask *aDownloadTask = nil;
+    NSURLRequest *aURLRequest = [self urlRequestForDownloadFromRemoteURL:aDownloadItem.remoteURL];
+    if (aURLRequest)
     {
-        aHasActiveDownloadsFlag = YES;
+        aDownloadTask = [self.backgroundSession downloadTaskWithRequest:aURLRequest];
+    }
+    if (aDownloadTask)
+    {
+        aDownloadTask.taskDescription = aDownloadItem.downloadToken;
+        if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1)
+        {
+            aDownloadTask.priority = [HWIFileDownloader sessionTaskPriorityForPriority:aDownloadItem.priority];
+        }
+        [self removeActiveDownloadItemWithDownloadID:aDownloadID];
+        aDownloadItem.isSegmented = NO;
+        aDownloadItem.sessionDownloadTask = aDownloadTask;
+        [self addActiveDownloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier];
+        [aDownloadTask resume];
+    }
+    else
+    {
+        NSLog(@"ERR: No url request (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        NSError *aRequestError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadURL userInfo:nil];
+        [self handleDownloadWithError:aRequestError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
     }
-    return aHasActiveDownloadsFlag;
 }
 
 
-- (nonnull NSURL *)tempLocalFileURLForDownloadFromURL:(nonnull NSURL *)aRemoteURL
+- (void)startSegmentsForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                          downloadID:(NSUInteger)aDownloadID
+                    expectedFileSize:(int64_t)anExpectedFileSize
+                       segmentsCount:(NSUInteger)aSegmentsCount
 {
-    NSString *anOfflineDownloadDirectory = NSTemporaryDirectory();
-    anOfflineDownloadDirectory = [anOfflineDownloadDirectory stringByAppendingPathComponent:@"file-download"];
-    if ([[NSFileManager defaultManager] fileExistsAtPath:anOfflineDownloadDirectory] == NO)
+    NSMutableArray<HWIFileDownloadSegment *> *aSegmentsArray = [NSMutableArray arrayWithCapacity:aSegmentsCount];
+    int64_t aSegmentLength = anExpectedFileSize / aSegmentsCount;
+    for (NSUInteger anIndex = 0; anIndex < aSegmentsCount; anIndex++)
     {
-        [[NSFileManager defaultManager] createDirectoryAtPath:anOfflineDownloadDirectory withIntermediateDirectories:YES attributes:nil error:NULL];
+        int64_t anOffset = anIndex * aSegmentLength;
+        int64_t aLength = (anIndex == aSegmentsCount - 1) ? (anExpectedFileSize - anOffset) : aSegmentLength;
+        [aSegmentsArray addObject:[[HWIFileDownloadSegment alloc] initWithOffset:anOffset length:aLength receivedFileSizeInBytes:0]];
     }
-    NSURL *anOfflineDownloadDirectoryURL = [NSURL fileURLWithPath:anOfflineDownloadDirectory isDirectory:YES];
-    [anOfflineDownloadDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:NULL];
-    
-    NSString *aFilePathName = [anOfflineDownloadDirectory stringByAppendingPathComponent:[aRemoteURL lastPathComponent]];
-    NSURL *aLocalFileURL = [NSURL fileURLWithPath:aFilePathName isDirectory:NO];
-    return aLocalFileURL;
+    NSURL *aTempDirectoryURL = [[self tempLocalFileURLForDownloadFromURL:aDownloadItem.remoteURL] URLByDeletingLastPathComponent];
+    aDownloadItem.segmentedFileURL = [aTempDirectoryURL URLByAppendingPathComponent:[NSString stringWithFormat:@"%@.segmented", [[NSUUID UUID] UUIDString]] isDirectory:NO];
+    aDownloadItem.segmentsArray = aSegmentsArray;
+    aDownloadItem.expectedFileSizeInBytes = anExpectedFileSize;
+    [self startSegmentTransfersOfDownloadItem:aDownloadItem downloadID:aDownloadID preallocatesFile:YES];
 }
 
 
-#pragma mark - BackgroundSessionCompletionHandler
-
-
-- (void)setBackgroundSessionCompletionHandlerBlock:(nullable HWIBackgroundSessionCompletionHandlerBlock)aBackgroundSessionCompletionHandlerBlock
+- (void)continueSegmentsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                            downloadID:(NSUInteger)aDownloadID
+                  resumeDataDictionary:(nonnull NSDictionary *)aResumeDataDictionary
 {
-    self.bgSessionCompletionHandlerBlock = aBackgroundSessionCompletionHandlerBlock;
+    int64_t anExpectedFileSize = [[aResumeDataDictionary objectForKey:@"expectedFileSize"] longLongValue];
+    NSURL *aTempDirectoryURL = [[self tempLocalFileURLForDownloadFromURL:aDownloadItem.remoteURL] URLByDeletingLastPathComponent];
+    NSURL *aSegmentedFileURL = [aTempDirectoryURL URLByAppendingPathComponent:[aResumeDataDictionary objectForKey:@"fileName"] isDirectory:NO];
+    NSNumber *aFileSize = nil;
+    [aSegmentedFileURL getResourceValue:&aFileSize forKey:NSURLFileSizeKey error:NULL];
+    // a missing file (e.g. after purging the temporary directory) is downloaded again
+    BOOL aFileExistsFlag = (aFileSize && ([aFileSize longLongValue] == anExpectedFileSize));
+    NSArray<NSArray<NSNumber *> *> *aRangesArray = [aResumeDataDictionary objectForKey:@"segments"];
+    NSMutableArray<HWIFileDownloadSegment *> *aSegmentsArray = [NSMutableArray arrayWithCapacity:aRangesArray.count];
+    int64_t aReceivedFileSize = 0;
+    for (NSArray<NSNumber *> *aRangeArray in aRangesArray)
+    {
+        int64_t aSegmentReceivedFileSize = aFileExistsFlag ? [[aRangeArray objectAtIndex:2] longLongValue] : 0;
+        [aSegmentsArray addObject:[[HWIFileDownloadSegment alloc] initWithOffset:[[aRangeArray objectAtIndex:0] longLongValue]
+                                                                          length:[[aRangeArray objectAtIndex:1] longLongValue]
+                                                         receivedFileSizeInBytes:aSegmentReceivedFileSize]];
+        aReceivedFileSize += aSegmentReceivedFileSize;
+    }
+    aDownloadItem.segmentedFileURL = aSegmentedFileURL;
+    aDownloadItem.segmentsArray = aSegmentsArray;
+    aDownloadItem.expectedFileSizeInBytes = anExpectedFileSize;
+    aDownloadItem.receivedFileSizeInBytes = aReceivedFileSize;
+    aDownloadItem.resumedFileSizeInBytes = aReceivedFileSize;
+    if (aDownloadItem.retriesCount > 0)
+    {
+        // the ranges are requested with the validators of the first response
+        self.retryResumedBytesCount += aReceivedFileSize;
+    }
+    aDownloadItem.responseETag = [aResumeDataDictionary objectForKey:@"entityTag"];
+    aDownloadItem.responseLastModified = [aResumeDataDictionary objectForKey:@"lastModified"];
+    NSLog(@"INFO: Segmented download (id: %@) continued (received: %@ bytes, expected: %@ bytes) (%@, %d)", aDownloadItem.downloadToken, @(aReceivedFileSize), @(anExpectedFileSize), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    [self startSegmentTransfersOfDownloadItem:aDownloadItem downloadID:aDownloadID preallocatesFile:(aFileExistsFlag == NO)];
 }
 
 
-#pragma mark - NSURLSession
-#pragma mark - NSURLSessionDownloadDelegate
-
-
-- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didFinishDownloadingToURL:(nonnull NSURL *)aDownloadURL
+- (void)startSegmentTransfersOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                                 downloadID:(NSUInteger)aDownloadID
+                           preallocatesFile:(BOOL)aPreallocatesFileFlag
 {
-    NSString *anErrorString = nil;
-    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
-    if (aDownloadItem)
+    NSURLRequest *aURLRequest = [self urlRequestForDownloadFromRemoteURL:aDownloadItem.remoteURL];
+    if (aURLRequest)
     {
-        // move download item to final local location
+        NSURL *aSegmentedFileURL = aDownloadItem.segmentedFileURL;
+        int64_t anExpectedFileSize = aDownloadItem.expectedFileSizeInBytes;
+        HWIFileDownloadFileWriter *aFileWriter = [[HWIFileDownloadFileWriter alloc] initWithFileURL:aSegmentedFileURL bufferSize:0];
+        aDownloadItem.segmentedFileWriter = aFileWriter;
         
-        NSURL *aLocalDestinationFileURL = nil;
-        if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
-        {
-            NSURL *aRemoteURL = [[aDownloadTask.originalRequest URL] copy];
-            if (aRemoteURL)
-            {
-                aLocalDestinationFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadItem.downloadToken remoteURL:aRemoteURL];
-            }
-            else
+        // segment writes are dispatched to the same serial queue after the preallocation
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            [strongSelf.openFileWritersSet addObject:aFileWriter];
+            NSError *aPreallocateError = nil;
+            if (aPreallocatesFileFlag && ([HWIFileDownloadFileWriter preallocateFileAtURL:aSegmentedFileURL length:anExpectedFileSize error:&aPreallocateError] == NO))
             {
-                anErrorString = [NSString stringWithFormat:@"ERR: Missing information: Remote URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                NSLog(@"%@", anErrorString);
+                dispatch_async(aDownloaderDispatchQueue, ^{
+                    HWIFileDownloader *anotherStrongSelf = weakSelf;
+                    if ([anotherStrongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile cancelled download
+                    {
+                        NSString *aPreallocateErrorString = [NSString stringWithFormat:@"ERR: Unable to preallocate file at %@: %@ (%@, %d)", aSegmentedFileURL, aPreallocateError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                        NSLog(@"%@", aPreallocateErrorString);
+                        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+                        if (anErrorMessagesStackArray == nil)
+                        {
+                            anErrorMessagesStackArray = [NSMutableArray array];
+                        }
+                        [anErrorMessagesStackArray insertObject:aPreallocateErrorString atIndex:0];
+                        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+                        [anotherStrongSelf handleDownloadWithError:aPreallocateError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+                    }
+                });
             }
+        });
+        
+        if (self.queueJournal)
+        {
+            // the received ranges are saved for continuing after relaunch
+            aDownloadItem.segmentsResumeDataFileName = [[NSUUID UUID] UUIDString];
+            [self.queueJournal recordResumeDataFileName:aDownloadItem.segmentsResumeDataFileName ofDownloadToken:aDownloadItem.downloadToken];
+            [self scheduleQueueJournalFlush];
+            [self saveSegmentsResumeDataOfDownloadItem:aDownloadItem downloadID:aDownloadID];
         }
-        else
+        
+        NSString *anIfRangeString = aDownloadItem.responseETag;
+        if ((anIfRangeString == nil) || [anIfRangeString hasPrefix:@"W/"])
         {
-            aLocalDestinationFileURL = [HWIFileDownloader localFileURLForRemoteURL:aDownloadTask.originalRequest.URL];
+            // weak entity tags are not allowed with If-Range
+            anIfRangeString = aDownloadItem.responseLastModified;
         }
-        if (aLocalDestinationFileURL)
+        NSURLSession *aStreamSession = [self openStreamSession];
+        NSMutableArray<NSURLSessionDataTask *> *aSegmentTasksArray = [NSMutableArray arrayWithCapacity:aDownloadItem.segmentsArray.count];
+        for (HWIFileDownloadSegment *aSegment in aDownloadItem.segmentsArray)
         {
-            if ([[NSFileManager defaultManager] fileExistsAtPath:aLocalDestinationFileURL.path] == YES)
+            if (aSegment.isCompleted == NO)
             {
-                NSError *aRemoveError = nil;
-                [[NSFileManager defaultManager] removeItemAtURL:aLocalDestinationFileURL error:&aRemoveError];
-                if (aRemoveError)
-                {
-                    anErrorString = [NSString stringWithFormat:@"ERR: Error on removing file at %@: %@ (%@, %d)", aLocalDestinationFileURL, aRemoveError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                    NSLog(@"%@", anErrorString);
-                }
-            }
-            NSError *anError = nil;
-            BOOL aSuccessFlag = [[NSFileManager defaultManager] moveItemAtURL:aDownloadURL toURL:aLocalDestinationFileURL error:&anError];
-            if (aSuccessFlag == NO)
-            {
-                NSError *aMoveError = anError;
-                if (aMoveError == nil)
-                {
-                    aMoveError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotMoveFile userInfo:nil];
-                }
-                anErrorString = [NSString stringWithFormat:@"ERR: Unable to move file from %@ to %@ (%@) (%@, %d)", aDownloadURL, aLocalDestinationFileURL, aMoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                NSLog(@"%@", anErrorString);
-            }
-            else
-            {
-                NSError *anError = nil;
-                NSDictionary *aFileAttributesDictionary = [[NSFileManager defaultManager] attributesOfItemAtPath:aLocalDestinationFileURL.path error:&anError];
-                if (anError)
+                // the remaining range of a continued segment
+                NSMutableURLRequest *aSegmentRequest = [aURLRequest mutableCopy];
+                [aSegmentRequest setValue:[NSString stringWithFormat:@"bytes=%lld-%lld", aSegment.offset + aSegment.receivedFileSizeInBytes, aSegment.offset + aSegment.length - 1] forHTTPHeaderField:@"Range"];
+                if (anIfRangeString)
                 {
-                    anErrorString = [NSString stringWithFormat:@"ERR: Error on getting file size for item at %@: %@ (%@, %d)", aLocalDestinationFileURL, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                    NSLog(@"%@", anErrorString);
+                    // a changed file is answered with 200 instead of 206
+                    [aSegmentRequest setValue:anIfRangeString forHTTPHeaderField:@"If-Range"];
                 }
-                else
+                NSURLSessionDataTask *aSegmentTask = [aStreamSession dataTaskWithRequest:aSegmentRequest];
+                aSegmentTask.taskDescription = aDownloadItem.downloadToken;
+                if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_7_1)
                 {
-                    unsigned long long aFileSize = [aFileAttributesDictionary fileSize];
-                    if (aFileSize == 0)
-                    {
-                        NSError *aFileSizeZeroError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorZeroByteResource userInfo:nil];
-                        anErrorString = [NSString stringWithFormat:@"ERR: Zero file size for item at %@: %@ (%@, %d)", aLocalDestinationFileURL, aFileSizeZeroError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                        NSLog(@"%@", anErrorString);
-                    }
-                    else
-                    {
-                        if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadAtLocalFileURL:isValidForDownloadIdentifier:)])
-                        {
-                            BOOL anIsValidDownloadFlag = [self.fileDownloadDelegate downloadAtLocalFileURL:aLocalDestinationFileURL isValidForDownloadIdentifier:aDownloadItem.downloadToken];
-                            if (anIsValidDownloadFlag == NO)
-                            {
-                                anErrorString = [NSString stringWithFormat:@"ERR: Download check failed for item at %@", aLocalDestinationFileURL];
-                                NSLog(@"%@", anErrorString);
-                            }
-                        }
-                    }
+                    aSegmentTask.priority = [HWIFileDownloader sessionTaskPriorityForPriority:aDownloadItem.priority];
                 }
+                aSegment.sessionDataTask = aSegmentTask;
+                [aSegmentTasksArray addObject:aSegmentTask];
+                [self.segmentDownloadIDsDictionary setObject:@(aDownloadID) forKey:@(aSegmentTask.taskIdentifier)];
             }
         }
-        else
+        if (aSegmentTasksArray.count == 0)
         {
-            anErrorString = [NSString stringWithFormat:@"ERR: Missing information: Local file URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-            NSLog(@"%@", anErrorString);
+            // paused after the last byte had been received
+            [self finishSegmentsOfDownloadItem:aDownloadItem downloadID:aDownloadID];
+        }
+        for (NSURLSessionDataTask *aSegmentTask in aSegmentTasksArray)
+        {
+            [aSegmentTask resume];
         }
-        if (anErrorString)
+    }
+    else
+    {
+        NSLog(@"ERR: No url request (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        NSError *aRequestError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadURL userInfo:nil];
+        [self handleDownloadWithError:aRequestError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+    }
+}
+
+
+- (NSURLSessionResponseDisposition)dispositionForResponse:(nonnull NSURLResponse *)aResponse
+                                            ofSegmentTask:(nonnull NSURLSessionTask *)aSegmentTask
+                                               downloadID:(NSUInteger)aDownloadID
+{
+    NSURLSessionResponseDisposition aDisposition = NSURLSessionResponseAllow;
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    HWIFileDownloadSegment *aSegment = [aDownloadItem segmentForTaskIdentifier:aSegmentTask.taskIdentifier];
+    if (aSegment)
+    {
+        NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aResponse;
+        NSInteger aHttpStatusCode = [aHttpResponse isKindOfClass:[NSHTTPURLResponse class]] ? aHttpResponse.statusCode : 0;
+        aDownloadItem.lastHttpStatusCode = aHttpStatusCode;
+        if (aHttpStatusCode != 206)
         {
+            // the range has not been served (e.g. the file has changed meanwhile); the body is not written
+            aDisposition = NSURLSessionResponseCancel;
+            NSString *anErrorString = [NSString stringWithFormat:@"Invalid http status code for segment: %@", @(aHttpStatusCode)];
             NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
             if (anErrorMessagesStackArray == nil)
             {
@@ -760,673 +1617,3561 @@
             }
             [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
             [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+            
+            NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil];
+            [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
         }
-        else
-        {
-            aDownloadItem.finalLocalFileURL = aLocalDestinationFileURL;
-        }
-    }
-    else
-    {
-        NSLog(@"ERR: Missing download item for taskIdentifier: %@ (%@, %d)", @(aDownloadTask.taskIdentifier), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
     }
+    return aDisposition;
 }
 
 
-- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didWriteData:(int64_t)aBytesWrittenCount totalBytesWritten:(int64_t)aTotalBytesWrittenCount totalBytesExpectedToWrite:(int64_t)aTotalBytesExpectedToWriteCount
+- (void)handleReceivedData:(nonnull NSData *)aData ofSegmentTask:(nonnull NSURLSessionTask *)aSegmentTask downloadID:(NSUInteger)aDownloadID
 {
-    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
-    if (aDownloadItem)
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    HWIFileDownloadSegment *aSegment = [aDownloadItem segmentForTaskIdentifier:aSegmentTask.taskIdentifier];
+    if (aSegment)
     {
         if (aDownloadItem.downloadStartDate == nil)
         {
             aDownloadItem.downloadStartDate = [NSDate date];
         }
-        aDownloadItem.receivedFileSizeInBytes = aTotalBytesWrittenCount;
-        aDownloadItem.expectedFileSizeInBytes = aTotalBytesExpectedToWriteCount;
-        if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifier:)])
+        int64_t aBytesCount = MIN((int64_t)aData.length, aSegment.length - aSegment.receivedFileSizeInBytes);
+        if (aBytesCount < (int64_t)aData.length)
+        {
+            // data beyond the range would overwrite the next segment
+            aData = [aData subdataWithRange:NSMakeRange(0, (NSUInteger)aBytesCount)];
+        }
+        int64_t aFileOffset = aSegment.offset + aSegment.receivedFileSizeInBytes;
+        aSegment.receivedFileSizeInBytes += aBytesCount;
+        aDownloadItem.receivedFileSizeInBytes += aBytesCount;
+        [self notifyProgressChangedForDownloadItem:aDownloadItem];
+        [self recordReceivedBytes:aBytesCount ofDownloadItem:aDownloadItem];
+        [self throttleDownloadItem:aDownloadItem downloadID:aDownloadID afterReceivingBytes:aBytesCount];
+        
+        HWIFileDownloadWriteBudget *aWriteBudget = self.writeBudget;
+        if ([aWriteBudget reserveBytesCount:aBytesCount])
+        {
+            [self holdTransfersForWriter];
+        }
+        else if (aWriteBudget.isExhausted && (aDownloadItem.isWaitingForWriter == NO))
         {
-            NSString *aTaskDescription = [aDownloadTask.taskDescription copy];
-            if (aTaskDescription)
+            // started while the writer is behind
+            [self holdTransfersOfDownloadItem:aDownloadItem];
+        }
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.segmentedFileWriter;
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            NSError *aWriteError = nil;
+            BOOL aWriteSuccessFlag = [aFileWriter writeData:aData atOffset:aFileOffset error:&aWriteError];
+            BOOL aResumesTransfersFlag = [aWriteBudget releaseBytesCount:aBytesCount];
+            if ((aWriteSuccessFlag == NO) || aResumesTransfersFlag)
             {
-                [self.fileDownloadDelegate downloadProgressChangedForIdentifier:aTaskDescription];
+                dispatch_async(aDownloaderDispatchQueue, ^{
+                    HWIFileDownloader *strongSelf = weakSelf;
+                    if (aWriteSuccessFlag == NO)
+                    {
+                        [strongSelf handleFailedSegmentWriteAtOffset:aFileOffset downloadItem:aDownloadItem downloadID:aDownloadID error:aWriteError];
+                    }
+                    if (aResumesTransfersFlag)
+                    {
+                        [strongSelf resumeTransfersWaitingForWriter];
+                    }
+                });
             }
-        }
+        });
+        [self scheduleSegmentsResumeDataSaveOfDownloadItem:aDownloadItem downloadID:aDownloadID];
     }
 }
 
 
-- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didResumeAtOffset:(int64_t)aFileOffset expectedTotalBytes:(int64_t)aTotalBytesExpectedCount
+- (void)handleFailedSegmentWriteAtOffset:(int64_t)aFileOffset
+                            downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                              downloadID:(NSUInteger)aDownloadID
+                                   error:(nonnull NSError *)aWriteError
 {
-    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
-    if (aDownloadItem)
+    if ([self.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile cancelled download
     {
-        aDownloadItem.resumedFileSizeInBytes = aFileOffset;
-        aDownloadItem.downloadStartDate = [NSDate date];
-        aDownloadItem.bytesPerSecondSpeed = 0;
-        NSLog(@"INFO: Download (id: %@) resumed (offset: %@ bytes, expected: %@ bytes", aDownloadTask.taskDescription, @(aFileOffset), @(aTotalBytesExpectedCount));
+        NSString *aWriteErrorString = [NSString stringWithFormat:@"ERR: Unable to write segment data (offset: %@) to %@: %@ (%@, %d)", @(aFileOffset), aDownloadItem.segmentedFileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+        NSLog(@"%@", aWriteErrorString);
+        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+        if (anErrorMessagesStackArray == nil)
+        {
+            anErrorMessagesStackArray = [NSMutableArray array];
+        }
+        [anErrorMessagesStackArray insertObject:aWriteErrorString atIndex:0];
+        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+        [self handleDownloadWithError:aWriteError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
     }
 }
 
 
-#pragma mark - NSURLSessionTaskDelegate
-
-
-- (void)URLSession:(nonnull NSURLSession *)aSession task:(nonnull NSURLSessionTask *)aDownloadTask didCompleteWithError:(nullable NSError *)anError
+- (void)handleCompletedSegmentTask:(nonnull NSURLSessionTask *)aSegmentTask
+                        downloadID:(NSUInteger)aDownloadID
+                             error:(nullable NSError *)anError
 {
-    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
-    if (aDownloadItem)
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    HWIFileDownloadSegment *aSegment = [aDownloadItem segmentForTaskIdentifier:aSegmentTask.taskIdentifier];
+    if (aSegment)
     {
-        NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aDownloadTask.response;
-        NSInteger aHttpStatusCode = aHttpResponse.statusCode;
-        aDownloadItem.lastHttpStatusCode = aHttpStatusCode;
-        if (anError == nil)
+        aSegment.sessionDataTask = nil;
+        if (anError)
         {
-            BOOL aHttpStatusCodeIsCorrectFlag = NO;
-            if ([self.fileDownloadDelegate respondsToSelector:@selector(httpStatusCode:isValidForDownloadIdentifier:)])
-            {
-                aHttpStatusCodeIsCorrectFlag = [self.fileDownloadDelegate httpStatusCode:aHttpStatusCode isValidForDownloadIdentifier:aDownloadItem.downloadToken];
-            }
-            else
+            // a retry continues the received ranges
+            [self handleDownloadWithError:anError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:[HWIFileDownloader resumeDataOfSegmentedDownloadItem:aDownloadItem]];
+        }
+        else if (aSegment.receivedFileSizeInBytes < aSegment.length)
+        {
+            NSString *anErrorString = [NSString stringWithFormat:@"Incomplete segment (offset: %@, length: %@, received: %@)", @(aSegment.offset), @(aSegment.length), @(aSegment.receivedFileSizeInBytes)];
+            NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+            if (anErrorMessagesStackArray == nil)
             {
-                aHttpStatusCodeIsCorrectFlag = [HWIFileDownloader httpStatusCode:aHttpStatusCode isValidForDownloadIdentifier:aDownloadItem.downloadToken];
+                anErrorMessagesStackArray = [NSMutableArray array];
             }
-            if (aHttpStatusCodeIsCorrectFlag == YES)
+            [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
+            [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+            
+            NSError *anIncompleteError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+            [self handleDownloadWithError:anIncompleteError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:[HWIFileDownloader resumeDataOfSegmentedDownloadItem:aDownloadItem]];
+        }
+        else
+        {
+            aSegment.isCompleted = YES;
+            BOOL anAllSegmentsCompletedFlag = YES;
+            for (HWIFileDownloadSegment *anotherSegment in aDownloadItem.segmentsArray)
             {
-                NSURL *aFinalLocalFileURL = aDownloadItem.finalLocalFileURL;
-                if (aFinalLocalFileURL)
-                {
-                    [self handleSuccessfulDownloadToLocalFileURL:aFinalLocalFileURL
-                                                    downloadItem:aDownloadItem
-                                                      downloadID:aDownloadTask.taskIdentifier];
-                }
-                else
+                if (anotherSegment.isCompleted == NO)
                 {
-                    NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil];
-                    [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier resumeData:nil];
+                    anAllSegmentsCompletedFlag = NO;
+                    break;
                 }
             }
-            else
+            if (anAllSegmentsCompletedFlag)
             {
-                NSString *anErrorString = [NSString stringWithFormat:@"Invalid http status code: %@", @(aHttpStatusCode)];
-                NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                if (anErrorMessagesStackArray == nil)
-                {
-                    anErrorMessagesStackArray = [NSMutableArray array];
-                }
-                [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
-                [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                
-                NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSURLErrorFailingURLStringErrorKey: aHttpResponse.URL.absoluteString, NSURLErrorFailingURLErrorKey: aHttpResponse.URL}];
-                [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier resumeData:nil];
+                [self finishSegmentsOfDownloadItem:aDownloadItem downloadID:aDownloadID];
             }
         }
+    }
+}
+
+
+- (void)finishSegmentsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    // the file is moved when the pending segment writes have been processed
+    HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.segmentedFileWriter;
+    dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+    __weak HWIFileDownloader *weakSelf = self;
+    dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+        HWIFileDownloader *strongSelf = weakSelf;
+        [strongSelf closeFileWriter:aFileWriter];
+        dispatch_async(aDownloaderDispatchQueue, ^{
+            HWIFileDownloader *anotherStrongSelf = weakSelf;
+            [anotherStrongSelf handleWrittenSegmentsOfDownloadItem:aDownloadItem downloadID:aDownloadID];
+        });
+    });
+}
+
+
+- (void)handleWrittenSegmentsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    if ([self.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile cancelled or failed download
+    {
+        [self removeSegmentsResumeDataOfDownloadItem:aDownloadItem];
+        NSURL *aLocalFileURL = [self moveDownloadedFileAtURL:aDownloadItem.segmentedFileURL
+                               toLocalFileURLForDownloadItem:aDownloadItem
+                                                   remoteURL:aDownloadItem.remoteURL];
+        if (aLocalFileURL)
+        {
+            aDownloadItem.finalLocalFileURL = aLocalFileURL;
+            aDownloadItem.segmentedFileURL = nil;
+            [self verifyDigestOfDownloadToLocalFileURL:aLocalFileURL
+                                          downloadItem:aDownloadItem
+                                            downloadID:aDownloadID];
+        }
         else
         {
-            NSData *aSessionDownloadTaskResumeData = [anError.userInfo objectForKey:NSURLSessionDownloadTaskResumeData];
-            //NSString *aFailingURLStringErrorKeyString = [anError.userInfo objectForKey:NSURLErrorFailingURLStringErrorKey];
-            //NSNumber *aBackgroundTaskCancelledReasonKeyNumber = [anError.userInfo objectForKey:NSURLErrorBackgroundTaskCancelledReasonKey];
-            
-            [self handleDownloadWithError:anError downloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier resumeData:aSessionDownloadTaskResumeData];
+            NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil];
+            [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
         }
     }
-    else
+}
+
+
+- (void)cancelSegmentsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem keepsSegmentedFile:(BOOL)aKeepsSegmentedFileFlag
+{
+    [aDownloadItem.segmentProbeTask cancel];
+    aDownloadItem.segmentProbeTask = nil;
+    for (HWIFileDownloadSegment *aSegment in aDownloadItem.segmentsArray)
     {
-        NSLog(@"ERR: Download item not found for download task: %@ (%@, %d)", aDownloadTask, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        if (aSegment.sessionDataTask.state != NSURLSessionTaskStateCompleted)
+        {
+            [aSegment.sessionDataTask cancel];
+        }
+    }
+    [self removeSegmentsResumeDataOfDownloadItem:aDownloadItem];
+    HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.segmentedFileWriter;
+    NSURL *aSegmentedFileURL = aKeepsSegmentedFileFlag ? nil : aDownloadItem.segmentedFileURL;
+    if (aFileWriter || aSegmentedFileURL)
+    {
+        // pending segment writes are processed first
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            [strongSelf closeFileWriter:aFileWriter];
+            if (aSegmentedFileURL && [[NSFileManager defaultManager] fileExistsAtPath:aSegmentedFileURL.path])
+            {
+                NSError *aRemoveError = nil;
+                BOOL aRemoveSuccessFlag = [[NSFileManager defaultManager] removeItemAtURL:aSegmentedFileURL error:&aRemoveError];
+                if (aRemoveSuccessFlag == NO)
+                {
+                    NSLog(@"ERR: Unable to remove file at %@ (%@) (%@, %d)", aSegmentedFileURL, aRemoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                }
+            }
+        });
     }
 }
 
 
-- (void)URLSession:(NSURLSession *)aSession
-              task:(NSURLSessionTask *)aTask
-didReceiveChallenge:(NSURLAuthenticationChallenge *)aChallenge
- completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential * _Nullable credential))aCompletionHandler
+#pragma mark - Segments Resume Data
+
+
++ (nullable NSData *)resumeDataOfSegmentedDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
 {
-    if ([self.fileDownloadDelegate respondsToSelector:@selector(onAuthenticationChallenge:downloadIdentifier:completionHandler:)])
+    NSData *aResumeData = nil;
+    if (aDownloadItem.segmentsArray && aDownloadItem.segmentedFileURL && aDownloadItem.remoteURL)
     {
-        NSString *aDownloadToken = [aTask.taskDescription copy];
-        if (aDownloadToken)
+        NSMutableArray<NSArray<NSNumber *> *> *aRangesArray = [NSMutableArray arrayWithCapacity:aDownloadItem.segmentsArray.count];
+        for (HWIFileDownloadSegment *aSegment in aDownloadItem.segmentsArray)
         {
-            [self.fileDownloadDelegate onAuthenticationChallenge:aChallenge
-                                              downloadIdentifier:aDownloadToken
-                                               completionHandler:^(NSURLCredential * _Nullable aCredential, NSURLSessionAuthChallengeDisposition aDisposition) {
-                                                   aCompletionHandler(aDisposition, aCredential);
-                                               }];
+            [aRangesArray addObject:@[@(aSegment.offset), @(aSegment.length), @(aSegment.receivedFileSizeInBytes)]];
         }
-        else
+        NSMutableDictionary *aResumeDataDictionary = [NSMutableDictionary dictionary];
+        [aResumeDataDictionary setObject:@1 forKey:HWIFileDownloadSegmentsResumeDataVersionKey];
+        [aResumeDataDictionary setObject:aDownloadItem.remoteURL.absoluteString forKey:@"remoteURL"];
+        [aResumeDataDictionary setObject:aDownloadItem.segmentedFileURL.lastPathComponent forKey:@"fileName"];
+        [aResumeDataDictionary setObject:@(aDownloadItem.expectedFileSizeInBytes) forKey:@"expectedFileSize"];
+        [aResumeDataDictionary setObject:aRangesArray forKey:@"segments"];
+        if (aDownloadItem.responseETag)
         {
-            NSLog(@"ERR: Missing task description (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-            aCompletionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+            [aResumeDataDictionary setObject:aDownloadItem.responseETag forKey:@"entityTag"];
+        }
+        if (aDownloadItem.responseLastModified)
+        {
+            [aResumeDataDictionary setObject:aDownloadItem.responseLastModified forKey:@"lastModified"];
         }
+        aResumeData = [NSPropertyListSerialization dataWithPropertyList:aResumeDataDictionary format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
     }
-    else
+    return aResumeData;
+}
+
+
++ (nullable NSDictionary *)segmentsResumeDataDictionaryOfResumeData:(nullable NSData *)aResumeData
+{
+    NSDictionary *aFoundResumeDataDictionary = nil;
+    if (aResumeData)
     {
-        NSLog(@"ERR: Received authentication challenge with no delegate method implemented (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-        aCompletionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+        // resume data of NSURLSession is a property list without the version key
+        NSDictionary *aResumeDataDictionary = [NSPropertyListSerialization propertyListWithData:aResumeData options:NSPropertyListImmutable format:NULL error:NULL];
+        if ([aResumeDataDictionary isKindOfClass:[NSDictionary class]] && [[aResumeDataDictionary objectForKey:HWIFileDownloadSegmentsResumeDataVersionKey] isEqual:@1])
+        {
+            NSString *aRemoteURLString = [aResumeDataDictionary objectForKey:@"remoteURL"];
+            NSString *aFileName = [aResumeDataDictionary objectForKey:@"fileName"];
+            NSNumber *anExpectedFileSize = [aResumeDataDictionary objectForKey:@"expectedFileSize"];
+            NSArray *aRangesArray = [aResumeDataDictionary objectForKey:@"segments"];
+            BOOL aValidFlag = ([aRemoteURLString isKindOfClass:[NSString class]] && [NSURL URLWithString:aRemoteURLString]
+                               && [aFileName isKindOfClass:[NSString class]] && (aFileName.lastPathComponent.length == aFileName.length)
+                               && [anExpectedFileSize isKindOfClass:[NSNumber class]]
+                               && [aRangesArray isKindOfClass:[NSArray class]] && (aRangesArray.count > 0));
+            int64_t aRangesLength = 0;
+            for (NSArray<NSNumber *> *aRangeArray in (aValidFlag ? aRangesArray : nil))
+            {
+                // contiguous ranges covering the file
+                if (([aRangeArray isKindOfClass:[NSArray class]] == NO) || (aRangeArray.count != 3)
+                    || ([[aRangeArray objectAtIndex:0] longLongValue] != aRangesLength)
+                    || ([[aRangeArray objectAtIndex:1] longLongValue] <= 0)
+                    || ([[aRangeArray objectAtIndex:2] longLongValue] < 0)
+                    || ([[aRangeArray objectAtIndex:2] longLongValue] > [[aRangeArray objectAtIndex:1] longLongValue]))
+                {
+                    aValidFlag = NO;
+                    break;
+                }
+                aRangesLength += [[aRangeArray objectAtIndex:1] longLongValue];
+            }
+            if (aValidFlag && (aRangesLength == [anExpectedFileSize longLongValue]))
+            {
+                aFoundResumeDataDictionary = aResumeDataDictionary;
+            }
+            else
+            {
+                NSLog(@"ERR: Invalid resume data of segmented download (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            }
+        }
     }
+    return aFoundResumeDataDictionary;
 }
 
 
-#pragma mark - NSURLSessionDelegate
+- (void)scheduleSegmentsResumeDataSaveOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    if (aDownloadItem.segmentsResumeDataFileName && (aDownloadItem.isSegmentsResumeDataSaveScheduled == NO))
+    {
+        aDownloadItem.isSegmentsResumeDataSaveScheduled = YES;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(HWIFileDownloaderSegmentsResumeDataSaveDelay * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            aDownloadItem.isSegmentsResumeDataSaveScheduled = NO;
+            [strongSelf saveSegmentsResumeDataOfDownloadItem:aDownloadItem downloadID:aDownloadID];
+        });
+    }
+}
 
 
-- (void)URLSessionDidFinishEventsForBackgroundURLSession:(NSURLSession *)aSession
+- (void)saveSegmentsResumeDataOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
 {
-    if (self.bgSessionCompletionHandlerBlock)
+    NSData *aResumeData = [HWIFileDownloader resumeDataOfSegmentedDownloadItem:aDownloadItem];
+    if (aResumeData && ([self.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem))
     {
-        void (^completionHandler)(void) = self.bgSessionCompletionHandlerBlock;
-        self.bgSessionCompletionHandlerBlock = nil;
-        completionHandler();
+        // stored when the received data has been written, so that no unwritten range is continued after a termination
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            dispatch_async(aDownloaderDispatchQueue, ^{
+                HWIFileDownloader *strongSelf = weakSelf;
+                NSString *aFileName = aDownloadItem.segmentsResumeDataFileName;
+                if (aFileName && ([strongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem)) // check for meanwhile finished download
+                {
+                    [strongSelf.resumeDataStore storeResumeData:aResumeData fileName:aFileName];
+                }
+            });
+        });
     }
 }
 
 
-- (void)URLSession:(NSURLSession *)aSession didBecomeInvalidWithError:(nullable NSError *)anError
+- (void)removeSegmentsResumeDataOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
 {
-    if (anError) {
-        NSLog(@"ERR: Session did become invalid with error: %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    if (aDownloadItem.segmentsResumeDataFileName)
+    {
+        [self.resumeDataStore removeResumeDataAtFileURL:[self.resumeDataStore fileURLForFileName:aDownloadItem.segmentsResumeDataFileName]];
+        aDownloadItem.segmentsResumeDataFileName = nil;
     }
-    else {
-        NSLog(@"INFO: Session has been intentionally invalidated (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+}
+
+
+#pragma mark - Download Status
+
+
+- (BOOL)isDownloadingIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    __block BOOL isDownloading = NO;
+    [self performOnDownloaderQueueAndWait:^{
+        NSString *aDownloadToken = [self transferDownloadTokenForDownloadToken:aDownloadIdentifier];
+        if (aDownloadToken == nil)
+        {
+            return;
+        }
+        NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadToken];
+        if (aDownloadID > -1)
+        {
+            HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+            if (aDownloadItem)
+            {
+                isDownloading = YES;
+            }
+        }
+        if (isDownloading == NO)
+        {
+            if ([self.waitingDownloadsQueue waitingItemForDownloadToken:aDownloadToken] || [self.backingOffWaitingItemsDictionary objectForKey:aDownloadToken])
+            {
+                isDownloading = YES;
+            }
+        }
+    }];
+    return isDownloading;
+}
+
+
+- (BOOL)isWaitingForDownloadOfIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    __block BOOL isWaitingForDownload = NO;
+    [self performOnDownloaderQueueAndWait:^{
+        NSString *aDownloadToken = [self transferDownloadTokenForDownloadToken:aDownloadIdentifier];
+        if (aDownloadToken == nil)
+        {
+            return;
+        }
+        if ([self.waitingDownloadsQueue waitingItemForDownloadToken:aDownloadToken] || [self.backingOffWaitingItemsDictionary objectForKey:aDownloadToken])
+        {
+            isWaitingForDownload = YES;
+        }
+        NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadToken];
+        if (aDownloadID > -1)
+        {
+            HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+            if (aDownloadItem && (aDownloadItem.receivedFileSizeInBytes == 0))
+            {
+                isWaitingForDownload = YES;
+            }
+        }
+    }];
+    return isWaitingForDownload;
+}
+
+
+- (BOOL)hasActiveDownloads
+{
+    __block BOOL aHasActiveDownloadsFlag = NO;
+    [self performOnDownloaderQueueAndWait:^{
+        if ((self.activeDownloadsDictionary.count > 0) || (self.waitingDownloadsQueue.count > 0) || (self.backingOffWaitingItemsDictionary.count > 0))
+        {
+            aHasActiveDownloadsFlag = YES;
+        }
+    }];
+    return aHasActiveDownloadsFlag;
+}
+
+
+- (nonnull NSURL *)tempLocalFileURLForDownloadFromURL:(nonnull NSURL *)aRemoteURL
+{
+    NSString *anOfflineDownloadDirectory = NSTemporaryDirectory();
+    anOfflineDownloadDirectory = [anOfflineDownloadDirectory stringByAppendingPathComponent:@"file-download"];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:anOfflineDownloadDirectory] == NO)
+    {
+        [[NSFileManager defaultManager] createDirectoryAtPath:anOfflineDownloadDirectory withIntermediateDirectories:YES attributes:nil error:NULL];
     }
+    NSURL *anOfflineDownloadDirectoryURL = [NSURL fileURLWithPath:anOfflineDownloadDirectory isDirectory:YES];
+    [anOfflineDownloadDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:NULL];
+    
+    NSString *aFilePathName = [anOfflineDownloadDirectory stringByAppendingPathComponent:[aRemoteURL lastPathComponent]];
+    NSURL *aLocalFileURL = [NSURL fileURLWithPath:aFilePathName isDirectory:NO];
+    return aLocalFileURL;
 }
 
 
-#pragma mark - NSURLConnection
-#pragma mark - NSURLConnectionDataDelegate
+#pragma mark - File Writer
 
 
-- (void)connectionDidFinishLoading:(nonnull NSURLConnection *)aConnection
+- (void)closeFileWriter:(nullable HWIFileDownloadFileWriter *)aFileWriter
 {
-    NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
-    if (aDownloadID)
+    [self closeFileWriter:aFileWriter error:NULL];
+}
+
+
+- (BOOL)closeFileWriter:(nullable HWIFileDownloadFileWriter *)aFileWriter error:(NSError * _Nullable * _Nullable)anError
+{
+    // called on downloadFileSerialWriterDispatchQueue
+    BOOL aCloseSuccessFlag = YES;
+    if (aFileWriter && [self.openFileWritersSet containsObject:aFileWriter])
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
-        
-        if (aDownloadItem)
+        NSError *aCloseError = nil;
+        aCloseSuccessFlag = [aFileWriter closeWithError:&aCloseError];
+        if (aCloseSuccessFlag == NO)
         {
-            NSURL *aLocalFileURL = nil;
-            if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+            NSLog(@"ERR: Unable to close file %@: %@ (%@, %d)", aFileWriter.fileURL, aCloseError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            if (anError)
             {
-                aLocalFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadItem.downloadToken remoteURL:aConnection.originalRequest.URL];
+                *anError = aCloseError;
             }
-            else
+        }
+        self.closedFileWritersWrittenBytesCount += aFileWriter.writtenBytesCount;
+        self.closedFileWritersSystemCallsCount += aFileWriter.systemCallsCount;
+        [self.openFileWritersSet removeObject:aFileWriter];
+    }
+    return aCloseSuccessFlag;
+}
+
+
+- (int64_t)writtenBytesCount
+{
+    __block int64_t aWrittenBytesCount = 0;
+    if (self.downloadFileSerialWriterDispatchQueue)
+    {
+        dispatch_sync(self.downloadFileSerialWriterDispatchQueue, ^{
+            aWrittenBytesCount = self.closedFileWritersWrittenBytesCount;
+            for (HWIFileDownloadFileWriter *aFileWriter in self.openFileWritersSet)
             {
-                aLocalFileURL = [HWIFileDownloader localFileURLForRemoteURL:aConnection.originalRequest.URL];
+                aWrittenBytesCount += aFileWriter.writtenBytesCount;
             }
-            
-            if (aLocalFileURL)
+        });
+    }
+    return aWrittenBytesCount;
+}
+
+
+- (NSUInteger)fileSystemCallsCount
+{
+    __block NSUInteger aFileSystemCallsCount = 0;
+    if (self.downloadFileSerialWriterDispatchQueue)
+    {
+        dispatch_sync(self.downloadFileSerialWriterDispatchQueue, ^{
+            aFileSystemCallsCount = self.closedFileWritersSystemCallsCount;
+            for (HWIFileDownloadFileWriter *aFileWriter in self.openFileWritersSet)
             {
-                
-                NSURL *aTempFileURL = [self tempLocalFileURLForDownloadFromURL:aConnection.originalRequest.URL];
-                
-                __weak HWIFileDownloader *weakSelf = self;
-                dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
-                    
-                    HWIFileDownloader *strongSelf = weakSelf;
+                aFileSystemCallsCount += aFileWriter.systemCallsCount;
+            }
+        });
+    }
+    return aFileSystemCallsCount;
+}
+
+
+#pragma mark - Statistics
+
+
+- (nonnull NSDictionary<NSString *, NSNumber *> *)statisticsDictionary
+{
+    NSMutableDictionary<NSString *, NSNumber *> *aStatisticsDict = [NSMutableDictionary dictionary];
+    [self performOnDownloaderQueueAndWait:^{
+        [aStatisticsDict setObject:@(self.activeDownloadsDictionary.count) forKey:@"activeDownloadsCount"];
+        [aStatisticsDict setObject:@(self.waitingDownloadsQueue.count) forKey:@"waitingDownloadsCount"];
+        [aStatisticsDict setObject:@(self.resumeDataStore.storedBytesCount) forKey:@"storedResumeDataBytesCount"];
+        [aStatisticsDict setObject:@([self currentConcurrentDownloadsWindow]) forKey:@"concurrentDownloadsWindow"];
+        [aStatisticsDict setObject:@(self.completedDownloadsCount) forKey:@"completedDownloadsCount"];
+        [aStatisticsDict setObject:@(self.failedDownloadsCount) forKey:@"failedDownloadsCount"];
+        [aStatisticsDict setObject:@(self.receivedBytesCount) forKey:@"receivedBytesCount"];
+        [aStatisticsDict setObject:@((NSUInteger)[self.throughputEstimator windowedBytesPerSecondAtTime:[NSDate timeIntervalSinceReferenceDate]]) forKey:@"bytesPerSecondSpeed"];
+        [aStatisticsDict setObject:@(self.progressCoalescer.suppressedChangesCount) forKey:@"suppressedProgressCallbacksCount"];
+        [aStatisticsDict setObject:@(self.deduplicator.savedRequestsCount) forKey:@"coalescedRequestsCount"];
+        [aStatisticsDict setObject:@(self.deduplicator.savedBytesCount) forKey:@"coalescedBytesCount"];
+        [aStatisticsDict setObject:@(self.retriesCount) forKey:@"retriesCount"];
+        [aStatisticsDict setObject:@(self.retryResumedBytesCount) forKey:@"retryResumedBytesCount"];
+        [aStatisticsDict setObject:@(self.streamedBytesCount) forKey:@"streamedBytesCount"];
+        [aStatisticsDict setObject:@(self.streamSuspensionsCount) forKey:@"streamSuspensionsCount"];
+    }];
+    [aStatisticsDict setObject:@(self.writeBudget.pendingBytesCount) forKey:@"pendingWriteBytesCount"];
+    [aStatisticsDict setObject:@(self.writeBudget.highWaterMarkBytesCount) forKey:@"pendingWriteBytesHighWaterMark"];
+    [aStatisticsDict setObject:@(self.writeBudget.stallsCount) forKey:@"writeStallsCount"];
+    [aStatisticsDict setObject:@(self.writeBudget.stallDuration) forKey:@"writeStallDuration"];
+    [aStatisticsDict setObject:@(self.writtenBytesCount) forKey:@"writtenBytesCount"];
+    [aStatisticsDict setObject:@(self.fileSystemCallsCount) forKey:@"fileSystemCallsCount"];
+    struct rusage aResourceUsage;
+    if (getrusage(RUSAGE_SELF, &aResourceUsage) == 0)
+    {
+        NSTimeInterval aCPUTime = (NSTimeInterval)(aResourceUsage.ru_utime.tv_sec + aResourceUsage.ru_stime.tv_sec) + (NSTimeInterval)(aResourceUsage.ru_utime.tv_usec + aResourceUsage.ru_stime.tv_usec) / 1000000.0;
+        [aStatisticsDict setObject:@(aCPUTime) forKey:@"processCPUTime"];
+        [aStatisticsDict setObject:@((int64_t)aResourceUsage.ru_maxrss) forKey:@"processPeakResidentSize"]; // bytes on Darwin
+    }
+    return aStatisticsDict;
+}
+
+
+#pragma mark - BackgroundSessionCompletionHandler
+
+
+- (void)setBackgroundSessionCompletionHandlerBlock:(nullable HWIBackgroundSessionCompletionHandlerBlock)aBackgroundSessionCompletionHandlerBlock
+{
+    [self performOnDownloaderQueueAndWait:^{
+        self.bgSessionCompletionHandlerBlock = aBackgroundSessionCompletionHandlerBlock;
+    }];
+}
+
+
+#pragma mark - NSURLSession
+#pragma mark - NSURLSessionDownloadDelegate
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didFinishDownloadingToURL:(nonnull NSURL *)aDownloadURL
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
+    NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aDownloadTask.response;
+    if (aDownloadItem.cacheEntry && ([aHttpResponse isKindOfClass:[NSHTTPURLResponse class]]) && (aHttpResponse.statusCode == 304))
+    {
+        // the cached file is used, the empty response body is discarded by the session
+        aDownloadItem.isNotModified = YES;
+    }
+    else if (aDownloadItem)
+    {
+        NSURL *aLocalDestinationFileURL = [self moveDownloadedFileAtURL:aDownloadURL
+                                          toLocalFileURLForDownloadItem:aDownloadItem
+                                                              remoteURL:[[aDownloadTask.originalRequest URL] copy]];
+        if (aLocalDestinationFileURL)
+        {
+            aDownloadItem.finalLocalFileURL = aLocalDestinationFileURL;
+        }
+    }
+    else
+    {
+        NSLog(@"ERR: Missing download item for taskIdentifier: %@ (%@, %d)", @(aDownloadTask.taskIdentifier), [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+}
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didWriteData:(int64_t)aBytesWrittenCount totalBytesWritten:(int64_t)aTotalBytesWrittenCount totalBytesExpectedToWrite:(int64_t)aTotalBytesExpectedToWriteCount
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
+    if (aDownloadItem)
+    {
+        if (aDownloadItem.downloadStartDate == nil)
+        {
+            aDownloadItem.downloadStartDate = [NSDate date];
+        }
+        aDownloadItem.receivedFileSizeInBytes = aTotalBytesWrittenCount;
+        aDownloadItem.expectedFileSizeInBytes = aTotalBytesExpectedToWriteCount;
+        [self notifyProgressChangedForDownloadItem:aDownloadItem];
+        [self recordReceivedBytes:aBytesWrittenCount ofDownloadItem:aDownloadItem];
+        [self throttleDownloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier afterReceivingBytes:aBytesWrittenCount];
+    }
+}
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession downloadTask:(nonnull NSURLSessionDownloadTask *)aDownloadTask didResumeAtOffset:(int64_t)aFileOffset expectedTotalBytes:(int64_t)aTotalBytesExpectedCount
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
+    if (aDownloadItem)
+    {
+        aDownloadItem.resumedFileSizeInBytes = aFileOffset;
+        if (aDownloadItem.retriesCount > 0)
+        {
+            self.retryResumedBytesCount += aFileOffset;
+        }
+        aDownloadItem.downloadStartDate = [NSDate date];
+        aDownloadItem.bytesPerSecondSpeed = 0;
+        [aDownloadItem.throughputEstimator reset];
+        NSLog(@"INFO: Download (id: %@) resumed (offset: %@ bytes, expected: %@ bytes", aDownloadTask.taskDescription, @(aFileOffset), @(aTotalBytesExpectedCount));
+    }
+}
+
+
+#pragma mark - NSURLSessionDataDelegate
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession dataTask:(nonnull NSURLSessionDataTask *)aDataTask didReceiveResponse:(nonnull NSURLResponse *)aResponse completionHandler:(nonnull void (^)(NSURLSessionResponseDisposition))aCompletionHandler
+{
+    NSURLSessionResponseDisposition aDisposition = NSURLSessionResponseAllow;
+    NSNumber *aSegmentedDownloadID = [self.segmentDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    NSNumber *aFoundDownloadID = [self.streamDataTaskDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    if (aSegmentedDownloadID)
+    {
+        aDisposition = [self dispositionForResponse:aResponse ofSegmentTask:aDataTask downloadID:[aSegmentedDownloadID unsignedIntegerValue]];
+    }
+    else if (aFoundDownloadID)
+    {
+        [self handleResponse:aResponse ofTransferWithDownloadID:aFoundDownloadID];
+    }
+    aCompletionHandler(aDisposition);
+}
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession dataTask:(nonnull NSURLSessionDataTask *)aDataTask didReceiveData:(nonnull NSData *)aData
+{
+    NSNumber *aSegmentedDownloadID = [self.segmentDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    NSNumber *aFoundDownloadID = [self.streamDataTaskDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    if (aSegmentedDownloadID)
+    {
+        [self handleReceivedData:aData ofSegmentTask:aDataTask downloadID:[aSegmentedDownloadID unsignedIntegerValue]];
+    }
+    else if (aFoundDownloadID)
+    {
+        [self handleReceivedData:aData ofTransferWithDownloadID:aFoundDownloadID];
+    }
+}
+
+
+- (void)handleCompletedStreamDataTask:(nonnull NSURLSessionTask *)aDataTask ofSession:(nonnull NSURLSession *)aSession error:(nullable NSError *)anError
+{
+    NSNumber *aSegmentedDownloadID = [self.segmentDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    NSNumber *aFoundDownloadID = [self.streamDataTaskDownloadIDsDictionary objectForKey:@(aDataTask.taskIdentifier)];
+    if (aSegmentedDownloadID)
+    {
+        [self.segmentDownloadIDsDictionary removeObjectForKey:@(aDataTask.taskIdentifier)];
+        [self handleCompletedSegmentTask:aDataTask downloadID:[aSegmentedDownloadID unsignedIntegerValue] error:anError];
+    }
+    else if (aFoundDownloadID)
+    {
+        [self.streamDataTaskDownloadIDsDictionary removeObjectForKey:@(aDataTask.taskIdentifier)];
+        if (anError)
+        {
+            [self handleFailedTransferWithError:anError downloadID:aFoundDownloadID];
+        }
+        else
+        {
+            [self handleFinishedTransferWithDownloadID:aFoundDownloadID];
+        }
+    }
+    if ((aSession == self.streamSession) && (self.streamDataTaskDownloadIDsDictionary.count == 0) && (self.segmentDownloadIDsDictionary.count == 0))
+    {
+        // the session retains its delegate until it is invalidated
+        [self.streamSession finishTasksAndInvalidate];
+        self.streamSession = nil;
+    }
+}
+
+
+#pragma mark - NSURLSessionTaskDelegate
+
+
+- (void)URLSession:(nonnull NSURLSession *)aSession task:(nonnull NSURLSessionTask *)aDownloadTask didCompleteWithError:(nullable NSError *)anError
+{
+    if (aSession != self.backgroundSession)
+    {
+        [self handleCompletedStreamDataTask:aDownloadTask ofSession:aSession error:anError];
+        return;
+    }
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadTask.taskIdentifier)];
+    if (aDownloadItem)
+    {
+        NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aDownloadTask.response;
+        NSInteger aHttpStatusCode = aHttpResponse.statusCode;
+        aDownloadItem.lastHttpStatusCode = aHttpStatusCode;
+        if ([aHttpResponse isKindOfClass:[NSHTTPURLResponse class]])
+        {
+            aDownloadItem.responseETag = [aHttpResponse.allHeaderFields objectForKey:@"ETag"];
+            aDownloadItem.responseLastModified = [aHttpResponse.allHeaderFields objectForKey:@"Last-Modified"];
+        }
+        if ((anError == nil) && aDownloadItem.cacheEntry && (aHttpStatusCode == 304))
+        {
+            aDownloadItem.isNotModified = YES;
+            [self completeNotModifiedDownloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier];
+        }
+        else if (anError == nil)
+        {
+            if ([self isValidHttpStatusCodeOfDownloadItem:aDownloadItem])
+            {
+                NSURL *aFinalLocalFileURL = aDownloadItem.finalLocalFileURL;
+                if (aFinalLocalFileURL)
+                {
+                    [self verifyDigestOfDownloadToLocalFileURL:aFinalLocalFileURL
+                                                  downloadItem:aDownloadItem
+                                                    downloadID:aDownloadTask.taskIdentifier];
+                }
+                else
+                {
+                    NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil];
+                    [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier resumeData:nil];
+                }
+            }
+            else
+            {
+                [self handleInvalidHttpStatusCodeOfDownloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier failingURL:aHttpResponse.URL];
+            }
+        }
+        else
+        {
+            NSData *aSessionDownloadTaskResumeData = [anError.userInfo objectForKey:NSURLSessionDownloadTaskResumeData];
+            //NSString *aFailingURLStringErrorKeyString = [anError.userInfo objectForKey:NSURLErrorFailingURLStringErrorKey];
+            //NSNumber *aBackgroundTaskCancelledReasonKeyNumber = [anError.userInfo objectForKey:NSURLErrorBackgroundTaskCancelledReasonKey];
+            
+            [self handleDownloadWithError:anError downloadItem:aDownloadItem downloadID:aDownloadTask.taskIdentifier resumeData:aSessionDownloadTaskResumeData];
+        }
+    }
+    else
+    {
+        NSLog(@"ERR: Download item not found for download task: %@ (%@, %d)", aDownloadTask, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+}
+
+
+- (void)URLSession:(NSURLSession *)aSession task:(NSURLSessionTask *)aTask didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)aMetrics
+{
+    // called before URLSession:task:didCompleteWithError: (iOS 10 and later)
+    NSNumber *aDownloadID = @(aTask.taskIdentifier);
+    if (aSession != self.backgroundSession)
+    {
+        aDownloadID = [self.streamDataTaskDownloadIDsDictionary objectForKey:@(aTask.taskIdentifier)];
+    }
+    HWIFileDownloadItem *aDownloadItem = aDownloadID ? [self.activeDownloadsDictionary objectForKey:aDownloadID] : nil;
+    if (aDownloadItem && (aDownloadItem.isSegmented == NO))
+    {
+        aDownloadItem.sessionTaskMetrics = aMetrics;
+    }
+}
+
+
+- (void)URLSession:(NSURLSession *)aSession
+              task:(NSURLSessionTask *)aTask
+didReceiveChallenge:(NSURLAuthenticationChallenge *)aChallenge
+ completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential * _Nullable credential))aCompletionHandler
+{
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(onAuthenticationChallenge:downloadIdentifier:completionHandler:)])
+    {
+        NSString *aDownloadToken = [aTask.taskDescription copy];
+        if (aDownloadToken)
+        {
+            [self.fileDownloadDelegate onAuthenticationChallenge:aChallenge
+                                              downloadIdentifier:aDownloadToken
+                                               completionHandler:^(NSURLCredential * _Nullable aCredential, NSURLSessionAuthChallengeDisposition aDisposition) {
+                                                   aCompletionHandler(aDisposition, aCredential);
+                                               }];
+        }
+        else
+        {
+            NSLog(@"ERR: Missing task description (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            aCompletionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+        }
+    }
+    else
+    {
+        NSLog(@"ERR: Received authentication challenge with no delegate method implemented (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        aCompletionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+    }
+}
+
+
+#pragma mark - NSURLSessionDelegate
+
+
+- (void)URLSessionDidFinishEventsForBackgroundURLSession:(NSURLSession *)aSession
+{
+    if (self.bgSessionCompletionHandlerBlock)
+    {
+        void (^completionHandler)(void) = self.bgSessionCompletionHandlerBlock;
+        self.bgSessionCompletionHandlerBlock = nil;
+        // the system's completion handler needs to be called on the main thread
+        if ([NSThread isMainThread])
+        {
+            completionHandler();
+        }
+        else
+        {
+            dispatch_async(dispatch_get_main_queue(), completionHandler);
+        }
+    }
+}
+
+
+- (void)URLSession:(NSURLSession *)aSession didBecomeInvalidWithError:(nullable NSError *)anError
+{
+    if (anError) {
+        NSLog(@"ERR: Session did become invalid with error: %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+    else {
+        NSLog(@"INFO: Session has been intentionally invalidated (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+}
+
+
+#pragma mark - NSURLConnection
+#pragma mark - NSURLConnectionDataDelegate
+
+
+- (void)connectionDidFinishLoading:(nonnull NSURLConnection *)aConnection
+{
+    NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
+    if (aDownloadID)
+    {
+        [self handleFinishedTransferWithDownloadID:aDownloadID];
+    }
+    else
+    {
+        NSLog(@"ERR: No download id found on URL connection finish (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    }
+}
+
+
+- (void)connection:(nonnull NSURLConnection *)aConnection didReceiveResponse:(nonnull NSURLResponse *)aResponse
+{
+    NSNumber *aFoundDownloadID = [self downloadIDForConnection:aConnection];
+    if (aFoundDownloadID)
+    {
+        [self handleResponse:aResponse ofTransferWithDownloadID:aFoundDownloadID];
+    }
+}
+
+
+- (void)connection:(nonnull NSURLConnection *)aConnection didReceiveData:(nonnull NSData *)aData
+{
+    NSNumber *aFoundDownloadID = [self downloadIDForConnection:aConnection];
+    if (aFoundDownloadID)
+    {
+        [self handleReceivedData:aData ofTransferWithDownloadID:aFoundDownloadID];
+    }
+}
+
+
+- (nullable NSURLRequest *)connection:(nonnull NSURLConnection *)aConnection willSendRequest:(nonnull NSURLRequest *)aRequest redirectResponse:(nullable NSURLResponse *)aRedirectResponse
+{
+    if (aRedirectResponse)
+    {
+        NSNumber *aFoundDownloadID = [self downloadIDForConnection:aConnection];
+        HWIFileDownloadItem *aDownloadItem = aFoundDownloadID ? [self.activeDownloadsDictionary objectForKey:aFoundDownloadID] : nil;
+        aDownloadItem.redirectsCount++;
+    }
+    return aRequest;
+}
+
+
+- (NSNumber *)downloadIDForConnection:(nonnull NSURLConnection *)aConnection
+{
+    return [self.connectionDownloadIDsMapTable objectForKey:aConnection];
+}
+
+
+#pragma mark - NSURLConnectionDelegate
+
+
+- (void)connection:(nonnull NSURLConnection *)aConnection didFailWithError:(nonnull NSError *)anError
+{
+    NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
+    if (aDownloadID)
+    {
+        [self handleFailedTransferWithError:anError downloadID:aDownloadID];
+    }
+}
+
+
+- (BOOL)connectionShouldUseCredentialStorage:(NSURLConnection *)aConnection
+{
+    return NO;
+}
+
+
+- (void)connection:(NSURLConnection *)aConnection willSendRequestForAuthenticationChallenge:(NSURLAuthenticationChallenge *)aChallenge
+{
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(onAuthenticationChallenge:downloadIdentifier:completionHandler:)])
+    {
+        NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
+        if (aDownloadID)
+        {
+            HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
+            
+            if (aDownloadItem)
+            {
+                
+                [self.fileDownloadDelegate onAuthenticationChallenge:aChallenge
+                                                  downloadIdentifier:aDownloadItem.downloadToken
+                                                   completionHandler:^(NSURLCredential * _Nullable aCredential, NSURLSessionAuthChallengeDisposition aDisposition) {
+                                                       [aChallenge.sender useCredential:aCredential forAuthenticationChallenge:aChallenge];
+                                                   }];
+            }
+            else
+            {
+                NSLog(@"ERR: Missing download item for download id: %@ (%@, %d)", aDownloadItem, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+            }
+        }
+        else
+        {
+            [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+        }
+    }
+    else
+    {
+        NSLog(@"ERR: Received authentication challenge with no delegate method implemented (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+    }
+}
+
+
+#pragma mark - Data Transfer
+
+
+- (void)handleFinishedTransferWithDownloadID:(nonnull NSNumber *)aDownloadID
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
+    
+    if (aDownloadItem.cacheEntry && (aDownloadItem.lastHttpStatusCode == 304))
+    {
+        // the cached file is used, the empty response body is discarded
+        aDownloadItem.isNotModified = YES;
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+        NSURL *aTempFileURL = aFileWriter.fileURL;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            [strongSelf closeFileWriter:aFileWriter];
+            [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:NULL];
+        });
+        [self completeNotModifiedDownloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue]];
+    }
+    else if (aDownloadItem.stream && (aDownloadItem.fileWriter == nil))
+    {
+        [self completeStreamedDownloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue]];
+    }
+    else if (aDownloadItem && ([self isValidHttpStatusCodeOfDownloadItem:aDownloadItem] == NO))
+    {
+        // the response body (e.g. an error page) is discarded
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+        id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+        NSURL *aTempFileURL = aFileWriter.fileURL;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            [strongSelf closeFileWriter:aFileWriter];
+            [strongSelf finishTransform:aTransform error:NULL];
+            if (aTempFileURL)
+            {
+                [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:NULL];
+            }
+        });
+        [self handleInvalidHttpStatusCodeOfDownloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] failingURL:aDownloadItem.remoteURL];
+    }
+    else if (aDownloadItem)
+    {
+        NSURL *aLocalFileURL = nil;
+        if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+        {
+            aLocalFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadItem.downloadToken remoteURL:aDownloadItem.remoteURL];
+        }
+        else
+        {
+            aLocalFileURL = [HWIFileDownloader localFileURLForRemoteURL:aDownloadItem.remoteURL];
+        }
+        
+        if (aLocalFileURL)
+        {
+            
+            HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+            id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+            NSURL *aTempFileURL = aFileWriter.fileURL;
+            
+            dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+            __weak HWIFileDownloader *weakSelf = self;
+            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                
+                HWIFileDownloader *strongSelf = weakSelf;
+                
+                // a truncated file is not moved into place
+                NSError *aCloseError = nil;
+                if (([strongSelf closeFileWriter:aFileWriter error:&aCloseError] == NO) && (aDownloadItem.fileWriteError == nil))
+                {
+                    aDownloadItem.fileWriteError = aCloseError;
+                }
+                NSError *aWriteError = aDownloadItem.fileWriteError;
+                
+                NSError *aDecodeError = nil;
+                BOOL aDecodeSuccessFlag = [strongSelf finishTransform:aTransform error:&aDecodeError];
+                NSError *aMoveError = nil;
+                BOOL aMoveSuccessFlag = NO;
+                int64_t aFileSize = 0;
+                if (aWriteError)
+                {
+                    [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:NULL];
+                    aMoveError = aWriteError;
+                }
+                else if (aDecodeSuccessFlag)
+                {
+                    aMoveSuccessFlag = [HWIFileDownloadFileWriter moveItemAtURL:aTempFileURL toURL:aLocalFileURL fileSize:&aFileSize error:&aMoveError];
+                }
+                else
+                {
+                    [[NSFileManager defaultManager] removeItemAtURL:aTempFileURL error:NULL];
+                    aMoveError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+                }
+                if (aMoveSuccessFlag == NO)
+                {
+                    NSString *anUnableToMoveErrorString = nil;
+                    if (aWriteError)
+                    {
+                        anUnableToMoveErrorString = [NSString stringWithFormat:@"ERR: Unable to write file %@ (%@) (%@, %d)", aTempFileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    }
+                    else if (aDecodeSuccessFlag)
+                    {
+                        anUnableToMoveErrorString = [NSString stringWithFormat:@"ERR: Unable to move file from %@ to %@ (%@) (%@, %d)", aTempFileURL, aLocalFileURL, aMoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    }
+                    else
+                    {
+                        anUnableToMoveErrorString = [NSString stringWithFormat:@"ERR: Unable to decode file %@ (%@) (%@, %d)", aTempFileURL, aDecodeError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    }
+                    NSLog(@"%@", anUnableToMoveErrorString);
+                    NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+                    if (anErrorMessagesStackArray == nil)
+                    {
+                        anErrorMessagesStackArray = [NSMutableArray array];
+                    }
+                    [anErrorMessagesStackArray insertObject:anUnableToMoveErrorString atIndex:0];
+                    [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+                    
+                    __weak HWIFileDownloader *anotherWeakSelf = strongSelf;
+                    dispatch_async(aDownloaderDispatchQueue, ^{
+                        HWIFileDownloader *anotherStrongSelf = anotherWeakSelf;
+                        if ([self isDownloadingIdentifier:aDownloadItem.downloadToken]) // check for meanwhile cancelled download
+                        {
+                            [anotherStrongSelf handleDownloadWithError:aMoveError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+                        }
+                    });
+                }
+                else
+                {
+                    __weak HWIFileDownloader *anotherWeakSelf = strongSelf;
                     
-                    NSError *aMoveError = nil;
-                    BOOL aMoveSuccessFlag = [[NSFileManager defaultManager] moveItemAtURL:aTempFileURL toURL:aLocalFileURL error:&aMoveError];
-                    if (aMoveSuccessFlag == NO)
+                    dispatch_async(aDownloaderDispatchQueue, ^{
+                        
+                        HWIFileDownloader *anotherStrongSelf = anotherWeakSelf;
+                        
+                        if ([self isDownloadingIdentifier:aDownloadItem.downloadToken] == NO)
+                        {
+                            // download has been cancelled meanwhile
+                            NSError *aRemoveError = nil;
+                            BOOL aRemoveSuccessFlag = [[NSFileManager defaultManager] removeItemAtURL:aLocalFileURL error:&aRemoveError];
+                            if (aRemoveSuccessFlag == NO)
+                            {
+                                NSLog(@"ERR: Unable to remove file at %@ (%@) (%@, %d)", aLocalFileURL, aRemoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                            }
+                        }
+                        else
+                        {
+                            
+                            // the size has been taken on moving the file
+                            if (aFileSize == 0)
+                            {
+                                NSError *aFileSizeZeroError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorZeroByteResource userInfo:nil];
+                                NSString *aFileSizeZeroErrorString = [NSString stringWithFormat:@"ERR: Zero file size for item at %@: %@ (%@, %d)", aLocalFileURL, aFileSizeZeroError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                                NSLog(@"%@", aFileSizeZeroErrorString);
+                                NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+                                if (anErrorMessagesStackArray == nil)
+                                {
+                                    anErrorMessagesStackArray = [NSMutableArray array];
+                                }
+                                [anErrorMessagesStackArray insertObject:aFileSizeZeroErrorString atIndex:0];
+                                [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+                                
+                                [anotherStrongSelf handleDownloadWithError:aFileSizeZeroError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+                            }
+                            else
+                            {
+                                aDownloadItem.finalLocalFileURL = aLocalFileURL;
+                                [anotherStrongSelf verifyDigestOfDownloadToLocalFileURL:aLocalFileURL
+                                                                           downloadItem:aDownloadItem
+                                                                             downloadID:[aDownloadID unsignedIntegerValue]];
+                            }
+                        }
+                    });
+                }
+                
+            });
+            
+        }
+        else
+        {
+            NSString *aMissingURLErrorString = [NSString stringWithFormat:@"ERR: Missing information: Local file URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            NSLog(@"%@", aMissingURLErrorString);
+            NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+            if (anErrorMessagesStackArray == nil)
+            {
+                anErrorMessagesStackArray = [NSMutableArray array];
+            }
+            [anErrorMessagesStackArray insertObject:aMissingURLErrorString atIndex:0];
+            [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+            NSError *aMissingURLError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorUnsupportedURL userInfo:nil];
+            [self handleDownloadWithError:aMissingURLError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+        }
+    }
+    else
+    {
+        NSLog(@"ERR: No download item found on transfer finish (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+
+    }
+}
+
+
+- (BOOL)isValidHttpStatusCodeOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    BOOL aHttpStatusCodeIsCorrectFlag = NO;
+    NSInteger aHttpStatusCode = aDownloadItem.lastHttpStatusCode;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(httpStatusCode:isValidForDownloadIdentifier:)])
+    {
+        aHttpStatusCodeIsCorrectFlag = [self.fileDownloadDelegate httpStatusCode:aHttpStatusCode isValidForDownloadIdentifier:aDownloadItem.downloadToken];
+    }
+    else
+    {
+        aHttpStatusCodeIsCorrectFlag = [HWIFileDownloader httpStatusCode:aHttpStatusCode isValidForDownloadIdentifier:aDownloadItem.downloadToken];
+    }
+    return aHttpStatusCodeIsCorrectFlag;
+}
+
+
+- (void)handleInvalidHttpStatusCodeOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID failingURL:(nullable NSURL *)aFailingURL
+{
+    NSString *anErrorString = [NSString stringWithFormat:@"Invalid http status code: %@", @(aDownloadItem.lastHttpStatusCode)];
+    NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+    if (anErrorMessagesStackArray == nil)
+    {
+        anErrorMessagesStackArray = [NSMutableArray array];
+    }
+    [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
+    [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+    
+    NSDictionary *anErrorUserInfoDict = nil;
+    if (aFailingURL.absoluteString)
+    {
+        anErrorUserInfoDict = @{NSURLErrorFailingURLStringErrorKey: aFailingURL.absoluteString, NSURLErrorFailingURLErrorKey: aFailingURL};
+    }
+    NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:anErrorUserInfoDict];
+    [self handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+}
+
+
++ (BOOL)getRangeStart:(nonnull int64_t *)aRangeStart totalLength:(nonnull int64_t *)aTotalLength ofContentRangeHeader:(nullable NSString *)aContentRangeString
+{
+    // bytes start-end/total (total may be *)
+    BOOL aParsedFlag = NO;
+    if ([aContentRangeString hasPrefix:@"bytes "])
+    {
+        NSScanner *aScanner = [NSScanner scannerWithString:[aContentRangeString substringFromIndex:6]];
+        long long aScannedStart = 0;
+        long long aScannedEnd = 0;
+        if ([aScanner scanLongLong:&aScannedStart] && [aScanner scanString:@"-" intoString:NULL]
+            && [aScanner scanLongLong:&aScannedEnd] && [aScanner scanString:@"/" intoString:NULL]
+            && (aScannedStart >= 0) && (aScannedEnd >= aScannedStart))
+        {
+            long long aScannedTotal = -1;
+            if ([aScanner scanLongLong:&aScannedTotal] == NO)
+            {
+                aScannedTotal = -1;
+            }
+            *aRangeStart = aScannedStart;
+            *aTotalLength = aScannedTotal;
+            aParsedFlag = YES;
+        }
+    }
+    return aParsedFlag;
+}
+
+
+- (void)handleResponse:(nonnull NSURLResponse *)aResponse ofTransferWithDownloadID:(nonnull NSNumber *)aFoundDownloadID
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aFoundDownloadID];
+    if (aDownloadItem)
+    {
+        if (aDownloadItem.downloadStartDate == nil)
+        {
+            aDownloadItem.downloadStartDate = [NSDate date];
+        }
+        long long anExpectedContentLength = [aResponse expectedContentLength];
+        if (anExpectedContentLength > 0)
+        {
+            aDownloadItem.expectedFileSizeInBytes = anExpectedContentLength;
+        }
+        NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aResponse;
+        aDownloadItem.lastHttpStatusCode = aHttpResponse.statusCode;
+        if ([aHttpResponse isKindOfClass:[NSHTTPURLResponse class]])
+        {
+            aDownloadItem.responseETag = [aHttpResponse.allHeaderFields objectForKey:@"ETag"];
+            aDownloadItem.responseLastModified = [aHttpResponse.allHeaderFields objectForKey:@"Last-Modified"];
+        }
+        [aDownloadItem.stream deliverResponse:aResponse];
+        if (aDownloadItem.resumedFileSizeInBytes > 0)
+        {
+            int64_t aRangeStart = -1;
+            int64_t aTotalLength = -1;
+            BOOL aPartialContentFlag = [aHttpResponse isKindOfClass:[NSHTTPURLResponse class]] && (aHttpResponse.statusCode == 206);
+            if (aPartialContentFlag)
+            {
+                [HWIFileDownloader getRangeStart:&aRangeStart totalLength:&aTotalLength ofContentRangeHeader:[aHttpResponse.allHeaderFields objectForKey:@"Content-Range"]];
+            }
+            if (aPartialContentFlag && (aRangeStart == aDownloadItem.resumedFileSizeInBytes))
+            {
+                if (aTotalLength > 0)
+                {
+                    aDownloadItem.expectedFileSizeInBytes = aTotalLength;
+                }
+                else if (anExpectedContentLength > 0)
+                {
+                    aDownloadItem.expectedFileSizeInBytes = aDownloadItem.resumedFileSizeInBytes + anExpectedContentLength;
+                }
+                if (aDownloadItem.retriesCount > 0)
+                {
+                    self.retryResumedBytesCount += aDownloadItem.resumedFileSizeInBytes;
+                }
+            }
+            else if ((aPartialContentFlag == NO) || (aRangeStart == 0))
+            {
+                // the range has been ignored, the partial file is replaced
+                if (aTotalLength > 0)
+                {
+                    aDownloadItem.expectedFileSizeInBytes = aTotalLength;
+                }
+                aDownloadItem.resumedFileSizeInBytes = 0;
+                aDownloadItem.receivedFileSizeInBytes = 0;
+                HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+                dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                    aFileWriter.appendsToExistingFile = NO;
+                });
+            }
+            else
+            {
+                // another range (or none) has been served; its data fits neither the partial file nor a new one
+                NSString *anErrorString = [NSString stringWithFormat:@"Invalid content range: %@ (expected offset: %@)", [aHttpResponse.allHeaderFields objectForKey:@"Content-Range"], @(aDownloadItem.resumedFileSizeInBytes)];
+                NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+                if (anErrorMessagesStackArray == nil)
+                {
+                    anErrorMessagesStackArray = [NSMutableArray array];
+                }
+                [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
+                [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+                NSError *aRangeError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil];
+                [self cancelDataTransferWithDownloadID:[aFoundDownloadID unsignedIntegerValue] error:aRangeError];
+                aDownloadItem = nil;
+            }
+        }
+        int64_t aRemainingFileSize = aDownloadItem.expectedFileSizeInBytes - aDownloadItem.resumedFileSizeInBytes;
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+        if (aFileWriter && (aDownloadItem.transform == nil) && (anExpectedContentLength > 0) && (aRemainingFileSize > 0))
+        {
+            // the file is opened with the first data, which is written after this on the same queue
+            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                aFileWriter.preallocationLength = aRemainingFileSize;
+            });
+        }
+    }
+}
+
+
+- (void)handleReceivedData:(nonnull NSData *)aData ofTransferWithDownloadID:(nonnull NSNumber *)aFoundDownloadID
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aFoundDownloadID];
+    if (aDownloadItem)
+    {
+        if (aDownloadItem.downloadStartDate == nil)
+        {
+            aDownloadItem.downloadStartDate = [NSDate date];
+        }
+        int64_t anUntilNowReceivedContentSize = aDownloadItem.receivedFileSizeInBytes;
+        int64_t aCompleteReceivedContentSize = anUntilNowReceivedContentSize + [aData length];
+        aDownloadItem.receivedFileSizeInBytes = aCompleteReceivedContentSize;
+        
+        [self notifyProgressChangedForDownloadItem:aDownloadItem];
+        [self recordReceivedBytes:(int64_t)aData.length ofDownloadItem:aDownloadItem];
+        [self throttleDownloadItem:aDownloadItem downloadID:[aFoundDownloadID unsignedIntegerValue] afterReceivingBytes:(int64_t)aData.length];
+        if (aDownloadItem.stream)
+        {
+            [self streamData:aData ofDownloadItem:aDownloadItem];
+        }
+        
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+        if (aFileWriter)
+        {
+            int64_t aBytesCount = (int64_t)aData.length;
+            HWIFileDownloadWriteBudget *aWriteBudget = self.writeBudget;
+            if ([aWriteBudget reserveBytesCount:aBytesCount])
+            {
+                [self holdTransfersForWriter];
+            }
+            else if (aWriteBudget.isExhausted && (aDownloadItem.isWaitingForWriter == NO))
+            {
+                // started while the writer is behind
+                [self holdTransfersOfDownloadItem:aDownloadItem];
+            }
+            HWIFileDownloadDigest *aDigest = aDownloadItem.digest;
+            id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+            dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+            __weak HWIFileDownloader *weakSelf = self;
+            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                if (aTransform)
+                {
+                    // a failure is reported when the transfer has finished
+                    [aTransform transformData:aData error:NULL];
+                }
+                else if (aDownloadItem.fileWriteError == nil)
+                {
+                    // the download fails with the first write error when the transfer has finished
+                    NSError *aWriteError = nil;
+                    BOOL aWriteSuccessFlag = [aFileWriter appendData:aData error:&aWriteError];
+                    if (aWriteSuccessFlag == NO)
+                    {
+                        NSLog(@"ERR: Unable to write to file %@: %@ (%@, %d)", aFileWriter.fileURL, aWriteError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                        aDownloadItem.fileWriteError = aWriteError;
+                    }
+                }
+                [aDigest updateWithData:aData];
+                if ([aWriteBudget releaseBytesCount:aBytesCount])
+                {
+                    dispatch_async(aDownloaderDispatchQueue, ^{
+                        HWIFileDownloader *strongSelf = weakSelf;
+                        [strongSelf resumeTransfersWaitingForWriter];
+                    });
+                }
+            });
+        }
+    }
+}
+
+
+- (void)handleFailedTransferWithError:(nonnull NSError *)anError downloadID:(nonnull NSNumber *)aDownloadID
+{
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
+    if (aDownloadItem)
+    {
+        NSLog(@"ERR: Transfer failed with error: %@ (%@, %d)", anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        HWIFileDownloadFileWriter *aFileWriter = aDownloadItem.fileWriter;
+        id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            [self closeFileWriter:aFileWriter];
+            if (aTransform)
+            {
+                // decoded downloads are not continued from a partial file
+                [self finishTransform:aTransform error:NULL];
+                [[NSFileManager defaultManager] removeItemAtURL:aTransform.outputURL error:NULL];
+            }
+        });
+        [self handleDownloadWithError:anError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+    }
+}
+
+
+#pragma mark - HWIFileDownloadTransportDelegate
+
+
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didReceiveResponse:(nonnull NSURLResponse *)aResponse
+{
+    [self handleResponse:aResponse ofTransferWithDownloadID:@(aTransferID)];
+}
+
+
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didReceiveData:(nonnull NSData *)aData
+{
+    [self handleReceivedData:aData ofTransferWithDownloadID:@(aTransferID)];
+}
+
+
+- (void)transport:(nonnull id<HWIFileDownloadTransport>)aTransport transferWithIdentifier:(NSUInteger)aTransferID didCompleteWithError:(nullable NSError *)anError
+{
+    if (anError)
+    {
+        [self handleFailedTransferWithError:anError downloadID:@(aTransferID)];
+    }
+    else
+    {
+        [self handleFinishedTransferWithDownloadID:@(aTransferID)];
+    }
+}
+
+
+#pragma mark - HWIFileDownloadDelegate Defaults
+
+
++ (nullable NSURL *)localFileURLForRemoteURL:(nonnull NSURL *)aRemoteURL
+{
+    NSURL *aLocalFileURL = nil;
+    NSURL *aFileDownloadDirectoryURL = nil;
+    NSError *anError = nil;
+    NSArray *aDocumentDirectoryURLsArray = [[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask];
+    NSURL *aDocumentsDirectoryURL = [aDocumentDirectoryURLsArray firstObject];
+    if (aDocumentsDirectoryURL)
+    {
+        aFileDownloadDirectoryURL = [aDocumentsDirectoryURL URLByAppendingPathComponent:@"file-download" isDirectory:YES];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:aFileDownloadDirectoryURL.path] == NO)
+        {
+            BOOL aCreateDirectorySuccess = [[NSFileManager defaultManager] createDirectoryAtPath:aFileDownloadDirectoryURL.path withIntermediateDirectories:YES attributes:nil error:&anError];
+            if (aCreateDirectorySuccess == NO)
+            {
+                NSLog(@"ERR on create directory: %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            }
+            else
+            {
+                BOOL aSetResourceValueSuccess = [aFileDownloadDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:&anError];
+                if (aSetResourceValueSuccess == NO)
+                {
+                    NSLog(@"ERR on set resource value (NSURLIsExcludedFromBackupKey): %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                }
+            }
+        }
+        NSString *aLocalFileName = [NSString stringWithFormat:@"%@.%@", [[NSUUID UUID] UUIDString], [[aRemoteURL lastPathComponent] pathExtension]];
+        aLocalFileURL = [aFileDownloadDirectoryURL URLByAppendingPathComponent:aLocalFileName isDirectory:NO];
+    }
+    return aLocalFileURL;
+}
+
+
++ (BOOL)httpStatusCode:(NSInteger)aHttpStatusCode isValidForDownloadIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    BOOL anIsCorrectFlag = NO;
+    if ((aHttpStatusCode >= 200) && (aHttpStatusCode < 300))
+    {
+        anIsCorrectFlag = YES;
+    }
+    return anIsCorrectFlag;
+}
+
+
+#pragma mark - Download Finalization
+
+
+- (nullable NSURL *)moveDownloadedFileAtURL:(nonnull NSURL *)aDownloadedFileURL
+              toLocalFileURLForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                                  remoteURL:(nullable NSURL *)aRemoteURL
+{
+    // move download item to final local location
+    NSString *anErrorString = nil;
+    NSURL *aLocalDestinationFileURL = nil;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+    {
+        if (aRemoteURL)
+        {
+            aLocalDestinationFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadItem.downloadToken remoteURL:aRemoteURL];
+        }
+        else
+        {
+            anErrorString = [NSString stringWithFormat:@"ERR: Missing information: Remote URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            NSLog(@"%@", anErrorString);
+        }
+    }
+    else
+    {
+        aLocalDestinationFileURL = [HWIFileDownloader localFileURLForRemoteURL:aRemoteURL];
+    }
+    if (aLocalDestinationFileURL)
+    {
+        // renamed over an existing file, copied only across volumes
+        NSError *anError = nil;
+        int64_t aFileSize = 0;
+        BOOL aSuccessFlag = [HWIFileDownloadFileWriter moveItemAtURL:aDownloadedFileURL toURL:aLocalDestinationFileURL fileSize:&aFileSize error:&anError];
+        if (aSuccessFlag == NO)
+        {
+            NSError *aMoveError = anError;
+            if (aMoveError == nil)
+            {
+                aMoveError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotMoveFile userInfo:nil];
+            }
+            anErrorString = [NSString stringWithFormat:@"ERR: Unable to move file from %@ to %@ (%@) (%@, %d)", aDownloadedFileURL, aLocalDestinationFileURL, aMoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            NSLog(@"%@", anErrorString);
+        }
+        else if (aFileSize == 0)
+        {
+            NSError *aFileSizeZeroError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorZeroByteResource userInfo:nil];
+            anErrorString = [NSString stringWithFormat:@"ERR: Zero file size for item at %@: %@ (%@, %d)", aLocalDestinationFileURL, aFileSizeZeroError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            NSLog(@"%@", anErrorString);
+        }
+    }
+    else
+    {
+        anErrorString = [NSString stringWithFormat:@"ERR: Missing information: Local file URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+        NSLog(@"%@", anErrorString);
+    }
+    if (anErrorString)
+    {
+        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+        if (anErrorMessagesStackArray == nil)
+        {
+            anErrorMessagesStackArray = [NSMutableArray array];
+        }
+        [anErrorMessagesStackArray insertObject:anErrorString atIndex:0];
+        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+        aLocalDestinationFileURL = nil;
+    }
+    return aLocalDestinationFileURL;
+}
+
+
+- (void)verifyDigestOfDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
+                                downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                                  downloadID:(NSUInteger)aDownloadID
+{
+    HWIFileDownloadOptions *anOptions = aDownloadItem.options;
+    if ((anOptions.expectedDigest == nil) || (anOptions.digestAlgorithm == HWIFileDownloadDigestAlgorithmNone))
+    {
+        [self decodeDownloadToLocalFileURL:aLocalFileURL
+                              downloadItem:aDownloadItem
+                                downloadID:aDownloadID];
+    }
+    else
+    {
+        // the digest is finished (NSURLConnection) or computed (NSURLSession) on the file writer queue, after all received data has been written
+        HWIFileDownloadDigest *aDigest = aDownloadItem.digest;
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            NSError *aDigestError = nil;
+            NSData *aComputedDigest = nil;
+            if (aDigest)
+            {
+                aComputedDigest = [aDigest finalDigest];
+            }
+            else
+            {
+                aComputedDigest = [HWIFileDownloadDigest digestOfFileAtURL:aLocalFileURL algorithm:anOptions.digestAlgorithm error:&aDigestError];
+            }
+            dispatch_async(aDownloaderDispatchQueue, ^{
+                HWIFileDownloader *strongSelf = weakSelf;
+                [strongSelf handleComputedDigest:aComputedDigest
+                                           error:aDigestError
+                       ofDownloadToLocalFileURL:aLocalFileURL
+                                    downloadItem:aDownloadItem
+                                      downloadID:aDownloadID];
+            });
+        });
+    }
+}
+
+
+- (void)handleComputedDigest:(nullable NSData *)aComputedDigest
+                       error:(nullable NSError *)aDigestError
+   ofDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
+                downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                  downloadID:(NSUInteger)aDownloadID
+{
+    if ([self.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile cancelled download
+    {
+        NSData *anExpectedDigest = aDownloadItem.options.expectedDigest;
+        if (aComputedDigest && [aComputedDigest isEqualToData:anExpectedDigest])
+        {
+            [self decodeDownloadToLocalFileURL:aLocalFileURL
+                                  downloadItem:aDownloadItem
+                                    downloadID:aDownloadID];
+        }
+        else
+        {
+            NSString *aDigestErrorString = nil;
+            if (aComputedDigest)
+            {
+                aDigestErrorString = [NSString stringWithFormat:@"ERR: Digest mismatch for item at %@ (expected: %@, computed: %@) (%@, %d)", aLocalFileURL, [HWIFileDownloadDigest hexStringWithDigest:anExpectedDigest], [HWIFileDownloadDigest hexStringWithDigest:aComputedDigest], [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            }
+            else
+            {
+                aDigestErrorString = [NSString stringWithFormat:@"ERR: Unable to compute digest for item at %@: %@ (%@, %d)", aLocalFileURL, aDigestError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+            }
+            NSLog(@"%@", aDigestErrorString);
+            NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+            if (anErrorMessagesStackArray == nil)
+            {
+                anErrorMessagesStackArray = [NSMutableArray array];
+            }
+            [anErrorMessagesStackArray insertObject:aDigestErrorString atIndex:0];
+            [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+            
+            NSError *aVerificationError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeRawData userInfo:nil];
+            [self handleDownloadWithError:aVerificationError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+        }
+    }
+}
+
+
+- (void)validateDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
+                          downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                            downloadID:(NSUInteger)aDownloadID
+{
+    // the delegate checks the final (decoded) file on all transports
+    BOOL anIsValidDownloadFlag = YES;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadAtLocalFileURL:isValidForDownloadIdentifier:)])
+    {
+        anIsValidDownloadFlag = [self.fileDownloadDelegate downloadAtLocalFileURL:aLocalFileURL isValidForDownloadIdentifier:aDownloadItem.downloadToken];
+    }
+    if (anIsValidDownloadFlag)
+    {
+        [self handleSuccessfulDownloadToLocalFileURL:aLocalFileURL
+                                        downloadItem:aDownloadItem
+                                          downloadID:aDownloadID];
+    }
+    else
+    {
+        NSError *aValidationError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeRawData userInfo:nil];
+        NSString *aValidationErrorString = [NSString stringWithFormat:@"WARN: Download check failed for item at %@: %@ (%@, %d)", aLocalFileURL, aValidationError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+        NSLog(@"%@", aValidationErrorString);
+        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+        if (anErrorMessagesStackArray == nil)
+        {
+            anErrorMessagesStackArray = [NSMutableArray array];
+        }
+        [anErrorMessagesStackArray insertObject:aValidationErrorString atIndex:0];
+        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+        [self handleDownloadWithError:aValidationError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+    }
+}
+
+
+#pragma mark - Download Completion Handler
+
+
+- (void)handleSuccessfulDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
+                                  downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                                    downloadID:(NSUInteger)aDownloadID
+{
+    aDownloadItem.progress.completedUnitCount = aDownloadItem.progress.totalUnitCount;
+    [self.progressCoalescer removeDownloadToken:aDownloadItem.downloadToken];
+    [self.bandwidthThrottle removeDownloadToken:aDownloadItem.downloadToken];
+    [self removeActiveDownloadItemWithDownloadID:aDownloadID];
+    self.completedDownloadsCount++;
+    [aDownloadItem.stream finishWithError:nil];
+    [self storeDownloadedFileAtURL:aLocalFileURL ofDownloadItem:aDownloadItem];
+    NSString *aDownloadToken = aDownloadItem.downloadToken;
+    [self.queueJournal recordEvent:HWIFileDownloadJournalEventComplete ofDownloadToken:aDownloadToken];
+    [self scheduleQueueJournalFlush];
+    BOOL anIsDetachedFlag = [self.deduplicator isDetachedPrimaryDownloadToken:aDownloadToken];
+    NSArray<NSURL *> *anExtractedFileURLsArray = nil;
+    if (anIsDetachedFlag == NO)
+    {
+        anExtractedFileURLsArray = [HWIFileDownloader extractedFileURLsOfDownloadItem:aDownloadItem localFileURL:aLocalFileURL];
+        [self finishMetricsOfDownloadItem:aDownloadItem];
+    }
+    [self completeCoalescedDownloadsOfDownloadItem:aDownloadItem withDownloadedFileAtURL:aLocalFileURL completionBlock:^{
+        if (anIsDetachedFlag == NO)
+        {
+            [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                [aDelegate decrementNetworkActivityIndicatorActivityCount];
+                
+                if (anExtractedFileURLsArray && [aDelegate respondsToSelector:@selector(downloadDidExtractFilesWithIdentifier:fileURLs:)])
+                {
+                    [aDelegate downloadDidExtractFilesWithIdentifier:aDownloadToken fileURLs:anExtractedFileURLsArray];
+                }
+                [aDelegate downloadDidCompleteWithIdentifier:aDownloadToken
+                                                localFileURL:aLocalFileURL];
+            }];
+        }
+    }];
+    [self startNextWaitingDownload];
+}
+
+
+- (void)handleDownloadWithError:(nonnull NSError *)anError
+                   downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                     downloadID:(NSUInteger)aDownloadID
+                     resumeData:(nullable NSData *)aResumeData
+{
+    if ([self retryDownloadItem:aDownloadItem downloadID:aDownloadID afterError:anError resumeData:aResumeData])
+    {
+        return;
+    }
+    BOOL anIsCancelledFlag = ([anError.domain isEqualToString:NSURLErrorDomain] && (anError.code == NSURLErrorCancelled));
+    if (aDownloadItem.isSegmented)
+    {
+        // only a pause keeps the segmented file for its resume data
+        if (anIsCancelledFlag == NO)
+        {
+            aResumeData = nil;
+        }
+        [self cancelSegmentsOfDownloadItem:aDownloadItem keepsSegmentedFile:(aResumeData != nil)];
+    }
+    aDownloadItem.progress.completedUnitCount = aDownloadItem.progress.totalUnitCount;
+    [self.progressCoalescer removeDownloadToken:aDownloadItem.downloadToken];
+    [self.bandwidthThrottle removeDownloadToken:aDownloadItem.downloadToken];
+    [self removeActiveDownloadItemWithDownloadID:aDownloadID];
+    self.failedDownloadsCount++;
+    [aDownloadItem.stream finishWithError:anError];
+    NSString *aDownloadToken = aDownloadItem.downloadToken;
+    [self.queueJournal recordEvent:(anIsCancelledFlag ? HWIFileDownloadJournalEventCancel : HWIFileDownloadJournalEventFail) ofDownloadToken:aDownloadToken];
+    [self scheduleQueueJournalFlush];
+    NSInteger aLastHttpStatusCode = aDownloadItem.lastHttpStatusCode;
+    NSArray<NSString *> *anErrorMessagesStack = aDownloadItem.errorMessagesStack;
+    BOOL anIsDetachedFlag = [self.deduplicator isDetachedPrimaryDownloadToken:aDownloadToken];
+    [self finishCoalescedDownloadsOfDownloadToken:aDownloadToken withError:anError httpStatusCode:aLastHttpStatusCode errorMessagesStack:anErrorMessagesStack];
+    if (anIsDetachedFlag == NO)
+    {
+        [self finishMetricsOfDownloadItem:aDownloadItem];
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+            
+            [aDelegate downloadFailedWithIdentifier:aDownloadToken
+                                              error:anError
+                                     httpStatusCode:aLastHttpStatusCode
+                                 errorMessagesStack:anErrorMessagesStack
+                                         resumeData:aResumeData];
+        }];
+    }
+    [self startNextWaitingDownload];
+}
+
+
+#pragma mark - Retry
+
+
+- (BOOL)retryDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+               downloadID:(NSUInteger)aDownloadID
+               afterError:(nonnull NSError *)anError
+               resumeData:(nullable NSData *)aResumeData
+{
+    HWIFileDownloadRetryPolicy *aRetryPolicy = aDownloadItem.options.retryPolicy;
+    NSString *aDownloadToken = aDownloadItem.downloadToken;
+    if ((aRetryPolicy == nil)
+        || (aDownloadItem.retriesCount >= aRetryPolicy.maximumRetriesCount)
+        || ((aResumeData == nil) && (aDownloadItem.remoteURL == nil))
+        || aDownloadItem.stream
+        || [self.deduplicator isDetachedPrimaryDownloadToken:aDownloadToken]
+        || ([aRetryPolicy shouldRetryAfterError:anError httpStatusCode:aDownloadItem.lastHttpStatusCode] == NO))
+    {
+        return NO;
+    }
+    
+    NSURL *aResumeDataFileURL = nil;
+    int64_t aPartialFileSize = 0;
+    if (aResumeData)
+    {
+        aResumeDataFileURL = [self.resumeDataStore storeResumeData:aResumeData];
+    }
+    else if (aDownloadItem.fileWriter && (aDownloadItem.digest == nil) && (aDownloadItem.cacheEntry == nil) && (aDownloadItem.transform == nil)
+             && ((aDownloadItem.lastHttpStatusCode == 200) || (aDownloadItem.lastHttpStatusCode == 206))
+             && ([anError.domain isEqualToString:NSURLErrorDomain] && (anError.code != NSURLErrorBadServerResponse)))
+    {
+        // the temporary file holds the received bytes of the interrupted response; counted when the range is accepted
+        aPartialFileSize = aDownloadItem.receivedFileSizeInBytes;
+    }
+    
+    if (aDownloadItem.isSegmented)
+    {
+        // the restart continues the received ranges of the resume data, also after relaunch
+        [self cancelSegmentsOfDownloadItem:aDownloadItem keepsSegmentedFile:(aResumeData != nil)];
+    }
+    // the progress keeps its unit of the root progress for the restart, the throttle keeps the limit of the download
+    [self.progressCoalescer removeDownloadToken:aDownloadToken];
+    [self removeActiveDownloadItemWithDownloadID:aDownloadID];
+    [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+        [aDelegate decrementNetworkActivityIndicatorActivityCount];
+    }];
+    
+    HWIFileDownloadWaitingItem *aWaitingItem = [[HWIFileDownloadWaitingItem alloc] initWithDownloadToken:aDownloadToken
+                                                                                                remoteURL:(aResumeDataFileURL ? nil : aDownloadItem.remoteURL)
+                                                                                        resumeDataFileURL:aResumeDataFileURL
+                                                                                                  options:aDownloadItem.options];
+    aWaitingItem.retriesCount = aDownloadItem.retriesCount + 1;
+    aWaitingItem.partialFileSize = aPartialFileSize;
+    aWaitingItem.progress = aDownloadItem.progress;
+    // restored as waiting after relaunch
+    [self.queueJournal recordRetry:aWaitingItem.retriesCount resumeDataFileName:aResumeDataFileURL.lastPathComponent partialFileSize:aPartialFileSize ofDownloadToken:aDownloadToken];
+    [self scheduleQueueJournalFlush];
+    self.retriesCount++;
+    [self.backingOffWaitingItemsDictionary setObject:aWaitingItem forKey:aDownloadToken];
+    NSTimeInterval aBackoffInterval = [aRetryPolicy backoffIntervalForRetryNumber:aWaitingItem.retriesCount];
+    NSLog(@"INFO: Retry %@ of download %@ in %.1f s after error: %@ (%@, %d)", @(aWaitingItem.retriesCount), aDownloadToken, aBackoffInterval, anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    __weak HWIFileDownloader *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(aBackoffInterval * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+        HWIFileDownloader *strongSelf = weakSelf;
+        // the download might have been cancelled or paused meanwhile
+        if ([strongSelf.backingOffWaitingItemsDictionary objectForKey:aDownloadToken] == aWaitingItem)
+        {
+            [strongSelf.backingOffWaitingItemsDictionary removeObjectForKey:aDownloadToken];
+            [strongSelf.waitingDownloadsQueue enqueueWaitingItem:aWaitingItem];
+            [strongSelf startWaitingDownloadsInFreeSlots];
+        }
+    });
+    [self startNextWaitingDownload];
+    return YES;
+}
+
+
+#pragma mark - Coalesced Downloads
+
+
+- (void)setCoalescesDownloadsWithSameRemoteURL:(BOOL)aCoalescesDownloadsWithSameRemoteURLFlag
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _coalescesDownloadsWithSameRemoteURL = aCoalescesDownloadsWithSameRemoteURLFlag;
+    }];
+}
+
+
+- (NSUInteger)coalescedRequestsCount
+{
+    __block NSUInteger aSavedRequestsCount = 0;
+    [self performOnDownloaderQueueAndWait:^{
+        aSavedRequestsCount = self.deduplicator.savedRequestsCount;
+    }];
+    return aSavedRequestsCount;
+}
+
+
+- (int64_t)coalescedBytesCount
+{
+    __block int64_t aSavedBytesCount = 0;
+    [self performOnDownloaderQueueAndWait:^{
+        aSavedBytesCount = self.deduplicator.savedBytesCount;
+    }];
+    return aSavedBytesCount;
+}
+
+
+- (nullable NSString *)transferDownloadTokenForDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    // attached downloads share the transfer of their primary download; a detached primary download has no transfer anymore
+    NSString *aTransferDownloadToken = [self.deduplicator primaryDownloadTokenForAttachedDownloadToken:aDownloadToken];
+    if (aTransferDownloadToken == nil)
+    {
+        if ([self.deduplicator isDetachedPrimaryDownloadToken:aDownloadToken] == NO)
+        {
+            aTransferDownloadToken = aDownloadToken;
+        }
+    }
+    return aTransferDownloadToken;
+}
+
+
+- (nonnull NSArray<NSString *> *)receivingDownloadTokensForDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+{
+    NSMutableArray<NSString *> *aDownloadTokensArray = [NSMutableArray array];
+    if ([self.deduplicator isDetachedPrimaryDownloadToken:aPrimaryDownloadToken] == NO)
+    {
+        [aDownloadTokensArray addObject:aPrimaryDownloadToken];
+    }
+    [aDownloadTokensArray addObjectsFromArray:[self.deduplicator attachedDownloadTokensForPrimaryDownloadToken:aPrimaryDownloadToken]];
+    return aDownloadTokensArray;
+}
+
+
+- (BOOL)detachCoalescedDownloadWithDownloadToken:(nonnull NSString *)aDownloadToken
+{
+    BOOL aDetachedFlag = NO;
+    BOOL aNotifyFlag = NO;
+    NSString *aPrimaryDownloadToken = [self.deduplicator primaryDownloadTokenForAttachedDownloadToken:aDownloadToken];
+    if (aPrimaryDownloadToken)
+    {
+        [self.deduplicator detachDownloadToken:aDownloadToken];
+        aDetachedFlag = YES;
+        aNotifyFlag = YES;
+    }
+    else if ([self.deduplicator isDetachedPrimaryDownloadToken:aDownloadToken])
+    {
+        // already cancelled
+        aPrimaryDownloadToken = aDownloadToken;
+        aDetachedFlag = YES;
+    }
+    else if ([self.deduplicator attachedDownloadTokensForPrimaryDownloadToken:aDownloadToken].count > 0)
+    {
+        // the transfer continues for the attached downloads
+        [self.deduplicator detachPrimaryDownloadToken:aDownloadToken];
+        aPrimaryDownloadToken = aDownloadToken;
+        aDetachedFlag = YES;
+        aNotifyFlag = YES;
+    }
+    if (aNotifyFlag)
+    {
+        [self.progressCoalescer removeDownloadToken:aDownloadToken];
+        NSError *aCancelledError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+            
+            [aDelegate downloadFailedWithIdentifier:aDownloadToken
+                                              error:aCancelledError
+                                     httpStatusCode:0
+                                 errorMessagesStack:nil
+                                         resumeData:nil];
+        }];
+    }
+    if (aDetachedFlag && [self.deduplicator isDetachedPrimaryDownloadToken:aPrimaryDownloadToken] && ([self.deduplicator attachedDownloadTokensForPrimaryDownloadToken:aPrimaryDownloadToken].count == 0))
+    {
+        // nobody waits for the transfer anymore
+        NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aPrimaryDownloadToken];
+        if (aDownloadID > -1)
+        {
+            [self cancelDownloadWithDownloadID:aDownloadID];
+        }
+        else if ([self removeWaitingItemForDownloadToken:aPrimaryDownloadToken])
+        {
+            [self.deduplicator removePrimaryDownloadToken:aPrimaryDownloadToken];
+        }
+    }
+    return aDetachedFlag;
+}
+
+
+- (void)completeCoalescedDownloadsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                         withDownloadedFileAtURL:(nonnull NSURL *)aLocalFileURL
+                                 completionBlock:(nonnull void (^)(void))aCompletionBlock
+{
+    BOOL anIsDetachedFlag = [self.deduplicator isDetachedPrimaryDownloadToken:aDownloadItem.downloadToken];
+    NSArray<NSString *> *anAttachedDownloadTokensArray = [self.deduplicator removePrimaryDownloadToken:aDownloadItem.downloadToken];
+    BOOL anIsFileInUseFlag = (anIsDetachedFlag == NO);
+    NSURL *aRemoteURL = aDownloadItem.remoteURL;
+    if (aRemoteURL == nil)
+    {
+        anAttachedDownloadTokensArray = @[];
+    }
+    NSMutableDictionary<NSString *, NSURL *> *anAttachedLocalFileURLsDict = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSURL *> *aLinkedFileURLsDict = [NSMutableDictionary dictionary];
+    for (NSString *anAttachedDownloadToken in anAttachedDownloadTokensArray)
+    {
+        // each attached download gets its own file without another request
+        NSURL *anAttachedLocalFileURL = nil;
+        if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+        {
+            anAttachedLocalFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:anAttachedDownloadToken remoteURL:aRemoteURL];
+        }
+        else
+        {
+            anAttachedLocalFileURL = [HWIFileDownloader localFileURLForRemoteURL:aRemoteURL];
+        }
+        if (anAttachedLocalFileURL)
+        {
+            [anAttachedLocalFileURLsDict setObject:anAttachedLocalFileURL forKey:anAttachedDownloadToken];
+            if ([anAttachedLocalFileURL.URLByStandardizingPath.path isEqualToString:aLocalFileURL.URLByStandardizingPath.path])
+            {
+                anIsFileInUseFlag = YES;
+            }
+            else
+            {
+                [aLinkedFileURLsDict setObject:anAttachedLocalFileURL forKey:anAttachedDownloadToken];
+            }
+        }
+    }
+    if ((anAttachedDownloadTokensArray.count == 0) && anIsFileInUseFlag)
+    {
+        aCompletionBlock();
+    }
+    else
+    {
+        // linked (or copied across volumes) on the file writer queue; the primary download completes afterwards, as its delegate may move the file
+        NSInteger aLastHttpStatusCode = aDownloadItem.lastHttpStatusCode;
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            __block int64_t aFileSize = 0;
+            if (aLinkedFileURLsDict.count < anAttachedLocalFileURLsDict.count)
+            {
+                aFileSize = (int64_t)[[[NSFileManager defaultManager] attributesOfItemAtPath:aLocalFileURL.path error:NULL] fileSize];
+            }
+            NSMutableDictionary<NSString *, NSError *> *aLinkErrorsDict = [NSMutableDictionary dictionary];
+            [aLinkedFileURLsDict enumerateKeysAndObjectsUsingBlock:^(NSString *anAttachedDownloadToken, NSURL *anAttachedLocalFileURL, BOOL *aStopFlag) {
+                NSError *aLinkError = nil;
+                int64_t aLinkedFileSize = 0;
+                if ([HWIFileDownloadFileWriter linkItemAtURL:aLocalFileURL toURL:anAttachedLocalFileURL fileSize:&aLinkedFileSize error:&aLinkError])
+                {
+                    aFileSize = aLinkedFileSize;
+                }
+                else
+                {
+                    [aLinkErrorsDict setObject:(aLinkError ? aLinkError : [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotCreateFile userInfo:nil]) forKey:anAttachedDownloadToken];
+                }
+            }];
+            if (anIsFileInUseFlag == NO)
+            {
+                // the primary download has been cancelled meanwhile
+                [[NSFileManager defaultManager] removeItemAtURL:aLocalFileURL error:NULL];
+            }
+            dispatch_async(aDownloaderDispatchQueue, ^{
+                HWIFileDownloader *strongSelf = weakSelf;
+                for (NSString *anAttachedDownloadToken in anAttachedDownloadTokensArray)
+                {
+                    NSURL *anAttachedLocalFileURL = [anAttachedLocalFileURLsDict objectForKey:anAttachedDownloadToken];
+                    NSError *aLinkError = [aLinkErrorsDict objectForKey:anAttachedDownloadToken];
+                    NSString *anErrorString = nil;
+                    if (anAttachedLocalFileURL == nil)
+                    {
+                        anErrorString = [NSString stringWithFormat:@"ERR: Missing information: Local file URL (token: %@) (%@, %d)", anAttachedDownloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    }
+                    else if (aLinkError)
+                    {
+                        anErrorString = [NSString stringWithFormat:@"ERR: Unable to link file from %@ to %@ (%@) (%@, %d)", aLocalFileURL, anAttachedLocalFileURL, aLinkError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    }
+                    [strongSelf.progressCoalescer removeDownloadToken:anAttachedDownloadToken];
+                    if (anErrorString == nil)
+                    {
+                        [strongSelf.deduplicator addSavedBytesCount:aFileSize];
+                        [strongSelf performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+                            
+                            [aDelegate downloadDidCompleteWithIdentifier:anAttachedDownloadToken
+                                                            localFileURL:anAttachedLocalFileURL];
+                        }];
+                    }
+                    else
+                    {
+                        NSLog(@"%@", anErrorString);
+                        NSError *aFinalError = aLinkError;
+                        if (aFinalError == nil)
+                        {
+                            aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotCreateFile userInfo:nil];
+                        }
+                        [strongSelf performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+                            
+                            [aDelegate downloadFailedWithIdentifier:anAttachedDownloadToken
+                                                              error:aFinalError
+                                                     httpStatusCode:aLastHttpStatusCode
+                                                 errorMessagesStack:@[anErrorString]
+                                                         resumeData:nil];
+                        }];
+                    }
+                }
+                aCompletionBlock();
+            });
+        });
+    }
+}
+
+
+- (void)finishCoalescedDownloadsOfDownloadToken:(nonnull NSString *)aPrimaryDownloadToken
+                                      withError:(nonnull NSError *)anError
+                                 httpStatusCode:(NSInteger)aHttpStatusCode
+                             errorMessagesStack:(nullable NSArray<NSString *> *)anErrorMessagesStack
+{
+    NSArray<NSString *> *anAttachedDownloadTokensArray = [self.deduplicator removePrimaryDownloadToken:aPrimaryDownloadToken];
+    for (NSString *anAttachedDownloadToken in anAttachedDownloadTokensArray)
+    {
+        [self.progressCoalescer removeDownloadToken:anAttachedDownloadToken];
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+            
+            [aDelegate downloadFailedWithIdentifier:anAttachedDownloadToken
+                                              error:anError
+                                     httpStatusCode:aHttpStatusCode
+                                 errorMessagesStack:anErrorMessagesStack
+                                         resumeData:nil];
+        }];
+    }
+}
+
+
+#pragma mark - Download Cache
+
+
+- (void)setCache:(nullable HWIFileDownloadCache *)aCache
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _cache = aCache;
+    }];
+}
+
+
+- (BOOL)completeDownloadWithDownloadToken:(nonnull NSString *)aDownloadToken
+                            fromRemoteURL:(nonnull NSURL *)aRemoteURL
+                               cacheEntry:(nonnull HWIFileDownloadCacheEntry *)aCacheEntry
+{
+    BOOL aCompletedFlag = NO;
+    NSURL *aLocalFileURL = nil;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+    {
+        aLocalFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadToken remoteURL:aRemoteURL];
+    }
+    else
+    {
+        aLocalFileURL = [HWIFileDownloader localFileURLForRemoteURL:aRemoteURL];
+    }
+    if (aLocalFileURL)
+    {
+        NSError *aLinkError = nil;
+        aCompletedFlag = [self.cache linkEntry:aCacheEntry toFileURL:aLocalFileURL notModified:NO error:&aLinkError];
+        if (aCompletedFlag)
+        {
+            [self scheduleCacheIndexSave];
+            // a restored waiting download might be completed from the cache
+            [self.queueJournal recordEvent:HWIFileDownloadJournalEventComplete ofDownloadToken:aDownloadToken];
+            [self scheduleQueueJournalFlush];
+            [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                [aDelegate incrementNetworkActivityIndicatorActivityCount];
+                [aDelegate decrementNetworkActivityIndicatorActivityCount];
+                
+                [aDelegate downloadDidCompleteWithIdentifier:aDownloadToken
+                                                localFileURL:aLocalFileURL];
+            }];
+        }
+    }
+    return aCompletedFlag;
+}
+
+
+- (void)completeNotModifiedDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    NSURL *aRemoteURL = aDownloadItem.cacheEntry.remoteURL;
+    NSURL *aLocalFileURL = nil;
+    if ([self.fileDownloadDelegate respondsToSelector:@selector(localFileURLForIdentifier:remoteURL:)])
+    {
+        aLocalFileURL = [self.fileDownloadDelegate localFileURLForIdentifier:aDownloadItem.downloadToken remoteURL:aRemoteURL];
+    }
+    else
+    {
+        aLocalFileURL = [HWIFileDownloader localFileURLForRemoteURL:aRemoteURL];
+    }
+    NSError *aLinkError = nil;
+    if (aLocalFileURL && [self.cache linkEntry:aDownloadItem.cacheEntry toFileURL:aLocalFileURL notModified:YES error:&aLinkError])
+    {
+        [self scheduleCacheIndexSave];
+        aDownloadItem.finalLocalFileURL = aLocalFileURL;
+        [self handleSuccessfulDownloadToLocalFileURL:aLocalFileURL
+                                        downloadItem:aDownloadItem
+                                          downloadID:aDownloadID];
+    }
+    else
+    {
+        NSString *aCacheErrorString = [NSString stringWithFormat:@"ERR: Unable to complete not modified download from cache (token: %@): %@ (%@, %d)", aDownloadItem.downloadToken, aLinkError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+        NSLog(@"%@", aCacheErrorString);
+        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+        if (anErrorMessagesStackArray == nil)
+        {
+            anErrorMessagesStackArray = [NSMutableArray array];
+        }
+        [anErrorMessagesStackArray insertObject:aCacheErrorString atIndex:0];
+        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+        
+        NSError *aCacheError = aLinkError;
+        if (aCacheError == nil)
+        {
+            aCacheError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotOpenFile userInfo:nil];
+        }
+        [self handleDownloadWithError:aCacheError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
+    }
+}
+
+
+- (void)storeDownloadedFileAtURL:(nonnull NSURL *)aLocalFileURL ofDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    HWIFileDownloadCache *aCache = self.cache;
+    NSURL *aRemoteURL = aDownloadItem.remoteURL;
+    if (aCache && aRemoteURL && (aDownloadItem.isSegmented == NO) && (aDownloadItem.isNotModified == NO) && (aDownloadItem.transform == nil) && (aDownloadItem.lastHttpStatusCode == 200))
+    {
+        // staged before the delegate may move the file; hashed on the file writer queue
+        NSURL *aStagedFileURL = [aCache stageFileAtURL:aLocalFileURL];
+        if (aStagedFileURL)
+        {
+            HWIFileDownloadOptions *anOptions = aDownloadItem.options;
+            NSString *aVerifiedDigest = nil;
+            if (anOptions.expectedDigest && (anOptions.digestAlgorithm == HWIFileDownloadDigestAlgorithmSHA256))
+            {
+                aVerifiedDigest = [HWIFileDownloadDigest hexStringWithDigest:anOptions.expectedDigest];
+            }
+            NSString *anETag = aDownloadItem.responseETag;
+            NSString *aLastModified = aDownloadItem.responseLastModified;
+            dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+            __weak HWIFileDownloader *weakSelf = self;
+            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+                NSString *aDigest = aVerifiedDigest;
+                if (aDigest == nil)
+                {
+                    NSError *aDigestError = nil;
+                    NSData *aComputedDigest = [HWIFileDownloadDigest digestOfFileAtURL:aStagedFileURL algorithm:HWIFileDownloadDigestAlgorithmSHA256 error:&aDigestError];
+                    if (aComputedDigest)
                     {
-                        NSString *anUnableToMoveErrorString = [NSString stringWithFormat:@"ERR: Unable to move file from %@ to %@ (%@) (%@, %d)", aTempFileURL, aLocalFileURL, aMoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                        NSLog(@"%@", anUnableToMoveErrorString);
-                        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                        if (anErrorMessagesStackArray == nil)
-                        {
-                            anErrorMessagesStackArray = [NSMutableArray array];
-                        }
-                        [anErrorMessagesStackArray insertObject:anUnableToMoveErrorString atIndex:0];
-                        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                        
-                        __weak HWIFileDownloader *anotherWeakSelf = strongSelf;
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            HWIFileDownloader *anotherStrongSelf = anotherWeakSelf;
-                            if ([self isDownloadingIdentifier:aDownloadItem.downloadToken]) // check for meanwhile cancelled download
-                            {
-                                [anotherStrongSelf handleDownloadWithError:aMoveError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
-                            }
-                        });
+                        aDigest = [HWIFileDownloadDigest hexStringWithDigest:aComputedDigest];
                     }
                     else
                     {
-                        __weak HWIFileDownloader *anotherWeakSelf = strongSelf;
-                        
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            
-                            HWIFileDownloader *anotherStrongSelf = anotherWeakSelf;
-                            
-                            if ([self isDownloadingIdentifier:aDownloadItem.downloadToken] == NO)
-                            {
-                                // download has been cancelled meanwhile
-                                NSError *aRemoveError = nil;
-                                BOOL aRemoveSuccessFlag = [[NSFileManager defaultManager] removeItemAtURL:aLocalFileURL error:&aRemoveError];
-                                if (aRemoveSuccessFlag == NO)
-                                {
-                                    NSLog(@"ERR: Unable to remove file at %@ (%@) (%@, %d)", aLocalFileURL, aRemoveError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-                                }
-                            }
-                            else
-                            {
-                                
-                                NSError *aFileAttributesError = nil;
-                                NSDictionary *aFileAttributesDictionary = [[NSFileManager defaultManager] attributesOfItemAtPath:aLocalFileURL.path error:&aFileAttributesError];
-                                if (aFileAttributesError)
-                                {
-                                    NSString *FileAttributesErrorString = [NSString stringWithFormat:@"ERR: Error on getting file size for item at %@: %@ (%@, %d)", aLocalFileURL, aFileAttributesError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                                    NSLog(@"%@", FileAttributesErrorString);
-                                    NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                                    if (anErrorMessagesStackArray == nil)
-                                    {
-                                        anErrorMessagesStackArray = [NSMutableArray array];
-                                    }
-                                    [anErrorMessagesStackArray insertObject:FileAttributesErrorString atIndex:0];
-                                    [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                                    
-                                    [anotherStrongSelf handleDownloadWithError:aFileAttributesError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
-                                }
-                                else
-                                {
-                                    unsigned long long aFileSize = [aFileAttributesDictionary fileSize];
-                                    if (aFileSize == 0)
-                                    {
-                                        NSError *aFileSizeZeroError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorZeroByteResource userInfo:nil];
-                                        NSString *aFileSizeZeroErrorString = [NSString stringWithFormat:@"ERR: Zero file size for item at %@: %@ (%@, %d)", aLocalFileURL, aFileSizeZeroError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                                        NSLog(@"%@", aFileSizeZeroErrorString);
-                                        NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                                        if (anErrorMessagesStackArray == nil)
-                                        {
-                                            anErrorMessagesStackArray = [NSMutableArray array];
-                                        }
-                                        [anErrorMessagesStackArray insertObject:aFileSizeZeroErrorString atIndex:0];
-                                        [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                                        
-                                        [anotherStrongSelf handleDownloadWithError:aFileSizeZeroError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
-                                    }
-                                    else
-                                    {
-                                        aDownloadItem.finalLocalFileURL = aLocalFileURL;
-                                        if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadAtLocalFileURL:isValidForDownloadIdentifier:)])
-                                        {
-                                            BOOL anIsValidDownloadFlag = [self.fileDownloadDelegate downloadAtLocalFileURL:aLocalFileURL isValidForDownloadIdentifier:aDownloadItem.downloadToken];
-                                            if (anIsValidDownloadFlag)
-                                            {
-                                                [anotherStrongSelf handleSuccessfulDownloadToLocalFileURL:aLocalFileURL
-                                                                                             downloadItem:aDownloadItem
-                                                                                               downloadID:[aDownloadID unsignedIntegerValue]];
-                                            }
-                                            else
-                                            {
-                                                NSError *aValidationError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeRawData userInfo:nil];
-                                                NSString *aValidationErrorString = [NSString stringWithFormat:@"WARN: Download check failed for item at %@: %@ (%@, %d)", aLocalFileURL, aValidationError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                                                NSLog(@"%@", aValidationErrorString);
-                                                NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                                                if (anErrorMessagesStackArray == nil)
-                                                {
-                                                    anErrorMessagesStackArray = [NSMutableArray array];
-                                                }
-                                                [anErrorMessagesStackArray insertObject:aValidationErrorString atIndex:0];
-                                                [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                                                [anotherStrongSelf handleDownloadWithError:aValidationError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
-                                            }
-                                        }
-                                        else
-                                        {
-                                            [anotherStrongSelf handleSuccessfulDownloadToLocalFileURL:aLocalFileURL
-                                                                                         downloadItem:aDownloadItem
-                                                                                           downloadID:[aDownloadID unsignedIntegerValue]];
-                                        }
-                                    }
-                                }
-                            }
-                        });
+                        NSLog(@"ERR: Unable to compute digest for cache of %@: %@ (%@, %d)", aRemoteURL, aDigestError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                    }
+                }
+                if (aDigest)
+                {
+                    [aCache storeStagedFileAtURL:aStagedFileURL digest:aDigest remoteURL:aRemoteURL eTag:anETag lastModified:aLastModified];
+                    dispatch_async(aDownloaderDispatchQueue, ^{
+                        HWIFileDownloader *strongSelf = weakSelf;
+                        [strongSelf scheduleCacheIndexSave];
+                    });
+                }
+                else
+                {
+                    [[NSFileManager defaultManager] removeItemAtURL:aStagedFileURL error:NULL];
+                }
+            });
+        }
+    }
+}
+
+
+- (void)scheduleCacheIndexSave
+{
+    if (self.isCacheIndexSaveScheduled == NO)
+    {
+        self.isCacheIndexSaveScheduled = YES;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(HWIFileDownloaderCacheIndexSaveDelay * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            strongSelf.isCacheIndexSaveScheduled = NO;
+            [strongSelf.cache saveIndexWithError:NULL];
+        });
+    }
+}
+
+
+#pragma mark - Queue Journal
+
+
+- (void)setQueueJournalFileURL:(nullable NSURL *)aQueueJournalFileURL
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _queueJournalFileURL = aQueueJournalFileURL;
+        [self.queueJournal flush];
+        if (aQueueJournalFileURL)
+        {
+            // resume data of waiting downloads survives the app next to the journal
+            self.resumeDataStore = [[HWIFileDownloadResumeDataStore alloc] initWithDirectoryURL:[aQueueJournalFileURL URLByAppendingPathExtension:@"resumedata"]];
+        }
+        self.queueJournal = aQueueJournalFileURL ? [[HWIFileDownloadJournal alloc] initWithFileURL:aQueueJournalFileURL] : nil;
+    }];
+}
+
+
+- (void)restoreWaitingDownloadsFromQueueJournal
+{
+    NSMutableSet<NSString *> *aResumeDataFileNamesSet = [NSMutableSet set];
+    for (HWIFileDownloadJournalEntry *anEntry in [self.queueJournal entries])
+    {
+        NSString *aDownloadToken = anEntry.downloadToken;
+        if ([self downloadIDForActiveDownloadToken:aDownloadToken] > -1)
+        {
+            continue;
+        }
+        BOOL anIsSegmentedFlag = ((anEntry.options.segmentsCount > 1) && anEntry.resumeDataFileName);
+        if (anEntry.isStarted && (self.transportKind == HWIFileDownloaderTransportKindSession) && (anIsSegmentedFlag == NO))
+        {
+            // the session continues or reports started downloads; segmented downloads continue their saved ranges
+            [self.queueJournal recordEvent:HWIFileDownloadJournalEventCancel ofDownloadToken:aDownloadToken];
+            continue;
+        }
+        if ((anEntry.remoteURL == nil) && (anEntry.resumeDataFileName == nil))
+        {
+            NSLog(@"ERR: Journal entry without remote url and resume data: %@ (%@, %d)", aDownloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+            [self.queueJournal recordEvent:HWIFileDownloadJournalEventFail ofDownloadToken:aDownloadToken];
+            continue;
+        }
+        HWIFileDownloadWaitingItem *aWaitingItem = [[HWIFileDownloadWaitingItem alloc] initWithDownloadToken:aDownloadToken
+                                                                                                    remoteURL:anEntry.remoteURL
+                                                                                            resumeDataFileURL:(anEntry.resumeDataFileName ? [self.resumeDataStore fileURLForFileName:anEntry.resumeDataFileName] : nil)
+                                                                                                      options:[anEntry.options copy]];
+        aWaitingItem.retriesCount = anEntry.retriesCount;
+        if ((anEntry.partialFileSize > 0) && anEntry.remoteURL)
+        {
+            // a purged temporary file is downloaded again
+            NSNumber *aFileSize = nil;
+            [[self tempLocalFileURLForDownloadFromURL:anEntry.remoteURL] getResourceValue:&aFileSize forKey:NSURLFileSizeKey error:NULL];
+            if ([aFileSize longLongValue] == anEntry.partialFileSize)
+            {
+                aWaitingItem.partialFileSize = anEntry.partialFileSize;
+            }
+        }
+        [self.waitingDownloadsQueue enqueueWaitingItem:aWaitingItem];
+        if (anEntry.resumeDataFileName)
+        {
+            [aResumeDataFileNamesSet addObject:anEntry.resumeDataFileName];
+        }
+    }
+    if (self.queueJournal)
+    {
+        // files of downloads finished before the journal had been written
+        [self.resumeDataStore removeAllResumeDataExceptFileNames:aResumeDataFileNamesSet];
+    }
+    [self scheduleQueueJournalFlush];
+    [self startWaitingDownloadsInFreeSlots];
+}
+
+
+- (void)scheduleQueueJournalFlush
+{
+    if (self.queueJournal && (self.isQueueJournalFlushScheduled == NO))
+    {
+        self.isQueueJournalFlushScheduled = YES;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(HWIFileDownloaderQueueJournalFlushDelay * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            strongSelf.isQueueJournalFlushScheduled = NO;
+            [strongSelf.queueJournal flush];
+        });
+    }
+}
+
+
+#pragma mark - Adaptive Concurrency
+
+
+- (void)setAdaptsConcurrentDownloadsCount:(BOOL)anAdaptsConcurrentDownloadsCountFlag
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _adaptsConcurrentDownloadsCount = anAdaptsConcurrentDownloadsCountFlag;
+        [self resetConcurrencyController];
+    }];
+}
+
+
+- (void)setMinimumConcurrentDownloadsCount:(NSUInteger)aMinimumConcurrentDownloadsCount
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _minimumConcurrentDownloadsCount = MAX(aMinimumConcurrentDownloadsCount, (NSUInteger)1);
+        [self resetConcurrencyController];
+    }];
+}
+
+
+- (void)resetConcurrencyController
+{
+    if (self.adaptsConcurrentDownloadsCount)
+    {
+        NSUInteger aMaximumWindow = (self.maxConcurrentFileDownloadsCount > 0) ? (NSUInteger)self.maxConcurrentFileDownloadsCount : HWIFileDownloaderAdaptiveMaximumConcurrentDownloadsCount;
+        self.concurrencyController = [[HWIFileDownloadConcurrencyController alloc] initWithMinimumWindow:MIN(self.minimumConcurrentDownloadsCount, aMaximumWindow) maximumWindow:aMaximumWindow];
+    }
+    else
+    {
+        self.concurrencyController = nil;
+    }
+    [self startWaitingDownloadsInFreeSlots];
+}
+
+
+- (NSInteger)concurrentDownloadsWindow
+{
+    __block NSInteger aConcurrentDownloadsWindow = -1;
+    [self performOnDownloaderQueueAndWait:^{
+        aConcurrentDownloadsWindow = [self currentConcurrentDownloadsWindow];
+    }];
+    return aConcurrentDownloadsWindow;
+}
+
+
+- (nonnull NSArray<NSDictionary<NSString *, id> *> *)concurrencyDecisionsLog
+{
+    __block NSArray<NSDictionary<NSString *, id> *> *aDecisionsLog = nil;
+    [self performOnDownloaderQueueAndWait:^{
+        aDecisionsLog = self.concurrencyController.decisionsLog;
+    }];
+    if (aDecisionsLog == nil)
+    {
+        aDecisionsLog = @[];
+    }
+    return aDecisionsLog;
+}
+
+
+- (NSInteger)currentConcurrentDownloadsWindow
+{
+    NSInteger aConcurrentDownloadsWindow = self.maxConcurrentFileDownloadsCount;
+    if (self.concurrencyController)
+    {
+        aConcurrentDownloadsWindow = (NSInteger)self.concurrencyController.window;
+    }
+    return aConcurrentDownloadsWindow;
+}
+
+
+- (BOOL)hasFreeDownloadSlot
+{
+    NSInteger aConcurrentDownloadsWindow = [self currentConcurrentDownloadsWindow];
+    return ((aConcurrentDownloadsWindow == -1) || ((NSInteger)self.activeDownloadsDictionary.count < aConcurrentDownloadsWindow));
+}
+
+
+- (void)startWaitingDownloadsInFreeSlots
+{
+    while ((self.waitingDownloadsQueue.count > 0) && [self hasFreeDownloadSlot])
+    {
+        if ([self startNextWaitingDownload] == NO)
+        {
+            // the hosts of all waiting downloads are at their limit
+            break;
+        }
+    }
+}
+
+
+#pragma mark - Host Limits
+
+
+- (void)setMaxConcurrentDownloadsPerHostCount:(NSInteger)aMaxConcurrentDownloadsPerHostCount
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _maxConcurrentDownloadsPerHostCount = aMaxConcurrentDownloadsPerHostCount;
+        [self startWaitingDownloadsInFreeSlots];
+    }];
+}
+
+
+- (void)setMaxConcurrentDownloadsCountsPerHostDictionary:(nonnull NSDictionary<NSString *, NSNumber *> *)aMaxConcurrentDownloadsCountsPerHostDictionary
+{
+    NSMutableDictionary<NSString *, NSNumber *> *aLowercaseHostsDictionary = [NSMutableDictionary dictionaryWithCapacity:aMaxConcurrentDownloadsCountsPerHostDictionary.count];
+    [aMaxConcurrentDownloadsCountsPerHostDictionary enumerateKeysAndObjectsUsingBlock:^(NSString *aHost, NSNumber *aMaxConcurrentDownloadsCount, BOOL *aStopFlag) {
+        [aLowercaseHostsDictionary setObject:aMaxConcurrentDownloadsCount forKey:aHost.lowercaseString];
+    }];
+    [self performOnDownloaderQueueAndWait:^{
+        _maxConcurrentDownloadsCountsPerHostDictionary = [aLowercaseHostsDictionary copy];
+        [self startWaitingDownloadsInFreeSlots];
+    }];
+}
+
+
+- (nonnull NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)hostDownloadsCountsDictionary
+{
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *aHostDownloadsCountsDict = [NSMutableDictionary dictionary];
+    [self performOnDownloaderQueueAndWait:^{
+        NSMutableSet<NSString *> *aHostKeysSet = [NSMutableSet setWithArray:self.activeHostKeysCountedSet.allObjects];
+        [aHostKeysSet unionSet:[self.waitingDownloadsQueue hostKeys]];
+        for (NSString *aHostKey in aHostKeysSet)
+        {
+            [aHostDownloadsCountsDict setObject:@{@"activeDownloadsCount" : @([self.activeHostKeysCountedSet countForObject:aHostKey]),
+                                                  @"waitingDownloadsCount" : @([self.waitingDownloadsQueue countForHostKey:aHostKey])}
+                                         forKey:aHostKey];
+        }
+    }];
+    return aHostDownloadsCountsDict;
+}
+
+
+- (BOOL)hasFreeDownloadSlotForHostKey:(nonnull NSString *)aHostKey
+{
+    BOOL aHasFreeSlotFlag = YES;
+    if (aHostKey.length > 0)
+    {
+        NSInteger aMaxConcurrentDownloadsCount = self.maxConcurrentDownloadsPerHostCount;
+        NSNumber *aHostMaxConcurrentDownloadsCount = [self.maxConcurrentDownloadsCountsPerHostDictionary objectForKey:aHostKey];
+        if (aHostMaxConcurrentDownloadsCount)
+        {
+            aMaxConcurrentDownloadsCount = [aHostMaxConcurrentDownloadsCount integerValue];
+        }
+        aHasFreeSlotFlag = ((aMaxConcurrentDownloadsCount < 0) || ((NSInteger)[self.activeHostKeysCountedSet countForObject:aHostKey] < aMaxConcurrentDownloadsCount));
+    }
+    return aHasFreeSlotFlag;
+}
+
+
++ (nonnull NSString *)hostKeyForRemoteURL:(nullable NSURL *)aRemoteURL
+{
+    NSString *aHostKey = aRemoteURL.host.lowercaseString;
+    if (aHostKey == nil)
+    {
+        aHostKey = @"";
+    }
+    return aHostKey;
+}
+
+
+#pragma mark - Download Metrics
+
+
+- (void)setCollectsMetricsHistograms:(BOOL)aCollectsMetricsHistogramsFlag
+{
+    [self performOnDownloaderQueueAndWait:^{
+        _collectsMetricsHistograms = aCollectsMetricsHistogramsFlag;
+        if (aCollectsMetricsHistogramsFlag == NO)
+        {
+            self.metricsRecorder = nil;
+        }
+        else if (self.metricsRecorder == nil)
+        {
+            self.metricsRecorder = [[HWIFileDownloadMetricsRecorder alloc] init];
+        }
+    }];
+}
+
+
+- (nonnull NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *)metricsPercentilesDictionary
+{
+    __block NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *> *aPercentilesDictionary = nil;
+    [self performOnDownloaderQueueAndWait:^{
+        aPercentilesDictionary = [self.metricsRecorder percentilesDictionary];
+    }];
+    if (aPercentilesDictionary == nil)
+    {
+        aPercentilesDictionary = @{};
+    }
+    return aPercentilesDictionary;
+}
+
+
+- (void)finishMetricsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    if (self.metricsRecorder || [self.fileDownloadDelegate respondsToSelector:@selector(downloadMetricsCollectedWithIdentifier:metrics:)])
+    {
+        HWIFileDownloadMetrics *aMetrics = [HWIFileDownloader metricsOfDownloadItem:aDownloadItem];
+        [self.metricsRecorder recordMetrics:aMetrics];
+        NSString *aDownloadToken = aDownloadItem.downloadToken;
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            if ([aDelegate respondsToSelector:@selector(downloadMetricsCollectedWithIdentifier:metrics:)])
+            {
+                [aDelegate downloadMetricsCollectedWithIdentifier:aDownloadToken metrics:aMetrics];
+            }
+        }];
+    }
+}
+
+
++ (nonnull HWIFileDownloadMetrics *)metricsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    // timestamps of the downloader are used if the session does not provide metrics (iOS 9 and earlier, NSURLConnection, transports)
+    NSTimeInterval aDomainLookupDuration = -1.0;
+    NSTimeInterval aConnectDuration = -1.0;
+    NSTimeInterval aSecureConnectionDuration = -1.0;
+    NSTimeInterval aTimeToFirstByte = -1.0;
+    NSTimeInterval aTransferDuration = -1.0;
+    NSUInteger aRedirectsCount = aDownloadItem.redirectsCount;
+    if ((aDownloadItem.transferStartTime > 0.0) && (aDownloadItem.firstByteTime > 0.0))
+    {
+        aTimeToFirstByte = aDownloadItem.firstByteTime - aDownloadItem.transferStartTime;
+    }
+    if (aDownloadItem.firstByteTime > 0.0)
+    {
+        aTransferDuration = aDownloadItem.lastByteTime - aDownloadItem.firstByteTime;
+    }
+    if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_9_x_Max)
+    {
+        NSURLSessionTaskMetrics *aTaskMetrics = aDownloadItem.sessionTaskMetrics;
+        NSURLSessionTaskTransactionMetrics *aTransactionMetrics = [aTaskMetrics.transactionMetrics lastObject];
+        if (aTransactionMetrics)
+        {
+            NSTimeInterval aReusedConnectionDuration = aTransactionMetrics.reusedConnection ? 0.0 : -1.0;
+            aDomainLookupDuration = [HWIFileDownloader durationFromDate:aTransactionMetrics.domainLookupStartDate toDate:aTransactionMetrics.domainLookupEndDate defaultDuration:aReusedConnectionDuration];
+            aConnectDuration = [HWIFileDownloader durationFromDate:aTransactionMetrics.connectStartDate toDate:aTransactionMetrics.connectEndDate defaultDuration:aReusedConnectionDuration];
+            aSecureConnectionDuration = [HWIFileDownloader durationFromDate:aTransactionMetrics.secureConnectionStartDate toDate:aTransactionMetrics.secureConnectionEndDate defaultDuration:aReusedConnectionDuration];
+            aTimeToFirstByte = [HWIFileDownloader durationFromDate:aTransactionMetrics.requestStartDate toDate:aTransactionMetrics.responseStartDate defaultDuration:aTimeToFirstByte];
+            aTransferDuration = [HWIFileDownloader durationFromDate:aTransactionMetrics.responseStartDate toDate:aTransactionMetrics.responseEndDate defaultDuration:aTransferDuration];
+            aRedirectsCount = aTaskMetrics.redirectCount;
+        }
+    }
+    NSString *aHost = aDownloadItem.remoteURL.host;
+    if (aHost == nil)
+    {
+        aHost = aDownloadItem.sessionDownloadTask.originalRequest.URL.host;
+    }
+    return [[HWIFileDownloadMetrics alloc] initWithHost:aHost
+                                          queueWaitTime:aDownloadItem.queueWaitTime
+                                   domainLookupDuration:aDomainLookupDuration
+                                        connectDuration:aConnectDuration
+                               secureConnectionDuration:aSecureConnectionDuration
+                                        timeToFirstByte:aTimeToFirstByte
+                                       transferDuration:aTransferDuration
+                                     receivedBytesCount:aDownloadItem.receivedFileSizeInBytes
+                                         redirectsCount:aRedirectsCount];
+}
+
+
++ (NSTimeInterval)durationFromDate:(nullable NSDate *)aStartDate toDate:(nullable NSDate *)anEndDate defaultDuration:(NSTimeInterval)aDefaultDuration
+{
+    NSTimeInterval aDuration = aDefaultDuration;
+    if (aStartDate && anEndDate)
+    {
+        aDuration = MAX([anEndDate timeIntervalSinceDate:aStartDate], 0.0);
+    }
+    return aDuration;
+}
+
+
+#pragma mark - Download Progress
+
+
+- (nullable HWIFileDownloadProgress *)downloadProgressForIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    __block HWIFileDownloadProgress *aDownloadProgress = nil;
+    [self performOnDownloaderQueueAndWait:^{
+        NSString *aDownloadToken = [self transferDownloadTokenForDownloadToken:aDownloadIdentifier];
+        NSInteger aDownloadID = aDownloadToken ? [self downloadIDForActiveDownloadToken:aDownloadToken] : -1;
+        if (aDownloadID > -1)
+        {
+            aDownloadProgress = [self downloadProgressForDownloadID:aDownloadID];
+        }
+    }];
+    return aDownloadProgress;
+}
+
+
+- (nullable HWIFileDownloadProgress *)downloadProgressForDownloadID:(NSUInteger)aDownloadID
+{
+    HWIFileDownloadProgress *aDownloadProgress = nil;
+    HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+    if (aDownloadItem)
+    {
+        float aDownloadProgressFloat = 0.0;
+        if (aDownloadItem.expectedFileSizeInBytes > 0)
+        {
+            aDownloadProgressFloat = (float)aDownloadItem.receivedFileSizeInBytes / (float)aDownloadItem.expectedFileSizeInBytes;
+        }
+        NSDictionary *aRemainingTimeDict = [HWIFileDownloader remainingTimeAndBytesPerSecondForDownloadItem:aDownloadItem];
+        [HWIFileDownloader updateProgressOfDownloadItem:aDownloadItem withRemainingTimeDict:aRemainingTimeDict];
+        aDownloadProgress = [[HWIFileDownloadProgress alloc] initWithDownloadProgress:aDownloadProgressFloat
+                                                                     expectedFileSize:aDownloadItem.expectedFileSizeInBytes
+                                                                     receivedFileSize:aDownloadItem.receivedFileSizeInBytes
+                                                               estimatedRemainingTime:[[aRemainingTimeDict objectForKey:@"remainingTime"] doubleValue]
+                                                                  bytesPerSecondSpeed:[[aRemainingTimeDict objectForKey:@"bytesPerSecondSpeed"] unsignedIntegerValue]
+                                                                             progress:aDownloadItem.progress];
+    }
+    return aDownloadProgress;
+}
+
+
+- (NSUInteger)bytesPerSecondSpeed
+{
+    __block double aBytesPerSecondSpeed = 0.0;
+    [self performOnDownloaderQueueAndWait:^{
+        aBytesPerSecondSpeed = [self.throughputEstimator windowedBytesPerSecondAtTime:[NSDate timeIntervalSinceReferenceDate]];
+    }];
+    return (NSUInteger)aBytesPerSecondSpeed;
+}
+
+
+- (void)recordReceivedBytes:(int64_t)aBytesCount ofDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    NSTimeInterval aTime = [NSDate timeIntervalSinceReferenceDate];
+    if (aDownloadItem.firstByteTime <= 0.0)
+    {
+        aDownloadItem.firstByteTime = aTime;
+        [self.concurrencyController addLatency:(aTime - aDownloadItem.transferStartTime)];
+    }
+    aDownloadItem.lastByteTime = aTime;
+    self.receivedBytesCount += aBytesCount;
+    [self.throughputEstimator addReceivedBytes:aBytesCount atTime:aTime];
+    if ([aDownloadItem.throughputEstimator addReceivedBytes:aBytesCount atTime:aTime])
+    {
+        // keeps observers of NSProgress up to date without calling downloadProgressForIdentifier:, once per sample
+        NSDictionary *aRemainingTimeDict = [HWIFileDownloader remainingTimeAndBytesPerSecondForDownloadItem:aDownloadItem];
+        [HWIFileDownloader updateProgressOfDownloadItem:aDownloadItem withRemainingTimeDict:aRemainingTimeDict];
+    }
+    if ([self.concurrencyController evaluateWithBytesPerSecondSpeed:[self.throughputEstimator windowedBytesPerSecondAtTime:aTime] hasWaitingDownloads:(self.waitingDownloadsQueue.count > 0) atTime:aTime])
+    {
+        [self startWaitingDownloadsInFreeSlots];
+    }
+}
+
+
++ (void)updateProgressOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem withRemainingTimeDict:(nonnull NSDictionary *)aRemainingTimeDict
+{
+    if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+    {
+        [aDownloadItem.progress setUserInfoObject:[aRemainingTimeDict objectForKey:@"remainingTime"] forKey:NSProgressEstimatedTimeRemainingKey];
+        [aDownloadItem.progress setUserInfoObject:[aRemainingTimeDict objectForKey:@"bytesPerSecondSpeed"] forKey:NSProgressThroughputKey];
+    }
+}
+
+
+- (NSUInteger)getProgressSnapshots:(nonnull HWIFileDownloadProgressSnapshot *)aSnapshotsBuffer
+                          maxCount:(NSUInteger)aMaxCount
+                    forIdentifiers:(nonnull NSArray<NSString *> *)anIdentifiersArray
+{
+    __block NSUInteger aSnapshotsCount = 0;
+    [self performOnDownloaderQueueAndWait:^{
+        NSTimeInterval aTime = [NSDate timeIntervalSinceReferenceDate];
+        NSUInteger anIdentifierIndex = 0;
+        for (NSString *aDownloadIdentifier in anIdentifiersArray)
+        {
+            if (aSnapshotsCount == aMaxCount)
+            {
+                break;
+            }
+            NSString *aDownloadToken = [self transferDownloadTokenForDownloadToken:aDownloadIdentifier];
+            if (aDownloadToken)
+            {
+                NSNumber *aDownloadID = [self.activeDownloadIDsDictionary objectForKey:aDownloadToken];
+                HWIFileDownloadItem *aDownloadItem = aDownloadID ? [self.activeDownloadsDictionary objectForKey:aDownloadID] : nil;
+                if (aDownloadItem || [self.waitingDownloadsQueue waitingItemForDownloadToken:aDownloadToken] || [self.backingOffWaitingItemsDictionary objectForKey:aDownloadToken])
+                {
+                    [HWIFileDownloader fillProgressSnapshot:&aSnapshotsBuffer[aSnapshotsCount] identifierIndex:anIdentifierIndex downloadItem:aDownloadItem atTime:aTime];
+                    aSnapshotsCount++;
+                }
+            }
+            anIdentifierIndex++;
+        }
+    }];
+    return aSnapshotsCount;
+}
+
+
+- (NSUInteger)getAllProgressSnapshots:(nonnull HWIFileDownloadProgressSnapshot *)aSnapshotsBuffer
+                             maxCount:(NSUInteger)aMaxCount
+                          identifiers:(nonnull NSMutableArray<NSString *> *)anIdentifiersArray
+{
+    [anIdentifiersArray removeAllObjects];
+    [self performOnDownloaderQueueAndWait:^{
+        NSTimeInterval aTime = [NSDate timeIntervalSinceReferenceDate];
+        for (HWIFileDownloadItem *aDownloadItem in self.activeDownloadsDictionary.objectEnumerator)
+        {
+            if ([self fillProgressSnapshots:aSnapshotsBuffer maxCount:aMaxCount identifiers:anIdentifiersArray downloadToken:aDownloadItem.downloadToken downloadItem:aDownloadItem atTime:aTime] == NO)
+            {
+                return;
+            }
+        }
+        // waiting downloads in start order, then downloads waiting for a retry
+        for (HWIFileDownloadWaitingItem *aWaitingItem in [self.waitingDownloadsQueue allWaitingItems])
+        {
+            if ([self fillProgressSnapshots:aSnapshotsBuffer maxCount:aMaxCount identifiers:anIdentifiersArray downloadToken:aWaitingItem.downloadToken downloadItem:nil atTime:aTime] == NO)
+            {
+                return;
+            }
+        }
+        for (NSString *aDownloadToken in self.backingOffWaitingItemsDictionary.keyEnumerator)
+        {
+            if ([self fillProgressSnapshots:aSnapshotsBuffer maxCount:aMaxCount identifiers:anIdentifiersArray downloadToken:aDownloadToken downloadItem:nil atTime:aTime] == NO)
+            {
+                return;
+            }
+        }
+    }];
+    return anIdentifiersArray.count;
+}
+
+
+- (BOOL)fillProgressSnapshots:(nonnull HWIFileDownloadProgressSnapshot *)aSnapshotsBuffer
+                     maxCount:(NSUInteger)aMaxCount
+                  identifiers:(nonnull NSMutableArray<NSString *> *)anIdentifiersArray
+                downloadToken:(nonnull NSString *)aDownloadToken
+                 downloadItem:(nullable HWIFileDownloadItem *)aDownloadItem
+                       atTime:(NSTimeInterval)aTime
+{
+    // coalesced downloads report the transfer of their primary download
+    for (NSString *aReceivingDownloadToken in [self receivingDownloadTokensForDownloadToken:aDownloadToken])
+    {
+        if (anIdentifiersArray.count == aMaxCount)
+        {
+            return NO;
+        }
+        [HWIFileDownloader fillProgressSnapshot:&aSnapshotsBuffer[anIdentifiersArray.count] identifierIndex:anIdentifiersArray.count downloadItem:aDownloadItem atTime:aTime];
+        [anIdentifiersArray addObject:aReceivingDownloadToken];
+    }
+    return YES;
+}
+
+
++ (void)fillProgressSnapshot:(nonnull HWIFileDownloadProgressSnapshot *)aSnapshot
+             identifierIndex:(NSUInteger)anIdentifierIndex
+                downloadItem:(nullable HWIFileDownloadItem *)aDownloadItem
+                      atTime:(NSTimeInterval)aTime
+{
+    aSnapshot->identifierIndex = anIdentifierIndex;
+    if (aDownloadItem)
+    {
+        aSnapshot->state = HWIFileDownloadProgressSnapshotStateActive;
+        aSnapshot->receivedFileSize = aDownloadItem.receivedFileSizeInBytes;
+        aSnapshot->expectedFileSize = MAX(aDownloadItem.expectedFileSizeInBytes, (int64_t)0);
+        aSnapshot->bytesPerSecondSpeed = [HWIFileDownloader bytesPerSecondSpeedForDownloadItem:aDownloadItem atTime:aTime];
+        aSnapshot->estimatedRemainingTime = [HWIFileDownloader remainingTimeForDownloadItem:aDownloadItem bytesPerSecondSpeed:aSnapshot->bytesPerSecondSpeed];
+    }
+    else
+    {
+        // waiting for a free slot or for a retry
+        aSnapshot->state = HWIFileDownloadProgressSnapshotStateWaiting;
+        aSnapshot->receivedFileSize = 0;
+        aSnapshot->expectedFileSize = 0;
+        aSnapshot->bytesPerSecondSpeed = 0.0;
+        aSnapshot->estimatedRemainingTime = 0.0;
+    }
+}
+
+
+#pragma mark - Progress Delivery
+
+
+- (void)setMaximumProgressDeliveryRate:(double)aMaximumProgressDeliveryRate
+{
+    [self performOnDownloaderQueueAndWait:^{
+        self.progressCoalescer.deliveryInterval = (aMaximumProgressDeliveryRate > 0.0) ? (1.0 / aMaximumProgressDeliveryRate) : 0.0;
+    }];
+}
+
+
+- (double)maximumProgressDeliveryRate
+{
+    __block NSTimeInterval aDeliveryInterval = 0.0;
+    [self performOnDownloaderQueueAndWait:^{
+        aDeliveryInterval = self.progressCoalescer.deliveryInterval;
+    }];
+    return (aDeliveryInterval > 0.0) ? (1.0 / aDeliveryInterval) : 0.0;
+}
+
+
+- (void)setMaximumProgressDeliveryRatePerDownload:(double)aMaximumProgressDeliveryRatePerDownload
+{
+    [self performOnDownloaderQueueAndWait:^{
+        self.progressCoalescer.deliveryIntervalPerDownload = (aMaximumProgressDeliveryRatePerDownload > 0.0) ? (1.0 / aMaximumProgressDeliveryRatePerDownload) : 0.0;
+    }];
+}
+
+
+- (double)maximumProgressDeliveryRatePerDownload
+{
+    __block NSTimeInterval aDeliveryIntervalPerDownload = 0.0;
+    [self performOnDownloaderQueueAndWait:^{
+        aDeliveryIntervalPerDownload = self.progressCoalescer.deliveryIntervalPerDownload;
+    }];
+    return (aDeliveryIntervalPerDownload > 0.0) ? (1.0 / aDeliveryIntervalPerDownload) : 0.0;
+}
+
+
+- (NSUInteger)suppressedProgressCallbacksCount
+{
+    __block NSUInteger aSuppressedChangesCount = 0;
+    [self performOnDownloaderQueueAndWait:^{
+        aSuppressedChangesCount = self.progressCoalescer.suppressedChangesCount;
+    }];
+    return aSuppressedChangesCount;
+}
+
+
+- (void)notifyProgressChangedForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    NSArray<NSString *> *aDownloadTokensArray = [self receivingDownloadTokensForDownloadToken:aDownloadItem.downloadToken];
+    if (self.progressCoalescer.isEnabled == NO)
+    {
+        if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifier:)])
+        {
+            [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+                for (NSString *aDownloadToken in aDownloadTokensArray)
+                {
+                    [aDelegate downloadProgressChangedForIdentifier:aDownloadToken];
+                }
+            }];
+        }
+    }
+    else if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifiers:)] || [self.fileDownloadDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifier:)])
+    {
+        for (NSString *aDownloadToken in aDownloadTokensArray)
+        {
+            [self.progressCoalescer addChangedDownloadToken:aDownloadToken];
+        }
+        [self scheduleProgressDelivery];
+    }
+}
+
+
+- (void)scheduleProgressDelivery
+{
+    if ((self.isProgressDeliveryScheduled == NO) && (self.progressCoalescer.pendingDownloadTokensCount > 0))
+    {
+        self.isProgressDeliveryScheduled = YES;
+        NSTimeInterval aDeliveryDelay = [self.progressCoalescer deliveryDelayAtTime:[NSDate timeIntervalSinceReferenceDate]];
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(aDeliveryDelay * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            strongSelf.isProgressDeliveryScheduled = NO;
+            [strongSelf deliverCoalescedProgress];
+        });
+    }
+}
+
+
+- (void)deliverCoalescedProgress
+{
+    NSArray<NSString *> *aDueDownloadTokensArray = [self.progressCoalescer removeDueDownloadTokensAtTime:[NSDate timeIntervalSinceReferenceDate]];
+    NSMutableDictionary<NSString *, HWIFileDownloadProgress *> *aDownloadProgressesDictionary = [NSMutableDictionary dictionaryWithCapacity:aDueDownloadTokensArray.count];
+    for (NSString *aDownloadToken in aDueDownloadTokensArray)
+    {
+        HWIFileDownloadProgress *aDownloadProgress = [self downloadProgressForIdentifier:aDownloadToken];
+        if (aDownloadProgress)
+        {
+            [aDownloadProgressesDictionary setObject:aDownloadProgress forKey:aDownloadToken];
+        }
+    }
+    if (aDownloadProgressesDictionary.count > 0)
+    {
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            if ([aDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifiers:)])
+            {
+                [aDelegate downloadProgressChangedForIdentifiers:aDownloadProgressesDictionary];
+            }
+            else if ([aDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifier:)])
+            {
+                for (NSString *aDownloadToken in aDownloadProgressesDictionary)
+                {
+                    [aDelegate downloadProgressChangedForIdentifier:aDownloadToken];
+                }
+            }
+        }];
+    }
+    // downloads held back by the per download rate are delivered with a later tick
+    [self scheduleProgressDelivery];
+}
+
+
+#pragma mark - Bandwidth
+
+
+- (void)setMaximumBytesPerSecond:(int64_t)aMaximumBytesPerSecond
+{
+    [self performOnDownloaderQueueAndWait:^{
+        self.bandwidthThrottle.bytesPerSecondLimit = aMaximumBytesPerSecond;
+    }];
+}
+
+
+- (int64_t)maximumBytesPerSecond
+{
+    __block int64_t aMaximumBytesPerSecond = 0;
+    [self performOnDownloaderQueueAndWait:^{
+        aMaximumBytesPerSecond = self.bandwidthThrottle.bytesPerSecondLimit;
+    }];
+    return aMaximumBytesPerSecond;
+}
+
+
+- (void)setMaximumBytesPerSecond:(int64_t)aMaximumBytesPerSecond forPriority:(HWIFileDownloadPriority)aPriority
+{
+    [self performOnDownloaderQueueAndWait:^{
+        [self.bandwidthThrottle setBytesPerSecondLimit:aMaximumBytesPerSecond forPriority:aPriority];
+    }];
+}
+
+
+- (void)setMaximumBytesPerSecond:(int64_t)aMaximumBytesPerSecond forDownloadWithIdentifier:(nonnull NSString *)aDownloadIdentifier
+{
+    [self performOnDownloaderQueueAndWait:^{
+        [self.bandwidthThrottle setBytesPerSecondLimit:aMaximumBytesPerSecond forDownloadToken:aDownloadIdentifier];
+    }];
+}
+
+
+- (void)throttleDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID afterReceivingBytes:(int64_t)aBytesCount
+{
+    if (self.bandwidthThrottle.isEnabled && (aBytesCount > 0))
+    {
+        NSTimeInterval aDelay = [self.bandwidthThrottle delayAfterReceivingBytes:aBytesCount
+                                                                   downloadToken:aDownloadItem.downloadToken
+                                                                        priority:aDownloadItem.priority
+                                                                          atTime:[NSDate timeIntervalSinceReferenceDate]];
+        if ((aDelay >= HWIFileDownloaderMinimumThrottleDelay) && (aDownloadItem.isThrottled == NO))
+        {
+            BOOL anIsSuspendedFlag = [HWIFileDownloader isSuspendedDownloadItem:aDownloadItem];
+            aDownloadItem.isThrottled = YES;
+            if (anIsSuspendedFlag == NO)
+            {
+                [self suspendTransfersOfDownloadItem:aDownloadItem];
+            }
+            __weak HWIFileDownloader *weakSelf = self;
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(aDelay * NSEC_PER_SEC)), self.downloaderDispatchQueue, ^{
+                HWIFileDownloader *strongSelf = weakSelf;
+                if ([strongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] == aDownloadItem) // check for meanwhile finished download
+                {
+                    aDownloadItem.isThrottled = NO;
+                    if ([HWIFileDownloader isSuspendedDownloadItem:aDownloadItem] == NO)
+                    {
+                        [strongSelf resumeTransfersOfDownloadItem:aDownloadItem];
                     }
-                    
-                });
-                
+                }
+            });
+        }
+    }
+}
+
+
++ (BOOL)isSuspendedDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    // the transfers run only if no reason for holding them applies
+    return (aDownloadItem.isThrottled || aDownloadItem.isStreamBacklogFull || aDownloadItem.isWaitingForWriter);
+}
+
+
+- (void)suspendTransfersOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    if (aDownloadItem.urlConnection)
+    {
+        // NSURLConnection is scheduled on the main run loop (iOS 6); no data is delivered while unscheduled
+        [aDownloadItem.urlConnection unscheduleFromRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
+    }
+    else if (self.transportKind == HWIFileDownloaderTransportKindCustom)
+    {
+        [self.transport suspendTransferWithIdentifier:aDownloadItem.transferIdentifier];
+    }
+    else
+    {
+        for (NSURLSessionTask *aTask in [self sessionTasksOfDownloadItem:aDownloadItem])
+        {
+            if (aTask.state == NSURLSessionTaskStateRunning)
+            {
+                [aTask suspend];
             }
-            else
+        }
+    }
+}
+
+
+- (void)resumeTransfersOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    if (aDownloadItem.urlConnection)
+    {
+        [aDownloadItem.urlConnection scheduleInRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
+    }
+    else if (self.transportKind == HWIFileDownloaderTransportKindCustom)
+    {
+        [self.transport resumeTransferWithIdentifier:aDownloadItem.transferIdentifier];
+    }
+    else
+    {
+        for (NSURLSessionTask *aTask in [self sessionTasksOfDownloadItem:aDownloadItem])
+        {
+            if (aTask.state == NSURLSessionTaskStateSuspended)
+            {
+                [aTask resume];
+            }
+        }
+    }
+}
+
+
+- (nonnull NSArray<NSURLSessionTask *> *)sessionTasksOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    NSMutableArray<NSURLSessionTask *> *aTasksArray = [NSMutableArray array];
+    if (aDownloadItem.isSegmented)
+    {
+        for (HWIFileDownloadSegment *aSegment in aDownloadItem.segmentsArray)
+        {
+            if (aSegment.sessionDataTask)
+            {
+                [aTasksArray addObject:aSegment.sessionDataTask];
+            }
+        }
+    }
+    else if (aDownloadItem.sessionDownloadTask)
+    {
+        [aTasksArray addObject:aDownloadItem.sessionDownloadTask];
+    }
+    else if (aDownloadItem.streamDataTask)
+    {
+        [aTasksArray addObject:aDownloadItem.streamDataTask];
+    }
+    return aTasksArray;
+}
+
+
+#pragma mark - Write Budget
+
+
+- (void)setMaximumPendingWriteBytesCount:(int64_t)aMaximumPendingWriteBytesCount
+{
+    self.writeBudget.capacity = aMaximumPendingWriteBytesCount;
+}
+
+
+- (int64_t)maximumPendingWriteBytesCount
+{
+    return self.writeBudget.capacity;
+}
+
+
+- (void)holdTransfersForWriter
+{
+    // all downloads share the file writer queue
+    for (HWIFileDownloadItem *aDownloadItem in self.activeDownloadsDictionary.allValues)
+    {
+        if ((aDownloadItem.fileWriter || aDownloadItem.segmentedFileWriter) && (aDownloadItem.isWaitingForWriter == NO))
+        {
+            [self holdTransfersOfDownloadItem:aDownloadItem];
+        }
+    }
+}
+
+
+- (void)holdTransfersOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    BOOL anIsSuspendedFlag = [HWIFileDownloader isSuspendedDownloadItem:aDownloadItem];
+    aDownloadItem.isWaitingForWriter = YES;
+    if (anIsSuspendedFlag == NO)
+    {
+        [self suspendTransfersOfDownloadItem:aDownloadItem];
+    }
+}
+
+
+- (void)resumeTransfersWaitingForWriter
+{
+    // the budget might have been exhausted again meanwhile; the next drain resumes the transfers
+    if (self.writeBudget.isExhausted == NO)
+    {
+        for (HWIFileDownloadItem *aDownloadItem in self.activeDownloadsDictionary.allValues)
+        {
+            if (aDownloadItem.isWaitingForWriter)
+            {
+                aDownloadItem.isWaitingForWriter = NO;
+                if ([HWIFileDownloader isSuspendedDownloadItem:aDownloadItem] == NO)
+                {
+                    [self resumeTransfersOfDownloadItem:aDownloadItem];
+                }
+            }
+        }
+    }
+}
+
+
+#pragma mark - Stream
+
+
+- (nonnull NSURLSession *)openStreamSession
+{
+    // data tasks of streamed and segmented downloads; background sessions do not deliver data while downloading
+    if (self.streamSession == nil)
+    {
+        self.streamSession = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                           delegate:self
+                                                      delegateQueue:self.sessionDelegateOperationQueue];
+    }
+    return self.streamSession;
+}
+
+
+- (void)attachStreamToDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    HWIFileDownloadOptions *anOptions = aDownloadItem.options;
+    HWIFileDownloadStream *aStream = [[HWIFileDownloadStream alloc] initWithConsumer:anOptions.streamConsumer
+                                                                       downloadToken:aDownloadItem.downloadToken
+                                                                     backlogCapacity:anOptions.maximumStreamBacklogSize
+                                                                       callbackQueue:self.downloaderDispatchQueue];
+    __weak HWIFileDownloader *weakSelf = self;
+    __weak HWIFileDownloadItem *weakDownloadItem = aDownloadItem;
+    aStream.drainHandler = ^{
+        HWIFileDownloader *strongSelf = weakSelf;
+        HWIFileDownloadItem *strongDownloadItem = weakDownloadItem;
+        if (strongDownloadItem && ([strongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] == strongDownloadItem)) // check for meanwhile finished download
+        {
+            strongDownloadItem.isStreamBacklogFull = NO;
+            if ([HWIFileDownloader isSuspendedDownloadItem:strongDownloadItem] == NO)
             {
-                NSString *aMissingURLErrorString = [NSString stringWithFormat:@"ERR: Missing information: Local file URL (token: %@) (%@, %d)", aDownloadItem.downloadToken, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
-                NSLog(@"%@", aMissingURLErrorString);
-                NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
-                if (anErrorMessagesStackArray == nil)
-                {
-                    anErrorMessagesStackArray = [NSMutableArray array];
-                }
-                [anErrorMessagesStackArray insertObject:aMissingURLErrorString atIndex:0];
-                [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
-                NSError *aMissingURLError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorUnsupportedURL userInfo:nil];
-                [self handleDownloadWithError:aMissingURLError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+                [strongSelf resumeTransfersOfDownloadItem:strongDownloadItem];
             }
         }
-        else
-        {
-            NSLog(@"ERR: No download item found on URL connection finish (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+    };
+    aDownloadItem.stream = aStream;
+}
+
 
+- (void)streamData:(nonnull NSData *)aData ofDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+{
+    HWIFileDownloadStream *aStream = aDownloadItem.stream;
+    [aStream deliverData:aData];
+    self.streamedBytesCount += (int64_t)aData.length;
+    if (aStream.isFull && (aDownloadItem.isStreamBacklogFull == NO))
+    {
+        // no more data is received until the consumer has caught up
+        BOOL anIsSuspendedFlag = [HWIFileDownloader isSuspendedDownloadItem:aDownloadItem];
+        aDownloadItem.isStreamBacklogFull = YES;
+        self.streamSuspensionsCount++;
+        if (anIsSuspendedFlag == NO)
+        {
+            [self suspendTransfersOfDownloadItem:aDownloadItem];
         }
     }
+}
+
+
+- (void)completeStreamedDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
+{
+    if ([self isValidHttpStatusCodeOfDownloadItem:aDownloadItem] == NO)
+    {
+        [self handleInvalidHttpStatusCodeOfDownloadItem:aDownloadItem downloadID:aDownloadID failingURL:aDownloadItem.remoteURL];
+    }
     else
     {
-        NSLog(@"ERR: No download id found on URL connection finish (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+        aDownloadItem.progress.completedUnitCount = aDownloadItem.progress.totalUnitCount;
+        [self.progressCoalescer removeDownloadToken:aDownloadItem.downloadToken];
+        [self.bandwidthThrottle removeDownloadToken:aDownloadItem.downloadToken];
+        [self removeActiveDownloadItemWithDownloadID:aDownloadID];
+        self.completedDownloadsCount++;
+        [aDownloadItem.stream finishWithError:nil];
+        NSString *aDownloadToken = aDownloadItem.downloadToken;
+        [self finishMetricsOfDownloadItem:aDownloadItem];
+        [self performDelegateCallback:^(NSObject<HWIFileDownloadDelegate> *aDelegate) {
+            [aDelegate decrementNetworkActivityIndicatorActivityCount];
+            
+            if ([aDelegate respondsToSelector:@selector(streamedDownloadDidCompleteWithIdentifier:)])
+            {
+                [aDelegate streamedDownloadDidCompleteWithIdentifier:aDownloadToken];
+            }
+        }];
+        [self startWaitingDownloadsInFreeSlots];
     }
 }
 
 
-- (void)connection:(nonnull NSURLConnection *)aConnection didReceiveResponse:(nonnull NSURLResponse *)aResponse
+#pragma mark - Decompression
+
+
++ (nullable id<HWIFileDownloadTransform>)transformOfKind:(HWIFileDownloadTransformKind)aTransformKind outputURL:(nonnull NSURL *)anOutputURL bufferSize:(NSUInteger)aBufferSize
 {
-    NSNumber *aFoundDownloadID = [self downloadIDForConnection:aConnection];
-    if (aFoundDownloadID)
+    id<HWIFileDownloadTransform> aTransform = nil;
+    switch (aTransformKind)
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aFoundDownloadID];
-        if (aDownloadItem)
-        {
-            if (aDownloadItem.downloadStartDate == nil)
-            {
-                aDownloadItem.downloadStartDate = [NSDate date];
-            }
-            long long anExpectedContentLength = [aResponse expectedContentLength];
-            if (anExpectedContentLength > 0)
-            {
-                aDownloadItem.expectedFileSizeInBytes = anExpectedContentLength;
-            }
-            NSHTTPURLResponse *aHttpResponse = (NSHTTPURLResponse *)aResponse;
-            aDownloadItem.lastHttpStatusCode = aHttpResponse.statusCode;
-        }
+        case HWIFileDownloadTransformKindGzip:
+            aTransform = [[HWIFileDownloadGzipTransform alloc] initWithOutputURL:anOutputURL bufferSize:aBufferSize];
+            break;
+        case HWIFileDownloadTransformKindZip:
+            aTransform = [[HWIFileDownloadZipTransform alloc] initWithOutputURL:anOutputURL bufferSize:aBufferSize];
+            break;
+        case HWIFileDownloadTransformKindNone:
+            break;
     }
+    return aTransform;
 }
 
 
-- (void)connection:(nonnull NSURLConnection *)aConnection didReceiveData:(nonnull NSData *)aData
+- (void)decodeDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
+                        downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
+                          downloadID:(NSUInteger)aDownloadID
 {
-    NSNumber *aFoundDownloadID = [self downloadIDForConnection:aConnection];
-    if (aFoundDownloadID)
+    if ((aDownloadItem.options.transformKind == HWIFileDownloadTransformKindNone) || aDownloadItem.transform)
     {
-        NSURL *aTempFileURL = [self tempLocalFileURLForDownloadFromURL:aConnection.originalRequest.URL];
-        if ([[NSFileManager defaultManager] fileExistsAtPath:aTempFileURL.path] == NO)
-        {
-            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
-                [[NSFileManager defaultManager] createFileAtPath:aTempFileURL.path contents:nil attributes:nil];
-            });
-        }
-        
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aFoundDownloadID];
-        if (aDownloadItem)
-        {
-            if (aDownloadItem.downloadStartDate == nil)
+        // not decoded or decoded while the data was received
+        [self validateDownloadToLocalFileURL:aLocalFileURL
+                                downloadItem:aDownloadItem
+                                  downloadID:aDownloadID];
+    }
+    else
+    {
+        // download tasks deliver the complete file, it is decoded in one pass into a hidden sibling and replaced
+        NSString *aDecodedFileName = [NSString stringWithFormat:@".%@.decoded", aLocalFileURL.lastPathComponent];
+        NSURL *aDecodedFileURL = [[aLocalFileURL URLByDeletingLastPathComponent] URLByAppendingPathComponent:aDecodedFileName];
+        [[NSFileManager defaultManager] removeItemAtURL:aDecodedFileURL error:NULL];
+        id<HWIFileDownloadTransform> aTransform = [HWIFileDownloader transformOfKind:aDownloadItem.options.transformKind outputURL:aDecodedFileURL bufferSize:self.fileWriteBufferSize];
+        dispatch_queue_t aDownloaderDispatchQueue = self.downloaderDispatchQueue;
+        __weak HWIFileDownloader *weakSelf = self;
+        dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
+            HWIFileDownloader *strongSelf = weakSelf;
+            NSError *aDecodeError = nil;
+            BOOL aDecodeSuccessFlag = [strongSelf decodeFileAtURL:aLocalFileURL withTransform:aTransform error:&aDecodeError];
+            if (aDecodeSuccessFlag)
             {
-                aDownloadItem.downloadStartDate = [NSDate date];
+                aDecodeSuccessFlag = [HWIFileDownloadFileWriter moveItemAtURL:aDecodedFileURL toURL:aLocalFileURL fileSize:NULL error:&aDecodeError];
             }
-            int64_t anUntilNowReceivedContentSize = aDownloadItem.receivedFileSizeInBytes;
-            int64_t aCompleteReceivedContentSize = anUntilNowReceivedContentSize + [aData length];
-            aDownloadItem.receivedFileSizeInBytes = aCompleteReceivedContentSize;
-            
-            if ([self.fileDownloadDelegate respondsToSelector:@selector(downloadProgressChangedForIdentifier:)])
+            if (aDecodeSuccessFlag == NO)
             {
-                NSString *aDownloadIdentifier = [aDownloadItem.downloadToken copy];
-                if (aDownloadIdentifier)
+                [[NSFileManager defaultManager] removeItemAtURL:aDecodedFileURL error:NULL];
+            }
+            dispatch_async(aDownloaderDispatchQueue, ^{
+                HWIFileDownloader *anotherStrongSelf = weakSelf;
+                if ([anotherStrongSelf.activeDownloadsDictionary objectForKey:@(aDownloadID)] != aDownloadItem)
                 {
-                    [self.fileDownloadDelegate downloadProgressChangedForIdentifier:aDownloadItem.downloadToken];
+                    // download has been cancelled meanwhile
+                    [[NSFileManager defaultManager] removeItemAtURL:aLocalFileURL error:NULL];
                 }
-            }
-            
-            dispatch_async(self.downloadFileSerialWriterDispatchQueue, ^{
-                NSFileHandle *aFileHandle = [NSFileHandle fileHandleForWritingAtPath:aTempFileURL.path];
-                if (!aFileHandle)
+                else if (aDecodeSuccessFlag)
                 {
-                    NSLog(@"ERR: No file handle (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
+                    aDownloadItem.transform = aTransform;
+                    [anotherStrongSelf validateDownloadToLocalFileURL:aLocalFileURL
+                                                         downloadItem:aDownloadItem
+                                                           downloadID:aDownloadID];
                 }
                 else
                 {
-                    [aFileHandle seekToEndOfFile];
-                    [aFileHandle writeData:aData];
-                    [aFileHandle closeFile];
+                    NSString *aDecodeErrorString = [NSString stringWithFormat:@"ERR: Unable to decode file %@ (%@) (%@, %d)", aLocalFileURL, aDecodeError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__];
+                    NSLog(@"%@", aDecodeErrorString);
+                    NSMutableArray<NSString *> *anErrorMessagesStackArray = [aDownloadItem.errorMessagesStack mutableCopy];
+                    if (anErrorMessagesStackArray == nil)
+                    {
+                        anErrorMessagesStackArray = [NSMutableArray array];
+                    }
+                    [anErrorMessagesStackArray insertObject:aDecodeErrorString atIndex:0];
+                    [aDownloadItem setErrorMessagesStack:anErrorMessagesStackArray];
+                    NSError *aFinalError = [[NSError alloc] initWithDomain:NSURLErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:nil];
+                    [anotherStrongSelf handleDownloadWithError:aFinalError downloadItem:aDownloadItem downloadID:aDownloadID resumeData:nil];
                 }
             });
-        }
+        });
     }
 }
 
 
-- (NSNumber *)downloadIDForConnection:(nonnull NSURLConnection *)aConnection
+- (BOOL)decodeFileAtURL:(nonnull NSURL *)aFileURL withTransform:(nonnull id<HWIFileDownloadTransform>)aTransform error:(NSError * _Nullable * _Nullable)anError
 {
-    NSNumber *aFoundDownloadID = nil;
-    NSArray *aDownloadKeysArray = [self.activeDownloadsDictionary allKeys];
-    for (NSNumber *aDownloadID in aDownloadKeysArray)
+    // called on downloadFileSerialWriterDispatchQueue
+    BOOL aSuccessFlag = YES;
+    NSInputStream *anInputStream = [NSInputStream inputStreamWithURL:aFileURL];
+    [anInputStream open];
+    NSMutableData *aReadBuffer = [NSMutableData dataWithLength:HWIFileDownloaderDecodeReadBufferSize];
+    NSInteger aReadLength = 0;
+    while (aSuccessFlag && ((aReadLength = [anInputStream read:aReadBuffer.mutableBytes maxLength:aReadBuffer.length]) > 0))
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
-        if ([aDownloadItem.urlConnection isEqual:aConnection])
-        {
-            aFoundDownloadID = aDownloadID;
-            break;
-        }
+        aSuccessFlag = [aTransform transformData:[NSData dataWithBytesNoCopy:aReadBuffer.mutableBytes length:(NSUInteger)aReadLength freeWhenDone:NO] error:anError];
     }
-    return aFoundDownloadID;
-}
-
-
-#pragma mark - NSURLConnectionDelegate
-
-
-- (void)connection:(nonnull NSURLConnection *)aConnection didFailWithError:(nonnull NSError *)anError
-{
-    NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
-    if (aDownloadID)
+    if (aSuccessFlag && (aReadLength < 0))
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
-        if (aDownloadItem)
+        aSuccessFlag = NO;
+        if (anError)
         {
-            NSLog(@"ERR: NSURLConnection failed with error: %@ (%@, %d)", anError.localizedDescription, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-            [self handleDownloadWithError:anError downloadItem:aDownloadItem downloadID:[aDownloadID unsignedIntegerValue] resumeData:nil];
+            *anError = anInputStream.streamError;
         }
     }
+    [anInputStream close];
+    // the output files are closed in any case
+    BOOL aFinishSuccessFlag = [self finishTransform:aTransform error:(aSuccessFlag ? anError : NULL)];
+    return (aSuccessFlag && aFinishSuccessFlag);
 }
 
 
-- (BOOL)connectionShouldUseCredentialStorage:(NSURLConnection *)aConnection
+- (BOOL)finishTransform:(nullable id<HWIFileDownloadTransform>)aTransform error:(NSError * _Nullable * _Nullable)anError
 {
-    return NO;
+    // called on downloadFileSerialWriterDispatchQueue
+    BOOL aSuccessFlag = YES;
+    if (aTransform)
+    {
+        aSuccessFlag = [aTransform finishWithError:anError];
+        self.closedFileWritersWrittenBytesCount += aTransform.writtenBytesCount;
+        self.closedFileWritersSystemCallsCount += aTransform.systemCallsCount;
+    }
+    return aSuccessFlag;
 }
 
 
-- (void)connection:(NSURLConnection *)aConnection willSendRequestForAuthenticationChallenge:(NSURLAuthenticationChallenge *)aChallenge
++ (nullable NSArray<NSURL *> *)extractedFileURLsOfDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem localFileURL:(nonnull NSURL *)aLocalFileURL
 {
-    if ([self.fileDownloadDelegate respondsToSelector:@selector(onAuthenticationChallenge:downloadIdentifier:completionHandler:)])
+    NSArray<NSURL *> *anExtractedFileURLsArray = nil;
+    id<HWIFileDownloadTransform> aTransform = aDownloadItem.transform;
+    if (aTransform)
     {
-        NSNumber *aDownloadID = [self downloadIDForConnection:aConnection];
-        if (aDownloadID)
+        // read after the transform has been finished on the file writer queue
+        NSArray<NSString *> *aRelativePathsArray = aTransform.outputRelativePaths;
+        if (aRelativePathsArray.count > 0)
         {
-            HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
-            
-            if (aDownloadItem)
-            {
-                
-                [self.fileDownloadDelegate onAuthenticationChallenge:aChallenge
-                                                  downloadIdentifier:aDownloadItem.downloadToken
-                                                   completionHandler:^(NSURLCredential * _Nullable aCredential, NSURLSessionAuthChallengeDisposition aDisposition) {
-                                                       [aChallenge.sender useCredential:aCredential forAuthenticationChallenge:aChallenge];
-                                                   }];
-            }
-            else
+            NSMutableArray<NSURL *> *aFileURLsArray = [NSMutableArray arrayWithCapacity:aRelativePathsArray.count];
+            for (NSString *aRelativePath in aRelativePathsArray)
             {
-                NSLog(@"ERR: Missing download item for download id: %@ (%@, %d)", aDownloadItem, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-                [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+                [aFileURLsArray addObject:[aLocalFileURL URLByAppendingPathComponent:aRelativePath]];
             }
+            anExtractedFileURLsArray = aFileURLsArray;
         }
         else
         {
-            [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+            anExtractedFileURLsArray = @[aLocalFileURL];
         }
     }
+    return anExtractedFileURLsArray;
+}
+
+
+#pragma mark - Dispatch Queues
+
+
+- (void)performOnDownloaderQueueAndWait:(nonnull void (^)(void))aBlock
+{
+    if ((self.usesPrivateDispatchQueue == NO) || (dispatch_get_specific(HWIFileDownloaderDispatchQueueKey) == (__bridge void *)self))
+    {
+        aBlock();
+    }
     else
     {
-        NSLog(@"ERR: Received authentication challenge with no delegate method implemented (%@, %d)", [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-        [aChallenge.sender cancelAuthenticationChallenge:aChallenge];
+        dispatch_sync(self.downloaderDispatchQueue, aBlock);
     }
 }
 
 
-#pragma mark - HWIFileDownloadDelegate Defaults
+- (void)performOnDownloaderQueue:(nonnull void (^)(void))aBlock
+{
+    if ((self.usesPrivateDispatchQueue == NO) || (dispatch_get_specific(HWIFileDownloaderDispatchQueueKey) == (__bridge void *)self))
+    {
+        aBlock();
+    }
+    else
+    {
+        dispatch_async(self.downloaderDispatchQueue, aBlock);
+    }
+}
 
 
-+ (nullable NSURL *)localFileURLForRemoteURL:(nonnull NSURL *)aRemoteURL
+- (void)performCallback:(nonnull void (^)(void))aCallbackBlock
 {
-    NSURL *aLocalFileURL = nil;
-    NSURL *aFileDownloadDirectoryURL = nil;
-    NSError *anError = nil;
-    NSArray *aDocumentDirectoryURLsArray = [[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask];
-    NSURL *aDocumentsDirectoryURL = [aDocumentDirectoryURLsArray firstObject];
-    if (aDocumentsDirectoryURL)
+    // called on downloaderDispatchQueue
+    if (self.delegateCallbackDispatchQueue)
     {
-        aFileDownloadDirectoryURL = [aDocumentsDirectoryURL URLByAppendingPathComponent:@"file-download" isDirectory:YES];
-        if ([[NSFileManager defaultManager] fileExistsAtPath:aFileDownloadDirectoryURL.path] == NO)
-        {
-            BOOL aCreateDirectorySuccess = [[NSFileManager defaultManager] createDirectoryAtPath:aFileDownloadDirectoryURL.path withIntermediateDirectories:YES attributes:nil error:&anError];
-            if (aCreateDirectorySuccess == NO)
-            {
-                NSLog(@"ERR on create directory: %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-            }
-            else
-            {
-                BOOL aSetResourceValueSuccess = [aFileDownloadDirectoryURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:&anError];
-                if (aSetResourceValueSuccess == NO)
-                {
-                    NSLog(@"ERR on set resource value (NSURLIsExcludedFromBackupKey): %@ (%@, %d)", anError, [NSString stringWithUTF8String:__FILE__].lastPathComponent, __LINE__);
-                }
-            }
-        }
-        NSString *aLocalFileName = [NSString stringWithFormat:@"%@.%@", [[NSUUID UUID] UUIDString], [[aRemoteURL lastPathComponent] pathExtension]];
-        aLocalFileURL = [aFileDownloadDirectoryURL URLByAppendingPathComponent:aLocalFileName isDirectory:NO];
+        dispatch_async(self.delegateCallbackDispatchQueue, aCallbackBlock);
+    }
+    else
+    {
+        aCallbackBlock();
     }
-    return aLocalFileURL;
 }
 
 
-+ (BOOL)httpStatusCode:(NSInteger)aHttpStatusCode isValidForDownloadIdentifier:(nonnull NSString *)aDownloadIdentifier
+- (void)performDelegateCallback:(nonnull void (^)(NSObject<HWIFileDownloadDelegate> * _Nonnull aDelegate))aDelegateCallbackBlock
 {
-    BOOL anIsCorrectFlag = NO;
-    if ((aHttpStatusCode >= 200) && (aHttpStatusCode < 300))
+    NSObject<HWIFileDownloadDelegate> *aDelegate = self.fileDownloadDelegate;
+    if (aDelegate)
     {
-        anIsCorrectFlag = YES;
+        [self performCallback:^{
+            aDelegateCallbackBlock(aDelegate);
+        }];
     }
-    return anIsCorrectFlag;
 }
 
 
-#pragma mark - Download Completion Handler
+#pragma mark - Utilities
 
 
-- (void)handleSuccessfulDownloadToLocalFileURL:(nonnull NSURL *)aLocalFileURL
-                                  downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
-                                    downloadID:(NSUInteger)aDownloadID
++ (nonnull NSDate *)appLaunchDate
 {
-    aDownloadItem.progress.completedUnitCount = aDownloadItem.progress.totalUnitCount;
-    [self.activeDownloadsDictionary removeObjectForKey:@(aDownloadID)];
-    [self.fileDownloadDelegate decrementNetworkActivityIndicatorActivityCount];
-    
-    [self.fileDownloadDelegate downloadDidCompleteWithIdentifier:aDownloadItem.downloadToken
-                                                    localFileURL:aLocalFileURL];
-    [self startNextWaitingDownload];
+    // taken when the first downloader is initialized, before any resume data has been written
+    static NSDate *anAppLaunchDate = nil;
+    static dispatch_once_t anOnceToken;
+    dispatch_once(&anOnceToken, ^{
+        // one second earlier for file systems with a timestamp resolution of one second
+        anAppLaunchDate = [NSDate dateWithTimeIntervalSinceNow:-1.0];
+    });
+    return anAppLaunchDate;
 }
 
 
-- (void)handleDownloadWithError:(nonnull NSError *)anError
-                   downloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem
-                     downloadID:(NSUInteger)aDownloadID
-                     resumeData:(nullable NSData *)aResumeData
+- (NSInteger)downloadIDForActiveDownloadToken:(nonnull NSString *)aDownloadToken
 {
-    aDownloadItem.progress.completedUnitCount = aDownloadItem.progress.totalUnitCount;
-    [self.activeDownloadsDictionary removeObjectForKey:@(aDownloadID)];
-    [self.fileDownloadDelegate decrementNetworkActivityIndicatorActivityCount];
-    
-    [self.fileDownloadDelegate downloadFailedWithIdentifier:aDownloadItem.downloadToken
-                                                      error:anError
-                                             httpStatusCode:aDownloadItem.lastHttpStatusCode
-                                         errorMessagesStack:aDownloadItem.errorMessagesStack
-                                                 resumeData:aResumeData];
-    [self startNextWaitingDownload];
+    NSInteger aFoundDownloadID = -1;
+    NSNumber *aDownloadID = [self.activeDownloadIDsDictionary objectForKey:aDownloadToken];
+    if (aDownloadID)
+    {
+        aFoundDownloadID = [aDownloadID unsignedIntegerValue];
+    }
+    return aFoundDownloadID;
 }
 
 
-#pragma mark - Download Progress
+#pragma mark - Download Registry
 
 
-- (nullable HWIFileDownloadProgress *)downloadProgressForIdentifier:(nonnull NSString *)aDownloadIdentifier
+- (void)addActiveDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem downloadID:(NSUInteger)aDownloadID
 {
-    HWIFileDownloadProgress *aDownloadProgress = nil;
-    NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aDownloadIdentifier];
-    if (aDownloadID > -1)
+    [self.activeDownloadsDictionary setObject:aDownloadItem forKey:@(aDownloadID)];
+    [self.activeDownloadIDsDictionary setObject:@(aDownloadID) forKey:aDownloadItem.downloadToken];
+    if (aDownloadItem.urlConnection)
     {
-        aDownloadProgress = [self downloadProgressForDownloadID:aDownloadID];
+        [self.connectionDownloadIDsMapTable setObject:@(aDownloadID) forKey:aDownloadItem.urlConnection];
     }
-    return aDownloadProgress;
+    if (aDownloadItem.hostKey == nil)
+    {
+        aDownloadItem.hostKey = [HWIFileDownloader hostKeyForRemoteURL:aDownloadItem.remoteURL];
+    }
+    [self.activeHostKeysCountedSet addObject:aDownloadItem.hostKey];
 }
 
 
-- (nullable HWIFileDownloadProgress *)downloadProgressForDownloadID:(NSUInteger)aDownloadID
+- (void)removeActiveDownloadItemWithDownloadID:(NSUInteger)aDownloadID
 {
-    HWIFileDownloadProgress *aDownloadProgress = nil;
     HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
     if (aDownloadItem)
     {
-        float aDownloadProgressFloat = 0.0;
-        if (aDownloadItem.expectedFileSizeInBytes > 0)
+        // a download token might have been restarted with another download id meanwhile
+        NSNumber *anIndexedDownloadID = [self.activeDownloadIDsDictionary objectForKey:aDownloadItem.downloadToken];
+        if ([anIndexedDownloadID unsignedIntegerValue] == aDownloadID)
         {
-            aDownloadProgressFloat = (float)aDownloadItem.receivedFileSizeInBytes / (float)aDownloadItem.expectedFileSizeInBytes;
+            [self.activeDownloadIDsDictionary removeObjectForKey:aDownloadItem.downloadToken];
         }
-        NSDictionary *aRemainingTimeDict = [HWIFileDownloader remainingTimeAndBytesPerSecondForDownloadItem:aDownloadItem];
-        if (floor(NSFoundationVersionNumber) > NSFoundationVersionNumber_iOS_6_1)
+        if (aDownloadItem.urlConnection)
         {
-            [aDownloadItem.progress setUserInfoObject:[aRemainingTimeDict objectForKey:@"remainingTime"] forKey:NSProgressEstimatedTimeRemainingKey];
-            [aDownloadItem.progress setUserInfoObject:[aRemainingTimeDict objectForKey:@"bytesPerSecondSpeed"] forKey:NSProgressThroughputKey];
+            [self.connectionDownloadIDsMapTable removeObjectForKey:aDownloadItem.urlConnection];
         }
-        aDownloadProgress = [[HWIFileDownloadProgress alloc] initWithDownloadProgress:aDownloadProgressFloat
-                                                                     expectedFileSize:aDownloadItem.expectedFileSizeInBytes
-                                                                     receivedFileSize:aDownloadItem.receivedFileSizeInBytes
-                                                               estimatedRemainingTime:[[aRemainingTimeDict objectForKey:@"remainingTime"] doubleValue]
-                                                                  bytesPerSecondSpeed:[[aRemainingTimeDict objectForKey:@"bytesPerSecondSpeed"] unsignedIntegerValue]
-                                                                             progress:aDownloadItem.progress];
+        if (aDownloadItem.hostKey)
+        {
+            [self.activeHostKeysCountedSet removeObject:aDownloadItem.hostKey];
+        }
+        [self.activeDownloadsDictionary removeObjectForKey:@(aDownloadID)];
     }
-    return aDownloadProgress;
 }
 
 
-#pragma mark - Utilities
-
-
-- (NSInteger)downloadIDForActiveDownloadToken:(nonnull NSString *)aDownloadToken
+- (nullable HWIFileDownloadWaitingItem *)removeWaitingItemForDownloadToken:(nonnull NSString *)aDownloadToken
 {
-    NSInteger aFoundDownloadID = -1;
-    NSArray *aDownloadKeysArray = [self.activeDownloadsDictionary allKeys];
-    for (NSNumber *aDownloadID in aDownloadKeysArray)
+    HWIFileDownloadWaitingItem *aRemovedWaitingItem = [self.waitingDownloadsQueue removeWaitingItemForDownloadToken:aDownloadToken];
+    if (aRemovedWaitingItem == nil)
     {
-        HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:aDownloadID];
-        if ([aDownloadItem.downloadToken isEqualToString:aDownloadToken])
-        {
-            aFoundDownloadID = [aDownloadID unsignedIntegerValue];
-            break;
-        }
+        aRemovedWaitingItem = [self.backingOffWaitingItemsDictionary objectForKey:aDownloadToken];
+        [self.backingOffWaitingItemsDictionary removeObjectForKey:aDownloadToken];
     }
-    return aFoundDownloadID;
+    if (aRemovedWaitingItem.resumeDataFileURL)
+    {
+        [self.resumeDataStore removeResumeDataAtFileURL:aRemovedWaitingItem.resumeDataFileURL];
+    }
+    if (aRemovedWaitingItem)
+    {
+        // e.g. the limit of a download waiting for a retry
+        [self.bandwidthThrottle removeDownloadToken:aDownloadToken];
+    }
+    [HWIFileDownloader completeProgress:aRemovedWaitingItem.progress];
+    return aRemovedWaitingItem;
 }
 
 
-- (void)startNextWaitingDownload
+- (BOOL)startNextWaitingDownload
 {
-    if ((self.maxConcurrentFileDownloadsCount == -1) || ((NSInteger)self.activeDownloadsDictionary.count < self.maxConcurrentFileDownloadsCount))
+    BOOL aStartedFlag = NO;
+    if ([self hasFreeDownloadSlot])
     {
-        if (self.waitingDownloadsArray.count > 0)
+        HWIFileDownloadWaitingItem *aWaitingItem = [self.waitingDownloadsQueue dequeueWaitingItemPassingHostTest:^BOOL(NSString *aHostKey) {
+            return [self hasFreeDownloadSlotForHostKey:aHostKey];
+        }];
+        if (aWaitingItem)
         {
-            NSDictionary *aWaitingDownload = [self.waitingDownloadsArray objectAtIndex:0];
-            NSString *aDownloadToken = aWaitingDownload[@"downloadToken"];
-            NSURL *aRemoteURL = aWaitingDownload[@"remoteURL"];
-            NSData *aResumeData = aWaitingDownload[@"resumeData"];
-            [self.waitingDownloadsArray removeObjectAtIndex:0];
-            [self startDownloadWithDownloadToken:aDownloadToken
-                                   fromRemoteURL:aRemoteURL
-                                 usingResumeData:aResumeData];
+            aStartedFlag = YES;
+            aWaitingItem.options.priority = aWaitingItem.priority;
+            NSData *aResumeData = nil;
+            if (aWaitingItem.resumeDataFileURL)
+            {
+                aResumeData = [self.resumeDataStore resumeDataAtFileURL:aWaitingItem.resumeDataFileURL];
+            }
+            self.retriedDownloadProgress = aWaitingItem.progress;
+            self.retriedDownloadRetriesCount = aWaitingItem.retriesCount;
+            [self startDownloadWithDownloadToken:aWaitingItem.downloadToken
+                                   fromRemoteURL:aWaitingItem.remoteURL
+                                 usingResumeData:aResumeData
+                                 partialFileSize:aWaitingItem.partialFileSize
+                                         options:aWaitingItem.options];
+            if (self.retriedDownloadProgress)
+            {
+                // completed from the cache or attached to another download
+                [HWIFileDownloader completeProgress:self.retriedDownloadProgress];
+                self.retriedDownloadProgress = nil;
+            }
+            self.retriedDownloadRetriesCount = 0;
+            if (aWaitingItem.resumeDataFileURL)
+            {
+                [self.resumeDataStore removeResumeDataAtFileURL:aWaitingItem.resumeDataFileURL];
+            }
+            NSInteger aDownloadID = [self downloadIDForActiveDownloadToken:aWaitingItem.downloadToken];
+            if (aDownloadID > -1)
+            {
+                HWIFileDownloadItem *aDownloadItem = [self.activeDownloadsDictionary objectForKey:@(aDownloadID)];
+                aDownloadItem.queueWaitTime = [NSDate timeIntervalSinceReferenceDate] - aWaitingItem.enqueueTime;
+            }
         }
     }
+    return aStartedFlag;
 }
 
 
@@ -1436,40 +5181,70 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)aChallenge
     NSUInteger aBytesPerSecondsSpeed = 0;
     if ((aDownloadItem.receivedFileSizeInBytes > 0) && (aDownloadItem.expectedFileSizeInBytes > 0))
     {
-        float aSmoothingFactor = 0.8; // range 0.0 ... 1.0 (determines the weight of the current speed calculation in relation to the stored past speed value)
-        NSTimeInterval aDownloadDurationUntilNow = [[NSDate date] timeIntervalSinceDate:aDownloadItem.downloadStartDate];
-        int64_t aDownloadedFileSize = aDownloadItem.receivedFileSizeInBytes - aDownloadItem.resumedFileSizeInBytes;
-        float aCurrentBytesPerSecondSpeed = (aDownloadDurationUntilNow > 0.0) ? (aDownloadedFileSize / aDownloadDurationUntilNow) : 0.0;
-        float aNewWeightedBytesPerSecondSpeed = 0.0;
-        if (aDownloadItem.bytesPerSecondSpeed > 0.0)
-        {
-            aNewWeightedBytesPerSecondSpeed = (aSmoothingFactor * aCurrentBytesPerSecondSpeed) + ((1.0 - aSmoothingFactor) * (float)aDownloadItem.bytesPerSecondSpeed);
-        }
-        else
-        {
-            aNewWeightedBytesPerSecondSpeed = aCurrentBytesPerSecondSpeed;
-        }
-        if (aNewWeightedBytesPerSecondSpeed > 0.0)
-        {
-            aRemainingTimeInterval = (aDownloadItem.expectedFileSizeInBytes - aDownloadItem.resumedFileSizeInBytes - aDownloadedFileSize) / aNewWeightedBytesPerSecondSpeed;
-        }
-        aBytesPerSecondsSpeed = (NSUInteger)aNewWeightedBytesPerSecondSpeed;
+        double aCurrentBytesPerSecondSpeed = [HWIFileDownloader bytesPerSecondSpeedForDownloadItem:aDownloadItem atTime:[NSDate timeIntervalSinceReferenceDate]];
+        aRemainingTimeInterval = [HWIFileDownloader remainingTimeForDownloadItem:aDownloadItem bytesPerSecondSpeed:aCurrentBytesPerSecondSpeed];
+        aBytesPerSecondsSpeed = (NSUInteger)aCurrentBytesPerSecondSpeed;
         aDownloadItem.bytesPerSecondSpeed = aBytesPerSecondsSpeed;
     }
     return @{@"bytesPerSecondSpeed" : @(aBytesPerSecondsSpeed), @"remainingTime" : @(aRemainingTimeInterval)};
 }
 
 
++ (double)bytesPerSecondSpeedForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem atTime:(NSTimeInterval)aTime
+{
+    // speed within the sliding window of the estimator, follows changes of the network within seconds
+    double aBytesPerSecondSpeed = [aDownloadItem.throughputEstimator windowedBytesPerSecondAtTime:aTime];
+    if ((aBytesPerSecondSpeed <= 0.0) && aDownloadItem.downloadStartDate)
+    {
+        // not enough samples yet: average since start
+        NSTimeInterval aDownloadDurationUntilNow = aTime - aDownloadItem.downloadStartDate.timeIntervalSinceReferenceDate;
+        int64_t aDownloadedFileSize = aDownloadItem.receivedFileSizeInBytes - aDownloadItem.resumedFileSizeInBytes;
+        aBytesPerSecondSpeed = (aDownloadDurationUntilNow > 0.0) ? (aDownloadedFileSize / aDownloadDurationUntilNow) : 0.0;
+    }
+    return aBytesPerSecondSpeed;
+}
+
+
++ (NSTimeInterval)remainingTimeForDownloadItem:(nonnull HWIFileDownloadItem *)aDownloadItem bytesPerSecondSpeed:(double)aBytesPerSecondSpeed
+{
+    NSTimeInterval aRemainingTimeInterval = 0.0;
+    if ((aBytesPerSecondSpeed > 0.0) && (aDownloadItem.expectedFileSizeInBytes > 0))
+    {
+        aRemainingTimeInterval = MAX(aDownloadItem.expectedFileSizeInBytes - aDownloadItem.receivedFileSizeInBytes, (int64_t)0) / aBytesPerSecondSpeed;
+    }
+    return aRemainingTimeInterval;
+}
+
+
 #pragma mark - Description
 
 
 - (NSString *)description
 {
     NSMutableDictionary *aDescriptionDict = [NSMutableDictionary dictionary];
-    [aDescriptionDict setObject:self.activeDownloadsDictionary forKey:@"activeDownloadsDictionary"];
-    [aDescriptionDict setObject:self.waitingDownloadsArray forKey:@"waitingDownloadsArray"];
-    [aDescriptionDict setObject:@(self.maxConcurrentFileDownloadsCount) forKey:@"maxConcurrentFileDownloadsCount"];
-    [aDescriptionDict setObject:@(self.highestDownloadID) forKey:@"highestDownloadID"];
+    [self performOnDownloaderQueueAndWait:^{
+        [aDescriptionDict setObject:self.activeDownloadsDictionary forKey:@"activeDownloadsDictionary"];
+        [aDescriptionDict setObject:self.waitingDownloadsQueue forKey:@"waitingDownloadsQueue"];
+        if (self.backingOffWaitingItemsDictionary.count > 0)
+        {
+            [aDescriptionDict setObject:self.backingOffWaitingItemsDictionary forKey:@"backingOffWaitingItemsDictionary"];
+        }
+        [aDescriptionDict setObject:@(self.maxConcurrentFileDownloadsCount) forKey:@"maxConcurrentFileDownloadsCount"];
+        if (self.concurrencyController)
+        {
+            [aDescriptionDict setObject:self.concurrencyController forKey:@"concurrencyController"];
+        }
+        [aDescriptionDict setObject:@(self.highestDownloadID) forKey:@"highestDownloadID"];
+        [aDescriptionDict setObject:self.progressCoalescer forKey:@"progressCoalescer"];
+        [aDescriptionDict setObject:self.bandwidthThrottle forKey:@"bandwidthThrottle"];
+        [aDescriptionDict setObject:self.deduplicator forKey:@"deduplicator"];
+    }];
+    [aDescriptionDict setObject:@(self.usesPrivateDispatchQueue) forKey:@"usesPrivateDispatchQueue"];
+    [aDescriptionDict setObject:@(self.transportKind) forKey:@"transportKind"];
+    if (self.transport)
+    {
+        [aDescriptionDict setObject:self.transport forKey:@"transport"];
+    }
     
     NSString *aDescriptionString = [NSString stringWithFormat:@"%@", aDescriptionDict];
     
@@ -1481,6 +5256,14 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)aChallenge
 }
 
 - (void)invalidateSessionConfigurationAndCancelTasks:(BOOL)cancelTasks {
+    [self performOnDownloaderQueueAndWait:^{
+        if (self.transportKind == HWIFileDownloaderTransportKindSession) {
+            [self invalidateBackgroundSessionAndCancelTasks:cancelTasks];
+        }
+    }];
+}
+
+- (void)invalidateBackgroundSessionAndCancelTasks:(BOOL)cancelTasks {
     NSURLSession *oldBackgroundSession = self.backgroundSession;
     self.backgroundSessionIdentifier = [NSString stringWithFormat:@"%@.%@", [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleIdentifier"], [NSUUID new].UUIDString];
 
@@ -1489,7 +5272,7 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)aChallenge
 
     self.backgroundSession = [NSURLSession sessionWithConfiguration:configuration
                                                            delegate:self
-                                                      delegateQueue:[NSOperationQueue mainQueue]];
+                                                      delegateQueue:self.sessionDelegateOperationQueue];
 
     if (cancelTasks) {
         [oldBackgroundSession invalidateAndCancel];